@@ -24,6 +24,18 @@ static void addParams(CLI::App &app, Params &params) {
               {"pixel", simulate::SimulatorType::Pixel}},
           CLI::ignore_case))
       ->capture_default_str();
+  app.add_option("--pixel-integrator", params.pixelIntegrator,
+                 "The integrator to use with the pixel simulator: rk101, "
+                 "rk212, rk323, rk435 or imex (implicit diffusion). If not "
+                 "set, the integrator from the model settings is used.")
+      ->transform(CLI::CheckedTransformer(
+          std::map<std::string, simulate::PixelIntegratorType, std::less<>>{
+              {"rk101", simulate::PixelIntegratorType::RK101},
+              {"rk212", simulate::PixelIntegratorType::RK212},
+              {"rk323", simulate::PixelIntegratorType::RK323},
+              {"rk435", simulate::PixelIntegratorType::RK435},
+              {"imex", simulate::PixelIntegratorType::IMEX}},
+          CLI::ignore_case));
   app.add_option("-o,--output-file", params.outputFile,
                  "The output file to write the results to. If not set, then "
                  "the input file is used.");
@@ -31,6 +43,34 @@ static void addParams(CLI::App &app, Params &params) {
                  "The maximum number of CPU threads to use (0 means unlimited)")
       ->check(CLI::NonNegativeNumber)
       ->capture_default_str();
+  app.add_option("--checkpoint-file", params.checkpointFile,
+                 "Periodically write a checkpoint to this file, which can be "
+                 "used to resume the simulation");
+  app.add_option("--checkpoint-interval", params.checkpointInterval,
+                 "The minimum time (in seconds) between checkpoints")
+      ->check(CLI::NonNegativeNumber)
+      ->capture_default_str();
+  app.add_option("--resume", params.resumeFile,
+                 "Resume the simulation from this checkpoint file")
+      ->check(CLI::ExistingFile);
+  app.add_option("--data-file", params.dataFile,
+                 "Store the simulation results in a temporary file with this "
+                 "name and a unique suffix while simulating, instead of "
+                 "keeping them all in memory");
+  app.add_option("--kernel-cache-dir", params.kernelCacheDir,
+                 "Cache compiled reaction kernels in this directory, to be "
+                 "re-used by later simulations of the same model");
+}
+
+static void addValidation(CLI::App &app, const Params &params) {
+  app.final_callback([&params]() {
+    if (params.simType == simulate::SimulatorType::DUNE &&
+        (!params.checkpointFile.empty() || !params.resumeFile.empty())) {
+      throw CLI::ValidationError(
+          "--checkpoint-file/--resume",
+          "Checkpoints are only supported by the pixel simulator");
+    }
+  });
 }
 
 static void addCallbacks(CLI::App &app) {
@@ -56,6 +96,7 @@ Params setupCLI(CLI::App &app) {
   app.description({fmt::format("Spatial Model Editor CLI v{}",
                                common::SPATIAL_MODEL_EDITOR_VERSION)});
   addParams(app, params);
+  addValidation(app, params);
   addCallbacks(app);
   addConfig(app);
   return params;
@@ -70,14 +111,47 @@ std::string toString(const simulate::SimulatorType &s) {
   return {};
 }
 
+std::string toString(const simulate::PixelIntegratorType &p) {
+  if (p == simulate::PixelIntegratorType::RK101) {
+    return "RK101";
+  } else if (p == simulate::PixelIntegratorType::RK212) {
+    return "RK212";
+  } else if (p == simulate::PixelIntegratorType::RK323) {
+    return "RK323";
+  } else if (p == simulate::PixelIntegratorType::RK435) {
+    return "RK435";
+  } else if (p == simulate::PixelIntegratorType::IMEX) {
+    return "IMEX";
+  }
+  return {};
+}
+
 void printParams(const Params &params) {
   fmt::print("\n# Simulation parameters:\n");
   fmt::print("#   - Model: {}\n", params.inputFile);
   fmt::print("#   - Simulation Type: {}\n", toString(params.simType));
+  if (params.simType == simulate::SimulatorType::Pixel &&
+      params.pixelIntegrator.has_value()) {
+    fmt::print("#   - Pixel Integrator: {}\n",
+               toString(params.pixelIntegrator.value()));
+  }
   fmt::print("#   - Simulation Length(s): {}\n", params.simulationTimes);
   fmt::print("#   - Image Interval(s): {}\n", params.imageIntervals);
   fmt::print("#   - Output file: {}\n", params.outputFile);
   fmt::print("#   - Max CPU threads: {}\n", params.maxThreads);
+  if (!params.checkpointFile.empty()) {
+    fmt::print("#   - Checkpoint file: {}\n", params.checkpointFile);
+    fmt::print("#   - Checkpoint interval: {}s\n", params.checkpointInterval);
+  }
+  if (!params.resumeFile.empty()) {
+    fmt::print("#   - Resume from checkpoint: {}\n", params.resumeFile);
+  }
+  if (!params.dataFile.empty()) {
+    fmt::print("#   - Temporary data file: {}\n", params.dataFile);
+  }
+  if (!params.kernelCacheDir.empty()) {
+    fmt::print("#   - Kernel cache directory: {}\n", params.kernelCacheDir);
+  }
 }
 
 } // namespace sme::cli
@@ -2,6 +2,7 @@
 
 #include "sme/simulate.hpp"
 #include <CLI/CLI.hpp>
+#include <optional>
 
 namespace sme::cli {
 
@@ -10,14 +11,23 @@ struct Params {
   std::string simulationTimes;
   std::string imageIntervals;
   simulate::SimulatorType simType{simulate::SimulatorType::DUNE};
+  // if not set, the integrator from the model settings is used
+  std::optional<simulate::PixelIntegratorType> pixelIntegrator{};
   std::string outputFile{};
   std::size_t maxThreads{0};
+  std::string checkpointFile{};
+  double checkpointInterval{600.0};
+  std::string resumeFile{};
+  std::string dataFile{};
+  std::string kernelCacheDir{};
 };
 
 Params setupCLI(CLI::App &app);
 
 std::string toString(const simulate::SimulatorType &s);
 
+std::string toString(const simulate::PixelIntegratorType &p);
+
 void printParams(const Params &params);
 
 } // namespace sme::cli
@@ -1,11 +1,15 @@
 #include "catch_wrapper.hpp"
 #include "cli_params.hpp"
+#include <fmt/core.h>
+#include <fstream>
 
 using namespace sme;
 
 TEST_CASE("CLI Params", "[cli][params]") {
   REQUIRE(cli::toString(simulate::SimulatorType::DUNE) == "DUNE");
   REQUIRE(cli::toString(simulate::SimulatorType::Pixel) == "Pixel");
+  REQUIRE(cli::toString(simulate::PixelIntegratorType::RK212) == "RK212");
+  REQUIRE(cli::toString(simulate::PixelIntegratorType::IMEX) == "IMEX");
 
   REQUIRE_NOTHROW(cli::printParams(cli::Params{}));
 
@@ -13,8 +17,24 @@ TEST_CASE("CLI Params", "[cli][params]") {
   cli::setupCLI(a);
   REQUIRE(a.get_description().substr(0, 24) == "Spatial Model Editor CLI");
   REQUIRE(a.get_groups().size() == 1);
-  REQUIRE(a.get_options().size() == 10);
+  REQUIRE(a.get_options().size() == 16);
   REQUIRE(a.get_option("file")->get_required() == true);
   REQUIRE(a.get_option("times")->get_required() == true);
   REQUIRE(a.get_option("image-intervals")->get_required() == true);
+
+  SECTION("Checkpoints are rejected for the dune simulator") {
+    const char *tmpInputFile{"tmpcliparams.xml"};
+    std::ofstream(tmpInputFile) << "<sbml/>";
+    CLI::App app;
+    auto params{cli::setupCLI(app)};
+    REQUIRE_THROWS_AS(
+        app.parse(fmt::format("{} 1 1 -s dune --checkpoint-file c.bin",
+                              tmpInputFile)),
+        CLI::ValidationError);
+    CLI::App appPixel;
+    auto paramsPixel{cli::setupCLI(appPixel)};
+    REQUIRE_NOTHROW(appPixel.parse(fmt::format(
+        "{} 1 1 -s pixel --checkpoint-file c.bin", tmpInputFile)));
+    REQUIRE(paramsPixel.checkpointFile == "c.bin");
+  }
 }
@@ -2,8 +2,12 @@
 #include "sme/logger.hpp"
 #include "sme/model.hpp"
 #include "sme/simulate.hpp"
+#include "sme/simulate_checkpoint.hpp"
+#include "sme/symbolic.hpp"
 #include <QFile>
+#include <algorithm>
 #include <fmt/core.h>
+#include <memory>
 
 namespace sme::cli {
 
@@ -24,10 +28,29 @@ void printSimulationTimes(
   }
 }
 
+// remove the first nCompleted timesteps from times
+static std::vector<std::pair<std::size_t, double>>
+getRemainingTimes(const std::vector<std::pair<std::size_t, double>> &times,
+                  std::size_t nCompleted) {
+  std::vector<std::pair<std::size_t, double>> remaining;
+  for (auto [n, l] : times) {
+    std::size_t nSkip{std::min(n, nCompleted)};
+    nCompleted -= nSkip;
+    if (n > nSkip) {
+      remaining.push_back({n - nSkip, l});
+    }
+  }
+  return remaining;
+}
+
 bool doSimulation(const Params &params) {
   // disable logging
   spdlog::set_level(spdlog::level::off);
 
+  if (!params.kernelCacheDir.empty()) {
+    common::Symbolic::setCacheDirectory(params.kernelCacheDir);
+  }
+
   // import model
   model::Model s;
   s.importFile(params.inputFile);
@@ -49,22 +72,65 @@ bool doSimulation(const Params &params) {
   auto &options{s.getSimulationSettings().options};
   options.pixel.enableMultiThreading = true;
   options.pixel.maxThreads = params.maxThreads;
+  if (params.pixelIntegrator.has_value()) {
+    options.pixel.integrator = params.pixelIntegrator.value();
+  }
   if (params.maxThreads == 1) {
     options.pixel.enableMultiThreading = false;
   }
-  simulate::Simulation sim(s);
-  if (const auto &e = sim.errorMessage(); !e.empty()) {
+  if (!params.dataFile.empty()) {
+    s.getSimulationData().concentration.setBackingFile(params.dataFile);
+  }
+  // number of timepoints in the input file, if continuing a simulation
+  const std::size_t nInitialTimePoints{
+      std::max(s.getSimulationData().timePoints.size(), std::size_t{1})};
+  auto initialTimes{s.getSimulationSettings().times};
+  std::unique_ptr<simulate::SimulationCheckpoint> checkpoint;
+  if (!params.resumeFile.empty()) {
+    checkpoint = simulate::importCheckpoint(params.resumeFile);
+    if (checkpoint == nullptr ||
+        checkpoint->data.timePoints.size() < nInitialTimePoints) {
+      fmt::print("\n\nError: invalid checkpoint '{}'\n\n", params.resumeFile);
+      return false;
+    }
+  }
+  auto sim{checkpoint == nullptr
+               ? std::make_unique<simulate::Simulation>(s)
+               : std::make_unique<simulate::Simulation>(s, *checkpoint)};
+  if (const auto &e = sim->errorMessage(); !e.empty()) {
     fmt::print("\n\nError in simulation setup: {}\n\n", e);
     return false;
   }
 
   printSimulationInfo(s);
 
-  sim.doMultipleTimesteps(times.value());
-  if (const auto &e = sim.errorMessage(); !e.empty()) {
+  auto remainingTimes{times.value()};
+  if (checkpoint != nullptr) {
+    remainingTimes = getRemainingTimes(
+        times.value(), checkpoint->data.timePoints.size() - nInitialTimePoints);
+  }
+  if (!sim->setCheckpointFile(params.checkpointFile,
+                              params.checkpointInterval)) {
+    fmt::print("\n\nError: checkpoints are not supported by this "
+               "simulator\n\n");
+    return false;
+  }
+  sim->doMultipleTimesteps(remainingTimes);
+  if (const auto &e = sim->errorMessage(); !e.empty()) {
     fmt::print("\n\nError during simulation: {}\n\n", e);
     return false;
   }
+  if (checkpoint != nullptr) {
+    // record the full list of simulation times, as if the simulation had not
+    // been interrupted
+    auto &settingsTimes{s.getSimulationSettings().times};
+    settingsTimes.clear();
+    if (nInitialTimePoints > 1) {
+      settingsTimes = initialTimes;
+    }
+    settingsTimes.insert(settingsTimes.end(), times.value().cbegin(),
+                         times.value().cend());
+  }
   s.exportSMEFile(params.outputFile);
   return true;
 }
@@ -54,4 +54,35 @@ TEST_CASE("CLI Simulate", "[cli][simulate]") {
     REQUIRE(m2.getSimulationData().timePoints.size() == 13);
     REQUIRE(m2.getSimulationData().timePoints[12] == dbl_approx(1.20));
   }
+  SECTION("Pixel integrator from model is used if not specified") {
+    const char *tmpXmlFile{"tmpcli3.xml"};
+    const char *tmpInputFile{"tmpcli3.sme"};
+    const char *tmpOutputFile{"tmpcli3out.sme"};
+    QFile::copy(":/models/ABtoC.xml", tmpXmlFile);
+    model::Model m;
+    m.importFile(tmpXmlFile);
+    m.getSimulationSettings().options.pixel.integrator =
+        simulate::PixelIntegratorType::RK323;
+    m.exportSMEFile(tmpInputFile);
+    cli::Params params;
+    params.inputFile = tmpInputFile;
+    params.simulationTimes = "0.1";
+    params.imageIntervals = "0.1";
+    params.outputFile = tmpOutputFile;
+    params.simType = simulate::SimulatorType::Pixel;
+    doSimulation(params);
+    model::Model m2;
+    m2.importFile(tmpOutputFile);
+    REQUIRE(m2.getSimulationData().timePoints.size() == 2);
+    REQUIRE(m2.getSimulationSettings().options.pixel.integrator ==
+            simulate::PixelIntegratorType::RK323);
+    // integrator specified on the command line is used instead
+    params.inputFile = tmpInputFile;
+    params.pixelIntegrator = simulate::PixelIntegratorType::RK435;
+    doSimulation(params);
+    model::Model m3;
+    m3.importFile(tmpOutputFile);
+    REQUIRE(m3.getSimulationSettings().options.pixel.integrator ==
+            simulate::PixelIntegratorType::RK435);
+  }
 }
@@ -7,12 +7,17 @@
 //  - returns simplified expressions with constants/functions inlined as string
 //  - returns differential of any expression wrt any variable as string
 //  - compiles expressions using LLVM for fast repeated evaluation
+//  - optionally compiles a batched version that evaluates several points
+//  per call, the first time it is used
+//  - compiled object code is cached, so compiling the same expressions again
+//  is cheap
 
 #pragma once
 
 #include "sme/symbolic_function.hpp"
 #include <cstddef>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <symengine/basic.h>
 #include <symengine/llvm_double.h>
@@ -25,7 +30,17 @@ namespace sme::common {
 
 class Symbolic {
 private:
+  // evaluates batchSize independent copies of the expressions in one call,
+  // compiled by the first call to evalBatch
+  struct BatchKernel {
+    std::once_flag compiled{};
+    std::unique_ptr<SymEngine::LLVMDoubleVisitor> lambda{};
+  };
   std::unique_ptr<SymEngine::LLVMDoubleVisitor> lambdaLLVM{};
+  std::unique_ptr<BatchKernel> batchKernel{};
+  std::size_t batchSize{1};
+  bool compileDoCSE{true};
+  unsigned compileOptLevel{3};
   SymEngine::vec_basic exprInlined{};
   SymEngine::vec_basic exprOriginal{};
   SymEngine::vec_basic varVec{};
@@ -35,6 +50,7 @@ private:
   SymEngine::SbmlParser parser{};
   bool valid{false};
   bool compiled{false};
+  void compileBatchKernel() const;
 
 public:
   Symbolic();
@@ -60,7 +76,8 @@ public:
              const std::vector<std::pair<std::string, double>> &constants = {},
              const std::vector<SymbolicFunction> &functions = {},
              bool allow_unknown_symbols = false);
-  bool compile(bool doCSE = true, unsigned optLevel = 3);
+  bool compile(bool doCSE = true, unsigned optLevel = 3,
+               std::size_t nBatch = 1);
   [[nodiscard]] std::string expr(std::size_t i = 0) const;
   [[nodiscard]] std::string inlinedExpr(std::size_t i = 0) const;
   [[nodiscard]] std::string diff(const std::string &var,
@@ -70,10 +87,26 @@ public:
   void eval(std::vector<double> &results,
             const std::vector<double> &vars = {}) const;
   void eval(double *results, const double *vars) const;
+  // evaluate at nPoints points, where the variables for point i start at
+  // vars[i*stride] and the results for point i are written to
+  // results[i*stride]. If nBatch > 1 was given to compile, the batched
+  // version is compiled by the first call. The points are passed directly to
+  // the compiled function if stride equals the number of variables and
+  // expressions, otherwise they are copied through a buffer
+  void evalBatch(double *results, const double *vars, std::size_t nPoints,
+                 std::size_t stride) const;
+  [[nodiscard]] std::size_t getBatchSize() const;
   [[nodiscard]] bool isValid() const;
   [[nodiscard]] bool isCompiled() const;
   [[nodiscard]] const std::string &getErrorMessage() const;
   void clear();
+  // the cache of compiled object code is shared by all instances. It is keyed
+  // by the inlined expressions, variables, CSE flag & optimization level, and
+  // is kept in memory, and also in this directory if it is not empty
+  static void setCacheDirectory(const std::string &directory);
+  [[nodiscard]] static std::string getCacheDirectory();
+  [[nodiscard]] static std::size_t getCacheSize();
+  static void clearCache();
 };
 
 } // namespace sme::common
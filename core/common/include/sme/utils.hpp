@@ -166,31 +166,44 @@ std::vector<int> toInt(const std::vector<bool> &v);
 /**
  * @brief Convert a string to a vector of values
  *
- * The values in the string are separated by spaces.
+ * The values in the string are separated by whitespace. Parsing stops at the
+ * first value that cannot be parsed. Large strings are split into chunks at
+ * whitespace boundaries and the chunks are parsed in parallel.
+ *
+ * Supported types are the built-in integer types, `float` and `double`.
  *
  * @tparam T the type of the values
  */
-template <typename T> std::vector<T> stringToVector(const std::string &str) {
-  std::istringstream ss(str);
-  return std::vector<T>(std::istream_iterator<T>(ss),
-                        std::istream_iterator<T>{});
-}
+template <typename T> std::vector<T> stringToVector(std::string_view str);
 
 /**
  * @brief Convert a vector of values to a string
  *
  * The values in the string are separated by spaces.
- * Doubles are printed in scientific notation with 17 significant digits.
+ * Floating point values use the shortest representation that round-trips
+ * exactly. Large vectors are converted in parallel chunks.
+ *
+ * Supported types are the built-in integer types, `float` and `double`.
  *
  * @tparam T the type of the values
  */
-template <typename T> std::string vectorToString(const std::vector<T> &vec) {
-  if constexpr (std::is_floating_point_v<T>) {
-    return fmt::format("{:.17e}", fmt::join(vec, " "));
-  } else {
-    return fmt::format("{}", fmt::join(vec, " "));
-  }
-}
+template <typename T> std::string vectorToString(const std::vector<T> &vec);
+
+/**
+ * @brief Convert a vector of doubles to a compressed base64 string
+ *
+ * The values are stored as zlib compressed little-endian binary doubles,
+ * which is much smaller and faster to parse than a text representation.
+ */
+std::string vectorToCompressedBase64(const std::vector<double> &vec);
+
+/**
+ * @brief Convert a compressed base64 string to a vector of doubles
+ *
+ * The inverse of vectorToCompressedBase64. Throws std::invalid_argument if
+ * the string is not a valid encoding of a vector of doubles.
+ */
+std::vector<double> compressedBase64ToVector(const std::string &str);
 
 /**
  * @brief Default set of colours
@@ -147,6 +147,11 @@ model::Settings fromXml(const std::string &xml) {
     SPDLOG_WARN("Failed to import Settings from xml - using default values: {}",
                 e.what());
     return {};
+  } catch (const std::invalid_argument &e) {
+    // e.g. an invalid compressed binary array
+    SPDLOG_WARN("Failed to import Settings from xml - using default values: {}",
+                e.what());
+    return {};
   }
   std::locale::global(userLocale);
   return sbmlAnnotation;
@@ -298,6 +298,31 @@ TEST_CASE("Serialization",
     REQUIRE(s2.simulationSettings.options.pixel.maxErr.rel ==
             dbl_approx(s.simulationSettings.options.pixel.maxErr.rel));
   }
+  SECTION("optimization target values xml roundtrip") {
+    sme::model::Settings s{};
+    auto &optCost{s.optimizeOptions.optCosts.emplace_back()};
+    optCost.name = "cost";
+    optCost.targetValues.resize(100 * 100);
+    for (std::size_t i = 0; i < optCost.targetValues.size(); ++i) {
+      optCost.targetValues[i] = 0.1 * static_cast<double>(i % 37);
+    }
+    auto xml{common::toXml(s)};
+    // target values are stored as a single compressed string
+    REQUIRE(xml.find("<targetValuesBase64>") != std::string::npos);
+    REQUIRE(xml.find("<targetValues ") == std::string::npos);
+    REQUIRE(xml.size() < 8 * optCost.targetValues.size());
+    auto s2{common::fromXml(xml)};
+    REQUIRE(s2.optimizeOptions.optCosts.size() == 1);
+    REQUIRE(s2.optimizeOptions.optCosts[0].name == "cost");
+    REQUIRE(s2.optimizeOptions.optCosts[0].targetValues ==
+            optCost.targetValues);
+    // invalid encoded values: default settings are used
+    auto begin{xml.find("<targetValuesBase64>") + 20};
+    auto end{xml.find("</targetValuesBase64>")};
+    xml.replace(begin, end - begin, "invalid!");
+    auto s3{common::fromXml(xml)};
+    REQUIRE(s3.optimizeOptions.optCosts.empty());
+  }
   SECTION("check DE locale doesn't break settings xml roundtrip") {
     // https://github.com/spatial-model-editor/spatial-model-editor/issues/535
     std::locale userLocale{};
@@ -1,10 +1,153 @@
 #include "sme/symbolic.hpp"
 #include "sme/logger.hpp"
+#include "sme/version.hpp"
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QSysInfo>
+#include <algorithm>
+#include <deque>
 #include <map>
+#include <mutex>
 #include <ranges>
+#include <symengine/symengine_config.h>
 
 namespace sme::common {
 
+// in-memory cache of compiled object code, with optional on-disk copy
+struct ObjectCodeCache {
+  // don't let a long optimization with many distinct kernels use up memory
+  static constexpr std::size_t maxEntries{1024};
+  std::mutex mutex;
+  std::map<std::string, std::string, std::less<>> objects;
+  std::deque<std::string> insertionOrder;
+  std::string directory;
+};
+
+static ObjectCodeCache &getObjectCodeCache() {
+  static ObjectCodeCache cache;
+  return cache;
+}
+
+// key contains everything that affects the generated object code. It also
+// contains the host, as LLVM compiles for the host CPU, and a cache directory
+// may be shared between machines
+static std::string getCacheKey(const SymEngine::vec_basic &variables,
+                               const SymEngine::vec_basic &expressions,
+                               bool doCSE, unsigned optLevel) {
+  std::string key{fmt::format(
+      "sme {};symengine {};{};{};cse {};opt {};", SPATIAL_MODEL_EDITOR_VERSION,
+      SYMENGINE_VERSION, QSysInfo::buildAbi().toStdString(),
+      QSysInfo::machineHostName().toStdString(), doCSE, optLevel)};
+  // serialized expressions are exact, unlike the printed versions, which
+  // round floating point constants
+  for (const auto *basics : {&variables, &expressions}) {
+    key.append(fmt::format("{};", basics->size()));
+    for (const auto &b : *basics) {
+      auto s{b->dumps()};
+      key.append(fmt::format("{}:", s.size()));
+      key.append(s);
+    }
+  }
+  return key;
+}
+
+static QString getCacheFilename(const std::string &directory,
+                                const std::string &key) {
+  auto hash{QCryptographicHash::hash(
+      QByteArray::fromRawData(key.data(), static_cast<qsizetype>(key.size())),
+      QCryptographicHash::Sha256)};
+  return QDir(directory.c_str()).filePath(hash.toHex() + ".o");
+}
+
+static void addToMemoryCache(const std::string &key,
+                             const std::string &objectCode) {
+  auto &cache{getObjectCodeCache()};
+  std::scoped_lock lock(cache.mutex);
+  if (cache.objects.try_emplace(key, objectCode).second) {
+    cache.insertionOrder.push_back(key);
+  }
+  while (cache.insertionOrder.size() > ObjectCodeCache::maxEntries) {
+    cache.objects.erase(cache.insertionOrder.front());
+    cache.insertionOrder.pop_front();
+  }
+}
+
+static bool loadFromCache(const std::string &key,
+                          SymEngine::LLVMDoubleVisitor &lambda) {
+  auto &cache{getObjectCodeCache()};
+  std::string objectCode;
+  std::string directory;
+  {
+    std::scoped_lock lock(cache.mutex);
+    if (auto iter{cache.objects.find(key)}; iter != cache.objects.cend()) {
+      objectCode = iter->second;
+    }
+    directory = cache.directory;
+  }
+  if (objectCode.empty() && !directory.empty()) {
+    QFile file(getCacheFilename(directory, key));
+    if (file.open(QIODevice::ReadOnly)) {
+      QDataStream in(&file);
+      QByteArray fileKey;
+      QByteArray fileObjectCode;
+      in >> fileKey >> fileObjectCode;
+      // the full key is stored in the file in case of a hash collision
+      if (in.status() == QDataStream::Ok && fileKey.toStdString() == key) {
+        objectCode = fileObjectCode.toStdString();
+        addToMemoryCache(key, objectCode);
+      }
+    }
+  }
+  if (objectCode.empty()) {
+    return false;
+  }
+  try {
+    lambda.loads(objectCode);
+  } catch (const std::exception &e) {
+    SPDLOG_WARN("Failed to load cached object code: {}", e.what());
+    return false;
+  }
+  SPDLOG_DEBUG("using cached object code");
+  return true;
+}
+
+static void storeInCache(const std::string &key,
+                         const SymEngine::LLVMDoubleVisitor &lambda) {
+  const auto &objectCode{lambda.dumps()};
+  addToMemoryCache(key, objectCode);
+  auto directory{Symbolic::getCacheDirectory()};
+  if (directory.empty()) {
+    return;
+  }
+  QSaveFile file(getCacheFilename(directory, key));
+  if (!file.open(QIODevice::WriteOnly)) {
+    SPDLOG_WARN("Failed to write object code to cache directory '{}'",
+                directory);
+    return;
+  }
+  QDataStream out(&file);
+  out << QByteArray::fromStdString(key)
+      << QByteArray::fromStdString(objectCode);
+  file.commit();
+}
+
+// compile, or load the object code from the cache if available
+static void initLLVM(SymEngine::LLVMDoubleVisitor &lambda,
+                     const SymEngine::vec_basic &variables,
+                     const SymEngine::vec_basic &expressions, bool doCSE,
+                     unsigned optLevel) {
+  auto key{getCacheKey(variables, expressions, doCSE, optLevel)};
+  if (loadFromCache(key, lambda)) {
+    return;
+  }
+  lambda.init(variables, expressions, doCSE, optLevel);
+  storeInCache(key, lambda);
+}
+
 struct SymEngineFunc {
   std::string name{};
   SymEngine::vec_basic args{};
@@ -171,8 +314,12 @@ bool Symbolic::parse(
                functions, allow_unknown_symbols);
 }
 
-bool Symbolic::compile(bool doCSE, unsigned optLevel) {
+bool Symbolic::compile(bool doCSE, unsigned optLevel, std::size_t nBatch) {
   lambdaLLVM = std::make_unique<SymEngine::LLVMDoubleVisitor>();
+  batchKernel.reset();
+  batchSize = std::max(nBatch, std::size_t{1});
+  compileDoCSE = doCSE;
+  compileOptLevel = optLevel;
   if (!valid) {
     return false;
   }
@@ -185,7 +332,7 @@ bool Symbolic::compile(bool doCSE, unsigned optLevel) {
   }
 #endif
   try {
-    lambdaLLVM->init(varVec, exprInlined, doCSE, optLevel);
+    initLLVM(*lambdaLLVM, varVec, exprInlined, doCSE, optLevel);
   } catch (const std::exception &e) {
     // if SymEngine failed to compile, capture error message
     SPDLOG_WARN("{}", e.what());
@@ -194,10 +341,43 @@ bool Symbolic::compile(bool doCSE, unsigned optLevel) {
     errorMessage = fmt::format("Error compiling expression: {}", e.what());
     return false;
   }
+  if (batchSize > 1) {
+    batchKernel = std::make_unique<BatchKernel>();
+  }
   compiled = true;
   return true;
 }
 
+void Symbolic::compileBatchKernel() const {
+  // concatenate batchSize copies of the expressions, each with their own
+  // copy of the variables, so that LLVM can vectorize across the copies
+  SymEngine::vec_basic batchVars;
+  SymEngine::vec_basic batchExprs;
+  batchVars.reserve(batchSize * varVec.size());
+  batchExprs.reserve(batchSize * exprInlined.size());
+  for (std::size_t iBatch = 0; iBatch < batchSize; ++iBatch) {
+    SymEngine::map_basic_basic d;
+    for (const auto &v : varVec) {
+      // '#' is not allowed in SBML ids so can't clash with a variable
+      auto vCopy{SymEngine::symbol(fmt::format("{}#{}", sbml(*v), iBatch))};
+      d[v] = vCopy;
+      batchVars.push_back(vCopy);
+    }
+    for (const auto &e : exprInlined) {
+      batchExprs.push_back(e->xreplace(d));
+    }
+  }
+  auto lambda{std::make_unique<SymEngine::LLVMDoubleVisitor>()};
+  try {
+    initLLVM(*lambda, batchVars, batchExprs, compileDoCSE, compileOptLevel);
+  } catch (const std::exception &e) {
+    // the expressions already compiled unbatched, so fall back to those
+    SPDLOG_WARN("Failed to compile batched expressions: {}", e.what());
+    return;
+  }
+  batchKernel->lambda = std::move(lambda);
+}
+
 std::string Symbolic::expr(std::size_t i) const {
   return sbml(*exprOriginal[i]);
 }
@@ -242,7 +422,7 @@ void Symbolic::relabel(const std::vector<std::string> &newVariables) {
   std::swap(varVec, newVarVec);
   std::swap(symbols, newSymbols);
   if (compiled) {
-    compile(true, 3);
+    compile(compileDoCSE, compileOptLevel, batchSize);
   }
 }
 
@@ -268,19 +448,66 @@ void Symbolic::rescale(double factor,
     SPDLOG_DEBUG("  -> '{}'", sbml(*e));
   }
   if (compiled) {
-    compile(true, 3);
+    compile(compileDoCSE, compileOptLevel, batchSize);
   }
 }
 
 void Symbolic::eval(std::vector<double> &results,
                     const std::vector<double> &vars) const {
-  lambdaLLVM->call(results.data(), vars.data());
+  eval(results.data(), vars.data());
 }
 
 void Symbolic::eval(double *results, const double *vars) const {
   lambdaLLVM->call(results, vars);
 }
 
+void Symbolic::evalBatch(double *results, const double *vars,
+                         std::size_t nPoints, std::size_t stride) const {
+  const std::size_t nVars{varVec.size()};
+  const std::size_t nExprs{exprInlined.size()};
+  std::size_t i{0};
+  if (batchKernel != nullptr && nPoints >= batchSize) {
+    // other threads wait here until the batched version has been compiled
+    std::call_once(batchKernel->compiled, [this]() { compileBatchKernel(); });
+  }
+  // only read after call_once, which synchronizes with the compilation
+  const auto *lambdaLLVMBatch{nPoints >= batchSize && batchKernel != nullptr
+                                  ? batchKernel->lambda.get()
+                                  : nullptr};
+  if (lambdaLLVMBatch != nullptr) {
+    if (stride == nVars && stride == nExprs) {
+      // points are contiguous: call batched function directly on the data
+      for (; i + batchSize <= nPoints; i += batchSize) {
+        lambdaLLVMBatch->call(results + i * stride, vars + i * stride);
+      }
+    } else {
+      // gather/scatter each batch of points through contiguous buffers,
+      // which are reused by each thread between calls
+      thread_local std::vector<double> batchVars;
+      thread_local std::vector<double> batchResults;
+      batchVars.resize(batchSize * nVars);
+      batchResults.resize(batchSize * nExprs);
+      for (; i + batchSize <= nPoints; i += batchSize) {
+        for (std::size_t j = 0; j < batchSize; ++j) {
+          std::copy_n(vars + (i + j) * stride, nVars,
+                      batchVars.data() + j * nVars);
+        }
+        lambdaLLVMBatch->call(batchResults.data(), batchVars.data());
+        for (std::size_t j = 0; j < batchSize; ++j) {
+          std::copy_n(batchResults.data() + j * nExprs, nExprs,
+                      results + (i + j) * stride);
+        }
+      }
+    }
+  }
+  // remaining points
+  for (; i < nPoints; ++i) {
+    eval(results + i * stride, vars + i * stride);
+  }
+}
+
+std::size_t Symbolic::getBatchSize() const { return batchSize; }
+
 bool Symbolic::isValid() const { return valid; }
 
 bool Symbolic::isCompiled() const { return compiled; }
@@ -289,6 +516,8 @@ const std::string &Symbolic::getErrorMessage() const { return errorMessage; }
 
 void Symbolic::clear() {
   lambdaLLVM.reset();
+  batchKernel.reset();
+  batchSize = 1;
   exprInlined.clear();
   exprOriginal.clear();
   varVec.clear();
@@ -297,4 +526,33 @@ void Symbolic::clear() {
   valid = false;
   compiled = false;
 }
+
+void Symbolic::setCacheDirectory(const std::string &directory) {
+  if (!directory.empty() && !QDir().mkpath(directory.c_str())) {
+    SPDLOG_WARN("Failed to create cache directory '{}'", directory);
+    return;
+  }
+  auto &cache{getObjectCodeCache()};
+  std::scoped_lock lock(cache.mutex);
+  cache.directory = directory;
+}
+
+std::string Symbolic::getCacheDirectory() {
+  auto &cache{getObjectCodeCache()};
+  std::scoped_lock lock(cache.mutex);
+  return cache.directory;
+}
+
+std::size_t Symbolic::getCacheSize() {
+  auto &cache{getObjectCodeCache()};
+  std::scoped_lock lock(cache.mutex);
+  return cache.objects.size();
+}
+
+void Symbolic::clearCache() {
+  auto &cache{getObjectCodeCache()};
+  std::scoped_lock lock(cache.mutex);
+  cache.objects.clear();
+  cache.insertionOrder.clear();
+}
 } // namespace sme::common
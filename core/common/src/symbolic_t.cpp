@@ -1,6 +1,7 @@
 #include "catch_wrapper.hpp"
 #include "math_test_utils.hpp"
 #include "sme/symbolic.hpp"
+#include <QDir>
 #include <cmath>
 
 using namespace sme;
@@ -215,6 +216,44 @@ TEST_CASE("Symbolic", "[core/common/symbolic][core/common][core][symbolic]") {
       }
     }
   }
+  SECTION("batched evaluation") {
+    std::vector<std::string> expr{"3*x + 4/y - 1.0*x + 0.2*x*y - 0.1",
+                                  "z - cos(x)*sin(y) - x*y", "x*x*z - 2"};
+    common::Symbolic sym(expr, {"x", "y", "z"}, {});
+    REQUIRE(sym.compile(true, 3, 4) == true);
+    REQUIRE(sym.isCompiled() == true);
+    REQUIRE(sym.getBatchSize() == 4);
+    // nPoints not a multiple of the batch size
+    for (std::size_t stride : {std::size_t{3}, std::size_t{5}}) {
+      constexpr std::size_t nPoints{11};
+      std::vector<double> vars(nPoints * stride, 0.0);
+      for (std::size_t i = 0; i < nPoints; ++i) {
+        vars[i * stride] = 0.1 + 0.3 * static_cast<double>(i);
+        vars[i * stride + 1] = 2.5 - 0.2 * static_cast<double>(i);
+        vars[i * stride + 2] = -0.7 + 0.01 * static_cast<double>(i * i);
+      }
+      std::vector<double> res(nPoints * stride, -99.0);
+      sym.evalBatch(res.data(), vars.data(), nPoints, stride);
+      std::vector<double> r(3, 0);
+      for (std::size_t i = 0; i < nPoints; ++i) {
+        CAPTURE(stride);
+        CAPTURE(i);
+        sym.eval(r.data(), vars.data() + i * stride);
+        REQUIRE(res[i * stride] == dbl_approx(r[0]));
+        REQUIRE(res[i * stride + 1] == dbl_approx(r[1]));
+        REQUIRE(res[i * stride + 2] == dbl_approx(r[2]));
+        // padding elements are not modified
+        for (std::size_t j = 3; j < stride; ++j) {
+          REQUIRE(res[i * stride + j] == dbl_approx(-99.0));
+        }
+      }
+    }
+    // relabeling preserves batch size
+    sym.relabel({"a", "b", "c"});
+    REQUIRE(sym.getBatchSize() == 4);
+    sym.clear();
+    REQUIRE(sym.getBatchSize() == 1);
+  }
   SECTION("exponentiale^(4*x): print exponential function") {
     std::string expr{"exponentiale^(4*x)"};
     REQUIRE_THAT(common::Symbolic(expr, {}, {}).getErrorMessage(),
@@ -644,3 +683,107 @@ TEST_CASE("Symbolic", "[core/common/symbolic][core/common][core][symbolic]") {
     REQUIRE(sym.isCompiled() == false);
   }
 }
+
+TEST_CASE("Symbolic object code cache",
+          "[core/common/symbolic][core/common][core][symbolic]") {
+  common::Symbolic::clearCache();
+  REQUIRE(common::Symbolic::getCacheSize() == 0);
+  std::vector<double> res(1, 0);
+  common::Symbolic sym("3*x + a", {"x"}, {{"a", 7.0}});
+  REQUIRE(sym.compile());
+  REQUIRE(common::Symbolic::getCacheSize() == 1);
+  SECTION("same expressions re-use cached object code") {
+    common::Symbolic sym2("3*x + b", {"x"}, {{"b", 7.0}});
+    REQUIRE(sym2.compile());
+    REQUIRE(common::Symbolic::getCacheSize() == 1);
+    sym2.eval(res, {2.0});
+    REQUIRE(res[0] == dbl_approx(13.0));
+  }
+  SECTION("constants that differ in the last digit are not the same") {
+    common::Symbolic sym2("3*x + a", {"x"}, {{"a", std::nextafter(7.0, 8.0)}});
+    REQUIRE(sym2.compile());
+    REQUIRE(common::Symbolic::getCacheSize() == 2);
+    sym2.eval(res, {0.0});
+    REQUIRE(res[0] == std::nextafter(7.0, 8.0));
+  }
+  SECTION("different compile options are not the same") {
+    REQUIRE(sym.compile(false));
+    REQUIRE(common::Symbolic::getCacheSize() == 2);
+    REQUIRE(sym.compile(true, 1));
+    REQUIRE(common::Symbolic::getCacheSize() == 3);
+    REQUIRE(sym.compile(true, 3, 4));
+    // batched version is only compiled when it is first used
+    REQUIRE(common::Symbolic::getCacheSize() == 3);
+    std::vector<double> vars{2.0, 2.0, 2.0};
+    std::vector<double> results(vars.size(), 0.0);
+    sym.evalBatch(results.data(), vars.data(), vars.size(), 1);
+    REQUIRE(common::Symbolic::getCacheSize() == 3);
+    vars.push_back(2.0);
+    results.push_back(0.0);
+    sym.evalBatch(results.data(), vars.data(), vars.size(), 1);
+    // batched version has its own object code
+    REQUIRE(common::Symbolic::getCacheSize() == 4);
+    for (auto r : results) {
+      REQUIRE(r == dbl_approx(13.0));
+    }
+    sym.eval(res, {2.0});
+    REQUIRE(res[0] == dbl_approx(13.0));
+  }
+  SECTION("relabel recompiles with the same compile options") {
+    REQUIRE(sym.compile(false, 1));
+    REQUIRE(common::Symbolic::getCacheSize() == 2);
+    sym.relabel({"y"});
+    REQUIRE(common::Symbolic::getCacheSize() == 3);
+    common::Symbolic sym2("3*y + a", {"y"}, {{"a", 7.0}});
+    REQUIRE(sym2.compile(false, 1));
+    REQUIRE(common::Symbolic::getCacheSize() == 3);
+    sym.eval(res, {2.0});
+    REQUIRE(res[0] == dbl_approx(13.0));
+  }
+  SECTION("cache directory") {
+    QDir dir("tmpsymboliccache");
+    dir.removeRecursively();
+    common::Symbolic::setCacheDirectory("tmpsymboliccache");
+    REQUIRE(common::Symbolic::getCacheDirectory() == "tmpsymboliccache");
+    REQUIRE(dir.exists());
+    common::Symbolic sym2("x*x - 1", {"x"});
+    REQUIRE(sym2.compile());
+    REQUIRE(dir.entryList(QDir::Files).size() == 1);
+    // object code is loaded from the cache directory
+    common::Symbolic::clearCache();
+    common::Symbolic sym3("x*x - 1", {"x"});
+    REQUIRE(sym3.compile());
+    REQUIRE(common::Symbolic::getCacheSize() == 1);
+    REQUIRE(dir.entryList(QDir::Files).size() == 1);
+    sym3.eval(res, {3.0});
+    REQUIRE(res[0] == dbl_approx(8.0));
+    common::Symbolic::setCacheDirectory({});
+    dir.removeRecursively();
+  }
+}
+
+TEST_CASE("Symbolic parameters",
+          "[core/common/symbolic][core/common][core][symbolic]") {
+  // a is a parameter: a variable that is supplied with each point, so its
+  // value can be changed without recompiling
+  common::Symbolic sym(std::vector<std::string>{"a*x + b", "0"}, {"x", "a"},
+                       {{"b", 1.0}});
+  REQUIRE(sym.compile(true, 3, 4));
+  std::vector<double> res(2, 0);
+  sym.eval(res, {3.0, 2.0});
+  REQUIRE(res[0] == dbl_approx(7.0));
+  sym.eval(res, {3.0, -1.0});
+  REQUIRE(res[0] == dbl_approx(-2.0));
+  // batched evaluation directly on rows of [x, a], with a partial final batch
+  std::vector<double> vars;
+  for (int i = 0; i < 7; ++i) {
+    vars.push_back(static_cast<double>(i));
+    vars.push_back(-1.0);
+  }
+  std::vector<double> results(vars.size(), 0.0);
+  sym.evalBatch(results.data(), vars.data(), 7, 2);
+  for (std::size_t i = 0; i < 7; ++i) {
+    REQUIRE(results[2 * i] == dbl_approx(1.0 - static_cast<double>(i)));
+    REQUIRE(results[2 * i + 1] == dbl_approx(0.0));
+  }
+}
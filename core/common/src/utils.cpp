@@ -1,8 +1,21 @@
 #include "sme/utils.hpp"
 #include "sme/image_stack.hpp"
+#include <QByteArray>
+#include <QtEndian>
 #include <algorithm>
+#include <charconv>
+#include <cmath>
 #include <limits>
 #include <stdexcept>
+#include <system_error>
+// Qt defines emit keyword which interferes with a tbb emit() function
+#ifdef emit
+#undef emit
+#include <oneapi/tbb/parallel_for.h>
+#define emit // restore the Qt empty definition of "emit"
+#else
+#include <oneapi/tbb/parallel_for.h>
+#endif
 
 namespace sme::common {
 
@@ -57,6 +70,219 @@ std::vector<int> toInt(const std::vector<bool> &v) {
   return r;
 }
 
+// chunk sizes for parallel conversion: strings or vectors smaller than this
+// are converted in a single chunk
+static constexpr std::size_t stringChunkSize{1 << 20};
+static constexpr std::size_t vectorChunkSize{1 << 16};
+
+static bool isWhitespace(char c) {
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' ||
+         c == '\f';
+}
+
+static const char *skipWhitespace(const char *first, const char *last) {
+  while (first != last && isWhitespace(*first)) {
+    ++first;
+  }
+  return first;
+}
+
+// parse a floating point value with Qt: unlike std::from_chars this is
+// available on all supported platforms and accepts subnormal values
+template <typename T>
+static const char *parseFloatingPoint(const char *first, const char *last,
+                                      T &value) {
+  const auto *tokenEnd{std::find_if(first, last, isWhitespace)};
+  bool ok{false};
+  auto dbl{QByteArray::fromRawData(first, tokenEnd - first).toDouble(&ok)};
+  if (!ok && std::fpclassify(dbl) != FP_SUBNORMAL) {
+    return nullptr;
+  }
+  value = static_cast<T>(dbl);
+  return tokenEnd;
+}
+
+// parse a single value, returns nullptr on failure
+template <typename T>
+static const char *parseValue(const char *first, const char *last, T &value) {
+  // istream accepts an explicit leading plus sign, from_chars does not
+  if (*first == '+' && last - first > 1 && first[1] != '-') {
+    ++first;
+  }
+  if constexpr (std::is_floating_point_v<T>) {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    auto [ptr, ec]{std::from_chars(first, last, value)};
+    if (ec == std::errc::result_out_of_range) {
+      // some implementations reject subnormal values
+      return parseFloatingPoint(first, last, value);
+    }
+    if (ec != std::errc{} || (ptr != last && !isWhitespace(*ptr))) {
+      return nullptr;
+    }
+    return ptr;
+#else
+    return parseFloatingPoint(first, last, value);
+#endif
+  } else {
+    auto [ptr, ec]{std::from_chars(first, last, value)};
+    if (ec != std::errc{} || (ptr != last && !isWhitespace(*ptr))) {
+      return nullptr;
+    }
+    return ptr;
+  }
+}
+
+template <typename T> struct ParsedChunk {
+  std::vector<T> values;
+  bool valid{true};
+};
+
+template <typename T>
+static ParsedChunk<T> parseChunk(const char *first, const char *last) {
+  ParsedChunk<T> chunk;
+  // rough estimate of the number of values
+  chunk.values.reserve(static_cast<std::size_t>(last - first) / 8);
+  first = skipWhitespace(first, last);
+  while (first != last) {
+    T value;
+    first = parseValue(first, last, value);
+    if (first == nullptr) {
+      chunk.valid = false;
+      return chunk;
+    }
+    chunk.values.push_back(value);
+    first = skipWhitespace(first, last);
+  }
+  return chunk;
+}
+
+template <typename T> std::vector<T> stringToVector(std::string_view str) {
+  const char *begin{str.data()};
+  const char *end{str.data() + str.size()};
+  // split into chunks at whitespace so that no value straddles two chunks
+  std::vector<const char *> boundaries{begin};
+  for (std::size_t i = stringChunkSize; i < str.size(); i += stringChunkSize) {
+    const auto *from{std::max(begin + i, boundaries.back() + 1)};
+    const auto *b{std::find_if(from, end, isWhitespace)};
+    if (b == end) {
+      break;
+    }
+    boundaries.push_back(b);
+  }
+  boundaries.push_back(end);
+  std::size_t nChunks{boundaries.size() - 1};
+  if (nChunks == 1) {
+    return parseChunk<T>(begin, end).values;
+  }
+  std::vector<ParsedChunk<T>> chunks(nChunks);
+  tbb::parallel_for(std::size_t{0}, nChunks, [&](std::size_t i) {
+    chunks[i] = parseChunk<T>(boundaries[i], boundaries[i + 1]);
+  });
+  std::size_t nValues{0};
+  for (const auto &chunk : chunks) {
+    nValues += chunk.values.size();
+    if (!chunk.valid) {
+      break;
+    }
+  }
+  std::vector<T> values;
+  values.reserve(nValues);
+  for (const auto &chunk : chunks) {
+    values.insert(values.end(), chunk.values.cbegin(), chunk.values.cend());
+    if (!chunk.valid) {
+      break;
+    }
+  }
+  return values;
+}
+
+template <typename T>
+static void appendValues(std::string &str, const T *first, const T *last) {
+  for (const auto *v = first; v != last; ++v) {
+    fmt::format_to(std::back_inserter(str), "{} ", *v);
+  }
+}
+
+template <typename T> std::string vectorToString(const std::vector<T> &vec) {
+  if (vec.empty()) {
+    return {};
+  }
+  std::string str;
+  std::size_t nChunks{(vec.size() + vectorChunkSize - 1) / vectorChunkSize};
+  if (nChunks == 1) {
+    appendValues(str, vec.data(), vec.data() + vec.size());
+    str.pop_back();
+    return str;
+  }
+  std::vector<std::string> chunks(nChunks);
+  tbb::parallel_for(std::size_t{0}, nChunks, [&vec, &chunks](std::size_t i) {
+    const T *first{vec.data() + i * vectorChunkSize};
+    const T *last{vec.data() + std::min((i + 1) * vectorChunkSize, vec.size())};
+    appendValues(chunks[i], first, last);
+  });
+  std::size_t nChars{0};
+  for (const auto &chunk : chunks) {
+    nChars += chunk.size();
+  }
+  str.reserve(nChars);
+  for (const auto &chunk : chunks) {
+    str.append(chunk);
+  }
+  // remove trailing separator
+  str.pop_back();
+  return str;
+}
+
+#define SME_INSTANTIATE_STRING_VECTOR_CONVERSIONS(T)                           \
+  template std::vector<T> stringToVector<T>(std::string_view str);            \
+  template std::string vectorToString<T>(const std::vector<T> &vec);
+SME_INSTANTIATE_STRING_VECTOR_CONVERSIONS(signed char)
+SME_INSTANTIATE_STRING_VECTOR_CONVERSIONS(unsigned char)
+SME_INSTANTIATE_STRING_VECTOR_CONVERSIONS(short)
+SME_INSTANTIATE_STRING_VECTOR_CONVERSIONS(unsigned short)
+SME_INSTANTIATE_STRING_VECTOR_CONVERSIONS(int)
+SME_INSTANTIATE_STRING_VECTOR_CONVERSIONS(unsigned int)
+SME_INSTANTIATE_STRING_VECTOR_CONVERSIONS(long)
+SME_INSTANTIATE_STRING_VECTOR_CONVERSIONS(unsigned long)
+SME_INSTANTIATE_STRING_VECTOR_CONVERSIONS(long long)
+SME_INSTANTIATE_STRING_VECTOR_CONVERSIONS(unsigned long long)
+SME_INSTANTIATE_STRING_VECTOR_CONVERSIONS(float)
+SME_INSTANTIATE_STRING_VECTOR_CONVERSIONS(double)
+#undef SME_INSTANTIATE_STRING_VECTOR_CONVERSIONS
+
+std::string vectorToCompressedBase64(const std::vector<double> &vec) {
+  if (vec.empty()) {
+    return {};
+  }
+  // doubles are encoded as little-endian, regardless of native byte order
+  QByteArray bytes(static_cast<qsizetype>(vec.size() * sizeof(double)),
+                   Qt::Uninitialized);
+  qToLittleEndian<double>(vec.data(), static_cast<qsizetype>(vec.size()),
+                          bytes.data());
+  return qCompress(bytes).toBase64().toStdString();
+}
+
+std::vector<double> compressedBase64ToVector(const std::string &str) {
+  if (str.empty()) {
+    return {};
+  }
+  auto base64{QByteArray::fromBase64Encoding(
+      QByteArray::fromStdString(str), QByteArray::AbortOnBase64DecodingErrors)};
+  if (!base64) {
+    throw std::invalid_argument("Invalid base64 encoding");
+  }
+  auto bytes{qUncompress(*base64)};
+  if (bytes.isEmpty() ||
+      static_cast<std::size_t>(bytes.size()) % sizeof(double) != 0) {
+    throw std::invalid_argument("Invalid compressed array of doubles");
+  }
+  std::vector<double> vec(static_cast<std::size_t>(bytes.size()) /
+                          sizeof(double));
+  qFromLittleEndian<double>(bytes.constData(),
+                            static_cast<qsizetype>(vec.size()), vec.data());
+  return vec;
+}
+
 const std::vector<QColor> indexedColours::colours = std::vector<QColor>{
     {230, 25, 75},  {60, 180, 75},   {255, 225, 25}, {0, 130, 200},
     {245, 130, 48}, {145, 30, 180},  {70, 240, 240}, {240, 50, 230},
@@ -5,6 +5,7 @@
 #include <QDir>
 #include <QImage>
 #include <QRgb>
+#include <algorithm>
 #include <list>
 #include <set>
 #include <vector>
@@ -91,6 +92,64 @@ TEST_CASE("Utils", "[core/common/utils][core/common][core][utils]") {
       auto v2s = common::vectorToString(v);
       REQUIRE(common::stringToVector<double>(v2s) == v);
     }
+    SECTION("type: double, subnormal and legacy format") {
+      std::vector<double> v{4.9e-324, -1.5e-310, 1.0, 0.0};
+      REQUIRE(common::stringToVector<double>(common::vectorToString(v)) == v);
+      std::string s("1.00000000000000000e+00 +2.5e-01\n"
+                    "-3.00000000000000000e+00");
+      REQUIRE(common::stringToVector<double>(s) ==
+              std::vector<double>{1.0, 0.25, -3.0});
+    }
+    SECTION("whitespace is ignored, parsing stops at invalid value") {
+      REQUIRE(common::stringToVector<int>("  1\t2\n\n 3  ") ==
+              std::vector<int>{1, 2, 3});
+      REQUIRE(common::stringToVector<int>("1 2 x 3") == std::vector<int>{1, 2});
+      REQUIRE(common::stringToVector<int>("1 2a 3") == std::vector<int>{1});
+    }
+    SECTION("large vectors are converted in multiple chunks") {
+      std::vector<double> v(500000);
+      for (std::size_t i = 0; i < v.size(); ++i) {
+        v[i] = static_cast<double>(i) / 3.0 - 1e5;
+      }
+      auto v2s = common::vectorToString(v);
+      REQUIRE(common::stringToVector<double>(v2s) == v);
+      // an invalid value in the middle truncates the result at that value
+      auto i = v2s.find(' ', v2s.size() / 2);
+      v2s[i + 1] = 'x';
+      auto truncated = common::stringToVector<double>(v2s);
+      REQUIRE(truncated.size() < v.size());
+      REQUIRE(truncated.size() > v.size() / 2 - 10);
+      REQUIRE(std::equal(truncated.cbegin(), truncated.cend(), v.cbegin()));
+      std::vector<QRgb> c(1000000, 0xfffffffe);
+      REQUIRE(common::stringToVector<QRgb>(common::vectorToString(c)) == c);
+    }
+  }
+  SECTION("vector <-> compressed base64") {
+    SECTION("empty") {
+      std::vector<double> v{};
+      auto str{common::vectorToCompressedBase64(v)};
+      REQUIRE(str.empty());
+      REQUIRE(common::compressedBase64ToVector(str).empty());
+    }
+    SECTION("values are preserved exactly") {
+      std::vector<double> v{1.12341,     4.99,   1e-22, 999.123,
+                            1e-11 + 2.1, 2.1001, -33,   88e22};
+      auto str{common::vectorToCompressedBase64(v)};
+      REQUIRE(common::compressedBase64ToVector(str) == v);
+    }
+    SECTION("large array is smaller than text") {
+      std::vector<double> v(10000, 0.0);
+      v[123] = 3.14159;
+      auto str{common::vectorToCompressedBase64(v)};
+      REQUIRE(str.size() < 1000);
+      REQUIRE(common::compressedBase64ToVector(str) == v);
+    }
+    SECTION("invalid input") {
+      REQUIRE_THROWS_AS(common::compressedBase64ToVector("not base64!"),
+                        std::invalid_argument);
+      REQUIRE_THROWS_AS(common::compressedBase64ToVector("aGVsbG8="),
+                        std::invalid_argument);
+    }
   }
   SECTION("int <-> bool") {
     std::vector<bool> vb{true, true, false, true, false};
@@ -17,6 +17,7 @@
 namespace sme::mesh {
 
 class Boundaries;
+class IncrementalTriangulate;
 
 /**
  * @brief Constructs a triangular mesh from a geometry image
@@ -30,7 +31,9 @@ class Boundaries;
  * indices and vertices for SBML.
  *
  * The number of points used for each boundary line and the maximum triangle
- * area allowed for each compartment can then be adjusted.
+ * area allowed for each compartment can then be adjusted. When the mesh is
+ * re-constructed, only the compartments affected by these changes are
+ * re-triangulated.
  *
  */
 class Mesh {
@@ -43,6 +46,7 @@ private:
   std::vector<std::size_t> compartmentMaxTriangleArea;
   // generated data
   std::unique_ptr<Boundaries> boundaries;
+  std::unique_ptr<IncrementalTriangulate> triangulate;
   std::vector<std::vector<QPointF>> compartmentInteriorPoints;
   std::vector<QPointF> vertices;
   std::size_t nTriangles{};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "sme/image_stack.hpp"
+#include "sme/mesh_types.hpp"
+#include "sme/voxel.hpp"
+#include <QRgb>
+#include <QString>
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace sme::mesh {
+
+/**
+ * @brief Constructs a tetrahedral mesh from a 3d geometry image
+ *
+ * Given a segmented stack of geometry images, and the colours that correspond
+ * to compartments in the image, the volume of each compartment is meshed with
+ * tetrahedra using the
+ * `3D Mesh Generation <https://doc.cgal.org/latest/Mesh_3/index.html>`_
+ * package from CGAL. The interfaces between compartments are meshed once, so
+ * the tetrahedra of neighbouring compartments share vertices and faces.
+ *
+ * The mesh is provided in GMSH format, and as flat arrays of indices and
+ * vertices.
+ *
+ * The maximum tetrahedron volume allowed for each compartment can then be
+ * adjusted.
+ */
+class Mesh3d {
+private:
+  // input data
+  common::Volume volume{0, 0, 0};
+  std::vector<int> labels;
+  common::VoxelF origin{};
+  common::VolumeF voxel{1.0, 1.0, 1.0};
+  std::vector<std::size_t> compartmentMaxCellVolume;
+  // generated data
+  std::vector<std::array<double, 3>> vertices;
+  std::vector<std::vector<TetrahedronVertexIndices>> tetrahedronIndices;
+  bool validMesh{true};
+  std::string errorMessage{};
+  // convert point in voxel units to point in physical units
+  [[nodiscard]] std::array<double, 3>
+  voxelPointToPhysicalPoint(const std::array<double, 3> &voxelPoint) const;
+  void constructMesh();
+
+public:
+  Mesh3d();
+  /**
+   * @brief Constructs a mesh from the supplied images
+   *
+   * @param[in] images the segmented geometry images
+   * @param[in] maxCellVolume the max tetrahedron volume allowed for each
+   *    compartment, in units of voxels
+   * @param[in] voxelSize the physical size of a voxel
+   * @param[in] originPoint the physical location of the ``(0,0,0)`` voxel
+   * @param[in] compartmentColours the colours of compartments in the image
+   */
+  explicit Mesh3d(const common::ImageStack &images,
+                  std::vector<std::size_t> maxCellVolume = {},
+                  const common::VolumeF &voxelSize = {1.0, 1.0, 1.0},
+                  const common::VoxelF &originPoint = {0.0, 0.0, 0.0},
+                  const std::vector<QRgb> &compartmentColours = {});
+  ~Mesh3d();
+  /**
+   * @brief Returns true if the mesh is valid
+   */
+  [[nodiscard]] bool isValid() const;
+  /**
+   * @brief Returns an error message if the mesh is invalid
+   */
+  [[nodiscard]] const std::string &getErrorMessage() const;
+  /**
+   * @brief Set the maximum allowed tetrahedron volume for a given compartment
+   *
+   * @param[in] compartmentIndex the index of the compartment
+   * @param[in] maxCellVolume the maximum allowed tetrahedron volume
+   */
+  void setCompartmentMaxCellVolume(std::size_t compartmentIndex,
+                                   std::size_t maxCellVolume);
+  /**
+   * @brief Get the maximum allowed tetrahedron volume for a given compartment
+   *
+   * @param[in] compartmentIndex the index of the compartment
+   */
+  [[nodiscard]] std::size_t
+  getCompartmentMaxCellVolume(std::size_t compartmentIndex) const;
+  /**
+   * @brief The maximum allowed tetrahedron volumes for each compartment
+   */
+  [[nodiscard]] const std::vector<std::size_t> &
+  getCompartmentMaxCellVolume() const;
+  /**
+   * @brief The physical volume and origin to use
+   *
+   * The mesh uses voxel units internally, and is rescaled to physical values
+   * using the supplied physical origin and voxel size.
+   *
+   * @param[in] voxelSize the physical size of a voxel
+   * @param[in] originPoint the physical location of the ``(0,0,0)`` voxel
+   */
+  void setPhysicalGeometry(const common::VolumeF &voxelSize,
+                           const common::VoxelF &originPoint = {0.0, 0.0, 0.0});
+  /**
+   * @brief The physical mesh vertices as a flat array of doubles
+   */
+  [[nodiscard]] std::vector<double> getVerticesAsFlatArray() const;
+  /**
+   * @brief The mesh tetrahedron indices as a flat array of ints
+   */
+  [[nodiscard]] std::vector<int>
+  getTetrahedronIndicesAsFlatArray(std::size_t compartmentIndex) const;
+  /**
+   * @brief The mesh tetrahedron indices
+   *
+   * The indices of the positively oriented tetrahedra used in the mesh for
+   * each compartment
+   */
+  [[nodiscard]] const std::vector<std::vector<TetrahedronVertexIndices>> &
+  getTetrahedronIndices() const;
+  /**
+   * @brief The mesh in GMSH format
+   *
+   * @returns the mesh in GMSH format
+   */
+  [[nodiscard]] QString getGMSH() const;
+};
+
+} // namespace sme::mesh
@@ -7,5 +7,6 @@ namespace sme::mesh {
 
 using QTriangleF = std::array<QPointF, 3>;
 using TriangulateTriangleIndex = std::array<std::size_t, 3>;
+using TetrahedronVertexIndices = std::array<std::size_t, 4>;
 
 } // namespace sme::mesh
@@ -36,6 +36,7 @@ Mesh::Mesh(const QImage &image, std::vector<std::size_t> maxPoints,
       compartmentMaxTriangleArea(std::move(maxTriangleArea)),
       boundaries{std::make_unique<Boundaries>(image, compartmentColours,
                                               boundarySimplificationType)},
+      triangulate{std::make_unique<IncrementalTriangulate>()},
       compartmentInteriorPoints{getInteriorPoints(image, compartmentColours)} {
   SPDLOG_INFO("found {} boundaries", boundaries->size());
   for (const auto &boundary : boundaries->getBoundaries()) {
@@ -171,11 +172,10 @@ Mesh::getTriangleIndices() const {
 
 void Mesh::constructMesh() {
   try {
-    Triangulate triangulate(boundaries->getBoundaries(),
-                            compartmentInteriorPoints,
-                            compartmentMaxTriangleArea);
-    vertices = triangulate.getPoints();
-    triangleIndices = triangulate.getTriangleIndices();
+    triangulate->update(boundaries->getBoundaries(),
+                        compartmentInteriorPoints, compartmentMaxTriangleArea);
+    vertices = triangulate->getPoints();
+    triangleIndices = triangulate->getTriangleIndices();
 
     // construct triangles for each compartment:
     nTriangles = 0;
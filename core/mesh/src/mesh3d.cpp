@@ -0,0 +1,285 @@
+#include "sme/mesh3d.hpp"
+#include "sme/logger.hpp"
+#include "sme/utils.hpp"
+#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
+#include <CGAL/Labeled_mesh_domain_3.h>
+#include <CGAL/Mesh_complex_3_in_triangulation_3.h>
+#include <CGAL/Mesh_constant_domain_field_3.h>
+#include <CGAL/Mesh_criteria_3.h>
+#include <CGAL/Mesh_triangulation_3.h>
+#include <CGAL/make_mesh_3.h>
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+using CGALKernel = CGAL::Exact_predicates_inexact_constructions_kernel;
+using CGALMeshDomain = CGAL::Labeled_mesh_domain_3<CGALKernel>;
+using CGALTr = CGAL::Mesh_triangulation_3<CGALMeshDomain>::type;
+using CGALC3t3 = CGAL::Mesh_complex_3_in_triangulation_3<CGALTr>;
+using CGALMeshCriteria = CGAL::Mesh_criteria_3<CGALTr>;
+using CGALSizingField =
+    CGAL::Mesh_constant_domain_field_3<CGALMeshDomain::R,
+                                       CGALMeshDomain::Index>;
+
+namespace sme::mesh {
+
+// circumradius of a regular tetrahedron with the given volume, with a minimum
+// of one voxel, as a zero size would never be satisfied by the mesher
+static double maxCircumradius(std::size_t volume) {
+  const double edgeLength{
+      std::cbrt(6.0 * std::sqrt(2.0) * static_cast<double>(volume))};
+  return std::max(1.0, edgeLength * std::sqrt(6.0) / 4.0);
+}
+
+static double signedVolume(const std::array<double, 3> &a,
+                           const std::array<double, 3> &b,
+                           const std::array<double, 3> &c,
+                           const std::array<double, 3> &d) {
+  std::array<double, 3> u{b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+  std::array<double, 3> v{c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+  std::array<double, 3> w{d[0] - a[0], d[1] - a[1], d[2] - a[2]};
+  return (u[0] * (v[1] * w[2] - v[2] * w[1]) -
+          u[1] * (v[0] * w[2] - v[2] * w[0]) +
+          u[2] * (v[0] * w[1] - v[1] * w[0])) /
+         6.0;
+}
+
+std::array<double, 3> Mesh3d::voxelPointToPhysicalPoint(
+    const std::array<double, 3> &voxelPoint) const {
+  return {origin.p.x() + voxelPoint[0] * voxel.width(),
+          origin.p.y() + voxelPoint[1] * voxel.height(),
+          origin.z + voxelPoint[2] * voxel.depth()};
+}
+
+Mesh3d::Mesh3d() = default;
+
+Mesh3d::Mesh3d(const common::ImageStack &images,
+               std::vector<std::size_t> maxCellVolume,
+               const common::VolumeF &voxelSize,
+               const common::VoxelF &originPoint,
+               const std::vector<QRgb> &compartmentColours)
+    : volume{images.volume()}, origin{originPoint}, voxel{voxelSize},
+      compartmentMaxCellVolume{std::move(maxCellVolume)} {
+  // label each voxel with its compartment index + 1, or 0 if it is not part
+  // of a compartment. Note: y=0 is the bottom of the mesh but the top of the
+  // image, so the y index is inverted
+  const int nx{volume.width()};
+  const int ny{volume.height()};
+  labels.assign(volume.nVoxels(), 0);
+  for (std::size_t z = 0; z < volume.depth(); ++z) {
+    for (int y = 0; y < ny; ++y) {
+      for (int x = 0; x < nx; ++x) {
+        auto iter{std::ranges::find(compartmentColours, images[z].pixel(x, y))};
+        if (iter != compartmentColours.cend()) {
+          labels[static_cast<std::size_t>(x + nx * (ny - 1 - y)) +
+                 static_cast<std::size_t>(nx * ny) * z] =
+              static_cast<int>(iter - compartmentColours.cbegin()) + 1;
+        }
+      }
+    }
+  }
+  if (compartmentMaxCellVolume.size() != compartmentColours.size()) {
+    // if cell volumes not correctly specified use default value
+    constexpr std::size_t defaultCompartmentMaxCellVolume{40};
+    compartmentMaxCellVolume = std::vector<std::size_t>(
+        compartmentColours.size(), defaultCompartmentMaxCellVolume);
+    SPDLOG_INFO("no max cell volumes specified, using default value: {}",
+                defaultCompartmentMaxCellVolume);
+  }
+  constructMesh();
+}
+
+Mesh3d::~Mesh3d() = default;
+
+bool Mesh3d::isValid() const { return validMesh; }
+
+const std::string &Mesh3d::getErrorMessage() const { return errorMessage; }
+
+void Mesh3d::setCompartmentMaxCellVolume(std::size_t compartmentIndex,
+                                         std::size_t maxCellVolume) {
+  SPDLOG_INFO("compIndex {}: max cell volume {} -> {}", compartmentIndex,
+              compartmentMaxCellVolume.at(compartmentIndex), maxCellVolume);
+  compartmentMaxCellVolume.at(compartmentIndex) = maxCellVolume;
+  constructMesh();
+}
+
+std::size_t
+Mesh3d::getCompartmentMaxCellVolume(std::size_t compartmentIndex) const {
+  return compartmentMaxCellVolume.at(compartmentIndex);
+}
+
+const std::vector<std::size_t> &Mesh3d::getCompartmentMaxCellVolume() const {
+  return compartmentMaxCellVolume;
+}
+
+void Mesh3d::setPhysicalGeometry(const common::VolumeF &voxelSize,
+                                 const common::VoxelF &originPoint) {
+  voxel = voxelSize;
+  origin = originPoint;
+}
+
+std::vector<double> Mesh3d::getVerticesAsFlatArray() const {
+  // convert from voxels to physical coordinates
+  std::vector<double> v;
+  v.reserve(vertices.size() * 3);
+  for (const auto &voxelPoint : vertices) {
+    for (auto c : voxelPointToPhysicalPoint(voxelPoint)) {
+      v.push_back(c);
+    }
+  }
+  return v;
+}
+
+std::vector<int>
+Mesh3d::getTetrahedronIndicesAsFlatArray(std::size_t compartmentIndex) const {
+  std::vector<int> out;
+  const auto &indices = tetrahedronIndices[compartmentIndex];
+  out.reserve(indices.size() * 4);
+  for (const auto &t : indices) {
+    for (std::size_t ti : t) {
+      out.push_back(static_cast<int>(ti));
+    }
+  }
+  return out;
+}
+
+const std::vector<std::vector<TetrahedronVertexIndices>> &
+Mesh3d::getTetrahedronIndices() const {
+  return tetrahedronIndices;
+}
+
+void Mesh3d::constructMesh() {
+  vertices.clear();
+  tetrahedronIndices.clear();
+  try {
+    const int nx{volume.width()};
+    const int ny{volume.height()};
+    const int nz{static_cast<int>(volume.depth())};
+    const auto nCompartments{compartmentMaxCellVolume.size()};
+    if (labels.empty() || nCompartments == 0) {
+      throw std::invalid_argument("No compartments to mesh");
+    }
+    std::function<int(const CGALKernel::Point_3 &)> labelFunction{
+        [this, nx, ny, nz](const CGALKernel::Point_3 &p) {
+          auto x{static_cast<int>(std::floor(CGAL::to_double(p.x())))};
+          auto y{static_cast<int>(std::floor(CGAL::to_double(p.y())))};
+          auto z{static_cast<int>(std::floor(CGAL::to_double(p.z())))};
+          if (x < 0 || x >= nx || y < 0 || y >= ny || z < 0 || z >= nz) {
+            return 0;
+          }
+          return labels[static_cast<std::size_t>(x + nx * (y + ny * z))];
+        }};
+    // bounding box must enclose the whole domain, so pad by one voxel
+    CGALMeshDomain domain(labelFunction,
+                          CGAL::Bbox_3(-1.0, -1.0, -1.0, nx + 1.0, ny + 1.0,
+                                       nz + 1.0));
+    // use a separate max cell size for each compartment
+    double minCellSize{maxCircumradius(compartmentMaxCellVolume.front())};
+    CGALSizingField cellSize(minCellSize);
+    for (std::size_t i = 0; i < nCompartments; ++i) {
+      const double size{maxCircumradius(compartmentMaxCellVolume[i])};
+      cellSize.set_size(
+          size, 3, domain.index_from_subdomain_index(static_cast<int>(i + 1)));
+      minCellSize = std::min(minCellSize, size);
+    }
+    // the compartment surfaces follow the voxel faces, so only need to be
+    // approximated to within half a voxel
+    constexpr double facetAngle{25.0};
+    constexpr double facetDistance{0.5};
+    constexpr double cellRadiusEdgeRatio{3.0};
+    CGALMeshCriteria criteria(CGAL::parameters::facet_angle(facetAngle)
+                                  .facet_size(minCellSize)
+                                  .facet_distance(facetDistance)
+                                  .cell_radius_edge_ratio(cellRadiusEdgeRatio)
+                                  .cell_size(cellSize));
+    auto c3t3{CGAL::make_mesh_3<CGALC3t3>(domain, criteria)};
+
+    // get tetrahedra for each compartment, and the vertices that they use
+    tetrahedronIndices.resize(nCompartments);
+    std::map<CGALTr::Vertex_handle, std::size_t> vertexIndices;
+    for (auto cell = c3t3.cells_in_complex_begin();
+         cell != c3t3.cells_in_complex_end(); ++cell) {
+      auto label{c3t3.subdomain_index(cell)};
+      if (label < 1 || static_cast<std::size_t>(label) > nCompartments) {
+        continue;
+      }
+      TetrahedronVertexIndices t{};
+      for (int i = 0; i < 4; ++i) {
+        auto vh{cell->vertex(i)};
+        auto [iter, inserted] = vertexIndices.try_emplace(vh, vertices.size());
+        if (inserted) {
+          const auto &p{vh->point()};
+          vertices.push_back({CGAL::to_double(p.x()), CGAL::to_double(p.y()),
+                              CGAL::to_double(p.z())});
+        }
+        t[static_cast<std::size_t>(i)] = iter->second;
+      }
+      if (signedVolume(vertices[t[0]], vertices[t[1]], vertices[t[2]],
+                       vertices[t[3]]) < 0) {
+        std::swap(t[0], t[1]);
+      }
+      tetrahedronIndices[static_cast<std::size_t>(label - 1)].push_back(t);
+    }
+    SPDLOG_INFO("{} vertices", vertices.size());
+    for (std::size_t i = 0; i < nCompartments; ++i) {
+      SPDLOG_INFO("  - compartment {}: {} tetrahedra", i,
+                  tetrahedronIndices[i].size());
+    }
+    validMesh = true;
+    errorMessage.clear();
+  } catch (const std::exception &e) {
+    validMesh = false;
+    errorMessage = e.what();
+    SPDLOG_WARN("constructMesh failed with exception: {}", errorMessage);
+    vertices.clear();
+    tetrahedronIndices.clear();
+  }
+}
+
+QString Mesh3d::getGMSH() const {
+  // note: gmsh indexing starts with 1, so we need to add 1 to all indices
+  QString msh;
+  msh.append("$MeshFormat\n");
+  msh.append("2.2 0 8\n");
+  msh.append("$EndMeshFormat\n");
+  msh.append("$Nodes\n");
+  msh.append(QString("%1\n").arg(vertices.size()));
+  for (std::size_t i = 0; i < vertices.size(); ++i) {
+    auto physicalPoint = voxelPointToPhysicalPoint(vertices[i]);
+    msh.append(QString("%1 %2 %3 %4\n")
+                   .arg(i + 1)
+                   .arg(common::dblToQStr(physicalPoint[0]))
+                   .arg(common::dblToQStr(physicalPoint[1]))
+                   .arg(common::dblToQStr(physicalPoint[2])));
+  }
+  msh.append("$EndNodes\n");
+  msh.append("$Elements\n");
+  std::size_t nElem = 0;
+  for (const auto &comp : tetrahedronIndices) {
+    nElem += comp.size();
+  }
+  msh.append(QString("%1\n").arg(nElem));
+  std::size_t elementIndex{1};
+  std::size_t compartmentIndex{1};
+  for (const auto &comp : tetrahedronIndices) {
+    for (const auto &t : comp) {
+      msh.append(QString("%1 4 2 %2 %2 %3 %4 %5 %6\n")
+                     .arg(elementIndex)
+                     .arg(compartmentIndex)
+                     .arg(t[0] + 1)
+                     .arg(t[1] + 1)
+                     .arg(t[2] + 1)
+                     .arg(t[3] + 1));
+      ++elementIndex;
+    }
+    ++compartmentIndex;
+  }
+  msh.append("$EndElements\n");
+  return msh;
+}
+
+} // namespace sme::mesh
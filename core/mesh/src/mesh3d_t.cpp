@@ -0,0 +1,121 @@
+#include "catch_wrapper.hpp"
+#include "sme/image_stack.hpp"
+#include "sme/mesh3d.hpp"
+#include <QColor>
+#include <QStringList>
+#include <algorithm>
+#include <set>
+
+using namespace sme;
+
+static double tetrahedronVolume(const std::vector<double> &v,
+                                const mesh::TetrahedronVertexIndices &t) {
+  auto p{[&v, &t](std::size_t i, std::size_t j) {
+    return v[3 * t[i] + j] - v[3 * t[0] + j];
+  }};
+  return (p(1, 0) * (p(2, 1) * p(3, 2) - p(2, 2) * p(3, 1)) -
+          p(1, 1) * (p(2, 0) * p(3, 2) - p(2, 2) * p(3, 0)) +
+          p(1, 2) * (p(2, 0) * p(3, 1) - p(2, 1) * p(3, 0))) /
+         6.0;
+}
+
+TEST_CASE("Mesh3d", "[core/mesh/mesh3d][core/mesh][core][mesh]") {
+  // 12x12x12 voxel cube with a 6x6x6 voxel cube inside it
+  QRgb colOuter{QColor(0, 0, 0).rgb()};
+  QRgb colInner{QColor(255, 0, 0).rgb()};
+  common::ImageStack imgs({12, 12, 12}, QImage::Format_RGB32);
+  imgs.fill(colOuter);
+  for (std::size_t z = 3; z < 9; ++z) {
+    for (int x = 3; x < 9; ++x) {
+      for (int y = 3; y < 9; ++y) {
+        imgs[z].setPixel(x, y, colInner);
+      }
+    }
+  }
+  std::vector<QRgb> colours{colOuter, colInner};
+  SECTION("empty image") {
+    mesh::Mesh3d mesh3d(common::ImageStack{}, {}, {1.0, 1.0, 1.0},
+                        {0.0, 0.0, 0.0}, colours);
+    REQUIRE(mesh3d.isValid() == false);
+    REQUIRE(mesh3d.getTetrahedronIndices().empty());
+  }
+  SECTION("zero max cell volume") {
+    mesh::Mesh3d mesh3d(imgs, {0, 0}, {1.0, 1.0, 1.0}, {0.0, 0.0, 0.0},
+                        colours);
+    REQUIRE(mesh3d.isValid());
+    REQUIRE(mesh3d.getCompartmentMaxCellVolume() ==
+            std::vector<std::size_t>{0, 0});
+    REQUIRE(!mesh3d.getTetrahedronIndices()[0].empty());
+    REQUIRE(!mesh3d.getTetrahedronIndices()[1].empty());
+  }
+  SECTION("two nested cubes") {
+    common::VolumeF voxelSize{0.5, 1.0, 2.0};
+    mesh::Mesh3d mesh3d(imgs, {}, voxelSize, {1.0, 2.0, 3.0}, colours);
+    REQUIRE(mesh3d.isValid());
+    REQUIRE(mesh3d.getErrorMessage().empty());
+    REQUIRE(mesh3d.getCompartmentMaxCellVolume() ==
+            std::vector<std::size_t>{40, 40});
+    const auto v{mesh3d.getVerticesAsFlatArray()};
+    REQUIRE(v.size() % 3 == 0);
+    const auto &tets{mesh3d.getTetrahedronIndices()};
+    REQUIRE(tets.size() == 2);
+    REQUIRE(!tets[0].empty());
+    REQUIRE(!tets[1].empty());
+    REQUIRE(mesh3d.getTetrahedronIndicesAsFlatArray(1).size() ==
+            4 * tets[1].size());
+    // all vertices lie within the image in physical units
+    for (std::size_t i = 0; i < v.size(); i += 3) {
+      REQUIRE(v[i] >= 1.0 - 1e-8);
+      REQUIRE(v[i] <= 1.0 + 12 * 0.5 + 1e-8);
+      REQUIRE(v[i + 1] >= 2.0 - 1e-8);
+      REQUIRE(v[i + 1] <= 2.0 + 12 * 1.0 + 1e-8);
+      REQUIRE(v[i + 2] >= 3.0 - 1e-8);
+      REQUIRE(v[i + 2] <= 3.0 + 12 * 2.0 + 1e-8);
+    }
+    // tetrahedra are positively oriented, and have approximately the volume
+    // of each compartment
+    std::array<double, 2> compVolumes{0.0, 0.0};
+    for (std::size_t iComp = 0; iComp < 2; ++iComp) {
+      for (const auto &t : tets[iComp]) {
+        double vol{tetrahedronVolume(v, t)};
+        REQUIRE(vol > 0);
+        compVolumes[iComp] += vol;
+      }
+    }
+    // (the edges of the inner cube are smoothed by the mesh)
+    double voxelVolume{voxelSize.volume()};
+    REQUIRE(compVolumes[0] + compVolumes[1] ==
+            Catch::Approx(1728 * voxelVolume).epsilon(0.02));
+    REQUIRE(compVolumes[1] == Catch::Approx(216 * voxelVolume).epsilon(0.25));
+    // mesh is conforming: compartments share vertices on their interface
+    std::set<std::size_t> outerVertices;
+    for (const auto &t : tets[0]) {
+      outerVertices.insert(t.cbegin(), t.cend());
+    }
+    REQUIRE(std::ranges::any_of(tets[1], [&outerVertices](const auto &t) {
+      return std::ranges::any_of(
+          t, [&outerVertices](auto i) { return outerVertices.contains(i); });
+    }));
+    // gmsh output
+    QStringList msh{mesh3d.getGMSH().split("\n")};
+    REQUIRE(msh[0] == "$MeshFormat");
+    REQUIRE(msh[3] == "$Nodes");
+    REQUIRE(msh[4].toULongLong() == v.size() / 3);
+    REQUIRE(msh[5 + v.size() / 3] == "$EndNodes");
+    REQUIRE(msh[6 + v.size() / 3] == "$Elements");
+    REQUIRE(msh[7 + v.size() / 3].toULongLong() ==
+            tets[0].size() + tets[1].size());
+    // smaller max volume in one compartment: more tetrahedra in it
+    auto nInner{tets[1].size()};
+    mesh3d.setCompartmentMaxCellVolume(1, 2);
+    REQUIRE(mesh3d.isValid());
+    REQUIRE(mesh3d.getCompartmentMaxCellVolume(1) == 2);
+    REQUIRE(mesh3d.getTetrahedronIndices()[1].size() > nInner);
+    // changing physical geometry rescales the vertices
+    mesh3d.setPhysicalGeometry({1.0, 1.0, 1.0}, {0.0, 0.0, 0.0});
+    for (auto c : mesh3d.getVerticesAsFlatArray()) {
+      REQUIRE(c >= -1e-8);
+      REQUIRE(c <= 12.0 + 1e-8);
+    }
+  }
+}
@@ -9,7 +9,13 @@
 #include <CGAL/Triangulation_vertex_base_with_id_2.h>
 #include <QPointF>
 #include <algorithm>
+#include <cmath>
 #include <initializer_list>
+#include <limits>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <utility>
 
 using CGALKernel = CGAL::Exact_predicates_inexact_constructions_kernel;
 using CGALVertex = CGAL::Triangulation_vertex_base_with_id_2<CGALKernel>;
@@ -25,22 +31,12 @@ static TriangulateTriangleIndex toTriangleIndex(const CDT::Face_handle face) {
           static_cast<std::size_t>(face->vertex(2)->id())};
 }
 
-static void
-addTriangle(const CDT::Face_handle face,
-            std::vector<CDT::Face_handle> &facesToProcess,
-            std::vector<TriangulateTriangleIndex> &triangleIndices) {
-  face->set_marked(true);
-  facesToProcess.push_back(face);
-  triangleIndices.push_back(toTriangleIndex(face));
-}
-
-static void addTriangleAndNeighbours(
-    const CDT &cdt, const CDT::Face_handle startingFace,
-    std::vector<TriangulateTriangleIndex> &triangleIndices) {
-  std::vector<CDT::Face_handle> faces;
-  faces.reserve(512);
-  std::size_t faceIndex{0};
-  addTriangle(startingFace, faces, triangleIndices);
+static void addFaceAndNeighbours(const CDT &cdt,
+                                 const CDT::Face_handle startingFace,
+                                 std::vector<CDT::Face_handle> &faces) {
+  std::size_t faceIndex{faces.size()};
+  startingFace->set_marked(true);
+  faces.push_back(startingFace);
   while (faceIndex < faces.size()) {
     auto face{faces[faceIndex]};
     ++faceIndex;
@@ -61,29 +57,40 @@ static void addTriangleAndNeighbours(
         }
         if (!connectedFace->is_marked()) {
           // connected face is valid and has not already been added, so add it
-          addTriangle(connectedFace, faces, triangleIndices);
+          connectedFace->set_marked(true);
+          faces.push_back(connectedFace);
         }
       }
     }
   }
 }
 
-static std::vector<TriangulateTriangleIndex>
-getConnectedTriangleIndices(const CDT &cdt,
-                            const std::vector<QPointF> &interiorPoints) {
-  std::vector<TriangulateTriangleIndex> triangleIndices;
+static std::vector<CDT::Face_handle>
+getConnectedFaces(const CDT &cdt, const std::vector<QPointF> &interiorPoints) {
+  std::vector<CDT::Face_handle> faces;
+  faces.reserve(512);
   for (auto face = cdt.all_faces_begin(); face != cdt.all_faces_end(); ++face) {
     face->set_marked(false);
   }
   for (const auto &interiorPoint : interiorPoints) {
     SPDLOG_INFO("Adding interior point ({},{})", interiorPoint.x(),
                 interiorPoint.y());
-    SPDLOG_INFO("  - triangles before: {}", triangleIndices.size());
+    SPDLOG_INFO("  - triangles before: {}", faces.size());
     if (auto face{cdt.locate(CDT::Point(interiorPoint.x(), interiorPoint.y()))};
         face != nullptr && !face->is_marked()) {
-      addTriangleAndNeighbours(cdt, face, triangleIndices);
+      addFaceAndNeighbours(cdt, face, faces);
     }
-    SPDLOG_INFO("  - triangles after: {}", triangleIndices.size());
+    SPDLOG_INFO("  - triangles after: {}", faces.size());
+  }
+  return faces;
+}
+
+static std::vector<TriangulateTriangleIndex>
+getConnectedTriangleIndices(const CDT &cdt,
+                            const std::vector<QPointF> &interiorPoints) {
+  std::vector<TriangulateTriangleIndex> triangleIndices;
+  for (const auto &face : getConnectedFaces(cdt, interiorPoints)) {
+    triangleIndices.push_back(toTriangleIndex(face));
   }
   return triangleIndices;
 }
@@ -109,6 +116,12 @@ static CDT makeConstrainedDelaunayTriangulation(
   return cdt;
 }
 
+static double maxTriangleEdgeLength(double maxArea) {
+  // convert max area constraint to a max triangle edge length constraint
+  // assume equilateral triangles, so area = sqrt(3) length^2 / 4
+  return 1.5196713713 * std::sqrt(maxArea);
+}
+
 static void meshCdt(CDT &cdt,
                     const std::vector<TriangulateCompartment> &compartments) {
   // compartments are meshed in ascending order of max triangle area, to avoid
@@ -126,9 +139,7 @@ static void meshCdt(CDT &cdt,
       seeds.emplace_back(ip.x(), ip.y());
     }
     double maxArea{compartment.maxTriangleArea};
-    // convert max area constraint to a max triangle edge length constraint
-    // assume equilateral triangles, so area = sqrt(3) length^2 / 4
-    double maxLength{1.5196713713 * std::sqrt(maxArea)};
+    double maxLength{maxTriangleEdgeLength(maxArea)};
     SPDLOG_INFO("Max area {} -> max length {}", maxArea, maxLength);
     // https://doc.cgal.org/latest/Mesh_2/classCGAL_1_1Delaunay__mesh__size__criteria__2.html
     constexpr double bestAngleBoundWithGuaranteedTermination{0.125};
@@ -181,4 +192,361 @@ Triangulate::getTriangleIndices() const {
   return triangleIndices;
 }
 
+namespace {
+
+struct BoundaryLine {
+  std::vector<QPointF> points;
+  bool isLoop;
+  bool operator==(const BoundaryLine &) const = default;
+};
+
+BoundaryLine toBoundaryLine(const Boundary &boundary) {
+  BoundaryLine line{{}, boundary.isLoop()};
+  line.points.reserve(boundary.getPoints().size());
+  for (const auto &p : boundary.getPoints()) {
+    line.points.emplace_back(p);
+  }
+  return line;
+}
+
+std::size_t nSegments(const BoundaryLine &line) {
+  if (line.points.size() < 2) {
+    return 0;
+  }
+  return line.isLoop ? line.points.size() : line.points.size() - 1;
+}
+
+// split each segment into equal parts no longer than maxLength
+BoundaryLine splitBoundaryLine(const BoundaryLine &line, double maxLength) {
+  BoundaryLine split{{}, line.isLoop};
+  const auto n{line.points.size()};
+  for (std::size_t i = 0; i < nSegments(line); ++i) {
+    const auto &a{line.points[i]};
+    const auto &b{line.points[(i + 1) % n]};
+    auto length{std::hypot(b.x() - a.x(), b.y() - a.y())};
+    auto nParts{std::max(std::size_t{1}, static_cast<std::size_t>(
+                                             std::ceil(length / maxLength)))};
+    for (std::size_t k = 0; k < nParts; ++k) {
+      split.points.push_back(a + (b - a) * (static_cast<double>(k) /
+                                            static_cast<double>(nParts)));
+    }
+  }
+  if (!line.isLoop && !line.points.empty()) {
+    split.points.push_back(line.points.back());
+  }
+  return split;
+}
+
+std::vector<CDT::Vertex_handle> insertBoundaryLine(CDT &cdt,
+                                                   const BoundaryLine &line) {
+  std::vector<CDT::Vertex_handle> vertices;
+  vertices.reserve(line.points.size());
+  for (const auto &p : line.points) {
+    // inserting an existing point returns the existing vertex
+    vertices.push_back(cdt.insert(CDT::Point(p.x(), p.y())));
+  }
+  const auto n{vertices.size()};
+  for (std::size_t i = 0; i < nSegments(line); ++i) {
+    cdt.insert_constraint(vertices[i], vertices[(i + 1) % n]);
+  }
+  return vertices;
+}
+
+using VertexPair = std::pair<const CDT::Vertex *, const CDT::Vertex *>;
+
+VertexPair toVertexPair(CDT::Vertex_handle a, CDT::Vertex_handle b) {
+  const CDT::Vertex *pa{&*a};
+  const CDT::Vertex *pb{&*b};
+  return pa < pb ? VertexPair{pa, pb} : VertexPair{pb, pa};
+}
+
+// the indices of the boundary lines that enclose each compartment
+std::vector<std::vector<std::size_t>> getCompartmentBoundaryIndices(
+    const std::vector<BoundaryLine> &lines,
+    const std::vector<std::vector<QPointF>> &interiorPoints) {
+  CDT cdt;
+  std::map<VertexPair, std::size_t> edgeBoundaryIndex;
+  for (std::size_t iLine = 0; iLine < lines.size(); ++iLine) {
+    auto vertices{insertBoundaryLine(cdt, lines[iLine])};
+    const auto n{vertices.size()};
+    for (std::size_t i = 0; i < nSegments(lines[iLine]); ++i) {
+      edgeBoundaryIndex[toVertexPair(vertices[i], vertices[(i + 1) % n])] =
+          iLine;
+    }
+  }
+  std::vector<std::vector<std::size_t>> indices;
+  indices.reserve(interiorPoints.size());
+  for (const auto &compartmentInteriorPoints : interiorPoints) {
+    std::set<std::size_t> compartmentIndices;
+    for (const auto &face : getConnectedFaces(cdt, compartmentInteriorPoints)) {
+      for (int i = 0; i < 3; ++i) {
+        if (!face->is_constrained(i)) {
+          continue;
+        }
+        if (auto iter{edgeBoundaryIndex.find(toVertexPair(
+                face->vertex(cdt.cw(i)), face->vertex(cdt.ccw(i))))};
+            iter != edgeBoundaryIndex.cend()) {
+          compartmentIndices.insert(iter->second);
+        } else {
+          SPDLOG_WARN("Constrained edge does not match a boundary segment");
+        }
+      }
+    }
+    indices.emplace_back(compartmentIndices.cbegin(),
+                         compartmentIndices.cend());
+  }
+  return indices;
+}
+
+double squaredDistanceToSegment(const QPointF &p, const QPointF &a,
+                                const QPointF &b) {
+  auto ab{b - a};
+  auto ap{p - a};
+  double l2{QPointF::dotProduct(ab, ab)};
+  double t{l2 > 0 ? std::clamp(QPointF::dotProduct(ap, ab) / l2, 0.0, 1.0)
+                  : 0.0};
+  auto d{ap - t * ab};
+  return QPointF::dotProduct(d, d);
+}
+
+// insert a point that lies on a boundary line, splitting the constrained
+// edge that it lies on
+void insertBoundaryPoint(CDT &cdt, const QPointF &p) {
+  CDT::Point point(p.x(), p.y());
+  CDT::Locate_type lt{};
+  int li{0};
+  auto face{cdt.locate(point, lt, li)};
+  if (lt == CDT::VERTEX) {
+    return;
+  }
+  if (lt == CDT::FACE) {
+    // due to rounding the point may lie just inside a face instead of exactly
+    // on a constrained edge, in which case use the closest constrained edge
+    double minDistance{std::numeric_limits<double>::max()};
+    for (int i = 0; i < 3; ++i) {
+      if (face->is_constrained(i)) {
+        const auto &a{face->vertex(cdt.cw(i))->point()};
+        const auto &b{face->vertex(cdt.ccw(i))->point()};
+        double d{squaredDistanceToSegment(p, {a.x(), a.y()}, {b.x(), b.y()})};
+        if (d < minDistance) {
+          minDistance = d;
+          lt = CDT::EDGE;
+          li = i;
+        }
+      }
+    }
+  }
+  if (lt == CDT::EDGE) {
+    cdt.insert(point, lt, face, li);
+    return;
+  }
+  SPDLOG_WARN("Boundary point ({},{}) is not on a boundary line", p.x(),
+              p.y());
+  cdt.insert(point, face);
+}
+
+} // namespace
+
+struct IncrementalTriangulate::Compartment {
+  // the inputs used to triangulate this compartment
+  std::vector<QPointF> interiorPoints;
+  double maxTriangleArea{};
+  std::vector<std::size_t> boundaryIndices;
+  std::vector<BoundaryLine> boundaryLines;
+  // the refined triangulation
+  CDT cdt;
+  // points added to the boundary lines by the refinement, and the index of the
+  // boundary line that each one lies on
+  std::vector<std::pair<QPointF, std::size_t>> boundarySteinerPoints;
+  void triangulate();
+  [[nodiscard]] std::size_t nearestBoundaryIndex(const QPointF &p) const;
+};
+
+std::size_t IncrementalTriangulate::Compartment::nearestBoundaryIndex(
+    const QPointF &p) const {
+  std::size_t index{0};
+  double minDistance{std::numeric_limits<double>::max()};
+  for (std::size_t iLine = 0; iLine < boundaryLines.size(); ++iLine) {
+    const auto &linePoints{boundaryLines[iLine].points};
+    const auto n{linePoints.size()};
+    for (std::size_t i = 0; i < nSegments(boundaryLines[iLine]); ++i) {
+      double d{
+          squaredDistanceToSegment(p, linePoints[i], linePoints[(i + 1) % n])};
+      if (d < minDistance) {
+        minDistance = d;
+        index = boundaryIndices[iLine];
+      }
+    }
+  }
+  return index;
+}
+
+void IncrementalTriangulate::Compartment::triangulate() {
+  cdt.clear();
+  boundarySteinerPoints.clear();
+  if (interiorPoints.empty()) {
+    return;
+  }
+  std::set<std::pair<double, double>> linePoints;
+  for (const auto &line : boundaryLines) {
+    insertBoundaryLine(cdt, line);
+    for (const auto &p : line.points) {
+      linePoints.insert({p.x(), p.y()});
+    }
+  }
+  meshCdt(cdt, {{interiorPoints, maxTriangleArea}});
+  // find any points that were added to the boundary lines
+  std::set<const CDT::Vertex *> visited;
+  for (const auto &face : getConnectedFaces(cdt, interiorPoints)) {
+    for (int i = 0; i < 3; ++i) {
+      auto vertex{face->vertex(i)};
+      if (!visited.insert(&*vertex).second ||
+          !cdt.are_there_incident_constraints(vertex)) {
+        continue;
+      }
+      QPointF p(vertex->point().x(), vertex->point().y());
+      if (!linePoints.contains({p.x(), p.y()})) {
+        boundarySteinerPoints.emplace_back(p, nearestBoundaryIndex(p));
+      }
+    }
+  }
+  SPDLOG_INFO("{} points added to boundary lines",
+              boundarySteinerPoints.size());
+}
+
+IncrementalTriangulate::IncrementalTriangulate() = default;
+
+IncrementalTriangulate::~IncrementalTriangulate() = default;
+
+void IncrementalTriangulate::update(
+    const std::vector<Boundary> &boundaries,
+    const std::vector<std::vector<QPointF>> &interiorPoints,
+    const std::vector<std::size_t> &maxTriangleAreas) {
+  updatedCompartments.clear();
+  try {
+    std::vector<BoundaryLine> lines;
+    lines.reserve(boundaries.size());
+    for (const auto &boundary : boundaries) {
+      lines.push_back(toBoundaryLine(boundary));
+    }
+    auto compartmentBoundaryIndices{
+        getCompartmentBoundaryIndices(lines, interiorPoints)};
+    // split each boundary line using the smallest max triangle edge length of
+    // the compartments on either side of it
+    std::vector<double> maxLengths(lines.size(),
+                                   std::numeric_limits<double>::max());
+    for (std::size_t iComp = 0; iComp < interiorPoints.size(); ++iComp) {
+      double maxLength{maxTriangleEdgeLength(
+          static_cast<double>(maxTriangleAreas[iComp]))};
+      for (auto iLine : compartmentBoundaryIndices[iComp]) {
+        maxLengths[iLine] = std::min(maxLengths[iLine], maxLength);
+      }
+    }
+    for (std::size_t iLine = 0; iLine < lines.size(); ++iLine) {
+      lines[iLine] = splitBoundaryLine(lines[iLine], maxLengths[iLine]);
+    }
+    compartments.resize(interiorPoints.size());
+    for (std::size_t iComp = 0; iComp < interiorPoints.size(); ++iComp) {
+      std::vector<BoundaryLine> compartmentLines;
+      for (auto iLine : compartmentBoundaryIndices[iComp]) {
+        compartmentLines.push_back(lines[iLine]);
+      }
+      auto maxArea{static_cast<double>(maxTriangleAreas[iComp])};
+      auto &compartment{compartments[iComp]};
+      if (compartment != nullptr &&
+          compartment->interiorPoints == interiorPoints[iComp] &&
+          compartment->maxTriangleArea == maxArea &&
+          compartment->boundaryIndices == compartmentBoundaryIndices[iComp] &&
+          compartment->boundaryLines == compartmentLines) {
+        SPDLOG_INFO("Re-using triangulation of compartment {}", iComp);
+        continue;
+      }
+      SPDLOG_INFO("Triangulating compartment {}", iComp);
+      compartment = std::make_unique<Compartment>();
+      compartment->interiorPoints = interiorPoints[iComp];
+      compartment->maxTriangleArea = maxArea;
+      compartment->boundaryIndices = compartmentBoundaryIndices[iComp];
+      compartment->boundaryLines = std::move(compartmentLines);
+      compartment->triangulate();
+      updatedCompartments.push_back(iComp);
+    }
+    combineCompartments();
+  } catch (...) {
+    // discard any partial results, so that the next update starts again
+    compartments.clear();
+    points.clear();
+    triangleIndices.clear();
+    throw;
+  }
+}
+
+void IncrementalTriangulate::combineCompartments() {
+  points.clear();
+  triangleIndices.clear();
+  std::map<std::pair<double, double>, std::size_t> pointIndices;
+  for (std::size_t iComp = 0; iComp < compartments.size(); ++iComp) {
+    const auto &compartment{*compartments[iComp]};
+    // points added by neighbouring compartments to a shared boundary line
+    std::vector<QPointF> extraPoints;
+    for (std::size_t iOther = 0; iOther < compartments.size(); ++iOther) {
+      if (iOther == iComp) {
+        continue;
+      }
+      for (const auto &[p, iLine] :
+           compartments[iOther]->boundarySteinerPoints) {
+        if (std::ranges::find(compartment.boundaryIndices, iLine) !=
+            compartment.boundaryIndices.cend()) {
+          extraPoints.push_back(p);
+        }
+      }
+    }
+    const CDT *cdt{&compartment.cdt};
+    CDT cdtWithExtraPoints;
+    if (!extraPoints.empty()) {
+      // insert into a copy, to leave the cached triangulation unchanged
+      SPDLOG_INFO("Adding {} boundary points to compartment {}",
+                  extraPoints.size(), iComp);
+      cdtWithExtraPoints = compartment.cdt;
+      for (const auto &p : extraPoints) {
+        insertBoundaryPoint(cdtWithExtraPoints, p);
+      }
+      cdt = &cdtWithExtraPoints;
+    }
+    auto &compartmentTriangleIndices{triangleIndices.emplace_back()};
+    for (const auto &face :
+         getConnectedFaces(*cdt, compartment.interiorPoints)) {
+      TriangulateTriangleIndex t{};
+      for (int i = 0; i < 3; ++i) {
+        // points on a boundary line are shared with the neighbouring
+        // compartment, and have identical coordinates in both
+        const auto &p{face->vertex(i)->point()};
+        auto [iter, inserted] =
+            pointIndices.try_emplace({p.x(), p.y()}, points.size());
+        if (inserted) {
+          points.emplace_back(p.x(), p.y());
+        }
+        t[static_cast<std::size_t>(i)] = iter->second;
+      }
+      compartmentTriangleIndices.push_back(t);
+    }
+    SPDLOG_INFO("added compartment with {} triangles",
+                compartmentTriangleIndices.size());
+  }
+  SPDLOG_INFO("Mesh has {} vertices", points.size());
+}
+
+const std::vector<QPointF> &IncrementalTriangulate::getPoints() const {
+  return points;
+}
+
+const std::vector<std::vector<TriangulateTriangleIndex>> &
+IncrementalTriangulate::getTriangleIndices() const {
+  return triangleIndices;
+}
+
+const std::vector<std::size_t> &
+IncrementalTriangulate::getUpdatedCompartments() const {
+  return updatedCompartments;
+}
+
 } // namespace sme::mesh
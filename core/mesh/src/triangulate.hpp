@@ -5,6 +5,7 @@
 #include <QPointF>
 #include <array>
 #include <cstddef>
+#include <memory>
 #include <vector>
 
 namespace sme::mesh {
@@ -53,4 +54,61 @@ public:
   getTriangleIndices() const;
 };
 
+/**
+ * @brief Triangulate each compartment separately, re-using previous results
+ *
+ * Each compartment is triangulated using only the boundary lines that enclose
+ * it. These boundary lines are first split into segments that are no longer
+ * than the max triangle edge length of the finest compartment on either side,
+ * so that neighbouring compartments start from the same boundary points. Any
+ * points that the refinement of a compartment adds to a boundary line are
+ * then also inserted into the compartment on the other side, so that the
+ * combined mesh is conforming.
+ *
+ * The triangulation of each compartment is cached, and is only re-computed by
+ * update() if its interior points, max triangle area or boundary lines have
+ * changed.
+ */
+class IncrementalTriangulate {
+private:
+  struct Compartment;
+  std::vector<std::unique_ptr<Compartment>> compartments;
+  std::vector<std::size_t> updatedCompartments;
+  std::vector<QPointF> points;
+  std::vector<std::vector<TriangulateTriangleIndex>> triangleIndices;
+  void combineCompartments();
+
+public:
+  IncrementalTriangulate();
+  ~IncrementalTriangulate();
+  /**
+   * @brief Update the triangulation
+   *
+   * Only the compartments that are affected by any changes since the last
+   * call are re-triangulated. If an exception is thrown, all cached results
+   * are discarded.
+   *
+   * @param[in] boundaries the boundary lines separating the compartments
+   * @param[in] interiorPoints the interior point(s) for each compartment
+   * @param[in] maxTriangleAreas the maximum allowed triangle area for each
+   *    compartment
+   */
+  void update(const std::vector<Boundary> &boundaries,
+              const std::vector<std::vector<QPointF>> &interiorPoints,
+              const std::vector<std::size_t> &maxTriangleAreas);
+  /**
+   * @brief The vertices or points in the mesh
+   */
+  [[nodiscard]] const std::vector<QPointF> &getPoints() const;
+  /**
+   * @brief The triangle vertex indices for each compartment
+   */
+  [[nodiscard]] const std::vector<std::vector<TriangulateTriangleIndex>> &
+  getTriangleIndices() const;
+  /**
+   * @brief The compartments that were re-triangulated by the last update
+   */
+  [[nodiscard]] const std::vector<std::size_t> &getUpdatedCompartments() const;
+};
+
 } // namespace sme::mesh
@@ -15,3 +15,21 @@ static void mesh_TriangulateBoundaries(benchmark::State &state) {
 }
 
 SME_BENCHMARK(mesh_TriangulateBoundaries);
+
+template <typename T>
+static void mesh_IncrementalTriangulate_changeOneArea(benchmark::State &state) {
+  T data;
+  auto interiorPoints{sme::mesh::getInteriorPoints(data.imgs[0], data.colours)};
+  sme::mesh::Boundaries boundaries(data.imgs[0], data.colours, 0);
+  auto maxTriangleArea{data.maxTriangleArea};
+  const auto area{data.maxTriangleArea.back()};
+  sme::mesh::IncrementalTriangulate t;
+  t.update(boundaries.getBoundaries(), interiorPoints, maxTriangleArea);
+  for (auto _ : state) {
+    // alternate the max area of the last compartment
+    maxTriangleArea.back() = maxTriangleArea.back() == area ? 2 * area : area;
+    t.update(boundaries.getBoundaries(), interiorPoints, maxTriangleArea);
+  }
+}
+
+SME_BENCHMARK(mesh_IncrementalTriangulate_changeOneArea);
@@ -2,6 +2,7 @@
 #include "triangulate.hpp"
 #include <QImage>
 #include <QPoint>
+#include <algorithm>
 #include <cmath>
 
 using namespace sme;
@@ -119,3 +120,109 @@ TEST_CASE("Triangulate",
     }
   }
 }
+
+static double totalTriangleArea(
+    const std::vector<QPointF> &points,
+    const std::vector<mesh::TriangulateTriangleIndex> &triangles) {
+  double area = 0;
+  for (const auto &t : triangles) {
+    area += triangleArea(points[t[0]], points[t[1]], points[t[2]]);
+  }
+  return area;
+}
+
+static std::vector<std::size_t>
+verticesOnLine(const std::vector<QPointF> &points,
+               const std::vector<mesh::TriangulateTriangleIndex> &triangles,
+               double x) {
+  std::vector<std::size_t> indices;
+  for (const auto &t : triangles) {
+    for (auto i : t) {
+      if (points[i].x() == x) {
+        indices.push_back(i);
+      }
+    }
+  }
+  std::ranges::sort(indices);
+  auto [first, last] = std::ranges::unique(indices);
+  indices.erase(first, last);
+  return indices;
+}
+
+TEST_CASE("IncrementalTriangulate",
+          "[core/mesh/triangulate][core/mesh][core][triangulate]") {
+  std::vector<mesh::Boundary> boundaries;
+  // left boundary
+  boundaries.push_back(
+      mesh::Boundary({{10, 0}, {0, 0}, {0, 10}, {10, 10}}, false));
+  // right boundary
+  boundaries.push_back(
+      mesh::Boundary({{10, 0}, {20, 0}, {20, 10}, {10, 10}}, false));
+  // middle shared boundary
+  boundaries.push_back(mesh::Boundary({{10, 0}, {10, 10}}, false));
+  std::vector<std::vector<QPointF>> interiorPoints{{{5.0, 5.0}},
+                                                   {{15.0, 5.0}}};
+  std::vector<std::size_t> maxAreas{4, 3};
+  mesh::IncrementalTriangulate tri;
+  tri.update(boundaries, interiorPoints, maxAreas);
+  REQUIRE(tri.getUpdatedCompartments() == std::vector<std::size_t>{0, 1});
+  const auto &points{tri.getPoints()};
+  const auto &triangles{tri.getTriangleIndices()};
+  REQUIRE(triangles.size() == 2);
+  REQUIRE(maxTriangleArea(points, triangles[0]) <= 4);
+  REQUIRE(maxTriangleArea(points, triangles[1]) <= 3);
+  REQUIRE(totalTriangleArea(points, triangles[0]) == Catch::Approx(100.0));
+  REQUIRE(totalTriangleArea(points, triangles[1]) == Catch::Approx(100.0));
+  // mesh is conforming: both compartments use the same vertices on the
+  // shared boundary line
+  auto sharedVertices{verticesOnLine(points, triangles[0], 10.0)};
+  REQUIRE(sharedVertices.size() > 2);
+  REQUIRE(verticesOnLine(points, triangles[1], 10.0) == sharedVertices);
+  SECTION("update with no changes") {
+    auto nPoints{points.size()};
+    tri.update(boundaries, interiorPoints, maxAreas);
+    REQUIRE(tri.getUpdatedCompartments().empty());
+    REQUIRE(tri.getPoints().size() == nPoints);
+  }
+  SECTION("change max area of one compartment") {
+    // the shared boundary line is still split using the smaller max area of
+    // the right compartment, so the right compartment is unchanged
+    maxAreas[0] = 5;
+    tri.update(boundaries, interiorPoints, maxAreas);
+    REQUIRE(tri.getUpdatedCompartments() == std::vector<std::size_t>{0});
+    REQUIRE(maxTriangleArea(tri.getPoints(), tri.getTriangleIndices()[0]) <=
+            5);
+    REQUIRE(maxTriangleArea(tri.getPoints(), tri.getTriangleIndices()[1]) <=
+            3);
+    REQUIRE(verticesOnLine(tri.getPoints(), tri.getTriangleIndices()[1],
+                           10.0) == verticesOnLine(tri.getPoints(),
+                                                   tri.getTriangleIndices()[0],
+                                                   10.0));
+    // result is independent of previous updates
+    mesh::IncrementalTriangulate tri2;
+    tri2.update(boundaries, interiorPoints, maxAreas);
+    REQUIRE(tri2.getPoints().size() == tri.getPoints().size());
+    REQUIRE(tri2.getTriangleIndices()[0].size() ==
+            tri.getTriangleIndices()[0].size());
+    REQUIRE(tri2.getTriangleIndices()[1].size() ==
+            tri.getTriangleIndices()[1].size());
+  }
+  SECTION("change boundary line of one compartment") {
+    boundaries[1] =
+        mesh::Boundary({{10, 0}, {30, 0}, {30, 10}, {10, 10}}, false);
+    tri.update(boundaries, interiorPoints, maxAreas);
+    REQUIRE(tri.getUpdatedCompartments() == std::vector<std::size_t>{1});
+    REQUIRE(totalTriangleArea(tri.getPoints(), tri.getTriangleIndices()[0]) ==
+            Catch::Approx(100.0));
+    REQUIRE(totalTriangleArea(tri.getPoints(), tri.getTriangleIndices()[1]) ==
+            Catch::Approx(200.0));
+    REQUIRE(maxTriangleArea(tri.getPoints(), tri.getTriangleIndices()[1]) <=
+            3);
+  }
+  SECTION("interior point outside of boundary lines") {
+    interiorPoints[1] = {{25.0, 5.0}};
+    REQUIRE_THROWS(tri.update(boundaries, interiorPoints, maxAreas));
+    REQUIRE(tri.getPoints().empty());
+    REQUIRE(tri.getTriangleIndices().empty());
+  }
+}
@@ -120,7 +120,8 @@ public:
   void importSBMLFile(const std::string &filename);
   void importSBMLString(const std::string &xml,
                         const std::string &filename = {});
-  void exportSBMLFile(const std::string &filename);
+  void exportSBMLFile(const std::string &filename,
+                      bool compressSampledFields = false);
   void importFile(const std::string &filename);
   void exportSMEFile(const std::string &filename);
   QString getXml();
@@ -19,6 +19,7 @@ namespace sme {
 
 namespace mesh {
 class Mesh;
+class Mesh3d;
 }
 
 namespace model {
@@ -36,6 +37,9 @@ private:
   int numDimensions{3};
   common::ImageStack images;
   std::unique_ptr<mesh::Mesh> mesh;
+  // tetrahedral meshing is expensive, so the 3d mesh is only constructed when
+  // ensureMesh3d is called
+  std::unique_ptr<mesh::Mesh3d> mesh3d;
   bool isValid{false};
   bool hasImage{false};
   libsbml::Model *sbmlModel{nullptr};
@@ -72,6 +76,13 @@ public:
   getPhysicalPointAsString(const common::Voxel &voxel) const;
   [[nodiscard]] const common::ImageStack &getImages() const;
   [[nodiscard]] mesh::Mesh *getMesh() const;
+  // constructs the 3d mesh of a 3d geometry if it has not already been
+  // constructed, which can be slow
+  void ensureMesh3d();
+  // nullptr if the 3d mesh has not been constructed
+  [[nodiscard]] mesh::Mesh3d *getMesh3d() const;
+  // true if there is a valid 2d mesh, or a valid constructed 3d mesh
+  [[nodiscard]] bool getHasValidMesh() const;
   [[nodiscard]] bool getIsValid() const;
   [[nodiscard]] bool getHasImage() const;
   void writeGeometryToSBML() const;
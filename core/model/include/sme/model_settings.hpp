@@ -16,6 +16,7 @@ struct MeshParameters {
   std::vector<std::size_t> maxPoints{};
   std::vector<std::size_t> maxAreas{};
   std::size_t boundarySimplifierType{0};
+  std::vector<std::size_t> maxVolumes{};
   template <class Archive>
   void serialize(Archive &ar, std::uint32_t const version) {
     if (version == 0) {
@@ -23,6 +24,9 @@ struct MeshParameters {
     } else if (version == 1) {
       ar(CEREAL_NVP(maxPoints), CEREAL_NVP(maxAreas),
          CEREAL_NVP(boundarySimplifierType));
+    } else if (version == 2) {
+      ar(CEREAL_NVP(maxPoints), CEREAL_NVP(maxAreas),
+         CEREAL_NVP(boundarySimplifierType), CEREAL_NVP(maxVolumes));
     }
   }
 };
@@ -94,7 +98,7 @@ struct Settings {
 
 } // namespace sme::model
 
-CEREAL_CLASS_VERSION(sme::model::MeshParameters, 1);
+CEREAL_CLASS_VERSION(sme::model::MeshParameters, 2);
 CEREAL_CLASS_VERSION(sme::model::DisplayOptions, 1);
 CEREAL_CLASS_VERSION(sme::model::SimulationSettings, 1);
 CEREAL_CLASS_VERSION(sme::model::Settings, 2);
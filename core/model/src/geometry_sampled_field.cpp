@@ -89,7 +89,8 @@ static bool isNativeSampledFieldFormat(
   if (!allSampledValuesSet(sampledVolumes)) {
     return false;
   }
-  if (auto values = common::stringToVector<QRgb>(sampledField->getSamples());
+  if (auto values = common::stringToVector<QRgb>(
+          getSampledFieldSamples(sampledField));
       !valuesAreAllQRgb(values)) {
     return false;
   }
@@ -131,7 +132,8 @@ static std::vector<QRgb> setImagePixelsNative(
     const std::vector<const libsbml::SampledVolume *> &sampledVolumes) {
   std::vector<QRgb> colours;
   colours.reserve(sampledVolumes.size());
-  auto values = common::stringToVector<QRgb>(sampledField->getSamples());
+  auto values =
+      common::stringToVector<QRgb>(getSampledFieldSamples(sampledField));
   SPDLOG_DEBUG("Importing sampled field of {} samples of type QRgb",
                values.size());
   if (static_cast<int>(values.size()) != sampledField->getSamplesLength()) {
@@ -193,20 +195,8 @@ static std::vector<QRgb> setImagePixels(
   for (auto &img : imgs) {
     img.fill(qRgb(0, 0, 0));
   }
-  std::vector<T> values;
-  if (sampledField->getCompression() ==
-      libsbml::CompressionKind_t::SPATIAL_COMPRESSIONKIND_DEFLATED) {
-    // for compressed fields the string returned by getSamples() is compressed,
-    // so instead we get the field as doubles and then cast to the correct type.
-    std::vector<double> dbls;
-    sampledField->getSamples(dbls);
-    values.reserve(dbls.size());
-    for (auto dbl : dbls) {
-      values.push_back(static_cast<T>(dbl));
-    }
-  } else {
-    values = common::stringToVector<T>(sampledField->getSamples());
-  }
+  auto values{
+      common::stringToVector<T>(getSampledFieldSamples(sampledField))};
   SPDLOG_DEBUG("Importing sampled field of {} samples of type {}",
                values.size(), common::decltypeStr<T>());
   if (common::isItIndexes(values, importedSampledFieldColours.size())) {
@@ -1,6 +1,7 @@
 #include "sme/model.hpp"
 #include "id.hpp"
 #include "sbml_math.hpp"
+#include "sbml_utils.hpp"
 #include "sme/logger.hpp"
 #include "sme/mesh.hpp"
 #include "sme/utils.hpp"
@@ -9,6 +10,7 @@
 #include <QFileInfo>
 #include <algorithm>
 #include <combine/combinearchive.h>
+#include <memory>
 #include <omex/CaContent.h>
 #include <sbml/SBMLTransforms.h>
 #include <sbml/SBMLTypes.h>
@@ -136,13 +138,22 @@ bool Model::getHasUnsavedChanges() const {
 
 const QString &Model::getCurrentFilename() const { return currentFilename; }
 
-void Model::exportSBMLFile(const std::string &filename) {
+void Model::exportSBMLFile(const std::string &filename,
+                           bool compressSampledFields) {
   if (!isValid) {
     return;
   }
   updateSBMLDoc();
   SPDLOG_INFO("Exporting SBML model to {}", filename);
-  if (!libsbml::SBMLWriter().writeSBML(doc.get(), filename)) {
+  std::unique_ptr<libsbml::SBMLDocument> compressedDoc;
+  const auto *exportedDoc{doc.get()};
+  if (compressSampledFields) {
+    // compress a copy: the model itself keeps the uncompressed samples
+    compressedDoc.reset(doc->clone());
+    deflateSampledFields(compressedDoc->getModel());
+    exportedDoc = compressedDoc.get();
+  }
+  if (!libsbml::SBMLWriter().writeSBML(exportedDoc, filename)) {
     SPDLOG_ERROR("Failed to write to {}", filename);
     return;
   }
@@ -4,6 +4,7 @@
 #include "sbml_utils.hpp"
 #include "sme/logger.hpp"
 #include "sme/mesh.hpp"
+#include "sme/mesh3d.hpp"
 #include "sme/model_compartments.hpp"
 #include "sme/model_membranes.hpp"
 #include "sme/model_units.hpp"
@@ -290,18 +291,24 @@ void ModelGeometry::updateMesh() {
             !modelCompartments->getColours().contains(0);
   if (!isValid) {
     mesh.reset();
-    return;
-  }
-  // for now only generate a mesh for 2-d (single z slice) images
-  if (images.volume().depth() > 1) {
-    SPDLOG_WARN("Meshing not yet implemented for 3-d images");
-    mesh.reset();
+    mesh3d.reset();
     return;
   }
   hasUnsavedChanges = true;
   const auto &colours{modelCompartments->getColours()};
   const auto &ids{modelCompartments->getIds()};
   const auto &meshParams{sbmlAnnotation->meshParameters};
+  // 3-d mesh is re-constructed by the next call to ensureMesh3d, keeping any
+  // changes to the max cell volumes
+  if (mesh3d != nullptr && mesh3d->isValid()) {
+    sbmlAnnotation->meshParameters.maxVolumes =
+        mesh3d->getCompartmentMaxCellVolume();
+  }
+  mesh3d.reset();
+  if (images.volume().depth() > 1) {
+    mesh.reset();
+    return;
+  }
   // todo: use entire images stack - for now just take first one
   mesh = std::make_unique<mesh::Mesh>(images[0], meshParams.maxPoints,
                                       meshParams.maxAreas, voxelSize,
@@ -316,6 +323,7 @@ void ModelGeometry::updateMesh() {
 
 void ModelGeometry::clear() {
   mesh.reset();
+  mesh3d.reset();
   hasImage = false;
   isValid = false;
   images.clear();
@@ -375,6 +383,9 @@ void ModelGeometry::setVoxelSize(const common::VolumeF &newVoxelSize,
   SPDLOG_INFO("  - origin rescaled to ({},{},{})", physicalOrigin.p.x(),
               physicalOrigin.p.y(), physicalOrigin.z);
 
+  if (mesh3d != nullptr) {
+    mesh3d->setPhysicalGeometry(voxelSize, physicalOrigin);
+  }
   if (mesh != nullptr) {
     mesh->setPhysicalGeometry(voxelSize, physicalOrigin);
   }
@@ -450,6 +461,24 @@ const common::ImageStack &ModelGeometry::getImages() const { return images; }
 
 mesh::Mesh *ModelGeometry::getMesh() const { return mesh.get(); }
 
+void ModelGeometry::ensureMesh3d() {
+  if (mesh3d == nullptr && isValid && images.volume().depth() > 1) {
+    // 3-d image: tetrahedral mesh of the whole image stack
+    mesh3d = std::make_unique<mesh::Mesh3d>(
+        images, sbmlAnnotation->meshParameters.maxVolumes, voxelSize,
+        physicalOrigin, common::toStdVec(modelCompartments->getColours()));
+  }
+}
+
+mesh::Mesh3d *ModelGeometry::getMesh3d() const { return mesh3d.get(); }
+
+bool ModelGeometry::getHasValidMesh() const {
+  if (mesh != nullptr && mesh->isValid()) {
+    return true;
+  }
+  return mesh3d != nullptr && mesh3d->isValid();
+}
+
 bool ModelGeometry::getIsValid() const { return isValid; }
 
 bool ModelGeometry::getHasImage() const { return hasImage; }
@@ -460,6 +489,10 @@ void ModelGeometry::writeGeometryToSBML() const {
                                       mesh->getCompartmentMaxTriangleArea(),
                                       mesh->getBoundarySimplificationType()};
   }
+  if (mesh3d != nullptr && mesh3d->isValid()) {
+    sbmlAnnotation->meshParameters.maxVolumes =
+        mesh3d->getCompartmentMaxCellVolume();
+  }
 }
 
 bool ModelGeometry::getHasUnsavedChanges() const { return hasUnsavedChanges; }
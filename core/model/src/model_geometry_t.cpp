@@ -1,6 +1,7 @@
 #include "catch_wrapper.hpp"
 #include "model_test_utils.hpp"
 #include "sme/mesh.hpp"
+#include "sme/mesh3d.hpp"
 #include "sme/model.hpp"
 #include "sme/model_geometry.hpp"
 #include "sme/serialization.hpp"
@@ -106,6 +107,27 @@ TEST_CASE("Model geometry",
       REQUIRE(imgIndexed[0].pixelColor(176, 188).rgba() == innerCol);
     }
   }
+  SECTION("3d model has a tetrahedral mesh") {
+    auto m{getExampleModel(Mod::SingleCompartmentDiffusion3D)};
+    REQUIRE(m.getGeometry().getImages().volume().depth() > 1);
+    REQUIRE(m.getGeometry().getMesh() == nullptr);
+    // only constructed when explicitly requested
+    REQUIRE(m.getGeometry().getMesh3d() == nullptr);
+    REQUIRE(m.getGeometry().getHasValidMesh() == false);
+    m.getGeometry().ensureMesh3d();
+    REQUIRE(m.getGeometry().getMesh3d() != nullptr);
+    REQUIRE(m.getGeometry().getMesh3d()->isValid());
+    REQUIRE(m.getGeometry().getHasValidMesh());
+    REQUIRE(m.getGeometry().getMesh3d()->getTetrahedronIndices().size() == 1);
+    const auto *mesh3d{m.getGeometry().getMesh3d()};
+    m.getGeometry().ensureMesh3d();
+    REQUIRE(m.getGeometry().getMesh3d() == mesh3d);
+    m.getGeometry().clear();
+    REQUIRE(m.getGeometry().getMesh3d() == nullptr);
+    REQUIRE(m.getGeometry().getHasValidMesh() == false);
+    m.getGeometry().ensureMesh3d();
+    REQUIRE(m.getGeometry().getMesh3d() == nullptr);
+  }
   SECTION("very-simple-model") {
     auto m{getExampleModel(Mod::VerySimpleModel)};
     QRgb c0{qRgb(0, 2, 0)};
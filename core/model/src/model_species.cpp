@@ -131,16 +131,7 @@ ModelSpecies::getSampledFieldConcentrationFromSBML(const QString &id) const {
     // use string instead of vector of doubles overload to avoid libsbml issue
     // with stringstreams & subnormal doubles on macos:
     // https://github.com/spatial-model-editor/spatial-model-editor/issues/465
-    std::stringstream ss{sf->getSamples()};
-    double val;
-    while (ss >> val || !ss.eof()) {
-      if (ss.fail() && std::fpclassify(val) == FP_SUBNORMAL) {
-        // subnormal doubles set fail bit on macos but are otherwise correctly
-        // parsed
-        ss.clear();
-      }
-      array.push_back(val);
-    }
+    array = common::stringToVector<double>(getSampledFieldSamples(sf));
   }
   SPDLOG_INFO("returning array of size {}", array.size());
   return array;
@@ -637,7 +628,7 @@ void ModelSpecies::setSampledFieldConcentration(
   }
   sf->setId(sfId);
   SPDLOG_INFO("  - creating SampledField: {}", sf->getId());
-  sf->setSamples(concentrationArray);
+  sf->setSamples(common::vectorToString(concentrationArray));
   sf->setNumSamples1(modelGeometry->getImages().volume().width());
   sf->setNumSamples2(modelGeometry->getImages().volume().height());
   sf->setNumSamples3(
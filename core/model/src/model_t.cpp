@@ -4,6 +4,7 @@
 #include "sme/mesh.hpp"
 #include "sme/model.hpp"
 #include "sme/utils.hpp"
+#include <QFile>
 #include <sbml/SBMLTypes.h>
 #include <sbml/extension/SBMLDocumentPlugin.h>
 #include <sbml/packages/spatial/common/SpatialExtensionTypes.h>
@@ -1024,6 +1025,35 @@ TEST_CASE("SBML: import SBML doc with compressed sampledField",
   REQUIRE(s.getCompartments().getCompartment("vesicle")->nVoxels() == 104);
 }
 
+TEST_CASE("SBML: export SBML doc with compressed sampledFields",
+          "[core/model/model][core/model][core][model]") {
+  auto s{getExampleModel(Mod::ABtoC)};
+  auto conc{s.getSpecies().getSampledFieldConcentration("A")};
+  // modify concentration inside compartment, including subnormal values
+  for (std::size_t i = 0; i < conc.size(); ++i) {
+    if (conc[i] > 0) {
+      conc[i] = static_cast<double>(i % 7) * 0.1 + 1e-310;
+    }
+  }
+  s.getSpecies().setSampledFieldConcentration("A", conc);
+  s.exportSBMLFile("tmpcompressed.xml", true);
+  QFile f("tmpcompressed.xml");
+  REQUIRE(f.open(QIODevice::ReadOnly | QIODevice::Text));
+  auto xml{f.readAll()};
+  REQUIRE(xml.contains("spatial:compression=\"deflated\""));
+  REQUIRE(!xml.contains("spatial:compression=\"uncompressed\""));
+  // model itself is not modified
+  REQUIRE(s.getSpecies().getSampledFieldConcentration("A") == conc);
+  model::Model s2;
+  s2.importSBMLFile("tmpcompressed.xml");
+  REQUIRE(s2.getIsValid() == true);
+  REQUIRE(s2.getGeometry().getImages().volume().width() == 100);
+  REQUIRE(s2.getGeometry().getImages().volume().height() == 100);
+  REQUIRE(s2.getCompartments().getCompartment("comp")->nVoxels() ==
+          s.getCompartments().getCompartment("comp")->nVoxels());
+  REQUIRE(s2.getSpecies().getSampledFieldConcentration("A") == conc);
+}
+
 TEST_CASE("Import Combine archive",
           "[combine][archive][core/model/model][core/model][core][model]") {
   QString filename{"liver-simplified.omex"};
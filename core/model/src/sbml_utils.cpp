@@ -1,5 +1,11 @@
 #include "sbml_utils.hpp"
 #include "sme/logger.hpp"
+#include "sme/utils.hpp"
+#include <QByteArray>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include <sbml/extension/SBMLDocumentPlugin.h>
 #include <sbml/packages/spatial/extension/SpatialExtension.h>
 
@@ -232,4 +238,60 @@ libsbml::Parameter *getSpatialCoordinateParam(libsbml::Model *model,
       const_cast<const libsbml::Model *>(model), kind));
 }
 
+std::string getSampledFieldSamples(const libsbml::SampledField *sampledField) {
+  if (sampledField->getCompression() !=
+      libsbml::CompressionKind_t::SPATIAL_COMPRESSIONKIND_DEFLATED) {
+    return sampledField->getSamples();
+  }
+  // deflated samples are the zlib compressed bytes of the uncompressed text
+  auto bytes{common::stringToVector<unsigned char>(sampledField->getSamples())};
+  if (bytes.empty()) {
+    return {};
+  }
+  // qUncompress expects a 4-byte big-endian header with the uncompressed size,
+  // which is only used as the initial size of the output buffer
+  auto sizeHint{static_cast<quint32>(std::min(
+      bytes.size() * 8,
+      static_cast<std::size_t>(std::numeric_limits<quint32>::max())))};
+  QByteArray compressed(static_cast<qsizetype>(bytes.size() + 4),
+                        Qt::Uninitialized);
+  qToBigEndian(sizeHint, compressed.data());
+  std::memcpy(compressed.data() + 4, bytes.data(), bytes.size());
+  if (auto samples{qUncompress(compressed)}; !samples.isEmpty()) {
+    return samples.toStdString();
+  }
+  // not a zlib stream: fall back to the (slower) libsbml implementation
+  SPDLOG_WARN("Failed to decompress SampledField '{}', using libsbml",
+              sampledField->getId());
+  std::vector<double> values;
+  sampledField->getSamples(values);
+  return common::vectorToString(values);
+}
+
+void deflateSampledFields(libsbml::Model *model) {
+  auto *geom{const_cast<libsbml::Geometry *>(
+      getGeometry(const_cast<const libsbml::Model *>(model)))};
+  if (geom == nullptr) {
+    return;
+  }
+  for (unsigned i = 0; i < geom->getNumSampledFields(); ++i) {
+    auto *sf{geom->getSampledField(i)};
+    if (sf->getCompression() ==
+        libsbml::CompressionKind_t::SPATIAL_COMPRESSIONKIND_DEFLATED) {
+      continue;
+    }
+    auto compressed{qCompress(QByteArray::fromStdString(sf->getSamples()))};
+    // remove the 4-byte size header that Qt prepends to the zlib stream
+    const auto *data{
+        reinterpret_cast<const unsigned char *>(compressed.constData())};
+    std::vector<unsigned char> bytes(data + 4, data + compressed.size());
+    SPDLOG_INFO("SampledField '{}': compressed {} chars to {} bytes",
+                sf->getId(), sf->getSamples().size(), bytes.size());
+    sf->setSamples(common::vectorToString(bytes));
+    sf->setSamplesLength(static_cast<int>(bytes.size()));
+    sf->setCompression(
+        libsbml::CompressionKind_t::SPATIAL_COMPRESSIONKIND_DEFLATED);
+  }
+}
+
 } // namespace sme::model
@@ -15,6 +15,7 @@ class Model;
 class SampledFieldGeometry;
 class Species;
 class Parameter;
+class SampledField;
 } // namespace libsbml
 
 namespace sme::model {
@@ -43,4 +44,8 @@ getSpatialCoordinateParam(const libsbml::Model *model,
 
 libsbml::Parameter *getSpatialCoordinateParam(libsbml::Model *model,
                                               libsbml::CoordinateKind_t kind);
+
+std::string getSampledFieldSamples(const libsbml::SampledField *sampledField);
+
+void deflateSampledFields(libsbml::Model *model);
 } // namespace sme::model
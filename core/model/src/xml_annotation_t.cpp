@@ -29,6 +29,7 @@ TEST_CASE("XML Annotations",
     simulationSettings.options.dune.dt = 0.0123;
     auto &meshParameters{settings.meshParameters};
     meshParameters.boundarySimplifierType = 1;
+    meshParameters.maxVolumes = {5, 7};
     auto &optimizeOptions{settings.optimizeOptions};
     optimizeOptions.optAlgorithm.islands = 3;
     optimizeOptions.optAlgorithm.population = 7;
@@ -56,6 +57,7 @@ TEST_CASE("XML Annotations",
     REQUIRE(newSimulationSettings.options.dune.dt == dbl_approx(0.0123));
     auto &newMeshParameters{newSettings.meshParameters};
     REQUIRE(newMeshParameters.boundarySimplifierType == 1);
+    REQUIRE(newMeshParameters.maxVolumes == std::vector<std::size_t>{5, 7});
     auto &newOptimizeOptions{newSettings.optimizeOptions};
     REQUIRE(optimizeOptions.optAlgorithm.islands == 3);
     REQUIRE(optimizeOptions.optAlgorithm.population == 7);
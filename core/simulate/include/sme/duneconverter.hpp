@@ -1,5 +1,6 @@
 // DUNE-copasi ini file generation
 //  - DuneConverter: construct DUNE ini file from model
+//  - the ini text is only generated when requested, e.g. for export
 
 #pragma once
 
@@ -10,7 +11,10 @@
 #include <QSizeF>
 #include <QString>
 #include <map>
+#include <memory>
+#include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace sme {
@@ -21,10 +25,13 @@ class Model;
 
 namespace mesh {
 class Mesh;
+class Mesh3d;
 }
 
 namespace simulate {
 
+class IniFile;
+
 class DuneConverter {
 public:
   explicit DuneConverter(
@@ -32,9 +39,22 @@ public:
       const std::map<std::string, double, std::less<>> &substitutions = {},
       bool forExternalUse = false, const QString &outputIniFile = {},
       int doublePrecision = 18);
+  ~DuneConverter();
   [[nodiscard]] QString getIniFile() const;
+  /**
+   * @brief The ini file parameters as (key, value) pairs
+   *
+   * Can be used to construct a Dune::ParameterTree directly, without
+   * generating and then parsing the ini file text.
+   */
+  [[nodiscard]] std::vector<std::pair<std::string, std::string>>
+  getIniParameters() const;
+  [[nodiscard]] bool empty() const;
 
   [[nodiscard]] const mesh::Mesh *getMesh() const;
+  [[nodiscard]] const mesh::Mesh3d *getMesh3d() const;
+  // 2 for a triangular mesh, 3 for a tetrahedral mesh
+  [[nodiscard]] int getDimension() const;
   [[nodiscard]] const std::unordered_map<std::string, std::vector<double>> &
   getConcentrations() const;
   [[nodiscard]] const std::unordered_map<std::string,
@@ -46,8 +66,9 @@ public:
   [[nodiscard]] common::Volume getImageSize() const;
 
 private:
-  QString iniFile;
+  std::unique_ptr<IniFile> ini;
   const mesh::Mesh *mesh;
+  const mesh::Mesh3d *mesh3d;
   std::unordered_map<std::string, std::vector<double>> concentrations;
   std::unordered_map<std::string, std::vector<std::string>> speciesNames;
   std::vector<std::string> compartmentNames;
@@ -1,6 +1,7 @@
 #pragma once
 #include "sme/image_stack.hpp"
 #include "sme/model.hpp"
+#include "sme/optimize_checkpoint.hpp"
 #include "sme/optimize_options.hpp"
 #include "sme/simulate.hpp"
 #include <memory>
@@ -20,8 +21,16 @@
 
 namespace sme::simulate {
 
-using ThreadsafeModelQueue =
-    oneapi::tbb::concurrent_queue<std::shared_ptr<sme::model::Model>>;
+// a model, and a simulation of it that can be reset and re-used
+struct OptModel {
+  std::shared_ptr<sme::model::Model> model{};
+  std::shared_ptr<Simulation> simulation{};
+  // the same model with a coarsened geometry, if used for screening
+  std::shared_ptr<sme::model::Model> coarseModel{};
+  std::shared_ptr<Simulation> coarseSimulation{};
+};
+
+using ThreadsafeModelQueue = oneapi::tbb::concurrent_queue<OptModel>;
 
 struct OptTimestep {
   // the time to simulate for
@@ -36,6 +45,26 @@ struct OptConstData {
   std::vector<OptTimestep> optTimesteps{};
   common::Volume imageSize{};
   std::vector<double> maxTargetValues{};
+  // model with coarsened geometry for screening candidates: empty if not used
+  std::string coarseXmlModel{};
+  // optCosts with target values downsampled to the coarse geometry
+  std::vector<OptCost> coarseOptCosts{};
+  // ratio of the number of voxels in the full and coarse geometry images
+  double coarseCostScale{1.0};
+};
+
+/**
+ * @brief The costs of a candidate evaluated with a coarsened geometry
+ */
+struct OptScreeningCosts {
+  /**
+   * @brief The cost with the coarse geometry, rescaled to full resolution
+   */
+  double coarseCost;
+  /**
+   * @brief The cost at full resolution, NaN if the candidate was screened out
+   */
+  double fullCost;
 };
 
 /**
@@ -58,22 +87,47 @@ private:
   std::atomic<bool> isRunning{false};
   std::atomic<bool> stopRequested{false};
   std::atomic<std::size_t> nIterations{0};
+  std::atomic<double> costCeiling{std::numeric_limits<double>::max()};
   std::vector<double> bestFitness;
   std::vector<std::vector<double>> bestParams;
   mutable std::mutex bestResultsMutex;
   BestResults bestResults{};
   std::unique_ptr<ThreadsafeModelQueue> modelQueue{nullptr};
   std::string errorMessage{};
+  mutable std::mutex screeningCostsMutex;
+  std::vector<OptScreeningCosts> screeningCosts{};
+  std::unique_ptr<OptEvaluationLog> evaluationLog{nullptr};
+  // populations to resume from when the archipelago is constructed
+  std::unique_ptr<OptimizationCheckpoint> resumeCheckpoint{nullptr};
 
+  void init(sme::model::Model &model);
   std::size_t finalizeEvolve(const std::string &newErrorMessage = {});
+  void updateCostCeiling();
 
 public:
   /**
    * @brief Constructs an Optimization object from the supplied model
    *
    * @param[in] model the model to optimize
+   * @param[in] evaluationLogFilename the file to log every fitness
+   * evaluation to, replacing any existing file. If empty, a temporary file is
+   * used.
+   */
+  explicit Optimization(sme::model::Model &model,
+                        const std::string &evaluationLogFilename = {});
+  /**
+   * @brief Resumes an optimization of the supplied model from a checkpoint
+   *
+   * @param[in] model the model to optimize
+   * @param[in] checkpoint the state of the optimization to resume
+   * @param[in] evaluationLogFilename the evaluation log of the optimization
+   * that wrote the checkpoint, which is truncated to the evaluations that the
+   * checkpoint refers to. If empty, a temporary file is used, and the
+   * evaluations from before the checkpoint are not available.
    */
-  explicit Optimization(sme::model::Model &model);
+  Optimization(sme::model::Model &model,
+               const OptimizationCheckpoint &checkpoint,
+               const std::string &evaluationLogFilename = {});
   /**
    * @brief Do n iterations of parameter optimization
    */
@@ -102,6 +156,41 @@ public:
    */
   bool setBestResults(double fitness,
                       std::vector<std::vector<double>> &&results);
+  /**
+   * @brief The lowest full resolution fitness found so far
+   */
+  [[nodiscard]] double getBestResultsFitness() const;
+  /**
+   * @brief The largest fitness in the current island populations
+   *
+   * A candidate whose partial cost exceeds this can't improve on any member
+   * of the populations, so the evaluation of its fitness can be stopped early.
+   */
+  [[nodiscard]] double getCostCeiling() const;
+  /**
+   * @brief Record the costs of a candidate screened with a coarse geometry
+   */
+  void addScreeningCosts(const OptScreeningCosts &costs);
+  /**
+   * @brief The costs of each candidate screened with a coarse geometry
+   */
+  [[nodiscard]] std::vector<OptScreeningCosts> getScreeningCosts() const;
+  /**
+   * @brief Append the parameters and cost of a fitness evaluation to the log
+   */
+  void addEvaluation(const std::vector<double> &params, double cost);
+  /**
+   * @brief The parameters and cost of every fitness evaluation so far
+   *
+   * These are read from the evaluation log.
+   */
+  [[nodiscard]] std::vector<OptEvaluation> getEvaluations() const;
+  /**
+   * @brief The state required to resume this optimization
+   *
+   * Should not be called while the optimization is running.
+   */
+  [[nodiscard]] OptimizationCheckpoint getCheckpoint() const;
   /**
    * @brief Get an image of the a target
    */
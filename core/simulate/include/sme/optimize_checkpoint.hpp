@@ -0,0 +1,156 @@
+// Optimization checkpoint
+//  - state required to resume an optimization
+//  - the fitness evaluations are stored separately in an append-only log
+
+#pragma once
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/vector.hpp>
+#include <cereal/types/string.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class QFile;
+
+namespace sme::simulate {
+
+/**
+ * @brief The parameters and cost of a single fitness evaluation
+ */
+struct OptEvaluation {
+  /**
+   * @brief The values of the parameters being optimized
+   */
+  std::vector<double> params;
+  /**
+   * @brief The cost of these parameters
+   *
+   * For candidates that were stopped early, or screened out using a coarse
+   * geometry, this is an estimate of the cost.
+   */
+  double cost;
+
+  template <class Archive>
+  void serialize(Archive &ar, std::uint32_t const version) {
+    if (version == 0) {
+      ar(params, cost);
+    }
+  }
+};
+
+/**
+ * @brief The population of an island in the archipelago
+ */
+struct OptIslandState {
+  /**
+   * @brief The parameters of each individual in the population
+   */
+  std::vector<std::vector<double>> params;
+  /**
+   * @brief The fitness of each individual in the population
+   */
+  std::vector<double> fitness;
+  /**
+   * @brief The seed of the population
+   */
+  unsigned seed{0};
+  /**
+   * @brief The serialized algorithm of the island
+   *
+   * Includes the internal state of the algorithm, such as its random number
+   * generator, so that a resumed optimization continues in the same way as
+   * one that was not interrupted. If empty, the algorithm is re-seeded using
+   * the seed and the number of completed iterations.
+   */
+  std::string algorithm{};
+
+  template <class Archive>
+  void serialize(Archive &ar, std::uint32_t const version) {
+    if (version == 0) {
+      ar(params, fitness, seed);
+    } else if (version == 1) {
+      ar(params, fitness, seed, algorithm);
+    }
+  }
+};
+
+/**
+ * @brief The state required to resume an optimization
+ */
+struct OptimizationCheckpoint {
+  std::vector<OptIslandState> islands;
+  // the best fitness and parameters from each iteration
+  std::vector<double> bestFitness;
+  std::vector<std::vector<double>> bestParams;
+  std::size_t nIterations{0};
+  // number of fitness evaluations in the evaluation log
+  std::size_t nEvaluations{0};
+
+  template <class Archive>
+  void serialize(Archive &ar, std::uint32_t const version) {
+    if (version == 0) {
+      // the evaluations were stored in the checkpoint, and are not kept
+      std::vector<OptEvaluation> evaluations;
+      ar(islands, bestFitness, bestParams, nIterations, evaluations);
+    } else if (version == 1) {
+      ar(islands, bestFitness, bestParams, nIterations, nEvaluations);
+    }
+  }
+};
+
+std::unique_ptr<OptimizationCheckpoint>
+importOptimizationCheckpoint(const std::string &filename);
+bool exportOptimizationCheckpoint(const std::string &filename,
+                                  const OptimizationCheckpoint &checkpoint);
+
+/**
+ * @brief Append-only log of the fitness evaluations of an optimization
+ *
+ * Each evaluation is stored as a fixed size record of the parameter values
+ * followed by the cost, so appending an evaluation does not depend on the
+ * number of previous evaluations, and an existing log can be truncated to
+ * the evaluations that a checkpoint refers to.
+ */
+class OptEvaluationLog {
+private:
+  std::size_t nParams;
+  std::size_t nEvaluations{0};
+  // a temporary file that is removed with the log if no filename is given
+  std::unique_ptr<QFile> file;
+  mutable std::mutex fileMutex;
+
+public:
+  /**
+   * @brief Opens a new log, or an existing one
+   *
+   * @param[in] nParameters the number of parameters being optimized
+   * @param[in] filename the log file, or empty to use a temporary file
+   * @param[in] nExistingEvaluations if non-zero, the first
+   * ``nExistingEvaluations`` evaluations of an existing log are kept, and any
+   * later ones removed
+   */
+  explicit OptEvaluationLog(std::size_t nParameters,
+                            const std::string &filename = {},
+                            std::size_t nExistingEvaluations = 0);
+  OptEvaluationLog(const OptEvaluationLog &) = delete;
+  OptEvaluationLog &operator=(const OptEvaluationLog &) = delete;
+  ~OptEvaluationLog();
+  [[nodiscard]] bool isOpen() const;
+  [[nodiscard]] std::string getFilename() const;
+  [[nodiscard]] std::size_t size() const;
+  bool append(const OptEvaluation &evaluation);
+  [[nodiscard]] std::vector<OptEvaluation> read() const;
+};
+
+// the evaluation log that belongs to a checkpoint file
+std::string getOptEvaluationLogFilename(const std::string &checkpointFilename);
+
+} // namespace sme::simulate
+
+CEREAL_CLASS_VERSION(sme::simulate::OptEvaluation, 0);
+CEREAL_CLASS_VERSION(sme::simulate::OptIslandState, 1);
+CEREAL_CLASS_VERSION(sme::simulate::OptimizationCheckpoint, 1);
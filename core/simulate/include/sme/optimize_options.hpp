@@ -1,4 +1,5 @@
 #pragma once
+#include "sme/utils.hpp"
 #include <array>
 #include <cereal/cereal.hpp>
 #include <cereal/types/string.hpp>
@@ -123,6 +124,25 @@ struct OptCost {
          CEREAL_NVP(id), CEREAL_NVP(simulationTime), CEREAL_NVP(weight),
          CEREAL_NVP(compartmentIndex), CEREAL_NVP(speciesIndex),
          CEREAL_NVP(targetValues), CEREAL_NVP(epsilon));
+    } else if (version == 1) {
+      ar(CEREAL_NVP(optCostType), CEREAL_NVP(optCostDiffType), CEREAL_NVP(name),
+         CEREAL_NVP(id), CEREAL_NVP(simulationTime), CEREAL_NVP(weight),
+         CEREAL_NVP(compartmentIndex), CEREAL_NVP(speciesIndex));
+      if constexpr (cereal::traits::is_text_archive<Archive>::value) {
+        // an xml element for each value is slow to read and write, so the
+        // target values are stored as a single compressed binary string
+        std::string targetValuesBase64;
+        if constexpr (Archive::is_saving::value) {
+          targetValuesBase64 = common::vectorToCompressedBase64(targetValues);
+        }
+        ar(CEREAL_NVP(targetValuesBase64));
+        if constexpr (Archive::is_loading::value) {
+          targetValues = common::compressedBase64ToVector(targetValuesBase64);
+        }
+      } else {
+        ar(CEREAL_NVP(targetValues));
+      }
+      ar(CEREAL_NVP(epsilon));
     }
   }
 };
@@ -130,15 +150,15 @@ struct OptCost {
 /**
  * @brief Types of algorithms that can be used in optimization
  */
-enum class OptAlgorithmType { PSO, GPSO, DE, iDE, jDE, pDE, ABC, gaco };
+enum class OptAlgorithmType { PSO, GPSO, DE, iDE, jDE, pDE, ABC, gaco, LBFGS };
 
 /**
  * @brief An array of all algorithm types for iterating over
  */
-inline constexpr std::array<OptAlgorithmType, 8> optAlgorithmTypes{
-    OptAlgorithmType::PSO, OptAlgorithmType::GPSO, OptAlgorithmType::DE,
-    OptAlgorithmType::iDE, OptAlgorithmType::jDE,  OptAlgorithmType::pDE,
-    OptAlgorithmType::ABC, OptAlgorithmType::gaco};
+inline constexpr std::array<OptAlgorithmType, 9> optAlgorithmTypes{
+    OptAlgorithmType::PSO,  OptAlgorithmType::GPSO, OptAlgorithmType::DE,
+    OptAlgorithmType::iDE,  OptAlgorithmType::jDE,  OptAlgorithmType::pDE,
+    OptAlgorithmType::ABC,  OptAlgorithmType::gaco, OptAlgorithmType::LBFGS};
 
 /**
  * @brief Optimization algorithm options
@@ -182,18 +202,38 @@ struct OptimizeOptions {
    * @brief The costs to minimize
    */
   std::vector<OptCost> optCosts;
+  /**
+   * @brief The factor by which to coarsen the geometry to screen candidates
+   *
+   * If greater than one, each candidate is first simulated with the geometry
+   * image downsampled by this factor, and only promising candidates are then
+   * simulated at full resolution.
+   */
+  std::size_t coarseGeometryFactor{1};
+  /**
+   * @brief The threshold for simulating a candidate at full resolution
+   *
+   * A candidate is simulated at full resolution if its coarse cost, rescaled
+   * by the ratio of the number of voxels, is no more than this factor times
+   * the best full resolution cost so far. Values less than one are treated as
+   * one.
+   */
+  double screeningThreshold{2.0};
 
   template <class Archive>
   void serialize(Archive &ar, std::uint32_t const version) {
     if (version == 0) {
       ar(CEREAL_NVP(optAlgorithm), CEREAL_NVP(optParams), CEREAL_NVP(optCosts));
+    } else if (version == 1) {
+      ar(CEREAL_NVP(optAlgorithm), CEREAL_NVP(optParams), CEREAL_NVP(optCosts),
+         CEREAL_NVP(coarseGeometryFactor), CEREAL_NVP(screeningThreshold));
     }
   }
 };
 
 } // namespace sme::simulate
 
-CEREAL_CLASS_VERSION(sme::simulate::OptimizeOptions, 0);
-CEREAL_CLASS_VERSION(sme::simulate::OptCost, 0);
+CEREAL_CLASS_VERSION(sme::simulate::OptimizeOptions, 1);
+CEREAL_CLASS_VERSION(sme::simulate::OptCost, 1);
 CEREAL_CLASS_VERSION(sme::simulate::OptParam, 0);
 CEREAL_CLASS_VERSION(sme::simulate::OptAlgorithm, 0);
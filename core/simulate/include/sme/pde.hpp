@@ -5,6 +5,7 @@
 //  - also Jacobian of reaction terms for each species
 //  - factor to rescale species
 //  - factor to rescale reaction
+//  - optionally keeps some parameters as variables instead of inlining them
 // Reaction class
 //  - construct matrix of stoich coefficients and reaction terms as strings
 //  - along with a map of constants
@@ -35,6 +36,19 @@ struct PdeScaleFactors {
   double reaction{1.0};
 };
 
+// a parameter that remains a variable in the reaction terms, so that its
+// value can be changed after they have been compiled
+struct RuntimeParameter {
+  // id of the model parameter, or of the local reaction parameter
+  std::string id;
+  // id of the reaction for a local reaction parameter, otherwise empty
+  std::string reactionId;
+  // name of the variable that replaces this parameter in the reaction terms
+  std::string variable;
+  // value of the parameter in the model
+  double value;
+};
+
 class Pde {
 private:
   std::vector<std::string> rhs;
@@ -48,7 +62,8 @@ public:
       const PdeScaleFactors &pdeScaleFactors = {},
       const std::vector<std::string> &extraVariables = {},
       const std::vector<std::string> &relabelledExtraVariables = {},
-      const std::map<std::string, double, std::less<>> &substitutions = {});
+      const std::map<std::string, double, std::less<>> &substitutions = {},
+      const std::vector<RuntimeParameter> &runtimeParameters = {});
   [[nodiscard]] const std::vector<std::string> &getRHS() const;
   [[nodiscard]] const std::vector<std::vector<std::string>> &
   getJacobian() const;
@@ -58,6 +73,8 @@ class Reaction {
 private:
   // vector of speciesIDs
   std::vector<std::string> speciesIDs;
+  // vector of reactionIDs
+  std::vector<std::string> reactionIDs;
   // vector of reaction expressions as strings
   std::vector<std::string> expressions;
   // matrix M_ij of stoichiometric coefficients
@@ -73,6 +90,8 @@ public:
   [[nodiscard]] std::size_t size() const;
   [[nodiscard]] const std::vector<std::string> &getSpeciesIDs() const;
   [[nodiscard]] const std::string &
+  getReactionId(std::size_t reactionIndex) const;
+  [[nodiscard]] const std::string &
   getExpression(std::size_t reactionIndex) const;
   [[nodiscard]] double getMatrixElement(std::size_t speciesIndex,
                                         std::size_t reactionIndex) const;
@@ -82,6 +101,13 @@ public:
            const std::vector<std::string> &reactionIDs);
 };
 
+// the runtime parameters that apply to the given reaction: a local reaction
+// parameter takes precedence over a model parameter with the same id
+std::vector<const RuntimeParameter *>
+getReactionRuntimeParameters(const model::Model *doc,
+                             const std::string &reactionId,
+                             const std::vector<RuntimeParameter> &parameters);
+
 } // namespace simulate
 
 } // namespace sme
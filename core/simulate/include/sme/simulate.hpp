@@ -4,8 +4,10 @@
 
 #include "sme/image_stack.hpp"
 #include "sme/model_settings.hpp"
+#include "sme/simulate_checkpoint.hpp"
 #include "sme/simulate_data.hpp"
 #include "sme/simulate_options.hpp"
+#include <QElapsedTimer>
 #include <QImage>
 #include <QRgb>
 #include <QSize>
@@ -15,6 +17,7 @@
 #include <limits>
 #include <map>
 #include <memory>
+#include <optional>
 #include <queue>
 #include <string>
 #include <vector>
@@ -33,9 +36,11 @@ namespace simulate {
 
 class BaseSim;
 
-struct SimEvent {
-  double time;
-  std::vector<std::string> ids;
+struct ParameterOverride {
+  std::string id{};
+  // empty for a global parameter, otherwise the parent reaction id
+  std::string reactionId{};
+  double value{};
 };
 
 class Simulation {
@@ -57,13 +62,28 @@ private:
   std::atomic<bool> stopRequested{false};
   std::atomic<std::size_t> nCompletedTimesteps{0};
   std::queue<SimEvent> simEvents;
+  // time since the last time point, if resumed from a checkpoint that lies
+  // between two time points
+  double partialTimestep{0.0};
+  std::unique_ptr<CheckpointWriter> checkpointWriter;
+  double checkpointInterval{0.0};
+  QElapsedTimer checkpointTimer;
+  void init(const SimulationCheckpoint *checkpoint);
+  void initSimulator();
   void initModel();
   void initEvents();
   void applyNextEvent();
   void updateConcentrations(double t);
+  [[nodiscard]] SimulationState getState(double t) const;
+  void writeCheckpoint(double t);
+  // run the simulator, pausing to write any checkpoints that become due
+  std::size_t runSimulator(double startTime, double time, double timeout_ms,
+                           const std::function<bool()> &stopRunningCallback);
 
 public:
   explicit Simulation(model::Model &smeModel);
+  // resume a simulation of this model from a checkpoint
+  Simulation(model::Model &smeModel, const SimulationCheckpoint &checkpoint);
   ~Simulation();
 
   std::size_t doTimesteps(double time, std::size_t nSteps = 1,
@@ -71,7 +91,19 @@ public:
   std::size_t doMultipleTimesteps(
       const std::vector<std::pair<std::size_t, double>> &timesteps,
       double timeout_ms = -1.0,
-      const std::function<bool()> &stopRunningCallback = {});
+      const std::function<bool()> &stopRunningCallback = {},
+      const std::function<void()> &timepointCompletedCallback = {});
+  // apply the parameter values to the model and restart the simulation from
+  // the initial concentrations, re-using the existing simulator if possible.
+  // Returns true if the existing simulator was re-used
+  bool reset(const std::vector<ParameterOverride> &parameterOverrides = {});
+  // state required to resume the simulation from the last time point
+  [[nodiscard]] SimulationCheckpoint getCheckpoint() const;
+  // write a checkpoint to this file at most every interval_s seconds while
+  // simulating, including between time points, and at the end of each call
+  // to doMultipleTimesteps. An empty filename disables checkpoints. Returns
+  // false if the simulator does not support resuming from a checkpoint
+  bool setCheckpointFile(const std::string &filename, double interval_s);
   [[nodiscard]] const std::string &errorMessage() const;
   [[nodiscard]] const common::ImageStack &errorImages() const;
   [[nodiscard]] const std::vector<std::string> &getCompartmentIds() const;
@@ -94,6 +126,20 @@ public:
                                             std::size_t speciesIndex) const;
   [[nodiscard]] std::vector<double>
   getDcdtArray(std::size_t compartmentIndex, std::size_t speciesIndex) const;
+  // index of the parameter in the forward sensitivities, if available
+  [[nodiscard]] std::optional<std::size_t>
+  getSensitivityParameterIndex(const std::string &id,
+                               const std::string &reactionId = {}) const;
+  // d(conc)/d(parameter) at the last time point, same layout as getConcArray
+  [[nodiscard]] std::vector<double>
+  getConcSensitivityArray(std::size_t compartmentIndex,
+                          std::size_t speciesIndex,
+                          std::size_t parameterIndex) const;
+  // d(dcdt)/d(parameter), same layout as getDcdtArray
+  [[nodiscard]] std::vector<double>
+  getDcdtSensitivityArray(std::size_t compartmentIndex,
+                          std::size_t speciesIndex,
+                          std::size_t parameterIndex) const;
   [[nodiscard]] double getLowerOrderConc(std::size_t compartmentIndex,
                                          std::size_t speciesIndex,
                                          std::size_t pixelIndex) const;
@@ -109,6 +155,7 @@ public:
   [[nodiscard]] std::vector<std::vector<double>>
   getPyDcdts(std::size_t compartmentIndex) const;
   [[nodiscard]] std::size_t getNCompletedTimesteps() const;
+  [[nodiscard]] double getSimulatedTime() const;
   [[nodiscard]] const SimulationData &getSimulationData() const;
   [[nodiscard]] bool getIsRunning() const;
   [[nodiscard]] bool getIsStopping() const;
@@ -0,0 +1,91 @@
+// Simulation checkpoint
+//  - state required to resume a simulation
+//  - stored as two files:
+//     - filename: the current state, which is small and rewritten each time
+//     - filename.frames: append-only log of the completed time points
+
+#pragma once
+
+#include "sme/simulate_data.hpp"
+#include <cereal/cereal.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sme::simulate {
+
+struct SimEvent {
+  double time;
+  std::vector<std::string> ids;
+
+  template <class Archive>
+  void serialize(Archive &ar, std::uint32_t const version) {
+    if (version == 0) {
+      ar(time, ids);
+    }
+  }
+};
+
+// state of a simulation that is not contained in the simulation results
+struct SimulationState {
+  // current simulation time, which may lie between two time points
+  double time{0.0};
+  // concentrations at this time, in the same format as a frame of results
+  ConcentrationFrames::Frame concentration;
+  std::size_t concPadding{0};
+  // events that have not yet been applied
+  std::vector<SimEvent> events;
+  std::map<std::string, double, std::less<>> eventSubstitutions;
+  // simulator specific state, e.g. the current adaptive timestep
+  std::vector<double> integratorState;
+
+  template <class Archive>
+  void serialize(Archive &ar, std::uint32_t const version) {
+    if (version == 0) {
+      ar(time, concentration, concPadding, events, eventSubstitutions,
+         integratorState);
+    }
+  }
+};
+
+struct SimulationCheckpoint {
+  // simulation results so far, stored in the frame log
+  SimulationData data;
+  // stored in the checkpoint file
+  SimulationState state;
+};
+
+// writes checkpoints of a running simulation
+//  - the frames of each time point are only appended to the frame log once
+//  - the first write replaces any existing frame log with a new one
+class CheckpointWriter {
+private:
+  std::string filename;
+  // identifies the frame log that the checkpoint file refers to
+  std::uint64_t frameLogId;
+  // number of frames that have been written to the frame log
+  std::size_t nLoggedFrames{0};
+
+public:
+  explicit CheckpointWriter(std::string checkpointFilename);
+  [[nodiscard]] const std::string &getFilename() const;
+  // appends any new frames of data to the frame log, then replaces the
+  // checkpoint file with one that refers to them
+  bool write(const SimulationData &data, const SimulationState &state);
+};
+
+std::unique_ptr<SimulationCheckpoint>
+importCheckpoint(const std::string &filename);
+bool exportCheckpoint(const std::string &filename,
+                      const SimulationCheckpoint &checkpoint);
+
+} // namespace sme::simulate
+
+CEREAL_CLASS_VERSION(sme::simulate::SimEvent, 0);
+CEREAL_CLASS_VERSION(sme::simulate::SimulationState, 0);
@@ -5,16 +5,105 @@
 #include "sme/simulate_options.hpp"
 #include <cereal/cereal.hpp>
 #include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace sme::simulate {
 
+// time->compartment->(ix->species) concentrations
+//  - by default all frames are kept in memory
+//  - if a backing file is set, all but the most recent frames are compressed
+//    and appended to this file, and paged back in when they are accessed
+class ConcentrationFrames {
+public:
+  using Frame = std::vector<std::vector<double>>;
+
+private:
+  struct FrameLocation {
+    std::int64_t offset{0};
+    std::int64_t size{0};
+  };
+  class BackingFile;
+  // nullptr if the frame is only stored in the backing file
+  std::vector<std::shared_ptr<Frame>> frames;
+  std::vector<FrameLocation> locations;
+  std::shared_ptr<BackingFile> backingFile;
+  std::size_t maxFramesInMemory{1};
+  std::size_t maxCachedFrames{4};
+  // most recently used frames that have been paged in from the backing file
+  mutable std::list<std::pair<std::size_t, std::shared_ptr<const Frame>>>
+      cache;
+  mutable std::mutex mutex;
+  void writeOldFramesToBackingFile();
+  void readFrameIntoMemory(std::size_t i);
+  [[nodiscard]] std::shared_ptr<const Frame>
+  getFrameWithLock(std::size_t i) const;
+
+public:
+  ConcentrationFrames() = default;
+  ConcentrationFrames(std::initializer_list<Frame> initialFrames);
+  ConcentrationFrames(const ConcentrationFrames &other);
+  ConcentrationFrames(ConcentrationFrames &&other) noexcept;
+  ConcentrationFrames &operator=(const ConcentrationFrames &other);
+  ConcentrationFrames &operator=(ConcentrationFrames &&other) noexcept;
+  ~ConcentrationFrames();
+  // store frames in a temporary file with this filename followed by a unique
+  // suffix, keeping at most maxInMemory of the most recent frames in memory.
+  // An empty filename keeps all frames in memory
+  void setBackingFile(const std::string &filename, std::size_t maxInMemory = 1,
+                      std::size_t maxCached = 4);
+  [[nodiscard]] std::string getBackingFile() const;
+  [[nodiscard]] std::size_t size() const;
+  [[nodiscard]] bool empty() const;
+  void clear();
+  void reserve(std::size_t n);
+  void push_back(Frame frame);
+  Frame &emplace_back();
+  void pop_back();
+  // the most recent frame is always in memory
+  Frame &back();
+  [[nodiscard]] const Frame &back() const;
+  // shared ownership of a frame: safe to use while frames are being added
+  [[nodiscard]] std::shared_ptr<const Frame> getFrame(std::size_t i) const;
+  // returns a copy of the frame, use getFrame() to avoid copying
+  [[nodiscard]] Frame operator[](std::size_t i) const;
+  bool operator==(const ConcentrationFrames &other) const;
+
+  // same format as std::vector<Frame>, but writes/reads one frame at a time
+  template <class Archive> void save(Archive &ar) const {
+    const std::size_t n{size()};
+    ar(cereal::make_size_tag(static_cast<cereal::size_type>(n)));
+    for (std::size_t i = 0; i < n; ++i) {
+      ar(*getFrame(i));
+    }
+  }
+
+  template <class Archive> void load(Archive &ar) {
+    cereal::size_type n{0};
+    ar(cereal::make_size_tag(n));
+    clear();
+    reserve(static_cast<std::size_t>(n));
+    for (cereal::size_type i = 0; i < n; ++i) {
+      Frame frame;
+      ar(frame);
+      push_back(std::move(frame));
+    }
+  }
+};
+
 class SimulationData {
 public:
   std::vector<double> timePoints;
   // time->compartment->(ix->species)
-  std::vector<std::vector<std::vector<double>>> concentration;
+  ConcentrationFrames concentration;
   // time->compartment->species
   std::vector<std::vector<std::vector<AvgMinMax>>> avgMinMax;
   // time->compartment->species
@@ -45,7 +45,8 @@ struct DuneOptions {
   }
 };
 
-enum class PixelIntegratorType { RK101, RK212, RK323, RK435 };
+// IMEX: implicit diffusion, explicit reactions
+enum class PixelIntegratorType { RK101, RK212, RK323, RK435, IMEX };
 
 struct PixelIntegratorError {
   double abs{std::numeric_limits<double>::max()};
@@ -67,6 +68,21 @@ struct PixelOptions {
   std::size_t maxThreads{0};
   bool doCSE{true};
   unsigned optLevel{3};
+  // store species concentrations as one contiguous array per species
+  bool enableSoALayout{false};
+  // Strang splitting: reactions are integrated with the adaptive RK
+  // integrator, and each species diffuses with its own stable timestep.
+  // The splitting timestep follows the reaction error estimate, or with
+  // RK101 is the stable timestep of the slowest diffusing species, and is
+  // limited by maxTimestep
+  bool enableOperatorSplitting{false};
+  // optimization parameters & parameters changed by events are inputs to the
+  // compiled reaction terms instead of being inlined as constants, so that
+  // changing their values doesn't change the compiled code
+  bool enableRuntimeParameters{false};
+  // also integrate the forward sensitivities of the concentrations with
+  // respect to the runtime optimization parameters
+  bool enableSensitivities{false};
 
   template <class Archive>
   void serialize(Archive &ar, std::uint32_t const version) {
@@ -74,6 +90,28 @@ struct PixelOptions {
       ar(CEREAL_NVP(integrator), CEREAL_NVP(maxErr), CEREAL_NVP(maxTimestep),
          CEREAL_NVP(enableMultiThreading), CEREAL_NVP(maxThreads),
          CEREAL_NVP(doCSE), CEREAL_NVP(optLevel));
+    } else if (version == 1) {
+      ar(CEREAL_NVP(integrator), CEREAL_NVP(maxErr), CEREAL_NVP(maxTimestep),
+         CEREAL_NVP(enableMultiThreading), CEREAL_NVP(maxThreads),
+         CEREAL_NVP(doCSE), CEREAL_NVP(optLevel),
+         CEREAL_NVP(enableSoALayout));
+    } else if (version == 2) {
+      ar(CEREAL_NVP(integrator), CEREAL_NVP(maxErr), CEREAL_NVP(maxTimestep),
+         CEREAL_NVP(enableMultiThreading), CEREAL_NVP(maxThreads),
+         CEREAL_NVP(doCSE), CEREAL_NVP(optLevel),
+         CEREAL_NVP(enableSoALayout), CEREAL_NVP(enableOperatorSplitting));
+    } else if (version == 3) {
+      ar(CEREAL_NVP(integrator), CEREAL_NVP(maxErr), CEREAL_NVP(maxTimestep),
+         CEREAL_NVP(enableMultiThreading), CEREAL_NVP(maxThreads),
+         CEREAL_NVP(doCSE), CEREAL_NVP(optLevel),
+         CEREAL_NVP(enableSoALayout), CEREAL_NVP(enableOperatorSplitting),
+         CEREAL_NVP(enableRuntimeParameters));
+    } else if (version == 4) {
+      ar(CEREAL_NVP(integrator), CEREAL_NVP(maxErr), CEREAL_NVP(maxTimestep),
+         CEREAL_NVP(enableMultiThreading), CEREAL_NVP(maxThreads),
+         CEREAL_NVP(doCSE), CEREAL_NVP(optLevel),
+         CEREAL_NVP(enableSoALayout), CEREAL_NVP(enableOperatorSplitting),
+         CEREAL_NVP(enableRuntimeParameters), CEREAL_NVP(enableSensitivities));
     }
   }
 };
@@ -110,5 +148,5 @@ bool operator==(const AvgMinMax &lhs, const AvgMinMax &rhs);
 CEREAL_CLASS_VERSION(sme::simulate::Options, 0);
 CEREAL_CLASS_VERSION(sme::simulate::DuneOptions, 0);
 CEREAL_CLASS_VERSION(sme::simulate::PixelIntegratorError, 0);
-CEREAL_CLASS_VERSION(sme::simulate::PixelOptions, 0);
+CEREAL_CLASS_VERSION(sme::simulate::PixelOptions, 4);
 CEREAL_CLASS_VERSION(sme::simulate::AvgMinMax, 0);
@@ -1 +1,10 @@
 #include "basesim.hpp"
+
+namespace sme::simulate {
+
+std::vector<double> BaseSim::getIntegratorState() const { return {}; }
+
+void BaseSim::setIntegratorState(
+    [[maybe_unused]] const std::vector<double> &state) {}
+
+} // namespace sme::simulate
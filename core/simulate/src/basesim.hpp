@@ -4,6 +4,7 @@
 
 #include "sme/image_stack.hpp"
 #include <QImage>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -20,6 +21,14 @@ public:
   [[nodiscard]] virtual const std::string &errorMessage() const = 0;
   [[nodiscard]] virtual const common::ImageStack &errorImages() const = 0;
   virtual void setStopRequested(bool stop) = 0;
+  // total simulated time since the simulator was constructed or reset. It is
+  // updated after each internal timestep, so can be used to find how far a
+  // call to run() got before it was stopped
+  [[nodiscard]] virtual double getSimulatedTime() const = 0;
+  // integrator state that is not contained in the concentrations, required
+  // to resume a simulation from a checkpoint
+  [[nodiscard]] virtual std::vector<double> getIntegratorState() const;
+  virtual void setIntegratorState(const std::vector<double> &state);
 };
 
 } // namespace sme::simulate
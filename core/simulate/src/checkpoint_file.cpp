@@ -0,0 +1,34 @@
+#include "checkpoint_file.hpp"
+#include "sme/logger.hpp"
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace sme::simulate {
+
+bool writeFileViaTemporary(const std::string &filename,
+                           const std::function<void(std::ostream &)> &write) {
+  const std::string tmpFilename{filename + ".tmp"};
+  {
+    std::ofstream fs(tmpFilename, std::ios::binary);
+    if (!fs) {
+      return false;
+    }
+    write(fs);
+    fs.close();
+    if (!fs) {
+      return false;
+    }
+  }
+  // unlike std::rename, this also replaces an existing file on windows
+  std::error_code ec;
+  std::filesystem::rename(tmpFilename, filename, ec);
+  if (ec) {
+    SPDLOG_WARN("Failed to rename '{}' to '{}': {}", tmpFilename, filename,
+                ec.message());
+    return false;
+  }
+  return true;
+}
+
+} // namespace sme::simulate
@@ -0,0 +1,26 @@
+// Checkpoint file writing
+//  - writeFileViaTemporary: write a file without destroying the previous one
+//    if the write is interrupted
+
+#pragma once
+
+#include <functional>
+#include <ostream>
+#include <string>
+
+namespace sme::simulate {
+
+/**
+ * @brief Write a binary file via a temporary file
+ *
+ * The contents are first written to ``filename.tmp``, which then replaces any
+ * existing ``filename``.
+ *
+ * @param[in] filename the file to write
+ * @param[in] write the function that writes the contents to the stream
+ * @returns true if the file was successfully written
+ */
+bool writeFileViaTemporary(const std::string &filename,
+                           const std::function<void(std::ostream &)> &write);
+
+} // namespace sme::simulate
@@ -4,6 +4,7 @@
 #include "sme/geometry.hpp"
 #include "sme/logger.hpp"
 #include "sme/mesh.hpp"
+#include "sme/mesh3d.hpp"
 #include "sme/model.hpp"
 #include "sme/pde.hpp"
 #include "sme/simulate_options.hpp"
@@ -20,10 +21,10 @@
 
 namespace sme::simulate {
 
-static void addGrid(IniFile &ini) {
+static void addGrid(IniFile &ini, int dimension) {
   ini.addSection("grid");
   ini.addValue("path", "grid.msh");
-  ini.addValue("dimension", 2);
+  ini.addValue("dimension", dimension);
 }
 
 static void addModel(IniFile &ini) {
@@ -280,7 +281,8 @@ DuneConverter::DuneConverter(
     const model::Model &model,
     const std::map<std::string, double, std::less<>> &substitutions,
     bool forExternalUse, const QString &outputIniFile, int doublePrecision)
-    : mesh{model.getGeometry().getMesh()},
+    : ini{std::make_unique<IniFile>()}, mesh{model.getGeometry().getMesh()},
+      mesh3d{model.getGeometry().getMesh3d()},
       origin{model.getGeometry().getPhysicalOrigin()},
       voxelSize{model.getGeometry().getVoxelSize()},
       imageSize{model.getGeometry().getImages().volume()} {
@@ -297,8 +299,8 @@ DuneConverter::DuneConverter(
   auto filename{QString("%1.ini").arg(baseIniFile)};
   auto iniFilename{QDir(iniFileDir).filePath(filename)};
 
-  IniFile iniCommon;
-  addGrid(iniCommon);
+  auto &iniCommon{*ini};
+  addGrid(iniCommon, getDimension());
   addModel(iniCommon);
   addTimeStepping(iniCommon, model.getSimulationSettings().options.dune,
                   doublePrecision);
@@ -336,14 +338,12 @@ DuneConverter::DuneConverter(
     compartmentNames.push_back(compId.toStdString());
   }
 
-  iniFile = iniCommon.getText();
-
   if (forExternalUse) {
     // export ini files
     SPDLOG_TRACE("Exporting dune ini file: '{}'", iniFilename.toStdString());
     if (QFile f(iniFilename);
         f.open(QIODevice::ReadWrite | QIODevice::Truncate | QIODevice::Text)) {
-      f.write(iniFile.toUtf8());
+      f.write(getIniFile().toUtf8());
     } else {
       SPDLOG_ERROR("Failed to export ini file '{}'", iniFilename.toStdString());
     }
@@ -352,7 +352,8 @@ DuneConverter::DuneConverter(
     SPDLOG_TRACE("Exporting gmsh file: '{}'", gmshFilename.toStdString());
     if (QFile f(gmshFilename);
         f.open(QIODevice::ReadWrite | QIODevice::Truncate | QIODevice::Text)) {
-      f.write(mesh->getGMSH().toUtf8());
+      f.write(mesh3d != nullptr ? mesh3d->getGMSH().toUtf8()
+                                : mesh->getGMSH().toUtf8());
     } else {
       SPDLOG_ERROR("Failed to export gmsh file '{}'",
                    gmshFilename.toStdString());
@@ -360,10 +361,23 @@ DuneConverter::DuneConverter(
   }
 }
 
-QString DuneConverter::getIniFile() const { return iniFile; }
+DuneConverter::~DuneConverter() = default;
+
+QString DuneConverter::getIniFile() const { return ini->getText(); }
+
+std::vector<std::pair<std::string, std::string>>
+DuneConverter::getIniParameters() const {
+  return ini->getValues();
+}
+
+bool DuneConverter::empty() const { return ini->empty(); }
 
 const mesh::Mesh *DuneConverter::getMesh() const { return mesh; }
 
+const mesh::Mesh3d *DuneConverter::getMesh3d() const { return mesh3d; }
+
+int DuneConverter::getDimension() const { return mesh3d != nullptr ? 3 : 2; }
+
 const std::unordered_map<std::string, std::vector<double>> &
 DuneConverter::getConcentrations() const {
   return concentrations;
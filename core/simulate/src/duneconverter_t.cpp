@@ -3,6 +3,7 @@
 #include "model_test_utils.hpp"
 #include "sme/duneconverter.hpp"
 #include "sme/model.hpp"
+#include <algorithm>
 
 using namespace sme;
 using namespace sme::test;
@@ -40,6 +41,16 @@ TEST_CASE("DUNE: DuneConverter",
     REQUIRE(symEq(*line++, "reaction.jacobian.B.expression = 0.0001*A"));
     REQUIRE(symEq(*line++, "reaction.jacobian.C.expression = 0"));
     REQUIRE(symEq(*line++, "cross_diffusion.C.expression = 25"));
+    // same parameters are available without generating the ini text
+    auto params{dc.getIniParameters()};
+    REQUIRE(!dc.empty());
+    REQUIRE(params[0] == std::pair<std::string, std::string>{"grid.path",
+                                                             "grid.msh"});
+    REQUIRE(params[1] ==
+            std::pair<std::string, std::string>{"grid.dimension", "2"});
+    std::pair<std::string, std::string> compC{
+        "model.scalar_field.C.compartment", "comp"};
+    REQUIRE(std::ranges::find(params, compC) != params.cend());
   }
   SECTION("brusselator model") {
     auto s{getExampleModel(Mod::Brusselator)};
@@ -14,6 +14,7 @@
 #include <cstddef>
 #include <dune/functions/gridfunctions/gridviewfunction.hh>
 #include <memory>
+#include <span>
 #include <vector>
 
 namespace Dune {
@@ -22,12 +23,14 @@ template <typename F, int n> class FieldVector;
 
 namespace sme::simulate {
 
+// Note: refers to (but does not copy) the concentration array, which must
+// outlive this function
 template <typename Domain> class SmeGridFunction {
 public:
   SmeGridFunction(const common::VoxelF &physicalOrigin,
                   const common::VolumeF &voxelVolume,
                   const common::Volume &imageVolume,
-                  const std::vector<double> &concentration)
+                  std::span<const double> concentration)
       : origin{physicalOrigin}, voxel{voxelVolume}, vol{imageVolume},
         c(concentration) {
     SPDLOG_TRACE("  - {}x{} pixels", vol.width(), vol.height());
@@ -47,16 +50,24 @@ public:
     auto iy = std::clamp(
         static_cast<int>((globalPos[1] - origin.p.y()) / voxel.height()), 0,
         vol.height() - 1);
-    SPDLOG_TRACE("pixel ({},{})", ix, iy);
-    SPDLOG_TRACE("conc {}", c[static_cast<std::size_t>(ix + vol.width() * iy)]);
-    return c[static_cast<std::size_t>(ix + vol.width() * iy)];
+    std::size_t iz{0};
+    if constexpr (Domain::dimension == 3) {
+      iz = static_cast<std::size_t>(std::clamp(
+          static_cast<int>((globalPos[2] - origin.z) / voxel.depth()), 0,
+          static_cast<int>(vol.depth()) - 1));
+    }
+    auto i{static_cast<std::size_t>(ix + vol.width() * iy) +
+           static_cast<std::size_t>(vol.width() * vol.height()) * iz};
+    SPDLOG_TRACE("voxel ({},{},{})", ix, iy, iz);
+    SPDLOG_TRACE("conc {}", c[i]);
+    return c[i];
   }
 
 private:
   common::VoxelF origin;
   common::VolumeF voxel;
   common::Volume vol;
-  std::vector<double> c;
+  std::span<const double> c;
 };
 
 template <typename Grid, typename GridFunction>
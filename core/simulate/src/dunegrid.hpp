@@ -6,8 +6,10 @@
 #pragma once
 
 #include "sme/mesh.hpp"
+#include "sme/mesh3d.hpp"
 #include <array>
 #include <cstddef>
+#include <dune/common/fvector.hh>
 #include <dune/geometry/type.hh>
 #include <dune/grid/common/gridfactory.hh>
 #include <dune/grid/multidomaingrid/multidomaingrid.hh>
@@ -40,46 +42,64 @@ getOrCreateVertexIndex(std::size_t oldVertexIndex,
   return static_cast<unsigned int>(newVertexIndex);
 }
 
-template <typename HostGrid>
-void insertTriangle(const std::array<std::size_t, 3> &t,
-                    Dune::GridFactory<HostGrid> &factory,
-                    std::vector<int> &newVertexIndices, int &newVertexCount) {
-  factory.insertElement(
-      Dune::GeometryTypes::triangle,
-      {getOrCreateVertexIndex(t[0], newVertexIndices, newVertexCount),
-       getOrCreateVertexIndex(t[1], newVertexIndices, newVertexCount),
-       getOrCreateVertexIndex(t[2], newVertexIndices, newVertexCount)});
+// triangles for a 2d mesh, tetrahedra for a 3d mesh
+inline const auto &getElementIndices(const mesh::Mesh &mesh) {
+  return mesh.getTriangleIndices();
 }
 
-template <typename HostGrid>
+inline const auto &getElementIndices(const mesh::Mesh3d &mesh) {
+  return mesh.getTetrahedronIndices();
+}
+
+template <typename HostGrid, std::size_t nCorners>
+void insertElement(const std::array<std::size_t, nCorners> &e,
+                   Dune::GridFactory<HostGrid> &factory,
+                   std::vector<int> &newVertexIndices, int &newVertexCount) {
+  std::vector<unsigned int> corners;
+  corners.reserve(nCorners);
+  for (auto i : e) {
+    corners.push_back(
+        getOrCreateVertexIndex(i, newVertexIndices, newVertexCount));
+  }
+  factory.insertElement(Dune::GeometryTypes::simplex(nCorners - 1), corners);
+}
+
+template <typename HostGrid, typename Mesh>
 std::pair<std::vector<std::size_t>, std::shared_ptr<HostGrid>>
-makeHostGrid(const mesh::Mesh &mesh) {
+makeHostGrid(const Mesh &mesh) {
+  constexpr std::size_t dim{static_cast<std::size_t>(HostGrid::dimension)};
   Dune::GridFactory<HostGrid> factory;
   // get original vertices
   auto v = mesh.getVerticesAsFlatArray();
   // map old to new vertex index (-1 means vertex is unused)
-  std::vector<int> newVertexIndices(v.size() / 2, -1);
+  std::vector<int> newVertexIndices(v.size() / dim, -1);
   int newVertexCount{0};
   std::vector<std::size_t> numElements;
-  // add triangles from each compartment
-  for (const auto &triangles : mesh.getTriangleIndices()) {
-    numElements.push_back(triangles.size());
-    for (const auto &triangle : triangles) {
-      insertTriangle(triangle, factory, newVertexIndices, newVertexCount);
+  // add elements from each compartment
+  for (const auto &compartmentElements : getElementIndices(mesh)) {
+    numElements.push_back(compartmentElements.size());
+    for (const auto &element : compartmentElements) {
+      insertElement(element, factory, newVertexIndices, newVertexCount);
     }
   }
   // add vertices
   std::vector<double> newFlatVertices(
-      2 * static_cast<std::size_t>(newVertexCount), 0.0);
+      dim * static_cast<std::size_t>(newVertexCount), 0.0);
   for (std::size_t iOld = 0; iOld < newVertexIndices.size(); ++iOld) {
     auto iNew{newVertexIndices[iOld]};
     if (iNew >= 0) {
-      newFlatVertices[2 * static_cast<std::size_t>(iNew)] = v[2 * iOld];
-      newFlatVertices[2 * static_cast<std::size_t>(iNew) + 1] = v[2 * iOld + 1];
+      for (std::size_t d = 0; d < dim; ++d) {
+        newFlatVertices[dim * static_cast<std::size_t>(iNew) + d] =
+            v[dim * iOld + d];
+      }
     }
   }
-  for (std::size_t i = 0; i < newFlatVertices.size() / 2; ++i) {
-    factory.insertVertex({newFlatVertices[2 * i], newFlatVertices[2 * i + 1]});
+  for (std::size_t i = 0; i < newFlatVertices.size() / dim; ++i) {
+    Dune::FieldVector<double, HostGrid::dimension> vertex;
+    for (std::size_t d = 0; d < dim; ++d) {
+      vertex[static_cast<int>(d)] = newFlatVertices[dim * i + d];
+    }
+    factory.insertVertex(vertex);
   }
   return {numElements, factory.createGrid()};
 }
@@ -117,8 +137,8 @@ void assignElements(Grid &grid, const std::vector<std::size_t> &numElements) {
 
 } // namespace detail
 
-template <class HostGrid, class MDGTraits>
-auto makeDuneGrid(const mesh::Mesh &mesh) {
+template <class HostGrid, class MDGTraits, class Mesh>
+auto makeDuneGrid(const Mesh &mesh) {
   auto [numElements, hostGrid] = detail::makeHostGrid<HostGrid>(mesh);
   auto grid =
       detail::makeGrid<HostGrid, MDGTraits>(*hostGrid, numElements.size());
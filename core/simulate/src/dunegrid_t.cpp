@@ -3,6 +3,7 @@
 #include "dunegrid.hpp"
 #include "model_test_utils.hpp"
 #include "sme/duneconverter.hpp"
+#include "sme/mesh3d.hpp"
 #include "sme/model.hpp"
 #include <QFile>
 #include <locale>
@@ -74,3 +75,39 @@ TEST_CASE("DUNE: grid",
     }
   }
 }
+
+TEST_CASE("DUNE: 3d grid",
+          "[core/simulate/dunegrid][core/simulate][core][dunegrid][3d]") {
+  using HostGrid3d = Dune::UGGrid<3>;
+  using MDGTraits3d = Dune::mdgrid::DynamicSubDomainCountTraits<3, 1>;
+  auto m{getExampleModel(Mod::SingleCompartmentDiffusion3D)};
+  m.getGeometry().ensureMesh3d();
+  const auto *mesh3d{m.getGeometry().getMesh3d()};
+  REQUIRE(mesh3d != nullptr);
+  REQUIRE(mesh3d->isValid());
+  auto [grid, hostGrid] =
+      simulate::makeDuneGrid<HostGrid3d, MDGTraits3d>(*mesh3d);
+  REQUIRE(grid->maxSubDomainIndex() == 1);
+  // all tetrahedra are assigned to the compartment, with the same volume
+  double meshVolume{0};
+  const auto &tets{mesh3d->getTetrahedronIndices()[0]};
+  auto v{mesh3d->getVerticesAsFlatArray()};
+  for (const auto &t : tets) {
+    auto p{[&v, &t](std::size_t i, std::size_t j) {
+      return v[3 * t[i] + j] - v[3 * t[0] + j];
+    }};
+    meshVolume += (p(1, 0) * (p(2, 1) * p(3, 2) - p(2, 2) * p(3, 1)) -
+                   p(1, 1) * (p(2, 0) * p(3, 2) - p(2, 2) * p(3, 0)) +
+                   p(1, 2) * (p(2, 0) * p(3, 1) - p(2, 1) * p(3, 0))) /
+                  6.0;
+  }
+  double gridVolume{0};
+  std::size_t nElements{0};
+  for (const auto &e : elements(grid->subDomain(0).leafGridView())) {
+    REQUIRE(e.geometry().type().isTetrahedron());
+    gridVolume += e.geometry().volume();
+    ++nElements;
+  }
+  REQUIRE(nElements == tets.size());
+  REQUIRE(gridVolume == dbl_approx(meshVolume));
+}
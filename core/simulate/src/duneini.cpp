@@ -3,13 +3,46 @@
 
 namespace sme::simulate {
 
-const QString &IniFile::getText() const { return text; }
+QString IniFile::getText() const {
+  QString text;
+  std::size_t iValue{0};
+  auto appendValues{[&text, &iValue, this](std::size_t end) {
+    for (; iValue < end; ++iValue) {
+      const auto &[var, value] = values[iValue];
+      text.append(QString("%1 = %2\n").arg(var, value));
+    }
+  }};
+  for (const auto &[name, firstValue] : sections) {
+    appendValues(firstValue);
+    if (!text.isEmpty()) {
+      text.append("\n");
+    }
+    text.append(QString("[%1]\n").arg(name));
+  }
+  appendValues(values.size());
+  return text;
+}
 
-void IniFile::addSection(const QString &str) {
-  if (!text.isEmpty()) {
-    text.append("\n");
+std::vector<std::pair<std::string, std::string>> IniFile::getValues() const {
+  std::vector<std::pair<std::string, std::string>> keyValues;
+  keyValues.reserve(values.size());
+  std::string prefix;
+  auto iSection{sections.cbegin()};
+  for (std::size_t iValue = 0; iValue < values.size(); ++iValue) {
+    while (iSection != sections.cend() && iSection->second == iValue) {
+      prefix = iSection->first.toStdString() + ".";
+      ++iSection;
+    }
+    keyValues.emplace_back(prefix + values[iValue].first.toStdString(),
+                           values[iValue].second.toStdString());
   }
-  text.append(QString("[%1]\n").arg(str));
+  return keyValues;
+}
+
+bool IniFile::empty() const { return sections.empty() && values.empty(); }
+
+void IniFile::addSection(const QString &str) {
+  sections.emplace_back(str, values.size());
 }
 
 void IniFile::addSection(const QString &str1, const QString &str2) {
@@ -40,7 +73,7 @@ void IniFile::addSection(const QString &str1, const QString &str2,
 }
 
 void IniFile::addValue(const QString &var, const QString &value) {
-  text.append(QString("%1 = %2\n").arg(var, value));
+  values.emplace_back(var, value);
 }
 
 void IniFile::addValue(const QString &var, int value) {
@@ -51,6 +84,9 @@ void IniFile::addValue(const QString &var, double value, int precision) {
   addValue(var, common::dblToQStr(value, precision));
 }
 
-void IniFile::clear() { text.clear(); }
+void IniFile::clear() {
+  sections.clear();
+  values.clear();
+}
 
 } // namespace sme::simulate
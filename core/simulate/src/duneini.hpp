@@ -1,9 +1,14 @@
 // DUNE-copasi ini file generation
 //  - iniFile class: simple ini file generation one line at a time
+//  - the values are stored, and only converted to ini text when requested
 
 #pragma once
 
 #include <QString>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace sme {
 
@@ -11,10 +16,21 @@ namespace simulate {
 
 class IniFile {
 private:
-  QString text;
+  // each section name, and the index of its first value
+  std::vector<std::pair<QString, std::size_t>> sections;
+  std::vector<std::pair<QString, QString>> values;
 
 public:
-  [[nodiscard]] const QString &getText() const;
+  [[nodiscard]] QString getText() const;
+  /**
+   * @brief The values as (key, value) pairs
+   *
+   * Each key includes the name of its section, e.g. ``model.order``, as
+   * expected by Dune::ParameterTree.
+   */
+  [[nodiscard]] std::vector<std::pair<std::string, std::string>>
+  getValues() const;
+  [[nodiscard]] bool empty() const;
   void addSection(const QString &str);
   void addSection(const QString &str1, const QString &str2);
   void addSection(const QString &str1, const QString &str2,
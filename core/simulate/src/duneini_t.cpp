@@ -42,4 +42,27 @@ TEST_CASE("DUNE: ini files",
     correct = "[a.b.c]\n";
     REQUIRE(ini.getText() == correct);
   }
+  SECTION("values with section prefix") {
+    simulate::IniFile ini;
+    REQUIRE(ini.empty());
+    REQUIRE(ini.getValues().empty());
+    ini.addSection("t1");
+    ini.addValue("x", "a");
+    ini.addValue("y", 3);
+    // empty section
+    ini.addSection("t2");
+    ini.addSection("t2", "t3");
+    ini.addValue("z.w", 0.5, 10);
+    REQUIRE(!ini.empty());
+    auto values{ini.getValues()};
+    REQUIRE(values.size() == 3);
+    REQUIRE(values[0].first == "t1.x");
+    REQUIRE(values[0].second == "a");
+    REQUIRE(values[1].first == "t1.y");
+    REQUIRE(values[1].second == "3");
+    REQUIRE(values[2].first == "t2.t3.z.w");
+    REQUIRE(values[2].second == "0.5");
+    REQUIRE(ini.getText() ==
+            "[t1]\nx = a\ny = 3\n\n[t2]\n\n[t2.t3]\nz.w = 0.5\n");
+  }
 }
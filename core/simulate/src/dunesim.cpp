@@ -11,17 +11,16 @@
 #include "sme/model_geometry.hpp"
 #include "sme/utils.hpp"
 #include <QElapsedTimer>
-#include <QFile>
-#include <QImage>
-#include <QPainter>
 #include <algorithm>
+#include <array>
 #include <numeric>
-
-using QTriangleF = std::array<QPointF, 3>;
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/parallel_for.h>
 
 namespace sme::simulate {
 
 void DuneSim::initDuneSimCompartments(
+    const DuneConverter &dc,
     const std::vector<std::unique_ptr<geometry::Compartment>> &comps) {
   duneCompartments.clear();
   std::size_t compIndex{0};
@@ -31,7 +30,11 @@ void DuneSim::initDuneSimCompartments(
     auto imgVolume{comp->getCompartmentImages().volume()};
     auto nPixels{comp->getVoxels().size()};
     SPDLOG_INFO("  - {} pixels", nPixels);
-    const auto &speciesNames{pDuneImpl->speciesNames[comp->getId()]};
+    std::vector<std::string> speciesNames;
+    if (auto iter{dc.getSpeciesNames().find(comp->getId())};
+        iter != dc.getSpeciesNames().cend()) {
+      speciesNames = iter->second;
+    }
     std::size_t nNonConstantSpecies{0};
     for (const auto &speciesName : speciesNames) {
       if (!speciesName.empty()) {
@@ -50,33 +53,54 @@ void DuneSim::initDuneSimCompartments(
          comp.get(),
          {},
          {},
+         {},
+         {},
          std::vector<double>(nPixels * nNonConstantSpecies, 0.0)});
     ++compIndex;
   }
 }
 
-static std::pair<QPoint, QPoint> getBoundingBox(const QTriangleF &t,
-                                                const QSizeF &pixelSize,
-                                                const QPointF &pixelOrigin) {
-  // get triangle bounding box in physical units
-  QPointF fmin(t[0].x(), t[0].y());
-  QPointF fmax = fmin;
-  for (std::size_t i = 1; i < 3; ++i) {
-    fmin.setX(std::min(fmin.x(), t[i].x()));
-    fmax.setX(std::max(fmax.x(), t[i].x()));
-    fmin.setY(std::min(fmin.y(), t[i].y()));
-    fmax.setY(std::max(fmax.y(), t[i].y()));
+// convert a physical point to (non-integer) voxel units
+template <int DuneDimensions>
+static std::array<double, 3>
+toVoxelUnits(const Dune::FieldVector<double, DuneDimensions> &point,
+             const common::VolumeF &voxelSize,
+             const common::VoxelF &physicalOrigin) {
+  std::array<double, 3> v{(point[0] - physicalOrigin.p.x()) / voxelSize.width(),
+                          (point[1] - physicalOrigin.p.y()) /
+                              voxelSize.height(),
+                          0.0};
+  if constexpr (DuneDimensions == 3) {
+    v[2] = (point[2] - physicalOrigin.z) / voxelSize.depth();
+  }
+  return v;
+}
+
+template <typename Geometry>
+static std::pair<common::Voxel, common::Voxel>
+getBoundingBox(const Geometry &geo, const common::VolumeF &voxelSize,
+               const common::VoxelF &physicalOrigin,
+               const common::Volume &imageSize) {
+  // get element bounding box in voxel units
+  auto vMin{toVoxelUnits(geo.corner(0), voxelSize, physicalOrigin)};
+  auto vMax{vMin};
+  for (int i = 1; i < geo.corners(); ++i) {
+    auto v{toVoxelUnits(geo.corner(i), voxelSize, physicalOrigin)};
+    for (std::size_t d = 0; d < 3; ++d) {
+      vMin[d] = std::min(vMin[d], v[d]);
+      vMax[d] = std::max(vMax[d], v[d]);
+    }
   }
-  // convert physical points to pixel locations
-  fmin -= pixelOrigin;
-  fmin.rx() /= pixelSize.width();
-  fmin.ry() /= pixelSize.height();
-  fmax -= pixelOrigin;
-  fmax.rx() /= pixelSize.width();
-  fmax.ry() /= pixelSize.height();
-  return std::make_pair<QPoint, QPoint>(
-      QPoint(static_cast<int>(fmin.x()), static_cast<int>(fmin.y())),
-      QPoint(static_cast<int>(fmax.x()), static_cast<int>(fmax.y())));
+  // convert to voxel locations, clamped to the image
+  std::array<int, 3> imax{imageSize.width() - 1, imageSize.height() - 1,
+                          static_cast<int>(imageSize.depth()) - 1};
+  auto toVoxel{[&imax](const std::array<double, 3> &v) {
+    return common::Voxel{std::clamp(static_cast<int>(v[0]), 0, imax[0]),
+                         std::clamp(static_cast<int>(v[1]), 0, imax[1]),
+                         static_cast<std::size_t>(
+                             std::clamp(static_cast<int>(v[2]), 0, imax[2]))};
+  }};
+  return {toVoxel(vMin), toVoxel(vMax)};
 }
 
 static std::size_t getIxValidNeighbour(std::size_t ix,
@@ -87,7 +111,8 @@ static std::size_t getIxValidNeighbour(std::size_t ix,
   // return nearest neighbour if valid, otherwise add to queue
   for (std::size_t iter = 0; iter < 10 * ixValid.size(); ++iter) {
     std::size_t i = queue[queueIndex];
-    for (auto iy : {g->up_x(i), g->dn_x(i), g->up_y(i), g->dn_y(i)}) {
+    for (auto iy : {g->up_x(i), g->dn_x(i), g->up_y(i), g->dn_y(i), g->up_z(i),
+                    g->dn_z(i)}) {
       if (ixValid[iy]) {
         return iy;
       } else {
@@ -100,47 +125,81 @@ static std::size_t getIxValidNeighbour(std::size_t ix,
   return 0;
 }
 
-void DuneSim::updatePixels() {
-  SPDLOG_TRACE("pixel size: {}x{}", pixelSize.width(), pixelSize.height());
+template <int DuneDimensions>
+void DuneSim::updatePixels(const DuneImpl<DuneDimensions> &duneImpl) {
+  SPDLOG_TRACE("voxel size: {}x{}x{}", voxelSize.width(), voxelSize.height(),
+               voxelSize.depth());
+  constexpr int vertexCodim{DuneDimensions};
+  constexpr std::size_t nCorners{DuneDimensions + 1};
   for (auto &comp : duneCompartments) {
-    comp.pixels.clear();
-    comp.missingPixels.clear();
     SPDLOG_TRACE("compartment[{}]: {}", comp.index, comp.name);
     const auto &gridview{
-        pDuneImpl->grid->subDomain(static_cast<int>(comp.index))
-            .leafGridView()};
+        duneImpl.grid->subDomain(static_cast<int>(comp.index)).leafGridView()};
+    const auto &indexSet{gridview.indexSet()};
     const auto &qpi{comp.voxelIndexer};
+    comp.vertices.assign(indexSet.size(vertexCodim), {0.0, 0.0, 0.0});
+    comp.vertexConcentration.assign(comp.vertices.size() * comp.nSpecies,
+                                    0.0);
+    comp.pixelVertexIndices.assign(nCorners * qpi.size(), 0);
+    comp.pixelVertexWeights.assign(nCorners * qpi.size(), 0.0);
     std::vector<bool> ixAssigned(qpi.size(), false);
-    // get local coord for each pixel in each triangle
+    // get P1 basis function weights for each pixel in each simplex
     for (const auto e : elements(gridview)) {
-      auto &pixelsTriangle = comp.pixels.emplace_back();
       const auto &geo = e.geometry();
-      assert(geo.type().isTriangle());
+      assert(geo.type().isSimplex());
       auto ref = Dune::referenceElement(geo);
-      QPointF c0(geo.corner(0)[0], geo.corner(0)[1]);
-      QPointF c1(geo.corner(1)[0], geo.corner(1)[1]);
-      QPointF c2(geo.corner(2)[0], geo.corner(2)[1]);
-      auto [pMin, pMax] =
-          getBoundingBox({{c0, c1, c2}}, pixelSize, pixelOrigin);
-      SPDLOG_TRACE("  - bounding box ({},{}) - ({},{})", pMin.x(), pMin.y(),
-                   pMax.x(), pMax.y());
-      for (int x = pMin.x(); x < pMax.x() + 1; ++x) {
-        for (int y = pMin.y(); y < pMax.y() + 1; ++y) {
-          auto localPoint = e.geometry().local(
-              {(static_cast<double>(x) + 0.5) * pixelSize.width() +
-                   pixelOrigin.x(),
-               (static_cast<double>(y) + 0.5) * pixelSize.height() +
-                   pixelOrigin.y()});
-          // note: qpi/QImage has (0,0) in top-left corner:
-          common::Voxel vox{x, geometryImageSize.height() - 1 - y, 0};
-          if (auto ix{qpi.getIndex(vox)};
-              ix.has_value() && ref.checkInside(localPoint)) {
-            pixelsTriangle.push_back({*ix, {localPoint[0], localPoint[1]}});
-            ixAssigned[*ix] = true;
+      std::array<std::size_t, nCorners> vertexIndices{};
+      for (std::size_t i = 0; i < nCorners; ++i) {
+        auto iCorner{static_cast<int>(i)};
+        vertexIndices[i] = static_cast<std::size_t>(
+            indexSet.subIndex(e, iCorner, vertexCodim));
+        const auto &corner{geo.corner(iCorner)};
+        auto &vertex{comp.vertices[vertexIndices[i]]};
+        for (int d = 0; d < DuneDimensions; ++d) {
+          vertex[static_cast<std::size_t>(d)] = corner[d];
+        }
+      }
+      auto [vMin, vMax] =
+          getBoundingBox(geo, voxelSize, physicalOrigin, imageSize);
+      SPDLOG_TRACE("  - bounding box ({},{},{}) - ({},{},{})", vMin.p.x(),
+                   vMin.p.y(), vMin.z, vMax.p.x(), vMax.p.y(), vMax.z);
+      for (std::size_t z = vMin.z; z < vMax.z + 1; ++z) {
+        for (int x = vMin.p.x(); x < vMax.p.x() + 1; ++x) {
+          for (int y = vMin.p.y(); y < vMax.p.y() + 1; ++y) {
+            Dune::FieldVector<double, DuneDimensions> globalPoint;
+            globalPoint[0] =
+                (static_cast<double>(x) + 0.5) * voxelSize.width() +
+                physicalOrigin.p.x();
+            globalPoint[1] =
+                (static_cast<double>(y) + 0.5) * voxelSize.height() +
+                physicalOrigin.p.y();
+            if constexpr (DuneDimensions == 3) {
+              globalPoint[2] =
+                  (static_cast<double>(z) + 0.5) * voxelSize.depth() +
+                  physicalOrigin.z;
+            }
+            auto localPoint = geo.local(globalPoint);
+            // note: qpi/QImage has (0,0) in top-left corner:
+            common::Voxel vox{x, imageSize.height() - 1 - y, z};
+            if (auto ix{qpi.getIndex(vox)};
+                ix.has_value() && !ixAssigned[*ix] &&
+                ref.checkInside(localPoint)) {
+              // P1 basis functions on the reference simplex
+              auto *indices{&comp.pixelVertexIndices[nCorners * (*ix)]};
+              auto *weights{&comp.pixelVertexWeights[nCorners * (*ix)]};
+              weights[0] = 1.0;
+              for (std::size_t i = 0; i < nCorners; ++i) {
+                indices[i] = vertexIndices[i];
+              }
+              for (int d = 0; d < DuneDimensions; ++d) {
+                weights[0] -= localPoint[d];
+                weights[d + 1] = localPoint[d];
+              }
+              ixAssigned[*ix] = true;
+            }
           }
         }
       }
-      SPDLOG_TRACE("    - found {} pixels", pixelsTriangle.size());
     }
     // Deal with pixels that fell outside of mesh (either in a membrane, or
     // where the mesh boundary differs a little from the pixel boundary).
@@ -148,23 +207,29 @@ void DuneSim::updatePixels() {
     // compartment which does lie inside a triangle
     for (std::size_t ix = 0; ix < ixAssigned.size(); ++ix) {
       if (!ixAssigned[ix]) {
-        SPDLOG_DEBUG("pixel {} not in a triangle", ix);
+        SPDLOG_DEBUG("pixel {} not in an element", ix);
         // find a neighbouring valid pixel
         auto ixNeighbour = getIxValidNeighbour(ix, ixAssigned, comp.geometry);
         SPDLOG_DEBUG("  -> using concentration from pixel {}", ixNeighbour);
-        comp.missingPixels.push_back({ix, ixNeighbour});
+        for (std::size_t i = 0; i < nCorners; ++i) {
+          comp.pixelVertexIndices[nCorners * ix + i] =
+              comp.pixelVertexIndices[nCorners * ixNeighbour + i];
+          comp.pixelVertexWeights[nCorners * ix + i] =
+              comp.pixelVertexWeights[nCorners * ixNeighbour + i];
+        }
       }
     }
+    SPDLOG_TRACE("  - {} vertices, {} pixels", comp.vertices.size(),
+                 qpi.size());
   }
 }
 
 DuneSim::DuneSim(
     const model::Model &sbmlDoc, const std::vector<std::string> &compartmentIds,
     const std::map<std::string, double, std::less<>> &substitutions)
-    : geometryImageSize{sbmlDoc.getGeometry().getImages()[0].size()},
-      pixelSize(sbmlDoc.getGeometry().getVoxelSize().width(),
-                sbmlDoc.getGeometry().getVoxelSize().height()),
-      pixelOrigin{sbmlDoc.getGeometry().getPhysicalOrigin().p} {
+    : imageSize{sbmlDoc.getGeometry().getImages().volume()},
+      voxelSize{sbmlDoc.getGeometry().getVoxelSize()},
+      physicalOrigin{sbmlDoc.getGeometry().getPhysicalOrigin()} {
   try {
     const auto &lengthUnit{sbmlDoc.getUnits().getLength()};
     const auto &volumeUnit{sbmlDoc.getUnits().getVolume()};
@@ -180,20 +245,26 @@ DuneSim::DuneSim(
       SPDLOG_ERROR("Invalid integrator type requested");
       throw std::runtime_error("Invalid integrator type requested");
     }
-    if (dc.getIniFile().isEmpty()) {
+    if (dc.empty()) {
       currentErrorMessage = "Nothing to simulate";
       SPDLOG_WARN("{}", currentErrorMessage);
       return;
     }
-    pDuneImpl = std::make_unique<DuneImpl>(dc, options);
-    pDuneImpl->setInitial(dc);
     std::vector<const geometry::Compartment *> comps;
     for (const auto &compartmentId : compartmentIds) {
       comps.push_back(
           sbmlDoc.getCompartments().getCompartment(compartmentId.c_str()));
     }
-    initDuneSimCompartments(sbmlDoc.getCompartments().getCompartments());
-    updatePixels();
+    initDuneSimCompartments(dc, sbmlDoc.getCompartments().getCompartments());
+    if (dc.getDimension() == 3) {
+      pDuneImpl3d = std::make_unique<DuneImpl<3>>(dc, options);
+      pDuneImpl3d->setInitial(dc);
+      updatePixels(*pDuneImpl3d);
+    } else {
+      pDuneImpl2d = std::make_unique<DuneImpl<2>>(dc, options);
+      pDuneImpl2d->setInitial(dc);
+      updatePixels(*pDuneImpl2d);
+    }
     updateSpeciesConcentrations();
   } catch (const Dune::Exception &e) {
     currentErrorMessage = e.what();
@@ -208,28 +279,40 @@ DuneSim::~DuneSim() = default;
 
 std::size_t DuneSim::run(double time, double timeout_ms,
                          const std::function<bool()> &stopRunningCallback) {
-  if (pDuneImpl == nullptr) {
+  if (pDuneImpl2d == nullptr && pDuneImpl3d == nullptr) {
     return 0;
   }
   QElapsedTimer timer;
   timer.start();
+  std::size_t steps{0};
+  currentErrorMessage.clear();
+  // called after each internal DUNE timestep: returns true to stop early
+  auto stopRunning{[&](double t) {
+    simulatedTime.store(t);
+    ++steps;
+    if (stopRunningCallback && stopRunningCallback()) {
+      SPDLOG_DEBUG("Simulation cancelled: requesting stop");
+      currentErrorMessage = "Simulation cancelled";
+    } else if (timeout_ms >= 0.0 &&
+               static_cast<double>(timer.elapsed()) >= timeout_ms) {
+      SPDLOG_DEBUG("Simulation timeout: requesting stop");
+      currentErrorMessage = "Simulation timeout";
+    } else if (stopRequested.load()) {
+      SPDLOG_DEBUG("Simulation stopped early");
+      currentErrorMessage = "Simulation stopped early";
+    }
+    return !currentErrorMessage.empty();
+  }};
   try {
-    pDuneImpl->run(time);
-    updateSpeciesConcentrations();
-    currentErrorMessage.clear();
+    if (pDuneImpl3d != nullptr ? pDuneImpl3d->run(time, stopRunning)
+                               : pDuneImpl2d->run(time, stopRunning)) {
+      updateSpeciesConcentrations();
+    }
   } catch (const Dune::Exception &e) {
     currentErrorMessage = e.what();
     SPDLOG_ERROR("{}", currentErrorMessage);
   }
-  if (stopRunningCallback && stopRunningCallback()) {
-    SPDLOG_DEBUG("Simulation cancelled: requesting stop");
-    currentErrorMessage = "Simulation cancelled";
-  }
-  if (timeout_ms >= 0.0 && static_cast<double>(timer.elapsed()) >= timeout_ms) {
-    SPDLOG_DEBUG("Simulation timeout: requesting stop");
-    currentErrorMessage = "Simulation timeout";
-  }
-  return 1;
+  return steps;
 }
 
 const std::vector<double> &
@@ -245,53 +328,109 @@ const common::ImageStack &DuneSim::errorImages() const {
   return currentErrorImages;
 }
 
-void DuneSim::setStopRequested([[maybe_unused]] bool stop) {
-  SPDLOG_DEBUG("Not implemented - ignoring request");
+void DuneSim::setStopRequested(bool stop) { stopRequested.store(stop); }
+
+double DuneSim::getSimulatedTime() const { return simulatedTime.load(); }
+
+void DuneSim::setIntegratorState(
+    [[maybe_unused]] const std::vector<double> &state) {
+  // the DUNE solution is not restored from the sampled concentrations, so
+  // resuming would silently restart from the initial conditions
+  currentErrorMessage =
+      "Resuming from a checkpoint is not supported by the DUNE simulator";
+  SPDLOG_WARN("{}", currentErrorMessage);
+}
+
+bool DuneSim::reset(
+    const model::Model &sbmlDoc,
+    const std::map<std::string, double, std::less<>> &substitutions) {
+  if (pDuneImpl2d == nullptr && pDuneImpl3d == nullptr) {
+    return false;
+  }
+  auto resetImpl = [&](auto &duneImpl) {
+    simulate::DuneConverter dc(sbmlDoc, substitutions, false);
+    if (dc.getDimension() != duneImpl.dimension ||
+        dc.getSpeciesNames() != duneImpl.speciesNames) {
+      return false;
+    }
+    duneImpl.reset(dc, sbmlDoc.getSimulationSettings().options.dune);
+    duneImpl.setInitial(dc);
+    return true;
+  };
+  try {
+    if (!(pDuneImpl3d != nullptr ? resetImpl(*pDuneImpl3d)
+                                 : resetImpl(*pDuneImpl2d))) {
+      return false;
+    }
+  } catch (const Dune::Exception &e) {
+    SPDLOG_WARN("Failed to reset DUNE simulator: {}", e.what());
+    return false;
+  } catch (const std::runtime_error &e) {
+    SPDLOG_WARN("Failed to reset DUNE simulator: {}", e.what());
+    return false;
+  }
+  currentErrorMessage.clear();
+  stopRequested.store(false);
+  simulatedTime.store(0.0);
+  updateSpeciesConcentrations();
+  return true;
 }
 
 void DuneSim::updateSpeciesConcentrations() {
+  if (pDuneImpl3d != nullptr) {
+    updateSpeciesConcentrations(*pDuneImpl3d);
+  } else if (pDuneImpl2d != nullptr) {
+    updateSpeciesConcentrations(*pDuneImpl2d);
+  }
+}
+
+template <int DuneDimensions>
+void DuneSim::updateSpeciesConcentrations(DuneImpl<DuneDimensions> &duneImpl) {
+  constexpr std::size_t nCorners{DuneDimensions + 1};
   for (auto &comp : duneCompartments) {
     SPDLOG_TRACE("compartment {} [{}]", comp.name, comp.index);
-    pDuneImpl->updateGridFunctions(comp.name);
-    const auto &gridview{
-        pDuneImpl->grid->subDomain(static_cast<int>(comp.index))
-            .leafGridView()};
-    std::size_t iTriangle{0};
-    for (const auto e : elements(gridview)) {
-      SPDLOG_TRACE("triangle {} ({})", iTriangle,
-                   common::decltypeStr<decltype(e)>());
-      for (const auto &[ix, point] : comp.pixels[iTriangle]) {
-        // evaluate DUNE grid function at this pixel location
-        // convert pixel->global->local
-        Dune::FieldVector<double, 2> localPoint = {point[0], point[1]};
-        SPDLOG_TRACE("  - pixel ({}) -> -> local ({},{})", ix, localPoint[0],
-                     localPoint[1]);
-        std::size_t iSpecies{0};
-        for (const auto &speciesName : comp.speciesNames) {
-          if (!speciesName.empty()) {
-            SPDLOG_TRACE("    - species[{}] '{}'", iSpecies, speciesName);
-            double result{
-                pDuneImpl->evaluateGridFunction(speciesName, e, localPoint)};
-            // convert result from Amount / Length^3 to Amount / Volume
-            result *= volOverL3;
-            SPDLOG_TRACE("      - species[{}] '{}' = {}", iSpecies, speciesName,
-                         result);
-            // replace negative values with zero
-            comp.concentration[ix * comp.nSpecies + iSpecies] =
-                result < 0 ? 0 : result;
-            ++iSpecies;
+    if (comp.vertices.empty() || comp.nSpecies == 0) {
+      continue;
+    }
+    duneImpl.updateGridFunctions(comp.name);
+    // the P1 solution is determined by its values at the mesh vertices, so
+    // these are the only points where the grid functions are evaluated
+    std::size_t iSpecies{0};
+    for (const auto &speciesName : comp.speciesNames) {
+      if (!speciesName.empty()) {
+        SPDLOG_TRACE("  - species[{}] '{}'", iSpecies, speciesName);
+        for (std::size_t iv = 0; iv < comp.vertices.size(); ++iv) {
+          Dune::FieldVector<double, DuneDimensions> vertex;
+          for (int d = 0; d < DuneDimensions; ++d) {
+            vertex[d] = comp.vertices[iv][static_cast<std::size_t>(d)];
           }
+          // convert result from Amount / Length^3 to Amount / Volume
+          comp.vertexConcentration[iv * comp.nSpecies + iSpecies] =
+              volOverL3 * duneImpl.evaluateGridFunction(speciesName, vertex);
         }
-      }
-      ++iTriangle;
-    }
-    // fill in missing pixels with neighbouring value
-    for (const auto &[ixMissing, ixNeighbour] : comp.missingPixels) {
-      for (std::size_t iSpecies = 0; iSpecies < comp.nSpecies; ++iSpecies) {
-        comp.concentration[ixMissing * comp.nSpecies + iSpecies] =
-            comp.concentration[ixNeighbour * comp.nSpecies + iSpecies];
+        ++iSpecies;
       }
     }
+    // interpolate from vertices to pixels for all species at once
+    oneapi::tbb::parallel_for(
+        oneapi::tbb::blocked_range<std::size_t>(0, comp.voxelIndexer.size()),
+        [&comp](const oneapi::tbb::blocked_range<std::size_t> &r) {
+          const auto nSpecies{comp.nSpecies};
+          for (std::size_t ix = r.begin(); ix != r.end(); ++ix) {
+            const auto *indices{&comp.pixelVertexIndices[nCorners * ix]};
+            const auto *weights{&comp.pixelVertexWeights[nCorners * ix]};
+            for (std::size_t is = 0; is < nSpecies; ++is) {
+              double result{0};
+              for (std::size_t i = 0; i < nCorners; ++i) {
+                result += weights[i] *
+                          comp.vertexConcentration[indices[i] * nSpecies + is];
+              }
+              // replace negative values with zero
+              comp.concentration[ix * nSpecies + is] =
+                  result < 0 ? 0 : result;
+            }
+          }
+        });
   }
 }
 
@@ -7,9 +7,9 @@
 #include "sme/image_stack.hpp"
 #include "sme/simulate_options.hpp"
 #include "sme/utils.hpp"
-#include <QPointF>
-#include <QSize>
+#include "sme/voxel.hpp"
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <limits>
 #include <map>
@@ -18,10 +18,6 @@
 #include <utility>
 #include <vector>
 
-namespace dune {
-class DuneConverter;
-}
-
 namespace sme {
 
 namespace model {
@@ -34,9 +30,8 @@ class Compartment;
 
 namespace simulate {
 
-using PixelLocalPair = std::pair<std::size_t, std::array<double, 2>>;
-
-class DuneImpl;
+class DuneConverter;
+template <int DuneDimensions> class DuneImpl;
 
 struct DuneSimCompartment {
   std::string name;
@@ -45,28 +40,41 @@ struct DuneSimCompartment {
   std::vector<std::string> speciesNames;
   geometry::VoxelIndexer voxelIndexer;
   const geometry::Compartment *geometry;
-  // pixels+dune local coords for each triangle
-  std::vector<std::vector<PixelLocalPair>> pixels;
-  // index of nearest valid pixel for any missing pixels
-  std::vector<std::pair<std::size_t, std::size_t>> missingPixels;
+  // location of each mesh vertex in this compartment (z=0 for a 2d mesh)
+  std::vector<std::array<double, 3>> vertices;
+  // sparse matrix of P1 basis function weights that maps vertex values to
+  // pixel values, with one row per pixel and dimension+1 non-zeros per row:
+  // the vertices of the triangle or tetrahedron that contains the pixel (or
+  // the nearest valid pixel for any pixels that lie outside of the mesh)
+  std::vector<std::size_t> pixelVertexIndices;
+  std::vector<double> pixelVertexWeights;
+  std::vector<double> vertexConcentration;
   std::vector<double> concentration;
 };
 
 class DuneSim : public BaseSim {
 private:
-  std::unique_ptr<DuneImpl> pDuneImpl;
+  // only one of these is used, depending on the dimension of the mesh
+  std::unique_ptr<DuneImpl<2>> pDuneImpl2d;
+  std::unique_ptr<DuneImpl<3>> pDuneImpl3d;
   std::vector<DuneSimCompartment> duneCompartments;
   // dimensions of model
-  QSize geometryImageSize;
-  QSizeF pixelSize;
-  QPointF pixelOrigin;
+  common::Volume imageSize;
+  common::VolumeF voxelSize;
+  common::VoxelF physicalOrigin;
   void initDuneSimCompartments(
+      const DuneConverter &dc,
       const std::vector<std::unique_ptr<geometry::Compartment>> &comps);
-  void updatePixels();
+  template <int DuneDimensions>
+  void updatePixels(const DuneImpl<DuneDimensions> &duneImpl);
+  template <int DuneDimensions>
+  void updateSpeciesConcentrations(DuneImpl<DuneDimensions> &duneImpl);
   void updateSpeciesConcentrations();
   std::string currentErrorMessage{};
   common::ImageStack currentErrorImages{};
   double volOverL3;
+  std::atomic<bool> stopRequested{false};
+  std::atomic<double> simulatedTime{0.0};
 
 public:
   explicit DuneSim(
@@ -82,6 +90,25 @@ public:
   [[nodiscard]] const std::string &errorMessage() const override;
   [[nodiscard]] const common::ImageStack &errorImages() const override;
   void setStopRequested(bool stop) override;
+  /**
+   * @brief The current simulated time
+   *
+   * Updated after every internal DUNE timestep, so can be polled from another
+   * thread to report the progress of a call to run().
+   */
+  [[nodiscard]] double getSimulatedTime() const override;
+  void setIntegratorState(const std::vector<double> &state) override;
+  /**
+   * @brief Restart the simulation from the initial conditions of the model
+   *
+   * The existing grid and pixel interpolation weights are re-used, and only
+   * the DUNE model and its state are re-created, so the geometry and mesh of
+   * the model must not have changed since this simulator was constructed.
+   *
+   * @returns false if the simulator could not be reset in place
+   */
+  bool reset(const model::Model &sbmlDoc,
+             const std::map<std::string, double, std::less<>> &substitutions);
 };
 
 } // namespace simulate
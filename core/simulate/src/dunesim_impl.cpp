@@ -9,7 +9,14 @@
 
 namespace sme::simulate {
 
-DuneImpl::DuneImpl(const DuneConverter &dc, const DuneOptions &options)
+namespace {
+// thrown from the stepper callback to stop the integration early
+struct DuneRunStopped {};
+} // namespace
+
+template <int DuneDimensions>
+DuneImpl<DuneDimensions>::DuneImpl(const DuneConverter &dc,
+                                   const DuneOptions &options)
     : speciesNames{dc.getSpeciesNames()} {
   if (SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG) {
     // for debug GUI builds enable verbose DUNE logging
@@ -18,9 +25,33 @@ DuneImpl::DuneImpl(const DuneConverter &dc, const DuneOptions &options)
     // for release GUI builds disable DUNE logging
     spdlog::set_level(spdlog::level::off);
   }
-  std::stringstream ssIni(dc.getIniFile().toStdString());
-  Dune::ParameterTreeParser::readINITree(ssIni, config);
-  std::tie(grid, hostGrid) = makeDuneGrid<HostGrid, MDGTraits>(*dc.getMesh());
+  if constexpr (DuneDimensions == 2) {
+    std::tie(grid, hostGrid) =
+        makeDuneGrid<HostGrid, MDGTraits>(*dc.getMesh());
+  } else {
+    std::tie(grid, hostGrid) =
+        makeDuneGrid<HostGrid, MDGTraits>(*dc.getMesh3d());
+  }
+  initModel(dc, options);
+}
+
+template <int DuneDimensions>
+void DuneImpl<DuneDimensions>::reset(const DuneConverter &dc,
+                                     const DuneOptions &options) {
+  speciesNames = dc.getSpeciesNames();
+  gridFunctions.clear();
+  initModel(dc, options);
+}
+
+template <int DuneDimensions>
+void DuneImpl<DuneDimensions>::initModel(const DuneConverter &dc,
+                                         const DuneOptions &options) {
+  // construct parameters directly, no need to generate & parse ini text
+  config = {};
+  for (const auto &[key, value] : dc.getIniParameters()) {
+    config[key] = value;
+  }
+  vtkFilename.clear();
   if (options.writeVTKfiles) {
     vtkFilename = "vtk";
   }
@@ -34,22 +65,25 @@ DuneImpl::DuneImpl(const DuneConverter &dc, const DuneOptions &options)
           parser_type, std::move(parser_context));
   SPDLOG_INFO("model");
   model = Dune::Copasi::make_model<Model>(config.sub("model"), functor_factory);
+  t0 = 0.0;
   dt = options.dt;
   SPDLOG_INFO("state");
   state = model->make_state(grid, config.sub("model"));
   SPDLOG_INFO("stepper");
-  stepper = std::make_unique<
-      Dune::Copasi::SimpleAdaptiveStepper<Model::State, double, double>>(
+  stepper = std::make_unique<Dune::Copasi::SimpleAdaptiveStepper<
+      typename Model::State, double, double>>(
       options.decrease, options.increase, options.minDt, options.maxDt);
   SPDLOG_INFO("step_operator");
   step_operator = model->make_step_operator(*state, config.sub("model"));
   SPDLOG_INFO("done");
 }
 
-void DuneImpl::setInitial(const DuneConverter &dc) {
+template <int DuneDimensions>
+void DuneImpl<DuneDimensions>::setInitial(const DuneConverter &dc) {
   SPDLOG_INFO("Initial condition functions:");
   auto initialConditionFunctions{
-      makeModelDuneFunctions<Model::Grid, Model::GridFunction>(dc, *grid)};
+      makeModelDuneFunctions<typename Model::Grid,
+                             typename Model::GridFunction>(dc, *grid)};
   for (const auto &[k, v] : initialConditionFunctions) {
     SPDLOG_INFO("  - {}", k);
   }
@@ -57,15 +91,36 @@ void DuneImpl::setInitial(const DuneConverter &dc) {
   SPDLOG_INFO("end of interpolate");
 }
 
-void DuneImpl::run(double time) {
-  stepper->evolve(*step_operator, *state, *state, dt, t0 + time).or_throw();
+template <int DuneDimensions>
+bool DuneImpl<DuneDimensions>::run(
+    double time, const std::function<bool(double)> &stopRunning) {
+  const double tEnd{t0 + time};
+  bool completed{true};
+  try {
+    stepper
+        ->evolve(*step_operator, *state, *state, dt, tEnd,
+                 [&stopRunning](const typename Model::State &s) {
+                   SPDLOG_TRACE("t = {}", s.time);
+                   if (stopRunning && stopRunning(s.time)) {
+                     throw DuneRunStopped{};
+                   }
+                 })
+        .or_throw();
+  } catch (const DuneRunStopped &) {
+    SPDLOG_DEBUG("Stopped at t = {} before reaching t = {}", state->time,
+                 tEnd);
+    completed = false;
+  }
   if (!vtkFilename.empty()) {
     model->write_vtk(*state, vtkFilename, true);
   }
-  t0 += time;
+  t0 = completed ? tEnd : static_cast<double>(state->time);
+  return completed;
 }
 
-void DuneImpl::updateGridFunctions(const std::string &compartmentName) {
+template <int DuneDimensions>
+void DuneImpl<DuneDimensions>::updateGridFunctions(
+    const std::string &compartmentName) {
   // get grid function for each species in this compartment
   gridFunctions.clear();
   for (const auto &speciesName : speciesNames[compartmentName]) {
@@ -77,10 +132,14 @@ void DuneImpl::updateGridFunctions(const std::string &compartmentName) {
   }
 }
 
-[[nodiscard]] double DuneImpl::evaluateGridFunction(
-    const std::string &speciesName, const Elem &e,
-    const Dune::FieldVector<double, 2> &localPoint) const {
-  return gridFunctions.at(speciesName)(e.geometry().global(localPoint));
+template <int DuneDimensions>
+double DuneImpl<DuneDimensions>::evaluateGridFunction(
+    const std::string &speciesName,
+    const Dune::FieldVector<double, DuneDimensions> &globalPoint) const {
+  return gridFunctions.at(speciesName)(globalPoint);
 }
 
+template class DuneImpl<2>;
+template class DuneImpl<3>;
+
 } // namespace sme::simulate
@@ -3,50 +3,71 @@
 #pragma once
 
 #include "dune_headers.hpp"
+#include <functional>
 
 namespace sme::simulate {
 
 struct DuneOptions;
 class DuneConverter;
 
-class DuneImpl {
+template <int DuneDimensions> class DuneImpl {
 public:
-  static constexpr int DuneDimensions = 2;
+  static constexpr int dimension{DuneDimensions};
   using HostGrid = Dune::UGGrid<DuneDimensions>;
   using MDGTraits =
       Dune::mdgrid::DynamicSubDomainCountTraits<DuneDimensions, 10>;
   using Grid = Dune::mdgrid::MultiDomainGrid<HostGrid, MDGTraits>;
-  using GridView = Grid::LeafGridView;
-  using SubGrid = Grid::SubDomainGrid;
-  using SubGridView = SubGrid::LeafGridView;
+  using GridView = typename Grid::LeafGridView;
+  using SubGrid = typename Grid::SubDomainGrid;
+  using SubGridView = typename SubGrid::LeafGridView;
   using Elem = decltype(*(elements(std::declval<SubGridView>()).begin()));
   using Model =
-      Dune::Copasi::Model<Grid, Grid::SubDomainGrid::Traits::LeafGridView,
+      Dune::Copasi::Model<Grid,
+                          typename Grid::SubDomainGrid::Traits::LeafGridView,
                           double, double>;
   Dune::ParameterTree config;
   std::shared_ptr<Grid> grid;
   std::unordered_map<std::string, std::vector<std::string>> speciesNames;
   std::shared_ptr<Model> model;
-  std::shared_ptr<Model::State> state;
-  std::unordered_map<std::string, Model::GridFunction> gridFunctions;
-  std::unique_ptr<
-      Dune::Copasi::SimpleAdaptiveStepper<Model::State, double, double>>
+  std::shared_ptr<typename Model::State> state;
+  std::unordered_map<std::string, typename Model::GridFunction> gridFunctions;
+  std::unique_ptr<Dune::Copasi::SimpleAdaptiveStepper<typename Model::State,
+                                                      double, double>>
       stepper;
-  std::unique_ptr<Dune::PDELab::OneStep<Model::State>> step_operator;
+  std::unique_ptr<Dune::PDELab::OneStep<typename Model::State>> step_operator;
   double t0{0.0};
   double dt{1e-3};
   std::string vtkFilename{};
   explicit DuneImpl(const DuneConverter &dc, const DuneOptions &options);
   ~DuneImpl() = default;
+  /**
+   * @brief Re-create the model and its state on the existing grid
+   *
+   * Used when only the parameters of the model have changed: the grid is
+   * re-used, and the state must then be set with setInitial().
+   */
+  void reset(const DuneConverter &dc, const DuneOptions &options);
   void setInitial(const DuneConverter &dc);
-  void run(double time);
+  /**
+   * @brief Integrate the model forwards in time
+   *
+   * After each internal timestep ``stopRunning`` is called with the current
+   * simulated time, and if it returns true the integration is stopped early.
+   *
+   * @returns true if the simulation reached the requested time
+   */
+  bool run(double time, const std::function<bool(double)> &stopRunning = {});
   void updateGridFunctions(const std::string &compartmentName);
-  [[nodiscard]] double
-  evaluateGridFunction(const std::string &speciesName, const Elem &e,
-                       const Dune::FieldVector<double, 2> &localPoint) const;
+  [[nodiscard]] double evaluateGridFunction(
+      const std::string &speciesName,
+      const Dune::FieldVector<double, DuneDimensions> &globalPoint) const;
 
 private:
   std::shared_ptr<HostGrid> hostGrid;
+  void initModel(const DuneConverter &dc, const DuneOptions &options);
 };
 
+extern template class DuneImpl<2>;
+extern template class DuneImpl<3>;
+
 } // namespace sme::simulate
@@ -2,6 +2,8 @@
 #include "dunesim.hpp"
 #include "model_test_utils.hpp"
 #include "sme/model.hpp"
+#include <algorithm>
+#include <cmath>
 
 using namespace sme;
 using namespace sme::test;
@@ -89,6 +91,52 @@ TEST_CASE("DuneSim", "[core/simulate/dunesim][core/"
     REQUIRE(duneSim.errorMessage().empty());
     duneSim.run(1, -1, []() { return true; });
     REQUIRE(duneSim.errorMessage() == "Simulation cancelled");
+    // stopped after the first internal timestep
+    REQUIRE(duneSim.getSimulatedTime() > 0.0);
+    REQUIRE(duneSim.getSimulatedTime() < 1.0);
+  }
+  SECTION("Stop requested and timeout interrupt a run") {
+    auto m{getExampleModel(Mod::ABtoC)};
+    std::vector<std::string> comps{"comp"};
+    simulate::DuneSim duneSim(m, comps);
+    REQUIRE(duneSim.errorMessage().empty());
+    REQUIRE(duneSim.getSimulatedTime() == dbl_approx(0.0));
+    duneSim.setStopRequested(true);
+    REQUIRE(duneSim.run(100, -1, {}) == 1);
+    REQUIRE(duneSim.errorMessage() == "Simulation stopped early");
+    double t{duneSim.getSimulatedTime()};
+    REQUIRE(t < 100.0);
+    // continues from where it stopped
+    duneSim.setStopRequested(false);
+    REQUIRE(duneSim.run(0.01, -1, {}) > 0);
+    REQUIRE(duneSim.errorMessage().empty());
+    REQUIRE(duneSim.getSimulatedTime() == dbl_approx(t + 0.01));
+    // zero timeout: stops after the first internal timestep
+    REQUIRE(duneSim.run(100, 0, {}) == 1);
+    REQUIRE(duneSim.errorMessage() == "Simulation timeout");
+    REQUIRE(duneSim.getSimulatedTime() < t + 100.0);
+  }
+  SECTION("Linear concentration is interpolated to pixels") {
+    auto m{getExampleModel(Mod::ABtoC)};
+    m.getSpecies().setAnalyticConcentration("A", "x");
+    std::vector<std::string> comps{"comp"};
+    simulate::DuneSim duneSim(m, comps);
+    REQUIRE(duneSim.errorMessage().empty());
+    const auto &voxels{
+        m.getCompartments().getCompartment("comp")->getVoxels()};
+    const auto &conc{duneSim.getConcentrations(0)};
+    REQUIRE(conc.size() == 3 * voxels.size());
+    const double width{m.getGeometry().getVoxelSize().width()};
+    const double x0{m.getGeometry().getPhysicalOrigin().p.x()};
+    double maxDiff{0};
+    for (std::size_t ix = 0; ix < voxels.size(); ++ix) {
+      double x{x0 + (static_cast<double>(voxels[ix].p.x()) + 0.5) * width};
+      maxDiff = std::max(maxDiff, std::abs(conc[3 * ix] - x));
+    }
+    // only differs from the exact value by the pixel sampling of the
+    // initial concentration, or for pixels that lie outside the mesh
+    CAPTURE(maxDiff);
+    REQUIRE(maxDiff < 3.0 * width);
   }
   SECTION("Species are mapped to the correct initial concentrations") {
     // https://github.com/spatial-model-editor/spatial-model-editor/issues/852
@@ -3,6 +3,9 @@
 #include "sme/logger.hpp"
 #include "sme/model.hpp"
 #include "sme/utils.hpp"
+#include <algorithm>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <iostream>
 #include <pagmo/algorithms/bee_colony.hpp>
 #include <pagmo/algorithms/de.hpp>
@@ -11,6 +14,7 @@
 #include <pagmo/algorithms/pso.hpp>
 #include <pagmo/algorithms/pso_gen.hpp>
 #include <pagmo/algorithms/sade.hpp>
+#include <sstream>
 #include <utility>
 
 namespace sme::simulate {
@@ -73,6 +77,34 @@ getOptTimesteps(const OptimizeOptions &options) {
   return optTimesteps;
 }
 
+static void setCoarseGeometry(OptConstData &optConstData) {
+  const auto factor{optConstData.optimizeOptions.coarseGeometryFactor};
+  sme::model::Model coarseModel;
+  coarseModel.importSBMLString(optConstData.xmlModel);
+  if (!coarsenGeometry(coarseModel, factor)) {
+    SPDLOG_WARN("Geometry can't be coarsened by a factor of {}: candidates "
+                "will not be screened",
+                factor);
+    return;
+  }
+  const auto &coarseSize{coarseModel.getGeometry().getImages().volume()};
+  optConstData.coarseXmlModel = coarseModel.getXml().toStdString();
+  optConstData.coarseCostScale =
+      static_cast<double>(optConstData.imageSize.nVoxels()) /
+      static_cast<double>(coarseSize.nVoxels());
+  optConstData.coarseOptCosts = optConstData.optimizeOptions.optCosts;
+  for (auto &optCost : optConstData.coarseOptCosts) {
+    // target values with the wrong size are left unchanged, so that they
+    // are reported by calculateCosts
+    if (optCost.targetValues.size() == optConstData.imageSize.nVoxels()) {
+      optCost.targetValues = downsampleArray(
+          optCost.targetValues, optConstData.imageSize, coarseSize);
+    }
+  }
+  SPDLOG_INFO("Screening candidates with a {}x{}x{} geometry",
+              coarseSize.width(), coarseSize.height(), coarseSize.depth());
+}
+
 static std::unique_ptr<pagmo::algorithm>
 getPagmoAlgorithm(sme::simulate::OptAlgorithmType optAlgorithmType) {
   // https://esa.github.io/pagmo2/docs/cpp/cpp_docs.html#implemented-algorithms
@@ -94,11 +126,69 @@ getPagmoAlgorithm(sme::simulate::OptAlgorithmType optAlgorithmType) {
     return std::make_unique<pagmo::algorithm>(pagmo::bee_colony());
   case gaco:
     return std::make_unique<pagmo::algorithm>(pagmo::gaco(1, 7));
+  case LBFGS:
+    return std::make_unique<pagmo::algorithm>(PagmoLBFGS());
   default:
     return std::make_unique<pagmo::algorithm>(pagmo::pso());
   }
 }
 
+// the algorithm, including its internal state, as a string of bytes
+static std::string serializeAlgorithm(const pagmo::algorithm &algorithm) {
+  std::ostringstream ss;
+  try {
+    boost::archive::binary_oarchive ar(ss);
+    ar << algorithm;
+  } catch (const std::exception &e) {
+    SPDLOG_WARN("Failed to serialize algorithm '{}': {}", algorithm.get_name(),
+                e.what());
+    return {};
+  }
+  return ss.str();
+}
+
+static std::optional<pagmo::algorithm>
+deserializeAlgorithm(const std::string &bytes) {
+  if (bytes.empty()) {
+    return {};
+  }
+  std::istringstream ss(bytes);
+  pagmo::algorithm algorithm;
+  try {
+    boost::archive::binary_iarchive ar(ss);
+    ar >> algorithm;
+  } catch (const std::exception &e) {
+    SPDLOG_WARN("Failed to deserialize algorithm: {}", e.what());
+    return {};
+  }
+  return algorithm;
+}
+
+static std::unique_ptr<pagmo::archipelago>
+resumeArchipelago(const OptimizationCheckpoint &checkpoint,
+                  const pagmo::algorithm &algorithm,
+                  const pagmo::problem &problem) {
+  auto archipelago{std::make_unique<pagmo::archipelago>()};
+  for (const auto &island : checkpoint.islands) {
+    pagmo::population pop(problem, 0u, island.seed);
+    for (std::size_t i = 0; i < island.params.size(); ++i) {
+      pop.push_back(island.params[i], {island.fitness[i]});
+    }
+    auto algo{deserializeAlgorithm(island.algorithm)};
+    if (!algo.has_value() || algo->get_name() != algorithm.get_name()) {
+      algo = algorithm;
+      if (algo->has_set_seed()) {
+        // the state of the algorithm isn't available: use a new seed for
+        // each resumed iteration
+        algo->set_seed(island.seed +
+                       static_cast<unsigned>(checkpoint.nIterations));
+      }
+    }
+    archipelago->push_back(std::move(*algo), std::move(pop));
+  }
+  return archipelago;
+}
+
 std::size_t Optimization::finalizeEvolve(const std::string &newErrorMessage) {
   if (!newErrorMessage.empty()) {
     errorMessage = newErrorMessage;
@@ -111,7 +201,21 @@ std::size_t Optimization::finalizeEvolve(const std::string &newErrorMessage) {
   return nIterations;
 }
 
-Optimization::Optimization(sme::model::Model &model) {
+void Optimization::updateCostCeiling() {
+  double ceiling{std::numeric_limits<double>::lowest()};
+  for (const auto &island : *archi) {
+    for (const auto &f : island.get_population().get_f()) {
+      ceiling = std::max(ceiling, f[0]);
+    }
+  }
+  if (ceiling == std::numeric_limits<double>::lowest()) {
+    ceiling = std::numeric_limits<double>::max();
+  }
+  SPDLOG_INFO("Cost ceiling: {}", ceiling);
+  costCeiling.store(ceiling);
+}
+
+void Optimization::init(sme::model::Model &model) {
   const auto &options{model.getOptimizeOptions()};
   if (options.optAlgorithm.population < 2) {
     errorMessage = "Invalid optimization population size, can't be less than 2";
@@ -133,8 +237,10 @@ Optimization::Optimization(sme::model::Model &model) {
           sme::common::max(cost.targetValues));
     }
   }
-  modelQueue = std::make_unique<
-      oneapi::tbb::concurrent_queue<std::shared_ptr<sme::model::Model>>>();
+  if (options.coarseGeometryFactor > 1) {
+    setCoarseGeometry(*optConstData);
+  }
+  modelQueue = std::make_unique<ThreadsafeModelQueue>();
   algo = getPagmoAlgorithm(
       optConstData->optimizeOptions.optAlgorithm.optAlgorithmType);
 
@@ -145,12 +251,59 @@ Optimization::Optimization(sme::model::Model &model) {
   // needed
   for (std::size_t i = 0;
        i < optConstData->optimizeOptions.optAlgorithm.islands; ++i) {
-    auto m{std::make_shared<sme::model::Model>()};
-    m->importSBMLString(optConstData->xmlModel);
-    modelQueue->push(std::move(m));
+    modelQueue->push(makeOptModel(*optConstData));
+  }
+}
+
+Optimization::Optimization(sme::model::Model &model,
+                           const std::string &evaluationLogFilename) {
+  init(model);
+  if (!errorMessage.empty()) {
+    return;
+  }
+  evaluationLog = std::make_unique<OptEvaluationLog>(
+      optConstData->optimizeOptions.optParams.size(), evaluationLogFilename);
+  if (!evaluationLog->isOpen()) {
+    errorMessage = "Failed to open optimization evaluation log '" +
+                   evaluationLogFilename + "'";
   }
 }
 
+Optimization::Optimization(sme::model::Model &model,
+                           const OptimizationCheckpoint &checkpoint,
+                           const std::string &evaluationLogFilename) {
+  init(model);
+  if (!errorMessage.empty()) {
+    return;
+  }
+  const auto nParams{optConstData->optimizeOptions.optParams.size()};
+  auto hasParams = [nParams](const auto &params) {
+    return params.size() == nParams;
+  };
+  if (checkpoint.islands.empty() ||
+      !std::ranges::all_of(checkpoint.islands, [&hasParams](const auto &i) {
+        return i.params.size() == i.fitness.size() &&
+               std::ranges::all_of(i.params, hasParams);
+      })) {
+    errorMessage = "Optimization checkpoint does not match the parameters "
+                   "being optimized";
+    return;
+  }
+  evaluationLog = std::make_unique<OptEvaluationLog>(
+      nParams, evaluationLogFilename, checkpoint.nEvaluations);
+  if (!evaluationLog->isOpen()) {
+    errorMessage = "Failed to open optimization evaluation log '" +
+                   evaluationLogFilename + "' of the checkpoint";
+    return;
+  }
+  bestFitness = checkpoint.bestFitness;
+  bestParams = checkpoint.bestParams;
+  nIterations.store(checkpoint.nIterations);
+  resumeCheckpoint = std::make_unique<OptimizationCheckpoint>(checkpoint);
+  SPDLOG_INFO("Resuming optimization after {} iterations",
+              checkpoint.nIterations);
+}
+
 std::size_t Optimization::evolve(std::size_t n) {
   if (isRunning.load()) {
     SPDLOG_WARN("Evolve is currently running: ignoring call to evolve");
@@ -164,14 +317,21 @@ std::size_t Optimization::evolve(std::size_t n) {
   isRunning.store(true);
   if (archi == nullptr) {
     try {
-      archi = std::make_unique<pagmo::archipelago>(
-          optConstData->optimizeOptions.optAlgorithm.islands, *algo,
-          pagmo::problem{PagmoUDP(optConstData.get(), modelQueue.get(), this)},
-          optConstData->optimizeOptions.optAlgorithm.population);
+      pagmo::problem problem{
+          PagmoUDP(optConstData.get(), modelQueue.get(), this)};
+      if (resumeCheckpoint != nullptr) {
+        archi = resumeArchipelago(*resumeCheckpoint, *algo, problem);
+        resumeCheckpoint.reset();
+      } else {
+        archi = std::make_unique<pagmo::archipelago>(
+            optConstData->optimizeOptions.optAlgorithm.islands, *algo,
+            problem, optConstData->optimizeOptions.optAlgorithm.population);
+        appendBestFitnesssAndParams(*archi, bestFitness, bestParams);
+      }
     } catch (const std::invalid_argument &e) {
       return finalizeEvolve(e.what());
     }
-    appendBestFitnesssAndParams(*archi, bestFitness, bestParams);
+    updateCostCeiling();
   }
   SPDLOG_INFO("Starting {} {} evolve steps", n, algo->get_name());
   // ensure output vectors won't re-allocate during evolution
@@ -185,6 +345,7 @@ std::size_t Optimization::evolve(std::size_t n) {
       return finalizeEvolve(e.what());
     }
     appendBestFitnesssAndParams(*archi, bestFitness, bestParams);
+    updateCostCeiling();
     ++nIterations;
     if (stopRequested) {
       SPDLOG_INFO("Stopping evolve early after {} steps", nIterations.load());
@@ -232,6 +393,65 @@ bool Optimization::setBestResults(double fitness,
   return false;
 }
 
+double Optimization::getBestResultsFitness() const {
+  std::scoped_lock lock{bestResultsMutex};
+  return bestResults.fitness;
+}
+
+double Optimization::getCostCeiling() const { return costCeiling.load(); }
+
+void Optimization::addScreeningCosts(const OptScreeningCosts &costs) {
+  std::scoped_lock lock{screeningCostsMutex};
+  screeningCosts.push_back(costs);
+}
+
+std::vector<OptScreeningCosts> Optimization::getScreeningCosts() const {
+  std::scoped_lock lock{screeningCostsMutex};
+  return screeningCosts;
+}
+
+void Optimization::addEvaluation(const std::vector<double> &params,
+                                 double cost) {
+  if (evaluationLog != nullptr) {
+    evaluationLog->append({params, cost});
+  }
+}
+
+std::vector<OptEvaluation> Optimization::getEvaluations() const {
+  if (evaluationLog == nullptr) {
+    return {};
+  }
+  return evaluationLog->read();
+}
+
+OptimizationCheckpoint Optimization::getCheckpoint() const {
+  if (resumeCheckpoint != nullptr) {
+    // not yet resumed: nothing has changed
+    return *resumeCheckpoint;
+  }
+  OptimizationCheckpoint checkpoint;
+  if (archi != nullptr) {
+    for (const auto &island : *archi) {
+      auto pop{island.get_population()};
+      auto &state{checkpoint.islands.emplace_back()};
+      state.params = pop.get_x();
+      state.fitness.reserve(pop.size());
+      for (const auto &f : pop.get_f()) {
+        state.fitness.push_back(f[0]);
+      }
+      state.seed = pop.get_seed();
+      state.algorithm = serializeAlgorithm(island.get_algorithm());
+    }
+  }
+  checkpoint.bestFitness = bestFitness;
+  checkpoint.bestParams = bestParams;
+  checkpoint.nIterations = nIterations.load();
+  if (evaluationLog != nullptr) {
+    checkpoint.nEvaluations = evaluationLog->size();
+  }
+  return checkpoint;
+}
+
 common::ImageStack Optimization::getTargetImage(std::size_t index) const {
   return common::ImageStack(
       optConstData->imageSize,
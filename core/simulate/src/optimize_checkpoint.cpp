@@ -0,0 +1,162 @@
+#include "sme/optimize_checkpoint.hpp"
+#include "checkpoint_file.hpp"
+#include "sme/logger.hpp"
+#include <QFile>
+#include <QTemporaryFile>
+#include <algorithm>
+#include <cereal/archives/binary.hpp>
+#include <cstring>
+#include <fstream>
+
+namespace sme::simulate {
+
+static bool isValidCheckpoint(const OptimizationCheckpoint &checkpoint) {
+  if (checkpoint.islands.empty() ||
+      checkpoint.bestFitness.size() != checkpoint.bestParams.size()) {
+    return false;
+  }
+  return std::ranges::all_of(checkpoint.islands, [](const auto &island) {
+    return !island.params.empty() &&
+           island.params.size() == island.fitness.size();
+  });
+}
+
+std::unique_ptr<OptimizationCheckpoint>
+importOptimizationCheckpoint(const std::string &filename) {
+  auto checkpoint{std::make_unique<OptimizationCheckpoint>()};
+  std::ifstream fs(filename, std::ios::binary);
+  if (!fs) {
+    SPDLOG_WARN("Failed to read file '{}'", filename);
+    return {};
+  }
+  try {
+    cereal::BinaryInputArchive ar(fs);
+    ar(*checkpoint);
+  } catch (const std::exception &e) {
+    SPDLOG_WARN("Failed to import optimization checkpoint '{}'. {}", filename,
+                e.what());
+    return {};
+  }
+  if (!isValidCheckpoint(*checkpoint)) {
+    SPDLOG_WARN("Failed to import optimization checkpoint '{}'. Invalid "
+                "population",
+                filename);
+    return {};
+  }
+  return checkpoint;
+}
+
+bool exportOptimizationCheckpoint(const std::string &filename,
+                                  const OptimizationCheckpoint &checkpoint) {
+  // write to a temporary file first, so that an interrupted write does not
+  // destroy the previous checkpoint
+  return writeFileViaTemporary(filename, [&checkpoint](std::ostream &os) {
+    cereal::BinaryOutputArchive ar{os};
+    ar(checkpoint);
+  });
+}
+
+OptEvaluationLog::OptEvaluationLog(std::size_t nParameters,
+                                   const std::string &filename,
+                                   std::size_t nExistingEvaluations)
+    : nParams{nParameters} {
+  const auto recordSize{static_cast<qint64>((nParams + 1) * sizeof(double))};
+  if (filename.empty()) {
+    if (nExistingEvaluations > 0) {
+      SPDLOG_WARN("No evaluation log: {} existing evaluations are not "
+                  "available",
+                  nExistingEvaluations);
+    }
+    auto tmpFile{std::make_unique<QTemporaryFile>()};
+    if (tmpFile->open()) {
+      file = std::move(tmpFile);
+    }
+  } else if (nExistingEvaluations == 0) {
+    auto logFile{std::make_unique<QFile>(QString::fromStdString(filename))};
+    if (logFile->open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+      file = std::move(logFile);
+    }
+  } else {
+    // keep the evaluations that the checkpoint refers to
+    auto logFile{std::make_unique<QFile>(QString::fromStdString(filename))};
+    const auto nBytes{static_cast<qint64>(nExistingEvaluations) * recordSize};
+    if (logFile->open(QIODevice::ReadWrite) && logFile->size() >= nBytes &&
+        logFile->resize(nBytes)) {
+      file = std::move(logFile);
+      nEvaluations = nExistingEvaluations;
+    }
+  }
+  if (file == nullptr) {
+    SPDLOG_WARN("Failed to open optimization evaluation log '{}'", filename);
+  }
+}
+
+OptEvaluationLog::~OptEvaluationLog() = default;
+
+bool OptEvaluationLog::isOpen() const { return file != nullptr; }
+
+std::string OptEvaluationLog::getFilename() const {
+  if (file == nullptr) {
+    return {};
+  }
+  return file->fileName().toStdString();
+}
+
+std::size_t OptEvaluationLog::size() const {
+  std::scoped_lock lock(fileMutex);
+  return nEvaluations;
+}
+
+bool OptEvaluationLog::append(const OptEvaluation &evaluation) {
+  if (file == nullptr || evaluation.params.size() != nParams) {
+    return false;
+  }
+  std::vector<double> record(evaluation.params);
+  record.push_back(evaluation.cost);
+  const auto nBytes{static_cast<qint64>(record.size() * sizeof(double))};
+  std::scoped_lock lock(fileMutex);
+  if (!file->seek(file->size()) ||
+      file->write(reinterpret_cast<const char *>(record.data()), nBytes) !=
+          nBytes ||
+      !file->flush()) {
+    SPDLOG_WARN("Failed to write to optimization evaluation log '{}'",
+                file->fileName().toStdString());
+    return false;
+  }
+  ++nEvaluations;
+  return true;
+}
+
+std::vector<OptEvaluation> OptEvaluationLog::read() const {
+  std::vector<OptEvaluation> evaluations;
+  if (file == nullptr) {
+    return evaluations;
+  }
+  const std::size_t recordSize{(nParams + 1) * sizeof(double)};
+  QByteArray bytes;
+  {
+    std::scoped_lock lock(fileMutex);
+    if (!file->seek(0)) {
+      return evaluations;
+    }
+    bytes = file->read(static_cast<qint64>(nEvaluations * recordSize));
+  }
+  const auto n{static_cast<std::size_t>(bytes.size()) / recordSize};
+  evaluations.reserve(n);
+  const auto *src{bytes.constData()};
+  for (std::size_t i = 0; i < n; ++i) {
+    auto &evaluation{evaluations.emplace_back()};
+    evaluation.params.resize(nParams);
+    std::memcpy(evaluation.params.data(), src, nParams * sizeof(double));
+    std::memcpy(&evaluation.cost, src + nParams * sizeof(double),
+                sizeof(double));
+    src += recordSize;
+  }
+  return evaluations;
+}
+
+std::string getOptEvaluationLogFilename(const std::string &checkpointFilename) {
+  return checkpointFilename + ".evaluations";
+}
+
+} // namespace sme::simulate
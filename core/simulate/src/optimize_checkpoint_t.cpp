@@ -0,0 +1,122 @@
+#include "catch_wrapper.hpp"
+#include "sme/optimize_checkpoint.hpp"
+#include <QFile>
+
+using namespace sme;
+
+TEST_CASE("OptimizationCheckpoint",
+          "[core/simulate/optimize_checkpoint][core/simulate][core]"
+          "[optimize_checkpoint]") {
+  simulate::OptimizationCheckpoint checkpoint;
+  checkpoint.islands = {{{{0.1, 2.0}, {0.3, 1.5}}, {4.5, 3.25}, 123, "abc"},
+                        {{{0.7, 1.0}, {0.2, 1.1}}, {1.5, 0.25}, 99, {}}};
+  checkpoint.bestFitness = {1.5, 0.25};
+  checkpoint.bestParams = {{0.1, 2.0}, {0.2, 1.1}};
+  checkpoint.nIterations = 1;
+  checkpoint.nEvaluations = 7;
+  SECTION("export & import") {
+    REQUIRE(simulate::exportOptimizationCheckpoint("tmpoptcheckpoint.bin",
+                                                   checkpoint));
+    auto imported{
+        simulate::importOptimizationCheckpoint("tmpoptcheckpoint.bin")};
+    REQUIRE(imported != nullptr);
+    REQUIRE(imported->islands.size() == 2);
+    for (std::size_t i = 0; i < 2; ++i) {
+      REQUIRE(imported->islands[i].params == checkpoint.islands[i].params);
+      REQUIRE(imported->islands[i].fitness == checkpoint.islands[i].fitness);
+      REQUIRE(imported->islands[i].seed == checkpoint.islands[i].seed);
+      REQUIRE(imported->islands[i].algorithm ==
+              checkpoint.islands[i].algorithm);
+    }
+    REQUIRE(imported->bestFitness == checkpoint.bestFitness);
+    REQUIRE(imported->bestParams == checkpoint.bestParams);
+    REQUIRE(imported->nIterations == checkpoint.nIterations);
+    REQUIRE(imported->nEvaluations == checkpoint.nEvaluations);
+    // temporary file is removed after writing
+    REQUIRE(QFile::exists("tmpoptcheckpoint.bin.tmp") == false);
+  }
+  SECTION("import invalid files") {
+    REQUIRE(simulate::importOptimizationCheckpoint("non-existent-file.bin") ==
+            nullptr);
+    QFile f("invalidoptcheckpoint.bin");
+    REQUIRE(f.open(QIODevice::WriteOnly));
+    f.write("invalid");
+    f.close();
+    REQUIRE(simulate::importOptimizationCheckpoint(
+                "invalidoptcheckpoint.bin") == nullptr);
+    // mismatch between number of individuals and fitness values
+    checkpoint.islands[1].fitness.pop_back();
+    REQUIRE(simulate::exportOptimizationCheckpoint("tmpoptcheckpoint.bin",
+                                                   checkpoint));
+    REQUIRE(simulate::importOptimizationCheckpoint("tmpoptcheckpoint.bin") ==
+            nullptr);
+    // a checkpoint without any islands is invalid
+    checkpoint.islands.clear();
+    REQUIRE(simulate::exportOptimizationCheckpoint("tmpoptcheckpoint.bin",
+                                                   checkpoint));
+    REQUIRE(simulate::importOptimizationCheckpoint("tmpoptcheckpoint.bin") ==
+            nullptr);
+  }
+}
+
+TEST_CASE("OptEvaluationLog",
+          "[core/simulate/optimize_checkpoint][core/simulate][core]"
+          "[optimize_checkpoint]") {
+  const std::string filename{"tmpoptevaluations.bin"};
+  SECTION("temporary file") {
+    std::string tmpFilename;
+    {
+      simulate::OptEvaluationLog log(2);
+      REQUIRE(log.isOpen());
+      tmpFilename = log.getFilename();
+      REQUIRE(QFile::exists(tmpFilename.c_str()));
+      REQUIRE(log.append({{0.1, 2.0}, 4.5}));
+      REQUIRE(log.size() == 1);
+      REQUIRE(log.read().size() == 1);
+    }
+    // temporary file is removed with the log
+    REQUIRE(QFile::exists(tmpFilename.c_str()) == false);
+  }
+  SECTION("append, read, and truncate existing log") {
+    {
+      simulate::OptEvaluationLog log(2, filename);
+      REQUIRE(log.isOpen());
+      REQUIRE(log.getFilename() == filename);
+      REQUIRE(log.size() == 0);
+      REQUIRE(log.append({{0.1, 2.0}, 4.5}));
+      REQUIRE(log.append({{0.2, 1.1}, 0.25}));
+      REQUIRE(log.append({{0.3, 1.7}, 1.25}));
+      // wrong number of parameters
+      REQUIRE(log.append({{0.3}, 1.25}) == false);
+      REQUIRE(log.size() == 3);
+      auto evaluations{log.read()};
+      REQUIRE(evaluations.size() == 3);
+      REQUIRE(evaluations[1].params == std::vector<double>{0.2, 1.1});
+      REQUIRE(evaluations[1].cost == 0.25);
+    }
+    // log file is kept
+    REQUIRE(QFile::exists(filename.c_str()));
+    {
+      // keep the first two evaluations
+      simulate::OptEvaluationLog log(2, filename, 2);
+      REQUIRE(log.isOpen());
+      REQUIRE(log.size() == 2);
+      REQUIRE(log.append({{0.4, 1.9}, 3.5}));
+      auto evaluations{log.read()};
+      REQUIRE(evaluations.size() == 3);
+      REQUIRE(evaluations[1].params == std::vector<double>{0.2, 1.1});
+      REQUIRE(evaluations[2].params == std::vector<double>{0.4, 1.9});
+      REQUIRE(evaluations[2].cost == 3.5);
+    }
+    // the log has fewer evaluations than the checkpoint refers to
+    simulate::OptEvaluationLog invalidLog(2, filename, 4);
+    REQUIRE(invalidLog.isOpen() == false);
+    REQUIRE(invalidLog.append({{0.1, 2.0}, 4.5}) == false);
+    REQUIRE(invalidLog.read().empty());
+    // a new log replaces the existing one
+    simulate::OptEvaluationLog newLog(2, filename);
+    REQUIRE(newLog.isOpen());
+    REQUIRE(newLog.size() == 0);
+    REQUIRE(newLog.read().empty());
+  }
+}
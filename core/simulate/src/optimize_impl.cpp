@@ -1,5 +1,12 @@
 #include "optimize_impl.hpp"
 #include "sme/logger.hpp"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
 
 namespace sme::simulate {
 
@@ -27,6 +34,140 @@ void applyParameters(const pagmo::vector_double &values,
   }
 }
 
+std::vector<ParameterOverride>
+getParameterOverrides(const pagmo::vector_double &values,
+                      const std::vector<OptParam> &optParams) {
+  std::vector<ParameterOverride> overrides;
+  overrides.reserve(values.size());
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    const auto &param{optParams[i]};
+    switch (param.optParamType) {
+    case OptParamType::ModelParameter:
+      overrides.push_back({param.id, {}, values[i]});
+      break;
+    case OptParamType::ReactionParameter:
+      overrides.push_back({param.id, param.parentId, values[i]});
+      break;
+    default:
+      throw std::invalid_argument("Optimization: Invalid OptParamType");
+    }
+  }
+  return overrides;
+}
+
+static std::shared_ptr<sme::model::Model>
+makeOptimizationModel(const std::string &xmlModel,
+                      const OptConstData &optConstData) {
+  auto model{std::make_shared<sme::model::Model>()};
+  model->importSBMLString(xmlModel);
+  // parameter values are inputs to the compiled reaction terms, so that the
+  // simulation can be re-used for each set of parameters
+  auto &options{model->getSimulationSettings().options.pixel};
+  options.enableRuntimeParameters = true;
+  // gradient-based algorithms use the forward sensitivities
+  options.enableSensitivities =
+      optConstData.optimizeOptions.optAlgorithm.optAlgorithmType ==
+      OptAlgorithmType::LBFGS;
+  return model;
+}
+
+OptModel makeOptModel(const OptConstData &optConstData) {
+  OptModel m;
+  m.model = makeOptimizationModel(optConstData.xmlModel, optConstData);
+  if (!optConstData.coarseXmlModel.empty()) {
+    m.coarseModel =
+        makeOptimizationModel(optConstData.coarseXmlModel, optConstData);
+  }
+  return m;
+}
+
+std::vector<double> downsampleArray(const std::vector<double> &values,
+                                    const common::Volume &size,
+                                    const common::Volume &coarseSize) {
+  if (values.size() != size.nVoxels()) {
+    SPDLOG_ERROR("Mismatch between size of values ({}) and image ({})",
+                 values.size(), size.nVoxels());
+    throw std::invalid_argument("Optimization: Array size mismatch");
+  }
+  std::vector<double> coarseValues(coarseSize.nVoxels(), 0.0);
+  std::vector<std::size_t> counts(coarseSize.nVoxels(), 0);
+  const auto nx{static_cast<std::size_t>(size.width())};
+  const auto ny{static_cast<std::size_t>(size.height())};
+  const auto cnx{static_cast<std::size_t>(coarseSize.width())};
+  const auto cny{static_cast<std::size_t>(coarseSize.height())};
+  for (std::size_t z = 0; z < size.depth(); ++z) {
+    for (std::size_t y = 0; y < ny; ++y) {
+      for (std::size_t x = 0; x < nx; ++x) {
+        std::size_t ci{x * cnx / nx + cnx * (y * cny / ny + cny * z)};
+        coarseValues[ci] += values[x + nx * (y + ny * z)];
+        ++counts[ci];
+      }
+    }
+  }
+  for (std::size_t i = 0; i < coarseValues.size(); ++i) {
+    if (counts[i] > 0) {
+      coarseValues[i] /= static_cast<double>(counts[i]);
+    }
+  }
+  return coarseValues;
+}
+
+bool coarsenGeometry(sme::model::Model &model, std::size_t factor) {
+  auto &geometry{model.getGeometry()};
+  if (factor < 2 || !geometry.getIsValid()) {
+    return false;
+  }
+  const auto size{geometry.getImages().volume()};
+  const int f{static_cast<int>(factor)};
+  const common::Volume coarseSize{std::max(1, size.width() / f),
+                                  std::max(1, size.height() / f),
+                                  size.depth()};
+  if (coarseSize == size) {
+    return false;
+  }
+  SPDLOG_INFO("Coarsening geometry from {}x{}x{} to {}x{}x{}", size.width(),
+              size.height(), size.depth(), coarseSize.width(),
+              coarseSize.height(), coarseSize.depth());
+  auto &species{model.getSpecies()};
+  // image-based initial concentrations can't be imported into the new
+  // geometry, so they are removed and then replaced with downsampled ones
+  std::vector<std::pair<QString, std::vector<double>>> sampledFields;
+  for (const auto &compartmentId : model.getCompartments().getIds()) {
+    for (const auto &id : species.getIds(compartmentId)) {
+      if (species.getInitialConcentrationType(id) ==
+          sme::model::ConcentrationType::Image) {
+        sampledFields.emplace_back(
+            id, downsampleArray(species.getSampledFieldConcentration(id), size,
+                                coarseSize));
+        species.setInitialConcentration(id, 0.0);
+      }
+    }
+  }
+  const auto membraneIds{model.getMembranes().getIds()};
+  const auto voxelSize{geometry.getVoxelSize()};
+  auto images{geometry.getImages()};
+  geometry.importGeometryFromImages(
+      images.scaled(coarseSize.width(), coarseSize.height()), true);
+  if (model.getCompartments().getColours().contains(0) ||
+      model.getMembranes().getIds() != membraneIds) {
+    SPDLOG_WARN("Compartments and membranes not resolved by coarse geometry");
+    return false;
+  }
+  // keep the same physical size
+  geometry.setVoxelSize(
+      {voxelSize.width() * static_cast<double>(size.width()) /
+           static_cast<double>(coarseSize.width()),
+       voxelSize.height() * static_cast<double>(size.height()) /
+           static_cast<double>(coarseSize.height()),
+       voxelSize.depth()});
+  for (const auto &[id, array] : sampledFields) {
+    species.setSampledFieldConcentration(id, array);
+  }
+  species.updateAllAnalyticConcentrations();
+  geometry.updateMesh();
+  return true;
+}
+
 double calculateCosts(const std::vector<OptCost> &optCosts,
                       const std::vector<std::size_t> &optCostIndices,
                       const sme::simulate::Simulation &sim,
@@ -74,46 +215,239 @@ double calculateCosts(const std::vector<OptCost> &optCosts,
   return cost;
 }
 
+std::vector<double> calculateCostsGradient(
+    const std::vector<OptCost> &optCosts,
+    const std::vector<std::size_t> &optCostIndices,
+    const sme::simulate::Simulation &sim,
+    const std::vector<std::vector<double>> &currentTargets,
+    const std::vector<std::optional<std::size_t>> &sensitivityIndices) {
+  std::vector<double> gradient(sensitivityIndices.size(), 0.0);
+  for (const auto &optCostIndex : optCostIndices) {
+    const auto &optCost{optCosts[optCostIndex]};
+    const auto &values{currentTargets[optCostIndex]};
+    auto compIndex{optCost.compartmentIndex};
+    auto specIndex{optCost.speciesIndex};
+    // d(cost)/d(value) for each value
+    std::vector<double> dCost(values.size(), 0.0);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      double diff{values[i]};
+      double scale{1.0};
+      if (!optCost.targetValues.empty()) {
+        diff -= optCost.targetValues[i];
+        if (optCost.optCostDiffType == OptCostDiffType::Relative) {
+          scale = 1.0 / (std::abs(optCost.targetValues[i]) + optCost.epsilon);
+        }
+      }
+      if (diff > 0.0) {
+        dCost[i] = scale;
+      } else if (diff < 0.0) {
+        dCost[i] = -scale;
+      }
+    }
+    for (std::size_t k = 0; k < sensitivityIndices.size(); ++k) {
+      if (!sensitivityIndices[k].has_value()) {
+        continue;
+      }
+      std::vector<double> dValues;
+      switch (optCost.optCostType) {
+      case OptCostType::Concentration:
+        dValues = sim.getConcSensitivityArray(compIndex, specIndex,
+                                              sensitivityIndices[k].value());
+        break;
+      case OptCostType::ConcentrationDcdt:
+        dValues = sim.getDcdtSensitivityArray(compIndex, specIndex,
+                                              sensitivityIndices[k].value());
+        break;
+      default:
+        throw std::invalid_argument("Optimization: Invalid OptCostType");
+      }
+      for (std::size_t i = 0; i < std::min(dValues.size(), dCost.size());
+           ++i) {
+        gradient[k] += dCost[i] * dValues[i];
+      }
+    }
+    // weights are applied in the same way as in calculateCosts
+    for (auto &g : gradient) {
+      g *= optCost.weight;
+    }
+  }
+  return gradient;
+}
+
 PagmoUDP::PagmoUDP(const OptConstData *optConstData,
                    ThreadsafeModelQueue *modelQueue,
                    sme::simulate::Optimization *optimization)
     : m_optConstData{optConstData}, m_modelQueue{modelQueue},
       m_optimization{optimization} {}
 
-[[nodiscard]] pagmo::vector_double
-PagmoUDP::fitness(const pagmo::vector_double &dv) const {
-  std::shared_ptr<sme::model::Model> m;
+PagmoUDP::CostsStatus PagmoUDP::simulateCosts(
+    const pagmo::vector_double &dv, std::shared_ptr<sme::model::Model> &model,
+    std::shared_ptr<Simulation> &simulation,
+    const std::vector<OptCost> &optCosts, bool useCostCeiling, double &cost,
+    std::vector<std::vector<double>> &currentTargets,
+    pagmo::vector_double *gradient) const {
+  if (simulation == nullptr) {
+    model->getSimulationData().clear();
+    applyParameters(dv, model.get());
+    simulation = std::make_shared<sme::simulate::Simulation>(*model);
+  } else {
+    // only the parameter values differ from the previous evaluation
+    simulation->reset(
+        getParameterOverrides(dv, m_optConstData->optimizeOptions.optParams));
+  }
+  auto &sim{*simulation};
+  std::vector<std::optional<std::size_t>> sensitivityIndices;
+  if (gradient != nullptr) {
+    for (const auto &optParam : m_optConstData->optimizeOptions.optParams) {
+      sensitivityIndices.push_back(sim.getSensitivityParameterIndex(
+          optParam.id, optParam.optParamType == OptParamType::ReactionParameter
+                           ? optParam.parentId
+                           : std::string{}));
+    }
+    gradient->assign(dv.size(), 0.0);
+  }
+  cost = 0.0;
+  currentTargets.assign(optCosts.size(), std::vector<double>{});
+  // costs are non-negative, so the partial cost is a lower bound on the cost.
+  // The ceiling can decrease while simulating, so it is checked in the stop
+  // callback as well as after each timestep
+  auto exceededCeiling = [this, useCostCeiling, &cost]() {
+    return useCostCeiling && cost > m_optimization->getCostCeiling();
+  };
+  for (const auto &optTimestep : m_optConstData->optTimesteps) {
+    sim.doMultipleTimesteps(
+        {{1, optTimestep.simulationTime}}, -1, [this, &exceededCeiling]() {
+          return m_optimization->getIsStopping() || exceededCeiling();
+        });
+    if (m_optimization->getIsStopping()) {
+      return CostsStatus::Stopped;
+    }
+    if (exceededCeiling()) {
+      return CostsStatus::ExceededCeiling;
+    }
+    cost += calculateCosts(optCosts, optTimestep.optCostIndices, sim,
+                           currentTargets);
+    if (exceededCeiling()) {
+      SPDLOG_DEBUG("Partial cost {} exceeds ceiling: stopping early", cost);
+      return CostsStatus::ExceededCeiling;
+    }
+    if (gradient != nullptr) {
+      auto g{calculateCostsGradient(optCosts, optTimestep.optCostIndices, sim,
+                                    currentTargets, sensitivityIndices)};
+      for (std::size_t i = 0; i < g.size(); ++i) {
+        (*gradient)[i] += g[i];
+      }
+    }
+  }
+  if (gradient != nullptr) {
+    for (std::size_t i = 0; i < sensitivityIndices.size(); ++i) {
+      if (!sensitivityIndices[i].has_value()) {
+        (*gradient)[i] = std::numeric_limits<double>::quiet_NaN();
+      }
+    }
+  }
+  return CostsStatus::Completed;
+}
+
+double PagmoUDP::evaluate(const pagmo::vector_double &dv,
+                          pagmo::vector_double *gradient) const {
+  OptModel m;
   if (m_optimization->getIsStopping()) {
-    return {std::numeric_limits<double>::max()};
+    return std::numeric_limits<double>::max();
   }
   if (m_modelQueue == nullptr || !m_modelQueue->try_pop(m)) {
     SPDLOG_INFO("model queue missing or empty: constructing model");
-    m = std::make_shared<sme::model::Model>();
-    m->importSBMLString(m_optConstData->xmlModel);
+    m = makeOptModel(*m_optConstData);
   }
-  m->getSimulationData().clear();
-  applyParameters(dv, m.get());
-  sme::simulate::Simulation sim(*m);
   double cost{0.0};
-  std::vector<std::vector<double>> currentTargets(
-      m_optConstData->optimizeOptions.optCosts.size(), std::vector<double>{});
-  for (const auto &optTimestep : m_optConstData->optTimesteps) {
-    sim.doMultipleTimesteps({{1, optTimestep.simulationTime}}, -1, [this]() {
-      return m_optimization->getIsStopping();
-    });
-    if (m_optimization->getIsStopping()) {
-      return {std::numeric_limits<double>::max()};
+  std::vector<std::vector<double>> currentTargets;
+  // screen the candidate using the coarse geometry first
+  std::optional<double> coarseCost;
+  if (gradient == nullptr && m.coarseModel != nullptr) {
+    if (simulateCosts(dv, m.coarseModel, m.coarseSimulation,
+                      m_optConstData->coarseOptCosts, false, cost,
+                      currentTargets, nullptr) == CostsStatus::Stopped) {
+      return std::numeric_limits<double>::max();
+    }
+    coarseCost = cost * m_optConstData->coarseCostScale;
+    double threshold{
+        std::max(1.0, m_optConstData->optimizeOptions.screeningThreshold)};
+    if (coarseCost.value() >
+        threshold * m_optimization->getBestResultsFitness()) {
+      SPDLOG_INFO("Candidate screened out with coarse cost {}",
+                  coarseCost.value());
+      m_optimization->addScreeningCosts(
+          {coarseCost.value(), std::numeric_limits<double>::quiet_NaN()});
+      m_optimization->addEvaluation(dv, coarseCost.value());
+      if (m_modelQueue != nullptr) {
+        m_modelQueue->push(std::move(m));
+      }
+      return coarseCost.value();
     }
-    cost += calculateCosts(m_optConstData->optimizeOptions.optCosts,
-                           optTimestep.optCostIndices, sim, currentTargets);
   }
+  // the gradient needs the complete cost, so is never stopped early
+  auto status{simulateCosts(dv, m.model, m.simulation,
+                            m_optConstData->optimizeOptions.optCosts,
+                            gradient == nullptr, cost, currentTargets,
+                            gradient)};
+  if (status == CostsStatus::Stopped) {
+    return std::numeric_limits<double>::max();
+  }
+  if (status == CostsStatus::ExceededCeiling) {
+    // the partial cost is a lower bound, and worse than the whole population
+    m_optimization->addEvaluation(dv, cost);
+    if (m_modelQueue != nullptr) {
+      m_modelQueue->push(std::move(m));
+    }
+    return cost;
+  }
+  if (coarseCost.has_value()) {
+    m_optimization->addScreeningCosts({coarseCost.value(), cost});
+  }
+  m_optimization->addEvaluation(dv, cost);
   if (m_optimization->setBestResults(cost, std::move(currentTargets))) {
     SPDLOG_INFO("Updated current best results with cost {}", cost);
   }
   if (m_modelQueue != nullptr) {
     m_modelQueue->push(std::move(m));
   }
-  return {cost};
+  return cost;
+}
+
+[[nodiscard]] pagmo::vector_double
+PagmoUDP::fitness(const pagmo::vector_double &dv) const {
+  return {evaluate(dv, nullptr)};
+}
+
+[[nodiscard]] std::pair<double, pagmo::vector_double>
+PagmoUDP::fitnessAndGradient(const pagmo::vector_double &dv) const {
+  pagmo::vector_double gradient;
+  double cost{evaluate(dv, &gradient)};
+  if (cost == std::numeric_limits<double>::max()) {
+    return {cost, pagmo::vector_double(dv.size(), 0.0)};
+  }
+  const auto &optParams{m_optConstData->optimizeOptions.optParams};
+  for (std::size_t i = 0; i < gradient.size(); ++i) {
+    if (!std::isnan(gradient[i])) {
+      continue;
+    }
+    // no forward sensitivity for this parameter: use a finite difference
+    // with a step that stays within the bounds
+    const auto &optParam{optParams[i]};
+    constexpr double relativeStep{1e-4};
+    double h{relativeStep * (optParam.upperBound - optParam.lowerBound)};
+    if (dv[i] + h > optParam.upperBound) {
+      h = -h;
+    }
+    auto dvStep{dv};
+    dvStep[i] += h;
+    double costStep{evaluate(dvStep, nullptr)};
+    if (costStep == std::numeric_limits<double>::max()) {
+      return {costStep, pagmo::vector_double(dv.size(), 0.0)};
+    }
+    gradient[i] = (costStep - cost) / h;
+  }
+  return {cost, gradient};
 }
 
 [[nodiscard]] std::pair<pagmo::vector_double, pagmo::vector_double>
@@ -129,4 +463,168 @@ PagmoUDP::get_bounds() const {
   return bounds;
 }
 
+static double dot(const std::vector<double> &a, const std::vector<double> &b) {
+  return std::inner_product(a.cbegin(), a.cend(), b.cbegin(), 0.0);
+}
+
+// L-BFGS two-loop recursion for the search direction -H g, restricted to the
+// free variables
+static std::vector<double> getSearchDirection(
+    const std::vector<double> &g,
+    const std::deque<std::pair<std::vector<double>, std::vector<double>>>
+        &history,
+    const std::vector<bool> &isFree) {
+  const std::size_t n{g.size()};
+  std::vector<double> q(n, 0.0);
+  for (std::size_t i = 0; i < n; ++i) {
+    if (isFree[i]) {
+      q[i] = g[i];
+    }
+  }
+  std::vector<double> alpha(history.size(), 0.0);
+  for (std::size_t j = history.size(); j > 0; --j) {
+    const auto &[s, y] = history[j - 1];
+    alpha[j - 1] = dot(s, q) / dot(y, s);
+    for (std::size_t i = 0; i < n; ++i) {
+      q[i] -= alpha[j - 1] * y[i];
+    }
+  }
+  double gamma{1.0};
+  if (!history.empty()) {
+    const auto &[s, y] = history.back();
+    gamma = dot(s, y) / dot(y, y);
+  }
+  for (auto &v : q) {
+    v *= gamma;
+  }
+  for (std::size_t j = 0; j < history.size(); ++j) {
+    const auto &[s, y] = history[j];
+    double beta{dot(y, q) / dot(y, s)};
+    for (std::size_t i = 0; i < n; ++i) {
+      q[i] += s[i] * (alpha[j] - beta);
+    }
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    q[i] = isFree[i] ? -q[i] : 0.0;
+  }
+  return q;
+}
+
+PagmoLBFGS::PagmoLBFGS(std::size_t iterations, std::size_t historySize)
+    : m_iterations{iterations}, m_historySize{historySize} {}
+
+pagmo::population PagmoLBFGS::evolve(pagmo::population pop) const {
+  if (pop.size() == 0) {
+    return pop;
+  }
+  const auto *udp{pop.get_problem().extract<PagmoUDP>()};
+  if (udp == nullptr) {
+    throw std::invalid_argument(
+        "Optimization: L-BFGS can only be used with the optimization problem");
+  }
+  constexpr double failed{std::numeric_limits<double>::max()};
+  // search in parameters rescaled to [0,1] by their bounds
+  const auto [lb, ub] = pop.get_problem().get_bounds();
+  const std::size_t n{lb.size()};
+  auto toParams = [&lb, &ub](const std::vector<double> &u) {
+    pagmo::vector_double x(u.size());
+    for (std::size_t i = 0; i < u.size(); ++i) {
+      x[i] = lb[i] + u[i] * (ub[i] - lb[i]);
+    }
+    return x;
+  };
+  auto evaluate = [udp, &toParams, &lb, &ub](const std::vector<double> &u,
+                                             std::vector<double> &g) {
+    auto [f, gradient] = udp->fitnessAndGradient(toParams(u));
+    g.resize(u.size());
+    for (std::size_t i = 0; i < u.size(); ++i) {
+      g[i] = gradient[i] * (ub[i] - lb[i]);
+    }
+    return f;
+  };
+  const auto iBest{pop.best_idx()};
+  std::vector<double> u(n, 0.0);
+  for (std::size_t i = 0; i < n; ++i) {
+    if (ub[i] > lb[i]) {
+      u[i] = std::clamp((pop.get_x()[iBest][i] - lb[i]) / (ub[i] - lb[i]),
+                        0.0, 1.0);
+    }
+  }
+  std::vector<double> g;
+  double f{evaluate(u, g)};
+  std::deque<std::pair<std::vector<double>, std::vector<double>>> history;
+  for (std::size_t iter = 0; iter < m_iterations && f < failed; ++iter) {
+    // variables at a bound with the gradient pointing outwards are fixed
+    std::vector<bool> isFree(n, true);
+    for (std::size_t i = 0; i < n; ++i) {
+      isFree[i] = !((u[i] <= 0.0 && g[i] > 0.0) || (u[i] >= 1.0 && g[i] < 0.0));
+    }
+    auto d{getSearchDirection(g, history, isFree)};
+    if (dot(g, d) >= 0.0) {
+      // not a descent direction: fall back to steepest descent
+      history.clear();
+      d = getSearchDirection(g, history, isFree);
+    }
+    const double maxStep{std::ranges::max(
+        d, {}, [](double v) { return std::abs(v); })};
+    if (dot(g, d) >= 0.0 || maxStep == 0.0) {
+      SPDLOG_INFO("L-BFGS: projected gradient is zero");
+      break;
+    }
+    // initial steepest descent step: at most a tenth of the parameter range
+    double alpha{history.empty() ? 0.1 / std::abs(maxStep) : 1.0};
+    // backtracking line search with Armijo condition
+    constexpr std::size_t maxLineSearchSteps{10};
+    constexpr double c1{1e-4};
+    std::vector<double> uNew(n);
+    std::vector<double> gNew;
+    double fNew{failed};
+    bool accepted{false};
+    for (std::size_t j = 0; j < maxLineSearchSteps; ++j) {
+      for (std::size_t i = 0; i < n; ++i) {
+        uNew[i] = std::clamp(u[i] + alpha * d[i], 0.0, 1.0);
+      }
+      fNew = evaluate(uNew, gNew);
+      std::vector<double> step(n);
+      std::ranges::transform(uNew, u, step.begin(), std::minus<>{});
+      if (fNew < failed && fNew <= f + c1 * dot(g, step)) {
+        accepted = true;
+        break;
+      }
+      alpha *= 0.5;
+    }
+    if (!accepted) {
+      SPDLOG_INFO("L-BFGS: line search failed");
+      break;
+    }
+    std::vector<double> s(n);
+    std::vector<double> y(n);
+    std::ranges::transform(uNew, u, s.begin(), std::minus<>{});
+    std::ranges::transform(gNew, g, y.begin(), std::minus<>{});
+    if (dot(s, y) > std::numeric_limits<double>::epsilon() * dot(y, y)) {
+      history.emplace_back(std::move(s), std::move(y));
+      if (history.size() > m_historySize) {
+        history.pop_front();
+      }
+    }
+    constexpr double relativeTolerance{1e-10};
+    bool converged{f - fNew <= relativeTolerance * std::max(1.0, std::abs(f))};
+    SPDLOG_INFO("L-BFGS iteration {}: {} -> {}", iter, f, fNew);
+    u = std::move(uNew);
+    g = std::move(gNew);
+    f = fNew;
+    if (converged) {
+      break;
+    }
+  }
+  if (f < pop.get_f()[iBest][0]) {
+    pop.set_xf(iBest, toParams(u), {f});
+  }
+  return pop;
+}
+
+std::string PagmoLBFGS::get_name() const { return "Projected L-BFGS"; }
+
 } // namespace sme::simulate
+
+PAGMO_S11N_ALGORITHM_IMPLEMENT(sme::simulate::PagmoLBFGS)
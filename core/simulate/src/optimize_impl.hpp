@@ -4,18 +4,68 @@
 #include "sme/simulate.hpp"
 #include "sme/utils.hpp"
 #include <iostream>
+#include <optional>
+#include <pagmo/algorithm.hpp>
 #include <pagmo/algorithms/pso.hpp>
+#include <pagmo/population.hpp>
+#include <pagmo/s11n.hpp>
+#include <string>
+#include <utility>
 
 namespace sme::simulate {
 
 void applyParameters(const pagmo::vector_double &values,
                      sme::model::Model *model);
 
+std::vector<ParameterOverride>
+getParameterOverrides(const pagmo::vector_double &values,
+                      const std::vector<OptParam> &optParams);
+
+OptModel makeOptModel(const OptConstData &optConstData);
+
+/**
+ * @brief Downsample an array of values for each voxel in an image
+ *
+ * Each value in the coarse array is the average of the values in the
+ * corresponding block of voxels in the original array. Both arrays have one
+ * value per voxel, including every z layer, and std::invalid_argument is
+ * thrown if the size of values does not match.
+ */
+std::vector<double> downsampleArray(const std::vector<double> &values,
+                                    const common::Volume &size,
+                                    const common::Volume &coarseSize);
+
+/**
+ * @brief Downsample the geometry image of the model by the given factor
+ *
+ * The physical size of the geometry is unchanged, and image-based initial
+ * concentrations are downsampled to the new geometry. Returns false if the
+ * geometry can't be coarsened, for example if a compartment or membrane would
+ * no longer be resolved, in which case the model should not be used.
+ */
+bool coarsenGeometry(sme::model::Model &model, std::size_t factor);
+
 double calculateCosts(const std::vector<OptCost> &optCosts,
                       const std::vector<std::size_t> &optCostIndices,
                       const sme::simulate::Simulation &sim,
                       std::vector<std::vector<double>> &currentTargets);
 
+/**
+ * @brief Gradient of calculateCosts with respect to the optimization parameters
+ *
+ * Uses the forward sensitivities of the simulation, and the values in
+ * `currentTargets` from the preceding call to calculateCosts.
+ * `sensitivityIndices[i]` is the sensitivity index of optimization parameter
+ * `i` in the simulation: the gradient is only calculated for parameters with
+ * a value.
+ */
+std::vector<double> calculateCostsGradient(
+    const std::vector<OptCost> &optCosts,
+    const std::vector<std::size_t> &optCostIndices,
+    const sme::simulate::Simulation &sim,
+    const std::vector<std::vector<double>> &currentTargets,
+    const std::vector<std::optional<std::size_t>> &sensitivityIndices);
+
 /**
  * @brief Implements a Pagmo User Defined Problem to evolve
  *
@@ -29,6 +79,20 @@ private:
   const OptConstData *m_optConstData{nullptr};
   ThreadsafeModelQueue *m_modelQueue{nullptr};
   sme::simulate::Optimization *m_optimization{nullptr};
+  enum class CostsStatus { Completed, ExceededCeiling, Stopped };
+  // if `useCostCeiling` is true, the simulation is stopped early once the
+  // partial cost exceeds the cost ceiling of the optimization
+  CostsStatus simulateCosts(const pagmo::vector_double &dv,
+                            std::shared_ptr<sme::model::Model> &model,
+                            std::shared_ptr<Simulation> &simulation,
+                            const std::vector<OptCost> &optCosts,
+                            bool useCostCeiling, double &cost,
+                            std::vector<std::vector<double>> &currentTargets,
+                            pagmo::vector_double *gradient) const;
+  // gradient elements that can't be calculated from the forward sensitivities
+  // are set to NaN
+  double evaluate(const pagmo::vector_double &dv,
+                  pagmo::vector_double *gradient) const;
 
 public:
   PagmoUDP() = default;
@@ -37,8 +101,40 @@ public:
                     Optimization *optimization);
   [[nodiscard]] pagmo::vector_double
   fitness(const pagmo::vector_double &dv) const;
+  /**
+   * @brief The fitness and its gradient with respect to the parameters
+   *
+   * Uses forward sensitivities where available, and forward finite
+   * differences otherwise.
+   */
+  [[nodiscard]] std::pair<double, pagmo::vector_double>
+  fitnessAndGradient(const pagmo::vector_double &dv) const;
   [[nodiscard]] std::pair<pagmo::vector_double, pagmo::vector_double>
   get_bounds() const;
 };
 
+/**
+ * @brief Implements a gradient-based Pagmo User Defined Algorithm
+ *
+ * Each call to `evolve()` does a local search from the best individual in the
+ * population using L-BFGS, with the search direction projected onto the
+ * parameter bounds. Requires the problem to be a PagmoUDP.
+ */
+class PagmoLBFGS {
+private:
+  std::size_t m_iterations{10};
+  std::size_t m_historySize{5};
+
+public:
+  PagmoLBFGS() = default;
+  explicit PagmoLBFGS(std::size_t iterations, std::size_t historySize = 5);
+  [[nodiscard]] pagmo::population evolve(pagmo::population pop) const;
+  [[nodiscard]] std::string get_name() const;
+  template <typename Archive> void serialize(Archive &ar, unsigned) {
+    pagmo::detail::archive(ar, m_iterations, m_historySize);
+  }
+};
+
 } // namespace sme::simulate
+
+PAGMO_S11N_ALGORITHM_EXPORT_KEY(sme::simulate::PagmoLBFGS)
@@ -5,6 +5,9 @@
 #include "sme/optimize.hpp"
 #include "sme/utils.hpp"
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
 
 using namespace sme;
 using namespace sme::test;
@@ -43,6 +46,97 @@ TEST_CASE("Optimize applyParameters: reaction parameters",
           dbl_approx(-99));
 }
 
+TEST_CASE("Optimize getParameterOverrides",
+          "[core/simulate/optimize][core/simulate][core][optimize]") {
+  std::vector<simulate::OptParam> optParams{
+      {simulate::OptParamType::ModelParameter, "name", "param", "", 0.66,
+       0.99},
+      {simulate::OptParamType::ReactionParameter, "name", "k1", "r1", 0.05,
+       0.21}};
+  auto overrides{simulate::getParameterOverrides({0.123, -99}, optParams)};
+  REQUIRE(overrides.size() == 2);
+  REQUIRE(overrides[0].id == "param");
+  REQUIRE(overrides[0].reactionId.empty());
+  REQUIRE(overrides[0].value == dbl_approx(0.123));
+  REQUIRE(overrides[1].id == "k1");
+  REQUIRE(overrides[1].reactionId == "r1");
+  REQUIRE(overrides[1].value == dbl_approx(-99));
+}
+
+TEST_CASE("Optimize downsampleArray",
+          "[core/simulate/optimize][core/simulate][core][optimize]") {
+  // 4x3x1 array
+  std::vector<double> values{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+  SECTION("same size") {
+    auto coarse{simulate::downsampleArray(values, {4, 3, 1}, {4, 3, 1})};
+    REQUIRE(coarse == values);
+  }
+  SECTION("2x1x1") {
+    // x: [0,1] -> 0, [2,3] -> 1, y: [0,1,2] -> 0
+    auto coarse{simulate::downsampleArray(values, {4, 3, 1}, {2, 1, 1})};
+    REQUIRE(coarse.size() == 2);
+    REQUIRE(coarse[0] == dbl_approx((1 + 2 + 5 + 6 + 9 + 10) / 6.0));
+    REQUIRE(coarse[1] == dbl_approx((3 + 4 + 7 + 8 + 11 + 12) / 6.0));
+  }
+  SECTION("2x2x1") {
+    // x: [0,1] -> 0, [2,3] -> 1, y: [0,1] -> 0, [2] -> 1
+    auto coarse{simulate::downsampleArray(values, {4, 3, 1}, {2, 2, 1})};
+    REQUIRE(coarse.size() == 4);
+    REQUIRE(coarse[0] == dbl_approx((1 + 2 + 5 + 6) / 4.0));
+    REQUIRE(coarse[1] == dbl_approx((3 + 4 + 7 + 8) / 4.0));
+    REQUIRE(coarse[2] == dbl_approx((9 + 10) / 2.0));
+    REQUIRE(coarse[3] == dbl_approx((11 + 12) / 2.0));
+  }
+  SECTION("depth > 1") {
+    // 2x3x2 array: each z layer is downsampled separately
+    std::vector<double> values3d{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    auto coarse{simulate::downsampleArray(values3d, {2, 3, 2}, {1, 2, 2})};
+    REQUIRE(coarse.size() == 4);
+    // z = 0, y: [0,1] -> 0, [2] -> 1
+    REQUIRE(coarse[0] == dbl_approx((1 + 2 + 3 + 4) / 4.0));
+    REQUIRE(coarse[1] == dbl_approx((5 + 6) / 2.0));
+    // z = 1
+    REQUIRE(coarse[2] == dbl_approx((7 + 8 + 9 + 10) / 4.0));
+    REQUIRE(coarse[3] == dbl_approx((11 + 12) / 2.0));
+  }
+  SECTION("size mismatch") {
+    // a single z layer of a 3d image
+    REQUIRE_THROWS(simulate::downsampleArray(values, {4, 3, 2}, {2, 1, 2}));
+  }
+}
+
+TEST_CASE("Optimize coarsenGeometry",
+          "[core/simulate/optimize][core/simulate][core][optimize]") {
+  auto model{getExampleModel(Mod::ABtoC)};
+  const auto &geometry{model.getGeometry()};
+  REQUIRE(geometry.getImages().volume() == common::Volume{100, 100, 1});
+  SECTION("factor of one: no change") {
+    REQUIRE(simulate::coarsenGeometry(model, 1) == false);
+    REQUIRE(geometry.getImages().volume() == common::Volume{100, 100, 1});
+  }
+  SECTION("factor of two") {
+    REQUIRE(simulate::coarsenGeometry(model, 2) == true);
+    REQUIRE(geometry.getImages().volume() == common::Volume{50, 50, 1});
+    REQUIRE(geometry.getIsValid());
+    // physical size of geometry is unchanged
+    REQUIRE(geometry.getVoxelSize().width() == dbl_approx(2.0));
+    REQUIRE(geometry.getVoxelSize().height() == dbl_approx(2.0));
+    REQUIRE(geometry.getVoxelSize().depth() == dbl_approx(1.0));
+    REQUIRE(geometry.getPhysicalSize().width() == dbl_approx(100.0));
+    REQUIRE(geometry.getPhysicalSize().height() == dbl_approx(100.0));
+    // compartment volume is approximately the same
+    REQUIRE(model.getCompartments().getSize("comp") ==
+            dbl_approx(3149 * 1000).epsilon(0.1));
+    // coarse model can be simulated
+    model.getSimulationSettings().simulatorType =
+        simulate::SimulatorType::Pixel;
+    simulate::Simulation sim(model);
+    sim.doTimesteps(0.1);
+    REQUIRE(sim.errorMessage().empty());
+    REQUIRE(sim.getConcArray(1, 0, 0).size() == 50 * 50);
+  }
+}
+
 TEST_CASE("Optimize calculateCosts: zero or no target values",
           "[core/simulate/optimize][core/simulate][core][optimize]") {
   auto model{getExampleModel(Mod::ABtoC)};
@@ -333,3 +427,164 @@ TEST_CASE("Optimize calculateCosts: invalid target values",
   REQUIRE_THROWS(
       simulate::calculateCosts({optCostInvalid}, {0}, sim, currentTargets));
 }
+
+TEST_CASE("Optimize calculateCostsGradient: matches finite differences",
+          "[core/simulate/optimize][core/simulate][core][optimize]") {
+  auto makeModel = [](double k1) {
+    auto m{getExampleModel(Mod::ABtoC)};
+    m.getSimulationSettings().simulatorType =
+        sme::simulate::SimulatorType::Pixel;
+    m.getSpecies().setInitialConcentration("A", 1.0);
+    auto &options{m.getSimulationSettings().options.pixel};
+    options.integrator = simulate::PixelIntegratorType::RK435;
+    options.maxErr.rel = 1e-6;
+    options.enableRuntimeParameters = true;
+    options.enableSensitivities = true;
+    // sensitivities are calculated for the optimization parameters
+    m.getOptimizeOptions().optParams.push_back(
+        {simulate::OptParamType::ReactionParameter, "name", "k1", "r1", 0.05,
+         0.21});
+    m.getReactions().setParameterValue("r1", "k1", k1);
+    return m;
+  };
+  // cost: absolute concentration of species C
+  simulate::OptCost optCostC{};
+  optCostC.optCostType = simulate::OptCostType::Concentration;
+  optCostC.optCostDiffType = simulate::OptCostDiffType::Absolute;
+  optCostC.id = "C";
+  optCostC.weight = 0.7;
+  optCostC.compartmentIndex = 0;
+  optCostC.speciesIndex = 2;
+  // cost: relative difference of species A from a target that is larger than
+  // its concentration everywhere
+  simulate::OptCost optCostA{};
+  optCostA.optCostType = simulate::OptCostType::Concentration;
+  optCostA.optCostDiffType = simulate::OptCostDiffType::Relative;
+  optCostA.id = "A";
+  optCostA.weight = 1.3;
+  optCostA.compartmentIndex = 0;
+  optCostA.speciesIndex = 0;
+  optCostA.epsilon = 1e-3;
+  std::vector<simulate::OptCost> optCosts{optCostC, optCostA};
+  std::vector<std::size_t> optCostIndices{0, 1};
+  constexpr double k1{0.1};
+  constexpr double h{1e-3};
+  constexpr double t{0.5};
+  auto m{makeModel(k1)};
+  optCosts[1].targetValues = std::vector<double>(
+      m.getSpecies().getField("A")->getConcentrationImageArray().size(), 2.0);
+  simulate::Simulation sim(m);
+  sim.doMultipleTimesteps({{1, t}});
+  REQUIRE(sim.errorMessage().empty());
+  std::vector<std::vector<double>> currentTargets(2);
+  auto cost{
+      simulate::calculateCosts(optCosts, optCostIndices, sim, currentTargets)};
+  auto index{sim.getSensitivityParameterIndex("k1", "r1")};
+  REQUIRE(index.has_value());
+  auto gradient{simulate::calculateCostsGradient(
+      optCosts, optCostIndices, sim, currentTargets, {index, std::nullopt})};
+  REQUIRE(gradient.size() == 2);
+  // no gradient for a parameter without a sensitivity
+  REQUIRE(gradient[1] == 0.0);
+  // central difference of the cost with respect to k1
+  std::vector<double> costSteps;
+  for (double k1Step : {k1 + h, k1 - h}) {
+    auto mStep{makeModel(k1Step)};
+    simulate::Simulation simStep(mStep);
+    simStep.doMultipleTimesteps({{1, t}});
+    REQUIRE(simStep.errorMessage().empty());
+    costSteps.push_back(simulate::calculateCosts(optCosts, optCostIndices,
+                                                 simStep, currentTargets));
+  }
+  double finiteDifference{(costSteps[0] - costSteps[1]) / (2.0 * h)};
+  CAPTURE(cost);
+  CAPTURE(costSteps);
+  REQUIRE(std::abs(finiteDifference) > 0.0);
+  REQUIRE(gradient[0] == Catch::Approx(finiteDifference).epsilon(1e-2));
+}
+
+TEST_CASE("Optimize PagmoUDP: stop evaluation that exceeds the cost ceiling",
+          "[core/simulate/optimize][core/simulate][core][optimize]") {
+  auto model{getExampleModel(Mod::ABtoC)};
+  model.getSimulationSettings().simulatorType =
+      sme::simulate::SimulatorType::Pixel;
+  // target: concentration of A at t=1 and t=2 with k1 = 0.1
+  std::vector<double> target1;
+  std::vector<double> target2;
+  {
+    simulate::Simulation sim(model);
+    sim.doMultipleTimesteps({{2, 1.0}});
+    REQUIRE(sim.errorMessage().empty());
+    target1 = sim.getConcArray(1, 0, 0);
+    target2 = sim.getConcArray(2, 0, 0);
+  }
+  model.getSimulationData().clear();
+  simulate::OptimizeOptions optimizeOptions;
+  optimizeOptions.optAlgorithm.optAlgorithmType =
+      simulate::OptAlgorithmType::PSO;
+  optimizeOptions.optAlgorithm.islands = 1;
+  optimizeOptions.optAlgorithm.population = 2;
+  optimizeOptions.optParams.push_back(
+      {simulate::OptParamType::ReactionParameter, "name", "k1", "r1", 0.05,
+       0.21});
+  optimizeOptions.optCosts.push_back({simulate::OptCostType::Concentration,
+                                      simulate::OptCostDiffType::Absolute,
+                                      "name",
+                                      "A",
+                                      1.0,
+                                      1.0,
+                                      0,
+                                      0,
+                                      target1});
+  optimizeOptions.optCosts.push_back({simulate::OptCostType::Concentration,
+                                      simulate::OptCostDiffType::Absolute,
+                                      "name",
+                                      "A",
+                                      2.0,
+                                      1.0,
+                                      0,
+                                      0,
+                                      target2});
+  model.getOptimizeOptions() = optimizeOptions;
+  simulate::OptConstData optConstData;
+  optConstData.xmlModel = model.getXml().toStdString();
+  optConstData.optimizeOptions = optimizeOptions;
+  optConstData.optTimesteps = {{1.0, {0}}, {1.0, {1}}};
+  optConstData.imageSize = model.getGeometry().getImages().volume();
+  // the same costs, but only up to t=1
+  auto optConstDataFirstTimestep{optConstData};
+  optConstDataFirstTimestep.optTimesteps.pop_back();
+  // an optimization with a population, and so a finite cost ceiling
+  simulate::Optimization optimization(model);
+  optimization.evolve();
+  REQUIRE(optimization.getErrorMessage().empty());
+  const auto ceiling{optimization.getCostCeiling()};
+  REQUIRE(ceiling < std::numeric_limits<double>::max());
+  // an optimization without a population has no cost ceiling
+  simulate::Optimization optimizationNoCeiling(model);
+  REQUIRE(optimizationNoCeiling.getCostCeiling() ==
+          std::numeric_limits<double>::max());
+  // a candidate with a large k1 is far from both targets
+  const std::vector<double> dv{10.0};
+  const auto nEvaluations{optimization.getEvaluations().size()};
+  const auto bestFitness{optimization.getBestResultsFitness()};
+  simulate::PagmoUDP udp(&optConstData, nullptr, &optimization);
+  auto partialCost{udp.fitness(dv)[0]};
+  CAPTURE(ceiling);
+  CAPTURE(partialCost);
+  // the simulation was stopped after the first timestep, and the partial cost
+  // up to that point was returned
+  REQUIRE(partialCost > ceiling);
+  simulate::PagmoUDP udpFirstTimestep(&optConstDataFirstTimestep, nullptr,
+                                      &optimizationNoCeiling);
+  REQUIRE(partialCost == dbl_approx(udpFirstTimestep.fitness(dv)[0]));
+  simulate::PagmoUDP udpNoCeiling(&optConstData, nullptr,
+                                  &optimizationNoCeiling);
+  REQUIRE(partialCost < udpNoCeiling.fitness(dv)[0]);
+  // the partial cost is recorded, but is not a best result
+  auto evaluations{optimization.getEvaluations()};
+  REQUIRE(evaluations.size() == nEvaluations + 1);
+  REQUIRE(evaluations.back().params == dv);
+  REQUIRE(evaluations.back().cost == dbl_approx(partialCost));
+  REQUIRE(optimization.getBestResultsFitness() == bestFitness);
+}
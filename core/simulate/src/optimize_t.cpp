@@ -3,6 +3,9 @@
 #include "qt_test_utils.hpp"
 #include "sme/model.hpp"
 #include "sme/optimize.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 using namespace sme;
 using namespace sme::test;
@@ -204,12 +207,18 @@ TEST_CASE("Optimize ABtoC model for zero concentration of C",
                                       {}});
   model.getOptimizeOptions() = optimizeOptions;
   sme::simulate::Optimization optimization(model);
+  // no cost ceiling until there is a population
+  REQUIRE(optimization.getCostCeiling() ==
+          std::numeric_limits<double>::max());
   for (std::size_t i = 1; i < 3; ++i) {
     optimization.evolve();
     REQUIRE(optimization.getErrorMessage().empty());
     REQUIRE(optimization.getIterations() == i);
     // cost should decrease or stay the same with each iteration
     REQUIRE(is_sorted_descending(optimization.getFitness()));
+    // cost ceiling is the worst fitness in the population
+    REQUIRE(optimization.getCostCeiling() >= optimization.getFitness().back());
+    REQUIRE(optimization.getCostCeiling() < std::numeric_limits<double>::max());
     // k1 should decrease to minimize concentration of C
     std::vector<double> k1;
     for (const auto &param : optimization.getParams()) {
@@ -224,6 +233,207 @@ TEST_CASE("Optimize ABtoC model for zero concentration of C",
           dbl_approx(optimization.getParams().back()[0]));
 }
 
+TEST_CASE("Optimize ABtoC model with L-BFGS converges to target parameter",
+          "[core/simulate/optimize][core/simulate][core][optimize]") {
+  auto model{getExampleModel(Mod::ABtoC)};
+  model.getSimulationSettings().simulatorType =
+      sme::simulate::SimulatorType::Pixel;
+  // target: concentration of C after simulating for time 1 with k1 = 0.15
+  constexpr double k1Target{0.15};
+  model.getReactions().setParameterValue("r1", "k1", k1Target);
+  std::vector<double> target;
+  {
+    sme::simulate::Simulation sim(model);
+    sim.doMultipleTimesteps({{1, 1.0}});
+    REQUIRE(sim.errorMessage().empty());
+    target = sim.getConcArray(1, 0, 2);
+  }
+  model.getSimulationData().clear();
+  model.getReactions().setParameterValue("r1", "k1", 0.1);
+  sme::simulate::OptimizeOptions optimizeOptions;
+  optimizeOptions.optAlgorithm.optAlgorithmType =
+      sme::simulate::OptAlgorithmType::LBFGS;
+  optimizeOptions.optAlgorithm.islands = 1;
+  optimizeOptions.optAlgorithm.population = 2;
+  optimizeOptions.optParams.push_back(
+      {sme::simulate::OptParamType::ReactionParameter, "name", "k1", "r1", 0.05,
+       0.21});
+  optimizeOptions.optCosts.push_back({sme::simulate::OptCostType::Concentration,
+                                      simulate::OptCostDiffType::Absolute,
+                                      "name",
+                                      "C",
+                                      1.0,
+                                      1.0,
+                                      0,
+                                      2,
+                                      target});
+  model.getOptimizeOptions() = optimizeOptions;
+  sme::simulate::Optimization optimization(model);
+  for (std::size_t i = 1; i < 4; ++i) {
+    optimization.evolve();
+    REQUIRE(optimization.getErrorMessage().empty());
+    REQUIRE(optimization.getIterations() == i);
+    REQUIRE(is_sorted_descending(optimization.getFitness()));
+  }
+  // the exact gradient leads to the target parameter in a few iterations,
+  // wherever in the bounds the initial population is
+  CAPTURE(optimization.getFitness());
+  REQUIRE(optimization.getParams().back()[0] ==
+          Catch::Approx(k1Target).epsilon(1e-2));
+}
+
+TEST_CASE("Optimize ABtoC model with coarse geometry screening",
+          "[core/simulate/optimize][core/simulate][core][optimize]") {
+  auto model{getExampleModel(Mod::ABtoC)};
+  model.getSimulationSettings().simulatorType =
+      sme::simulate::SimulatorType::Pixel;
+  sme::simulate::OptimizeOptions optimizeOptions;
+  optimizeOptions.optAlgorithm.islands = 1;
+  optimizeOptions.optAlgorithm.population = 4;
+  optimizeOptions.optParams.push_back(
+      {sme::simulate::OptParamType::ReactionParameter, "name", "k1", "r1", 0.02,
+       0.88});
+  optimizeOptions.optCosts.push_back({sme::simulate::OptCostType::Concentration,
+                                      simulate::OptCostDiffType::Absolute,
+                                      "name",
+                                      "C",
+                                      1.0,
+                                      0.23,
+                                      0,
+                                      2,
+                                      {}});
+  optimizeOptions.coarseGeometryFactor = 2;
+  optimizeOptions.screeningThreshold = 1.0;
+  model.getOptimizeOptions() = optimizeOptions;
+  sme::simulate::Optimization optimization(model);
+  for (std::size_t i = 1; i < 3; ++i) {
+    optimization.evolve();
+    REQUIRE(optimization.getErrorMessage().empty());
+    REQUIRE(optimization.getIterations() == i);
+    REQUIRE(is_sorted_descending(optimization.getFitness()));
+  }
+  // every candidate is screened, and the best result is at full resolution
+  auto screeningCosts{optimization.getScreeningCosts()};
+  REQUIRE(!screeningCosts.empty());
+  REQUIRE(std::ranges::any_of(screeningCosts, [](const auto &costs) {
+    return !std::isnan(costs.fullCost);
+  }));
+  for (const auto &costs : screeningCosts) {
+    REQUIRE(costs.coarseCost >= 0.0);
+  }
+  REQUIRE(optimization.getFitness().back() ==
+          dbl_approx(optimization.getBestResultsFitness()));
+  auto img{optimization.getUpdatedBestResultImage(0)};
+  REQUIRE(img.has_value());
+  REQUIRE(img->volume() == sme::common::Volume{100, 100, 1});
+}
+
+TEST_CASE("Optimize ABtoC model and resume from a checkpoint",
+          "[core/simulate/optimize][core/simulate][core][optimize]") {
+  auto model{getExampleModel(Mod::ABtoC)};
+  model.getSimulationSettings().simulatorType =
+      sme::simulate::SimulatorType::Pixel;
+  sme::simulate::OptimizeOptions optimizeOptions;
+  optimizeOptions.optAlgorithm.islands = 2;
+  optimizeOptions.optAlgorithm.population = 3;
+  optimizeOptions.optParams.push_back(
+      {sme::simulate::OptParamType::ReactionParameter, "name", "k1", "r1", 0.02,
+       0.88});
+  optimizeOptions.optCosts.push_back({sme::simulate::OptCostType::Concentration,
+                                      simulate::OptCostDiffType::Absolute,
+                                      "name",
+                                      "C",
+                                      1.0,
+                                      0.23,
+                                      0,
+                                      2,
+                                      {}});
+  model.getOptimizeOptions() = optimizeOptions;
+  const std::string evaluationLog{
+      simulate::getOptEvaluationLogFilename("tmpoptresume.bin")};
+  sme::simulate::Optimization optimization(model, evaluationLog);
+  optimization.evolve();
+  REQUIRE(optimization.getErrorMessage().empty());
+  // every fitness evaluation is recorded in the log
+  auto evaluations{optimization.getEvaluations()};
+  REQUIRE(evaluations.size() >= 2 * 3);
+  for (const auto &evaluation : evaluations) {
+    REQUIRE(evaluation.params.size() == 1);
+    REQUIRE(evaluation.params[0] >= 0.02);
+    REQUIRE(evaluation.params[0] <= 0.88);
+  }
+  auto checkpoint{optimization.getCheckpoint()};
+  REQUIRE(checkpoint.islands.size() == 2);
+  REQUIRE(checkpoint.islands[0].params.size() == 3);
+  REQUIRE(checkpoint.islands[0].fitness.size() == 3);
+  REQUIRE(!checkpoint.islands[0].algorithm.empty());
+  REQUIRE(checkpoint.nIterations == 1);
+  REQUIRE(checkpoint.bestFitness == optimization.getFitness());
+  REQUIRE(checkpoint.nEvaluations == evaluations.size());
+  REQUIRE(simulate::exportOptimizationCheckpoint("tmpoptresume.bin",
+                                                 checkpoint));
+  auto imported{simulate::importOptimizationCheckpoint("tmpoptresume.bin")};
+  REQUIRE(imported != nullptr);
+  SECTION("resume") {
+    // evaluations after the checkpoint are removed from the log on resuming
+    optimization.addEvaluation({0.5}, 1.0);
+    REQUIRE(optimization.getEvaluations().size() == evaluations.size() + 1);
+    sme::simulate::Optimization resumed(model, *imported, evaluationLog);
+    REQUIRE(resumed.getErrorMessage().empty());
+    REQUIRE(resumed.getIterations() == 1);
+    REQUIRE(resumed.getFitness() == optimization.getFitness());
+    REQUIRE(resumed.getParams() == optimization.getParams());
+    REQUIRE(resumed.getEvaluations().size() == evaluations.size());
+    // checkpoint is unchanged until evolve is called
+    REQUIRE(resumed.getCheckpoint().islands[1].params ==
+            checkpoint.islands[1].params);
+    resumed.evolve();
+    REQUIRE(resumed.getErrorMessage().empty());
+    REQUIRE(resumed.getIterations() == 2);
+    REQUIRE(resumed.getFitness().size() == 3);
+    REQUIRE(is_sorted_descending(resumed.getFitness()));
+    auto resumedEvaluations{resumed.getEvaluations()};
+    REQUIRE(resumedEvaluations.size() > evaluations.size());
+    for (std::size_t i = 0; i < evaluations.size(); ++i) {
+      REQUIRE(resumedEvaluations[i].params == evaluations[i].params);
+      REQUIRE(resumedEvaluations[i].cost == evaluations[i].cost);
+    }
+  }
+  SECTION("resume gives the same results as an uninterrupted optimization") {
+    // the algorithm state is restored, so the resumed optimization does the
+    // same iteration as the original one
+    sme::simulate::Optimization resumed(model, *imported);
+    REQUIRE(resumed.getErrorMessage().empty());
+    optimization.evolve();
+    resumed.evolve();
+    REQUIRE(resumed.getErrorMessage().empty());
+    REQUIRE(resumed.getFitness() == optimization.getFitness());
+    REQUIRE(resumed.getParams() == optimization.getParams());
+    auto resumedCheckpoint{resumed.getCheckpoint()};
+    auto uninterruptedCheckpoint{optimization.getCheckpoint()};
+    for (std::size_t i = 0; i < 2; ++i) {
+      REQUIRE(resumedCheckpoint.islands[i].params ==
+              uninterruptedCheckpoint.islands[i].params);
+      REQUIRE(resumedCheckpoint.islands[i].fitness ==
+              uninterruptedCheckpoint.islands[i].fitness);
+    }
+  }
+  SECTION("evaluation log is missing evaluations") {
+    sme::simulate::Optimization newOptimization(model, evaluationLog);
+    sme::simulate::Optimization resumed(model, *imported, evaluationLog);
+    REQUIRE(!resumed.getErrorMessage().empty());
+    REQUIRE(resumed.evolve() == 0);
+  }
+  SECTION("checkpoint doesn't match optimization parameters") {
+    model.getOptimizeOptions().optParams.push_back(
+        {sme::simulate::OptParamType::ReactionParameter, "name", "k1", "r1",
+         0.02, 0.88});
+    sme::simulate::Optimization resumed(model, *imported);
+    REQUIRE(!resumed.getErrorMessage().empty());
+    REQUIRE(resumed.evolve() == 0);
+  }
+}
+
 TEST_CASE("setBestResults and getUpdatedBestResultImage",
           "[core/simulate/optimize][core/simulate][core][optimize]") {
   auto model{getExampleModel(Mod::ABtoC)};
@@ -23,7 +23,8 @@ Pde::Pde(const model::Model *doc_ptr,
          const PdeScaleFactors &pdeScaleFactors,
          const std::vector<std::string> &extraVariables,
          const std::vector<std::string> &relabelledExtraVariables,
-         const std::map<std::string, double, std::less<>> &substitutions) {
+         const std::map<std::string, double, std::less<>> &substitutions,
+         const std::vector<RuntimeParameter> &runtimeParameters) {
   bool relabel{!relabelledSpeciesIDs.empty() ||
                !relabelledExtraVariables.empty()};
   if (relabel && relabelledSpeciesIDs.size() != speciesIDs.size()) {
@@ -43,6 +44,16 @@ Pde::Pde(const model::Model *doc_ptr,
   // construct reaction expressions and stoich matrix
   Reaction reactions(doc_ptr, speciesIDs, reactionIDs);
 
+  // runtime parameters are not rescaled, and are never relabelled
+  std::vector<std::string> parameterVariables;
+  for (const auto &p : runtimeParameters) {
+    parameterVariables.push_back(p.variable);
+  }
+  auto unscaledVariables{extraVariables};
+  unscaledVariables.insert(unscaledVariables.end(),
+                           parameterVariables.cbegin(),
+                           parameterVariables.cend());
+
   // construct symbolic expressions: one rhs + Jacobian for each species
   rhs.clear();
   jacobian.clear();
@@ -51,6 +62,8 @@ Pde::Pde(const model::Model *doc_ptr,
     QString r("0.0");
     auto vars{reactions.getSpeciesIDs()};
     vars.insert(vars.end(), extraVariables.cbegin(), extraVariables.cend());
+    vars.insert(vars.end(), parameterVariables.cbegin(),
+                parameterVariables.cend());
     for (std::size_t j = 0; j < reactions.size(); ++j) {
       // get reaction term
       QString expr =
@@ -72,12 +85,26 @@ Pde::Pde(const model::Model *doc_ptr,
           }
         }
       }
+      // runtime parameters are variables instead of constants: parse them
+      // with their own ids, then relabel them to their variable names
+      auto termVars{vars};
+      auto relabelledTermVars{vars};
+      for (const auto *p : getReactionRuntimeParameters(
+               doc_ptr, reactions.getReactionId(j), runtimeParameters)) {
+        std::erase_if(constants,
+                      [p](const auto &c) { return c.first == p->id; });
+        termVars.push_back(p->id);
+        relabelledTermVars.push_back(p->variable);
+      }
       // parse and inline constants & function calls
-      common::Symbolic sym(expr.toStdString(), vars, constants,
+      common::Symbolic sym(expr.toStdString(), termVars, constants,
                            doc_ptr->getFunctions().getSymbolicFunctions());
       if (!sym.isValid()) {
         throw PdeError(sym.getErrorMessage());
       }
+      if (termVars.size() > vars.size()) {
+        sym.relabel(relabelledTermVars);
+      }
       // add term to rhs
       r.append(QString(" + (%1)").arg(sym.inlinedExpr().c_str()));
     }
@@ -90,7 +117,7 @@ Pde::Pde(const model::Model *doc_ptr,
     }
     // rescale species (but not the extra variables)
     SPDLOG_DEBUG("rescaling species");
-    sym.rescale(pdeScaleFactors.species, extraVariables);
+    sym.rescale(pdeScaleFactors.species, unscaledVariables);
     auto outputSpecies = speciesIDs;
     if (relabel) {
       SPDLOG_DEBUG("re-labelling species");
@@ -98,7 +125,10 @@ Pde::Pde(const model::Model *doc_ptr,
       outputSpecies.insert(outputSpecies.end(),
                            relabelledExtraVariables.cbegin(),
                            relabelledExtraVariables.cend());
-      sym.relabel(outputSpecies);
+      auto relabelledVars{outputSpecies};
+      relabelledVars.insert(relabelledVars.end(), parameterVariables.cbegin(),
+                            parameterVariables.cend());
+      sym.relabel(relabelledVars);
     }
     for (const auto &s : outputSpecies) {
       jacobian.back().push_back(sym.diff(s));
@@ -150,6 +180,10 @@ Reaction::getStoichMatrixRow(const model::Model *doc,
 
 std::size_t Reaction::size() const { return expressions.size(); }
 
+const std::string &Reaction::getReactionId(std::size_t reactionIndex) const {
+  return reactionIDs.at(reactionIndex);
+}
+
 const std::string &Reaction::getExpression(std::size_t reactionIndex) const {
   return expressions.at(reactionIndex);
 }
@@ -181,6 +215,7 @@ Reaction::Reaction(const model::Model *doc, std::vector<std::string> species,
       // insert it into the M matrix, and construct the corresponding
       // reaction term
       M.push_back(row);
+      reactionIDs.push_back(reacID);
 
       // get local parameters, append to global constants
       constants.emplace_back();
@@ -206,4 +241,21 @@ Reaction::Reaction(const model::Model *doc, std::vector<std::string> species,
   }
 }
 
+std::vector<const RuntimeParameter *>
+getReactionRuntimeParameters(const model::Model *doc,
+                             const std::string &reactionId,
+                             const std::vector<RuntimeParameter> &parameters) {
+  std::vector<const RuntimeParameter *> reactionParameters;
+  const auto localIds{common::toStdString(
+      doc->getReactions().getParameterIds(reactionId.c_str()))};
+  for (const auto &p : parameters) {
+    if (p.reactionId.empty()
+            ? std::ranges::find(localIds, p.id) == localIds.cend()
+            : p.reactionId == reactionId) {
+      reactionParameters.push_back(&p);
+    }
+  }
+  return reactionParameters;
+}
+
 } // namespace sme::simulate
@@ -12,16 +12,24 @@
 #include <cmath>
 #include <cstdlib>
 #include <memory>
+#include <optional>
 #include <oneapi/tbb/global_control.h>
 #include <oneapi/tbb/info.h>
 #include <utility>
 
 namespace sme::simulate {
 
-void PixelSim::calculateDcdt() {
+void PixelSim::calculateDcdt(bool includeDiffusion) {
   // calculate dcd/dt in all compartments
-  for (auto &sim : simCompartments) {
-    if (useTBB) {
+  for (auto *sim : unfusedCompartments) {
+    // with operator splitting diffusion is applied separately
+    if (!includeDiffusion || useOperatorSplitting) {
+      if (useTBB) {
+        sim->evaluateReactions_tbb();
+      } else {
+        sim->evaluateReactions();
+      }
+    } else if (useTBB) {
       sim->evaluateReactionsAndDiffusion_tbb();
     } else {
       sim->evaluateReactionsAndDiffusion();
@@ -29,17 +37,41 @@ void PixelSim::calculateDcdt() {
   }
   // membrane contribution to dc/dt
   for (auto &sim : simMembranes) {
-    sim->evaluateReactions();
+    if (useTBB) {
+      sim->evaluateReactions_tbb();
+    } else {
+      sim->evaluateReactions();
+    }
   }
-  for (auto &sim : simCompartments) {
-    sim->spatiallyAverageDcdt();
+  for (auto *sim : unfusedCompartments) {
+    if (useTBB) {
+      sim->spatiallyAverageDcdt_tbb();
+    } else {
+      sim->spatiallyAverageDcdt();
+    }
+  }
+}
+
+PixelIntegratorError PixelSim::doFusedRKSubstep(const FusedRKStage &stage) {
+  PixelIntegratorError err{0.0, 0.0};
+  for (auto *sim : fusedCompartments) {
+    PixelIntegratorError compErr;
+    if (useTBB) {
+      compErr = sim->doFusedRKSubstep_tbb(stage);
+    } else {
+      compErr = sim->doFusedRKSubstep(stage);
+    }
+    err.rel = std::max(err.rel, compErr.rel);
+    err.abs = std::max(err.abs, compErr.abs);
   }
+  return err;
 }
 
 void PixelSim::doRK101(double dt) {
   // RK1(0)1: Forwards Euler, no error estimate
+  doFusedRKSubstep({.type = FusedRKStage::Type::ForwardsEuler, .dt = dt});
   calculateDcdt();
-  for (auto &sim : simCompartments) {
+  for (auto *sim : unfusedCompartments) {
     if (useTBB) {
       sim->doForwardsEulerTimestep_tbb(dt);
     } else {
@@ -48,29 +80,35 @@ void PixelSim::doRK101(double dt) {
   }
 }
 
-void PixelSim::doRK212(double dt) {
+PixelIntegratorError PixelSim::doRK212(double dt) {
   // RK2(1)2: Heun / Modified Euler, with embedded forwards Euler error
   // estimate Shu-Osher form used here taken from eq(2.15) of
   // https://doi.org/10.1016/0021-9991(88)90177-5
+  doFusedRKSubstep({.type = FusedRKStage::Type::RK212Substep1, .dt = dt});
   calculateDcdt();
-  for (auto &sim : simCompartments) {
+  for (auto *sim : unfusedCompartments) {
     if (useTBB) {
       sim->doRK212Substep1_tbb(dt);
     } else {
       sim->doRK212Substep1(dt);
     }
   }
+  auto err{doFusedRKSubstep({.type = FusedRKStage::Type::RK212Substep2,
+                             .dt = dt,
+                             .calculateError = true,
+                             .epsilon = epsilon})};
   calculateDcdt();
-  for (auto &sim : simCompartments) {
+  for (auto *sim : unfusedCompartments) {
     if (useTBB) {
       sim->doRK212Substep2_tbb(dt);
     } else {
       sim->doRK212Substep2(dt);
     }
   }
+  return err;
 }
 
-void PixelSim::doRK323(double dt) {
+PixelIntegratorError PixelSim::doRK323(double dt) {
   // RK3(2)3: Shu Osher method with embedded Heun error estimate
   // Taken from eq(2.18) of
   // https://doi.org/10.1016/0021-9991(88)90177-5
@@ -79,18 +117,36 @@ void PixelSim::doRK323(double dt) {
   constexpr std::array<double, 3> g3{0.0, 0.75, 0.333333333333333333333};
   constexpr std::array<double, 3> beta{1.0, 0.25, 0.6666666666666666666};
   constexpr std::array<double, 3> delta{0.0, 0.0, 1.0};
-  for (auto &sim : simCompartments) {
+  constexpr std::array<double, 3> finalise{0.0, 2.0, -1.0};
+  PixelIntegratorError err{0.0, 0.0};
+  for (auto *sim : unfusedCompartments) {
     sim->doRKInit();
   }
   for (std::size_t i = 0; i < 3; ++i) {
+    bool lastStage{i + 1 == 3};
+    err = doFusedRKSubstep({.type = FusedRKStage::Type::ShuOsher,
+                            .dt = dt,
+                            .g1 = g1[i],
+                            .g2 = g2[i],
+                            .g3 = g3[i],
+                            .beta = beta[i],
+                            .delta = delta[i],
+                            .init = i == 0,
+                            .finalise = lastStage,
+                            .cFactor = finalise[0],
+                            .s2Factor = finalise[1],
+                            .s3Factor = finalise[2],
+                            .calculateError = lastStage,
+                            .epsilon = epsilon});
     doRKSubstep(dt, g1[i], g2[i], g3[i], beta[i], delta[i]);
   }
-  for (auto &sim : simCompartments) {
-    sim->doRKFinalise(0.0, 2.0, -1.0);
+  for (auto *sim : unfusedCompartments) {
+    sim->doRKFinalise(finalise[0], finalise[1], finalise[2]);
   }
+  return err;
 }
 
-void PixelSim::doRK435(double dt) {
+PixelIntegratorError PixelSim::doRK435(double dt) {
   // RK4(3)5: 3S* algorithm 6 (see also table 6)
   // https://doi.org/10.1016/j.jcp.2009.11.006
   // 5 stage RK4 with embedded RK3 error estimate
@@ -111,21 +167,40 @@ void PixelSim::doRK435(double dt) {
                                         -0.655568367959557,
                                         -0.194421504490852};
   double deltaSum = 1.0 / common::sum(delta);
-  for (auto &sim : simCompartments) {
+  const std::array<double, 3> finalise{deltaSum * delta[5], deltaSum,
+                                       deltaSum * delta[6]};
+  PixelIntegratorError err{0.0, 0.0};
+  for (auto *sim : unfusedCompartments) {
     sim->doRKInit();
   }
   for (std::size_t i = 0; i < 5; ++i) {
+    bool lastStage{i + 1 == 5};
+    err = doFusedRKSubstep({.type = FusedRKStage::Type::ShuOsher,
+                            .dt = dt,
+                            .g1 = g1[i],
+                            .g2 = g2[i],
+                            .g3 = g3[i],
+                            .beta = beta[i],
+                            .delta = delta[i],
+                            .init = i == 0,
+                            .finalise = lastStage,
+                            .cFactor = finalise[0],
+                            .s2Factor = finalise[1],
+                            .s3Factor = finalise[2],
+                            .calculateError = lastStage,
+                            .epsilon = epsilon});
     doRKSubstep(dt, g1[i], g2[i], g3[i], beta[i], delta[i]);
   }
-  for (auto &sim : simCompartments) {
-    sim->doRKFinalise(deltaSum * delta[5], deltaSum, deltaSum * delta[6]);
+  for (auto *sim : unfusedCompartments) {
+    sim->doRKFinalise(finalise[0], finalise[1], finalise[2]);
   }
+  return err;
 }
 
 void PixelSim::doRKSubstep(double dt, double g1, double g2, double g3,
                            double beta, double delta) {
   calculateDcdt();
-  for (auto &sim : simCompartments) {
+  for (auto *sim : unfusedCompartments) {
     if (useTBB) {
       sim->doRKSubstep_tbb(dt, g1, g2, g3, beta, delta);
     } else {
@@ -134,9 +209,86 @@ void PixelSim::doRKSubstep(double dt, double g1, double g2, double g3,
   }
 }
 
+bool PixelSim::doIMEX(double dt) {
+  // IMEX: diffusion is treated implicitly, so the timestep is not limited by
+  // the diffusion stability bound, and reactions explicitly. The first stage
+  // is first order (backwards Euler diffusion, forwards Euler reactions), the
+  // second is second order (Crank-Nicolson diffusion, Heun reactions), and
+  // the difference between them is used as the error estimate, so that both
+  // the diffusion and reaction errors are controlled
+  bool converged{true};
+  calculateDcdt(false);
+  for (auto *sim : unfusedCompartments) {
+    if (useTBB) {
+      sim->doIMEXSubstep1_tbb(dt);
+      converged &= sim->solveImplicitDiffusion_tbb(dt);
+    } else {
+      sim->doIMEXSubstep1(dt);
+      converged &= sim->solveImplicitDiffusion(dt);
+    }
+  }
+  if (!converged) {
+    return false;
+  }
+  calculateDcdt(false);
+  for (auto *sim : unfusedCompartments) {
+    if (useTBB) {
+      sim->doIMEXSubstep2_tbb(dt);
+      sim->addExplicitDiffusion_tbb(0.5 * dt);
+      converged &= sim->solveImplicitDiffusion_tbb(0.5 * dt);
+    } else {
+      sim->doIMEXSubstep2(dt);
+      sim->addExplicitDiffusion(0.5 * dt);
+      converged &= sim->solveImplicitDiffusion(0.5 * dt);
+    }
+  }
+  return converged;
+}
+
+void PixelSim::doDiffusionSubsteps(double dt) {
+  for (auto &sim : simCompartments) {
+    if (useTBB) {
+      sim->doDiffusionSubsteps_tbb(dt);
+    } else {
+      sim->doDiffusionSubsteps(dt);
+    }
+  }
+}
+
+void PixelSim::doOperatorSplittingStep(double dt) {
+  // Strang splitting: half step of diffusion, reactions integrated over the
+  // full step with the adaptive RK integrator, then another half step of
+  // diffusion
+  doDiffusionSubsteps(0.5 * dt);
+  constexpr double relativeTolerance = 1e-12;
+  double t{0};
+  while (t + dt * relativeTolerance < dt) {
+    if (integrator == PixelIntegratorType::RK101) {
+      // reactions are not limited by the diffusion stability bound
+      doRK101(dt - t);
+      t = dt;
+    } else {
+      t += doRKAdaptive(dt - t);
+      if (!currentErrorMessage.empty()) {
+        return;
+      }
+    }
+  }
+  doDiffusionSubsteps(0.5 * dt);
+  if (integrator == PixelIntegratorType::RK101) {
+    splittingTimestep = rk101SplittingTimestep;
+  } else {
+    // the splitting error depends on how quickly the reactions change the
+    // concentrations, so use the timestep that the reaction error estimate
+    // allows, growing by at most a factor of two per step
+    splittingTimestep = std::min(proposedTimestep, 2.0 * dt);
+  }
+}
+
 static double getErrorPower(PixelIntegratorType integrator) {
   double errPower{1.0};
-  if (integrator == PixelIntegratorType::RK212) {
+  if (integrator == PixelIntegratorType::RK212 ||
+      integrator == PixelIntegratorType::IMEX) {
     errPower = 1.0 / 2.0;
   } else if (integrator == PixelIntegratorType::RK323) {
     errPower = 1.0 / 3.0;
@@ -154,25 +306,45 @@ double PixelSim::doRKAdaptive(double dtMax) {
   do {
     // do timestep
     dt = std::min(nextTimestep, dtMax);
+    // error from fused compartments is calculated during the final RK stage
+    err.abs = 0;
+    err.rel = 0;
     if (integrator == PixelIntegratorType::RK212) {
-      doRK212(dt);
+      err = doRK212(dt);
     } else if (integrator == PixelIntegratorType::RK323) {
-      doRK323(dt);
+      err = doRK323(dt);
     } else if (integrator == PixelIntegratorType::RK435) {
-      doRK435(dt);
+      err = doRK435(dt);
+    } else if (integrator == PixelIntegratorType::IMEX && !doIMEX(dt)) {
+      // the implicit diffusion solve did not converge: reject the step and
+      // try again with a smaller one, which is better conditioned
+      err.abs = std::numeric_limits<double>::max();
+      err.rel = std::numeric_limits<double>::max();
+      proposedTimestep = 0.5 * dt;
+      nextTimestep = proposedTimestep;
+      SPDLOG_DEBUG("dt = {}: implicit diffusion solve did not converge", dt);
+      if (nextTimestep / dtMax < 1e-20) {
+        currentErrorMessage = "Failed to solve the implicit diffusion step";
+        return nextTimestep;
+      }
+      ++discardedSteps;
+      for (auto &sim : simCompartments) {
+        sim->undoRKStep();
+      }
+      continue;
     }
-    // calculate error
-    err.abs = 0;
-    err.rel = 0;
-    for (const auto &sim : simCompartments) {
-      auto compErr = sim->calculateRKError(epsilon);
+    // calculate error for remaining compartments
+    for (const auto *sim : unfusedCompartments) {
+      auto compErr = useTBB ? sim->calculateRKError_tbb(epsilon)
+                            : sim->calculateRKError(epsilon);
       err.rel = std::max(err.rel, compErr.rel);
       err.abs = std::max(err.abs, compErr.abs);
     }
     // calculate new timestep
     double errFactor = std::min(errMax.abs / err.abs, errMax.rel / err.rel);
     errFactor = std::pow(errFactor, errPower);
-    nextTimestep = std::min(0.95 * dt * errFactor, dtMax);
+    proposedTimestep = 0.95 * dt * errFactor;
+    nextTimestep = std::min(proposedTimestep, dtMax);
     SPDLOG_TRACE("dt = {} gave rel err = {}, abs err = {} -> new dt = {}", dt,
                  err.rel, err.abs, nextTimestep);
     if (nextTimestep / dtMax < 1e-20) {
@@ -204,6 +376,96 @@ double PixelSim::doRKAdaptive(double dtMax) {
   return dt;
 }
 
+// optimization parameters & parameters that are changed by events
+static std::vector<RuntimeParameter> collectRuntimeParameters(
+    const model::Model &doc,
+    const std::map<std::string, double, std::less<>> &substitutions) {
+  std::vector<RuntimeParameter> parameters;
+  const auto globalConstants{doc.getParameters().getGlobalConstants()};
+  auto addParameter = [&](const std::string &id,
+                          const std::string &reactionId) {
+    if (std::ranges::find_if(parameters, [&](const auto &p) {
+          return p.id == id && p.reactionId == reactionId;
+        }) != parameters.cend()) {
+      return;
+    }
+    std::optional<double> value;
+    if (reactionId.empty()) {
+      if (auto iter{std::ranges::find_if(
+              globalConstants, [&id](const auto &c) { return c.id == id; })};
+          iter != globalConstants.cend()) {
+        value = iter->value;
+      }
+    } else if (doc.getReactions()
+                   .getParameterIds(reactionId.c_str())
+                   .contains(id.c_str())) {
+      value = doc.getReactions().getParameterValue(reactionId.c_str(),
+                                                   id.c_str());
+    }
+    if (!value.has_value()) {
+      SPDLOG_WARN("'{}' is not a constant parameter: it will be inlined", id);
+      return;
+    }
+    if (auto iter{substitutions.find(id)}; iter != substitutions.cend()) {
+      value = iter->second;
+    }
+    SPDLOG_INFO("runtime parameter '{}' = {}", id, value.value());
+    parameters.push_back(
+        {id, reactionId,
+         fmt::format("sme_runtime_parameter_{}", parameters.size()),
+         value.value()});
+  };
+  for (const auto &optParam : doc.getOptimizeOptions().optParams) {
+    addParameter(optParam.id,
+                 optParam.optParamType == OptParamType::ReactionParameter
+                     ? optParam.parentId
+                     : std::string{});
+  }
+  for (const auto &id : doc.getEvents().getIds()) {
+    if (doc.getEvents().isParameter(id)) {
+      addParameter(doc.getEvents().getVariable(id).toStdString(), {});
+    }
+  }
+  return parameters;
+}
+
+// optimization parameters that are not changed by events: the sensitivity
+// equations assume the parameter has the same value for the whole simulation
+static std::vector<std::size_t>
+selectSensitivityParameters(const model::Model &doc,
+                            const std::vector<RuntimeParameter> &parameters) {
+  std::vector<std::size_t> indices;
+  for (const auto &membrane : doc.getMembranes().getMembranes()) {
+    if (!doc.getReactions().getIds(membrane.getId().c_str()).isEmpty()) {
+      SPDLOG_WARN("Forward sensitivities are not supported for models with "
+                  "membrane reactions");
+      return indices;
+    }
+  }
+  const auto &events{doc.getEvents()};
+  for (std::size_t i = 0; i < parameters.size(); ++i) {
+    const auto &p{parameters[i]};
+    bool isOptParam{std::ranges::any_of(
+        doc.getOptimizeOptions().optParams, [&p](const auto &optParam) {
+          return optParam.id == p.id &&
+                 (optParam.optParamType == OptParamType::ReactionParameter
+                      ? optParam.parentId
+                      : std::string{}) == p.reactionId;
+        })};
+    bool isEventTarget{
+        p.reactionId.empty() &&
+        std::ranges::any_of(events.getIds(), [&events, &p](const auto &id) {
+          return events.isParameter(id) &&
+                 events.getVariable(id).toStdString() == p.id;
+        })};
+    if (isOptParam && !isEventTarget) {
+      SPDLOG_INFO("forward sensitivity for parameter '{}'", p.id);
+      indices.push_back(i);
+    }
+  }
+  return indices;
+}
+
 PixelSim::PixelSim(
     const model::Model &sbmlDoc, const std::vector<std::string> &compartmentIds,
     const std::vector<std::vector<std::string>> &compartmentSpeciesIds,
@@ -226,6 +488,13 @@ PixelSim::PixelSim(
     if (spaceDependent) {
       nExtraVars += 2;
     }
+    if (sbmlDoc.getSimulationSettings().options.pixel.enableRuntimeParameters) {
+      runtimeParameters = collectRuntimeParameters(doc, substitutions);
+      if (sbmlDoc.getSimulationSettings().options.pixel.enableSensitivities) {
+        sensitivityParameters =
+            selectSensitivityParameters(doc, runtimeParameters);
+      }
+    }
     // add compartments
     for (std::size_t compIndex = 0; compIndex < compartmentIds.size();
          ++compIndex) {
@@ -236,7 +505,9 @@ PixelSim::PixelSim(
           doc, compartment, speciesIds,
           sbmlDoc.getSimulationSettings().options.pixel.doCSE,
           sbmlDoc.getSimulationSettings().options.pixel.optLevel, timeDependent,
-          spaceDependent, substitutions));
+          spaceDependent, substitutions,
+          sbmlDoc.getSimulationSettings().options.pixel.enableSoALayout,
+          runtimeParameters, sensitivityParameters));
       maxStableTimestep = std::min(
           maxStableTimestep, simCompartments.back()->getMaxStableTimestep());
     }
@@ -268,7 +539,43 @@ PixelSim::PixelSim(
             doc, &membrane, compA, compB,
             sbmlDoc.getSimulationSettings().options.pixel.doCSE,
             sbmlDoc.getSimulationSettings().options.pixel.optLevel,
-            timeDependent, spaceDependent, substitutions));
+            timeDependent, spaceDependent, substitutions, runtimeParameters));
+        // membrane reactions modify dcdt of these compartments after the
+        // compartment reactions & diffusion have been evaluated
+        if (compA != nullptr) {
+          compA->disallowFusedSteps();
+        }
+        if (compB != nullptr) {
+          compB->disallowFusedSteps();
+        }
+      }
+    }
+    // no error estimate with RK101: use a fixed splitting timestep of the
+    // stability bound of the slowest diffusing species, so that only the
+    // faster diffusing species need more than one diffusion substep
+    for (const auto &sim : simCompartments) {
+      rk101SplittingTimestep = std::max(
+          rk101SplittingTimestep, sim->getSlowestSpeciesStableTimestep());
+    }
+    if (rk101SplittingTimestep == 0.0) {
+      // nothing diffuses: reactions are limited only by maxTimestep
+      rk101SplittingTimestep = std::numeric_limits<double>::max();
+    }
+    if (integrator == PixelIntegratorType::RK101) {
+      splittingTimestep = rk101SplittingTimestep;
+    }
+    // IMEX already treats diffusion separately from reactions
+    useOperatorSplitting =
+        sbmlDoc.getSimulationSettings().options.pixel.enableOperatorSplitting &&
+        integrator != PixelIntegratorType::IMEX;
+    for (auto &sim : simCompartments) {
+      // IMEX stages need dcdt for all voxels before the implicit solve, and
+      // fused stages always include diffusion
+      if (sim->canFuseSteps() && integrator != PixelIntegratorType::IMEX &&
+          !useOperatorSplitting) {
+        fusedCompartments.push_back(sim.get());
+      } else {
+        unfusedCompartments.push_back(sim.get());
       }
     }
     // apply existing simulation concentrations if present
@@ -307,22 +614,31 @@ std::size_t PixelSim::run(double time, double timeout_ms,
   QElapsedTimer timer;
   timer.start();
   double tNow = 0;
+  const double tStart{simulatedTime.load()};
   std::size_t steps = 0;
   discardedSteps = 0;
   // do timesteps until we reach t
   constexpr double relativeTolerance = 1e-12;
   while (tNow + time * relativeTolerance < time) {
     double maxDt = std::min(maxTimestep, time - tNow);
-    if (integrator == PixelIntegratorType::RK101) {
+    if (useOperatorSplitting) {
+      double timestep = std::min(maxDt, splittingTimestep);
+      doOperatorSplittingStep(timestep);
+      if (!currentErrorMessage.empty()) {
+        break;
+      }
+      tNow += timestep;
+    } else if (integrator == PixelIntegratorType::RK101) {
       double timestep = std::min(maxDt, maxStableTimestep);
       doRK101(timestep);
       tNow += timestep;
     } else {
       tNow += doRKAdaptive(maxDt);
       if (!currentErrorMessage.empty()) {
-        return steps;
+        break;
       }
     }
+    simulatedTime.store(tStart + tNow);
     ++steps;
     if (timeout_ms >= 0.0 &&
         static_cast<double>(timer.elapsed()) >= timeout_ms) {
@@ -336,13 +652,16 @@ std::size_t PixelSim::run(double time, double timeout_ms,
     if (stopRequested.load()) {
       currentErrorMessage = "Simulation stopped early";
       SPDLOG_DEBUG("Simulation timeout or stopped early");
-      return steps;
+      break;
     }
   }
   SPDLOG_DEBUG("t={} integrated using {} steps ({:3.1f}% discarded)", time,
                steps + discardedSteps,
                static_cast<double>(100 * discardedSteps) /
                    static_cast<double>(steps + discardedSteps));
+  for (auto &sim : simCompartments) {
+    sim->updateAoSView();
+  }
   return steps;
 }
 
@@ -375,4 +694,102 @@ const common::ImageStack &PixelSim::errorImages() const {
 
 void PixelSim::setStopRequested(bool stop) { stopRequested.store(stop); }
 
+double PixelSim::getSimulatedTime() const { return simulatedTime.load(); }
+
+std::vector<double> PixelSim::getIntegratorState() const {
+  // concentrations are restored from the simulation data, so the only
+  // additional state is the next adaptive & operator splitting timesteps
+  return {nextTimestep, splittingTimestep};
+}
+
+void PixelSim::setIntegratorState(const std::vector<double> &state) {
+  if (state.size() != 2) {
+    currentErrorMessage = "Invalid integrator state in checkpoint";
+    SPDLOG_WARN("{}", currentErrorMessage);
+    return;
+  }
+  nextTimestep = state[0];
+  splittingTimestep = state[1];
+}
+
+const std::vector<RuntimeParameter> &PixelSim::getRuntimeParameters() const {
+  return runtimeParameters;
+}
+
+void PixelSim::setRuntimeParameterValues(const std::vector<double> &values) {
+  if (values.size() != runtimeParameters.size()) {
+    SPDLOG_WARN("expected {} runtime parameter values, got {}",
+                runtimeParameters.size(), values.size());
+    return;
+  }
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    runtimeParameters[i].value = values[i];
+  }
+  for (auto &sim : simCompartments) {
+    sim->setRuntimeParameterValues(values);
+  }
+  for (auto &sim : simMembranes) {
+    sim->setRuntimeParameterValues(values);
+  }
+}
+
+const std::vector<std::size_t> &PixelSim::getSensitivityParameters() const {
+  return sensitivityParameters;
+}
+
+std::vector<double>
+PixelSim::getConcentrationSensitivity(std::size_t compartmentIndex,
+                                      std::size_t speciesIndex,
+                                      std::size_t parameterIndex) const {
+  return simCompartments[compartmentIndex]->getConcentrationSensitivity(
+      speciesIndex, parameterIndex);
+}
+
+std::vector<double>
+PixelSim::getDcdtSensitivity(std::size_t compartmentIndex,
+                             std::size_t speciesIndex,
+                             std::size_t parameterIndex) const {
+  return simCompartments[compartmentIndex]->getDcdtSensitivity(speciesIndex,
+                                                               parameterIndex);
+}
+
+bool PixelSim::reset(
+    const std::vector<std::vector<double>> &concentrations,
+    const std::map<std::string, double, std::less<>> &substitutions) {
+  if (concentrations.size() != simCompartments.size()) {
+    return false;
+  }
+  if (!runtimeParameters.empty()) {
+    // the set of runtime parameters is fixed when the terms are compiled
+    auto parameters{collectRuntimeParameters(doc, substitutions)};
+    if (!std::ranges::equal(parameters, runtimeParameters,
+                            [](const auto &a, const auto &b) {
+                              return a.id == b.id &&
+                                     a.reactionId == b.reactionId;
+                            })) {
+      return false;
+    }
+    std::vector<double> values;
+    values.reserve(parameters.size());
+    for (const auto &p : parameters) {
+      values.push_back(p.value);
+    }
+    setRuntimeParameterValues(values);
+  }
+  for (std::size_t i = 0; i < simCompartments.size(); ++i) {
+    simCompartments[i]->setConcentrations(concentrations[i]);
+  }
+  nextTimestep = 1e-7;
+  proposedTimestep = 1e-7;
+  splittingTimestep = integrator == PixelIntegratorType::RK101
+                          ? rk101SplittingTimestep
+                          : 1e-7;
+  discardedSteps = 0;
+  simulatedTime.store(0.0);
+  currentErrorMessage.clear();
+  currentErrorImages = {};
+  stopRequested.store(false);
+  return true;
+}
+
 } // namespace sme::simulate
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "basesim.hpp"
+#include "sme/pde.hpp"
 #include "sme/simulate_options.hpp"
 #include <QImage>
 #include <atomic>
@@ -23,18 +24,29 @@ namespace simulate {
 
 class SimCompartment;
 class SimMembrane;
+struct FusedRKStage;
 
 class PixelSim : public BaseSim {
 private:
   std::vector<std::unique_ptr<SimCompartment>> simCompartments;
   std::vector<std::unique_ptr<SimMembrane>> simMembranes;
+  // compartments that evaluate dcdt & apply each RK stage in a single sweep
+  std::vector<SimCompartment *> fusedCompartments;
+  // compartments that evaluate dcdt for all voxels before each RK stage
+  std::vector<SimCompartment *> unfusedCompartments;
   const model::Model &doc;
   double maxStableTimestep{std::numeric_limits<double>::max()};
-  void calculateDcdt();
+  void calculateDcdt(bool includeDiffusion = true);
+  // return the error estimate for the fused compartments
+  PixelIntegratorError doFusedRKSubstep(const FusedRKStage &stage);
   void doRK101(double dt);
-  void doRK212(double dt);
-  void doRK323(double dt);
-  void doRK435(double dt);
+  PixelIntegratorError doRK212(double dt);
+  PixelIntegratorError doRK323(double dt);
+  PixelIntegratorError doRK435(double dt);
+  // returns false if an implicit diffusion solve did not converge
+  bool doIMEX(double dt);
+  void doDiffusionSubsteps(double dt);
+  void doOperatorSplittingStep(double dt);
   void doRKSubstep(double dt, double g1, double g2, double g3, double beta,
                    double delta);
   double doRKAdaptive(double dtMax);
@@ -43,13 +55,25 @@ private:
   PixelIntegratorError errMax;
   double maxTimestep{std::numeric_limits<double>::max()};
   double nextTimestep{1e-7};
+  // largest timestep allowed by the error estimate of the last adaptive step,
+  // before it was limited to the remaining time
+  double proposedTimestep{1e-7};
+  // operator splitting step, derived from the adaptive reaction timestep
+  double splittingTimestep{1e-7};
+  // fixed operator splitting step used with RK101
+  double rk101SplittingTimestep{0.0};
   double epsilon{1e-14};
   bool useTBB{false};
+  bool useOperatorSplitting{false};
   std::size_t numMaxThreads{1};
   std::string currentErrorMessage{};
   common::ImageStack currentErrorImages{};
   std::atomic<bool> stopRequested{false};
+  std::atomic<double> simulatedTime{0.0};
   std::size_t nExtraVars{0};
+  std::vector<RuntimeParameter> runtimeParameters;
+  // indices of the runtime parameters with forward sensitivities
+  std::vector<std::size_t> sensitivityParameters;
 
 public:
   explicit PixelSim(
@@ -71,6 +95,29 @@ public:
   [[nodiscard]] const std::string &errorMessage() const override;
   [[nodiscard]] const common::ImageStack &errorImages() const override;
   void setStopRequested(bool stop) override;
+  [[nodiscard]] double getSimulatedTime() const override;
+  [[nodiscard]] std::vector<double> getIntegratorState() const override;
+  void setIntegratorState(const std::vector<double> &state) override;
+  // parameters that are inputs to the compiled reaction terms
+  [[nodiscard]] const std::vector<RuntimeParameter> &
+  getRuntimeParameters() const;
+  // change the values of the runtime parameters without recompiling
+  void setRuntimeParameterValues(const std::vector<double> &values);
+  [[nodiscard]] const std::vector<std::size_t> &
+  getSensitivityParameters() const;
+  // d(conc)/d(parameter) of a species for each voxel, where parameterIndex
+  // is an index into getSensitivityParameters()
+  [[nodiscard]] std::vector<double>
+  getConcentrationSensitivity(std::size_t compartmentIndex,
+                              std::size_t speciesIndex,
+                              std::size_t parameterIndex) const;
+  [[nodiscard]] std::vector<double>
+  getDcdtSensitivity(std::size_t compartmentIndex, std::size_t speciesIndex,
+                     std::size_t parameterIndex) const;
+  // restart from the supplied concentrations, re-using the compiled reaction
+  // terms: returns false if the simulator needs to be reconstructed instead
+  bool reset(const std::vector<std::vector<double>> &concentrations,
+             const std::map<std::string, double, std::less<>> &substitutions);
 };
 
 } // namespace simulate
@@ -8,20 +8,27 @@
 #include <QStringList>
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
+#include <functional>
 #include <memory>
+#include <numeric>
 #include <utility>
+#include <vector>
 // Qt defines emit keyword which interferes with a tbb emit() function
 #ifdef emit
 #undef emit
 #include <oneapi/tbb/global_control.h>
 #include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/parallel_reduce.h>
 #include <oneapi/tbb/tick_count.h>
 #define emit // restore the Qt empty definition of "emit"
 #else
 #include <oneapi/tbb/global_control.h>
 #include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/parallel_reduce.h>
 #include <oneapi/tbb/tick_count.h>
 #endif
 
@@ -31,20 +38,100 @@ class PixelSimImplError : public std::runtime_error {
   using std::runtime_error::runtime_error;
 };
 
+// number of points evaluated per call of the batched reaction terms
+constexpr std::size_t reactionBatchSize{4};
+// number of points gathered into a contiguous buffer before evaluating
+constexpr std::size_t reactionBlockSize{16 * reactionBatchSize};
+// number of voxels in each tile of a fused RK stage: should be small enough
+// that the tile's conc, dcdt, s2, s3 stay in cache
+constexpr std::size_t fusedTileSize{128 * reactionBatchSize};
+
+// scratch buffers for evaluating the reaction terms of a block of points,
+// reused by each thread between calls. Each row is [variables, parameters]:
+// the parameters are the same for every point, so are only copied into the
+// rows when the buffers were last used with different parameter values
+struct ReactionBuffers {
+  std::uint64_t parameterValuesId{0};
+  std::vector<double> vars;
+  std::vector<double> result;
+};
+
+// unique id for each set of runtime parameter values
+static std::uint64_t newParameterValuesId() {
+  static std::atomic<std::uint64_t> id{0};
+  return ++id;
+}
+
+static ReactionBuffers &getReactionBuffers(std::size_t nVars,
+                                           const std::vector<double> &params,
+                                           std::uint64_t paramsId) {
+  thread_local ReactionBuffers buffers;
+  const std::size_t rowSize{nVars + params.size()};
+  if (buffers.parameterValuesId != paramsId ||
+      buffers.vars.size() != reactionBlockSize * rowSize) {
+    buffers.vars.resize(reactionBlockSize * rowSize);
+    buffers.result.resize(reactionBlockSize * rowSize);
+    for (std::size_t i = 0; i < reactionBlockSize; ++i) {
+      std::ranges::copy(params, buffers.vars.begin() +
+                                    static_cast<std::ptrdiff_t>(
+                                        i * rowSize + nVars));
+    }
+    buffers.parameterValuesId = paramsId;
+  }
+  return buffers;
+}
+
 template <typename Body>
-static void tbbParallelFor(std::size_t n, const Body &body) {
-  constexpr std::size_t tbbGrainSize{64};
+static void tbbParallelFor(std::size_t n, const Body &body,
+                           std::size_t tbbGrainSize = 64) {
   static oneapi::tbb::static_partitioner partitioner;
   oneapi::tbb::parallel_for(
       oneapi::tbb::blocked_range<std::size_t>(0, n, tbbGrainSize), body,
       partitioner);
 }
 
+template <typename T, typename Body, typename Join>
+static T tbbParallelReduce(std::size_t n, const T &identity, const Body &body,
+                           const Join &join) {
+  constexpr std::size_t tbbGrainSize{64};
+  static oneapi::tbb::static_partitioner partitioner;
+  return oneapi::tbb::parallel_reduce(
+      oneapi::tbb::blocked_range<std::size_t>(0, n, tbbGrainSize), identity,
+      [&body, &join](const oneapi::tbb::blocked_range<std::size_t> &r,
+                     T init) {
+        return join(init, body(r));
+      },
+      join, partitioner);
+}
+
+// deterministic sum of f(i) for i in [0, n): the order of the additions only
+// depends on n, not on the number of threads
+template <typename Func>
+static double tbbDeterministicSum(std::size_t n, const Func &f) {
+  constexpr std::size_t tbbGrainSize{1024};
+  return oneapi::tbb::parallel_deterministic_reduce(
+      oneapi::tbb::blocked_range<std::size_t>(0, n, tbbGrainSize), 0.0,
+      [&f](const oneapi::tbb::blocked_range<std::size_t> &r, double sum) {
+        for (std::size_t i = r.begin(); i < r.end(); ++i) {
+          sum += f(i);
+        }
+        return sum;
+      },
+      std::plus<>{});
+}
+
+static PixelIntegratorError maxError(const PixelIntegratorError &a,
+                                     const PixelIntegratorError &b) {
+  return {std::max(a.abs, b.abs), std::max(a.rel, b.rel)};
+}
+
 ReacExpr::ReacExpr(
     const model::Model &doc, const std::vector<std::string> &speciesIDs,
     const std::vector<std::string> &reactionIDs, double reactionScaleFactor,
     bool timeDependent, bool spaceDependent,
-    const std::map<std::string, double, std::less<>> &substitutions) {
+    const std::map<std::string, double, std::less<>> &substitutions,
+    const std::vector<RuntimeParameter> &runtimeParameters,
+    const std::vector<std::size_t> &sensitivityParameters) {
   // construct reaction expressions and variables
   PdeScaleFactors pdeScaleFactors;
   pdeScaleFactors.reaction = reactionScaleFactor;
@@ -59,10 +146,14 @@ ReacExpr::ReacExpr(
     extraVars.push_back(doc.getParameters().getSpatialCoordinates().y.id);
   }
   Pde pde(&doc, speciesIDs, reactionIDs, {}, pdeScaleFactors, extraVars, {},
-          substitutions);
+          substitutions, runtimeParameters);
   // add dt/dt = 1 reaction term, and t,x,y "species"
   variables = speciesIDs;
   variables.insert(variables.end(), extraVars.cbegin(), extraVars.cend());
+  std::vector<std::string> parameterVariables;
+  for (const auto &p : runtimeParameters) {
+    parameterVariables.push_back(p.variable);
+  }
   expressions = pde.getRHS();
   if (timeDependent) {
     expressions.emplace_back("1"); // dt/dt = 1
@@ -71,6 +162,47 @@ ReacExpr::ReacExpr(
     expressions.emplace_back("0"); // dx/dt = 0
     expressions.emplace_back("0"); // dy/dt = 0
   }
+  // forward sensitivities & runtime parameters follow the z "species", so
+  // that the variables match the layout of the voxel concentrations
+  if (spaceDependent &&
+      (!sensitivityParameters.empty() || !runtimeParameters.empty())) {
+    variables.push_back(doc.getParameters().getSpatialCoordinates().z.id);
+    expressions.emplace_back("0"); // dz/dt = 0
+  }
+  if (!sensitivityParameters.empty()) {
+    // forward sensitivities s_ik = dc_i/dp_k, with
+    // ds_ik/dt = sum_j (df_i/dc_j) s_jk + df_i/dp_k
+    auto rhsVars{variables};
+    rhsVars.insert(rhsVars.end(), parameterVariables.cbegin(),
+                   parameterVariables.cend());
+    common::Symbolic rhs(pde.getRHS(), rhsVars);
+    if (!rhs.isValid()) {
+      throw PdeError(rhs.getErrorMessage());
+    }
+    const auto &jacobian{pde.getJacobian()};
+    auto sensitivityVariable = [](std::size_t i, std::size_t k) {
+      return fmt::format("sme_sensitivity_{}_{}", k, i);
+    };
+    for (std::size_t k = 0; k < sensitivityParameters.size(); ++k) {
+      const auto &p{runtimeParameters[sensitivityParameters[k]]};
+      for (std::size_t i = 0; i < speciesIDs.size(); ++i) {
+        variables.push_back(sensitivityVariable(i, k));
+        std::string expr{fmt::format("({})", rhs.diff(p.variable, i))};
+        for (std::size_t j = 0; j < speciesIDs.size(); ++j) {
+          expr.append(fmt::format(" + ({})*({})", jacobian[i][j],
+                                  sensitivityVariable(j, k)));
+        }
+        expressions.push_back(std::move(expr));
+      }
+    }
+  }
+  // runtime parameters are the last variables, with dp/dt = 0, so that the
+  // compiled terms can be evaluated directly on rows of [species, parameters]
+  variables.insert(variables.end(), parameterVariables.cbegin(),
+                   parameterVariables.cend());
+  for (std::size_t i = 0; i < parameterVariables.size(); ++i) {
+    expressions.emplace_back("0");
+  }
 }
 
 void SimCompartment::spatiallyAverageDcdt() {
@@ -79,15 +211,30 @@ void SimCompartment::spatiallyAverageDcdt() {
   for (std::size_t is : nonSpatialSpeciesIndices) {
     double av = 0;
     for (std::size_t ix = 0; ix < nPixels; ++ix) {
-      av += dcdt[ix * nSpecies + is];
+      av += dcdt[index(ix, is)];
     }
     av /= static_cast<double>(nPixels);
     for (std::size_t ix = 0; ix < nPixels; ++ix) {
-      dcdt[ix * nSpecies + is] = av;
+      dcdt[index(ix, is)] = av;
     }
   }
 }
 
+void SimCompartment::spatiallyAverageDcdt_tbb() {
+  for (std::size_t is : nonSpatialSpeciesIndices) {
+    double av{tbbDeterministicSum(
+        nPixels, [this, is](std::size_t ix) { return dcdt[index(ix, is)]; })};
+    av /= static_cast<double>(nPixels);
+    tbbParallelFor(
+        nPixels, [this, is, av](
+                     const oneapi::tbb::blocked_range<std::size_t> &r) {
+          for (std::size_t ix = r.begin(); ix < r.end(); ++ix) {
+            dcdt[index(ix, is)] = av;
+          }
+        });
+  }
+}
+
 // Forwards Euler stability bound for dimensionless diffusion constant {D/dx^2,
 // D/dy^2, D/dz^2}
 static double calculateMaxStableTimestep(
@@ -100,8 +247,14 @@ SimCompartment::SimCompartment(
     const model::Model &doc, const geometry::Compartment *compartment,
     std::vector<std::string> sIds, bool doCSE, unsigned optLevel,
     bool timeDependent, bool spaceDependent,
-    const std::map<std::string, double, std::less<>> &substitutions)
-    : comp{compartment}, nPixels{compartment->nVoxels()}, nSpecies{sIds.size()},
+    const std::map<std::string, double, std::less<>> &substitutions,
+    bool enableSoALayout,
+    const std::vector<RuntimeParameter> &runtimeParameters,
+    const std::vector<std::size_t> &sensitivityParameters)
+    : useSoA{enableSoALayout}, comp{compartment},
+      nPixels{compartment->nVoxels()}, nSpecies{sIds.size()},
+      nModelSpecies{sIds.size()},
+      nSensitivityParameters{sensitivityParameters.size()},
       compartmentId{compartment->getId()}, speciesIds{std::move(sIds)} {
   // get species in compartment
   speciesNames.reserve(nSpecies);
@@ -117,6 +270,11 @@ SimCompartment::SimCompartment(
     // forwards euler stability bound
     maxStableTimestep = std::min(
         maxStableTimestep, calculateMaxStableTimestep(diffConstants.back()));
+    if (d > 0.0 && field->getIsSpatial()) {
+      slowestSpeciesStableTimestep =
+          std::max(slowestSpeciesStableTimestep,
+                   calculateMaxStableTimestep(diffConstants.back()));
+    }
     fields.push_back(field);
     speciesNames.push_back(doc.getSpecies().getName(s.c_str()).toStdString());
     if (!field->getIsSpatial()) {
@@ -132,11 +290,17 @@ SimCompartment::SimCompartment(
     reactionIDs = common::toStdString(reacsInCompartment);
   }
   ReacExpr reacExpr(doc, speciesIds, reactionIDs, 1.0, timeDependent,
-                    spaceDependent, substitutions);
+                    spaceDependent, substitutions, runtimeParameters,
+                    sensitivityParameters);
   if (!(sym.parse(reacExpr.expressions, reacExpr.variables) &&
-        sym.compile(doCSE, optLevel))) {
+        sym.compile(doCSE, optLevel, reactionBatchSize))) {
     throw PixelSimImplError(sym.getErrorMessage());
   }
+  std::vector<double> runtimeParameterValues;
+  for (const auto &p : runtimeParameters) {
+    runtimeParameterValues.push_back(p.value);
+  }
+  setRuntimeParameterValues(runtimeParameterValues);
   if (timeDependent) {
     speciesIds.push_back("time");
     diffConstants.push_back({0.0, 0.0, 0.0});
@@ -155,9 +319,34 @@ SimCompartment::SimCompartment(
     diffConstants.push_back({0.0, 0.0, 0.0});
     nSpecies += 3;
   }
+  // each sensitivity diffuses like the corresponding species
+  for (const auto &p : sensitivityParameters) {
+    for (std::size_t is = 0; is < nModelSpecies; ++is) {
+      speciesIds.push_back(fmt::format("d{}/d{}", speciesIds[is],
+                                       runtimeParameters[p].id));
+      auto d{diffConstants[is]};
+      diffConstants.push_back(d);
+      if (!fields[is]->getIsSpatial()) {
+        nonSpatialSpeciesIndices.push_back(nSpecies);
+      }
+      ++nSpecies;
+    }
+  }
+  if (useSoA) {
+    // pad each species array to a whole number of 64-byte cache lines
+    constexpr std::size_t doublesPerCacheLine{64 / sizeof(double)};
+    pixelStride = 1;
+    speciesStride = doublesPerCacheLine *
+                    ((nPixels + doublesPerCacheLine - 1) / doublesPerCacheLine);
+    initStencilRuns();
+    SPDLOG_DEBUG("  - SoA layout: {} vectorizable runs, {} boundary voxels",
+                 stencilRuns.size(), stencilBoundaryVoxels.size());
+  } else {
+    pixelStride = nSpecies;
+    speciesStride = 1;
+  }
   // setup concentrations vector with initial values
   conc.resize(nSpecies * nPixels);
-  dcdt.resize(conc.size(), 0.0);
   auto origin{doc.getGeometry().getPhysicalOrigin()};
   auto concIter{conc.begin()};
   for (std::size_t ix = 0; ix < compartment->nVoxels(); ++ix) {
@@ -183,12 +372,88 @@ SimCompartment::SimCompartment(
           origin.z + static_cast<double>(voxel.z) * voxelSize.depth(); // z
       ++concIter;
     }
+    // initial concentrations do not depend on the parameters
+    for (std::size_t i = 0; i < nModelSpecies * nSensitivityParameters; ++i) {
+      *concIter = 0;
+      ++concIter;
+    }
   }
   assert(concIter == conc.end());
+  if (useSoA) {
+    std::vector<double> c;
+    std::swap(c, conc);
+    fromAoS(c, conc, nSpecies);
+  }
+  dcdt.resize(conc.size(), 0.0);
+  updateAoSView();
+}
+
+void SimCompartment::initStencilRuns() {
+  // minimum number of voxels in a run for it to be worth vectorizing
+  constexpr std::size_t minRunLength{8};
+  auto getOffsets = [c = comp](std::size_t i) {
+    auto d = [i](std::size_t j) {
+      return static_cast<std::ptrdiff_t>(j) - static_cast<std::ptrdiff_t>(i);
+    };
+    return std::array<std::ptrdiff_t, 6>{d(c->up_x(i)), d(c->dn_x(i)),
+                                         d(c->up_y(i)), d(c->dn_y(i)),
+                                         d(c->up_z(i)), d(c->dn_z(i))};
+  };
+  stencilRuns.clear();
+  stencilBoundaryVoxels.clear();
+  std::size_t begin{0};
+  while (begin < nPixels) {
+    auto offsets{getOffsets(begin)};
+    std::size_t end{begin + 1};
+    while (end < nPixels && getOffsets(end) == offsets) {
+      ++end;
+    }
+    if (end - begin >= minRunLength) {
+      stencilRuns.push_back({begin, end, offsets});
+    } else {
+      for (std::size_t i = begin; i < end; ++i) {
+        stencilBoundaryVoxels.push_back(i);
+      }
+    }
+    begin = end;
+  }
+}
+
+void SimCompartment::toAoS(const std::vector<double> &src,
+                           std::vector<double> &dst, std::size_t nDst) const {
+  dst.resize(nPixels * nDst);
+  for (std::size_t ix = 0; ix < nPixels; ++ix) {
+    for (std::size_t is = 0; is < nDst; ++is) {
+      dst[ix * nDst + is] = src[index(ix, is)];
+    }
+  }
+}
+
+void SimCompartment::fromAoS(const std::vector<double> &src,
+                             std::vector<double> &dst, std::size_t nSrc) const {
+  dst.assign(useSoA ? nSpecies * speciesStride : nSpecies * nPixels, 0.0);
+  for (std::size_t ix = 0; ix < nPixels; ++ix) {
+    for (std::size_t is = 0; is < nSrc; ++is) {
+      dst[index(ix, is)] = src[ix * nSrc + is];
+    }
+  }
+}
+
+std::size_t SimCompartment::nOutputSpecies() const {
+  return nSpecies - nModelSpecies * nSensitivityParameters;
+}
+
+std::size_t SimCompartment::sensitivityIndex(std::size_t speciesIndex,
+                                             std::size_t parameterIndex) const {
+  return nOutputSpecies() + parameterIndex * nModelSpecies + speciesIndex;
 }
 
 void SimCompartment::evaluateDiffusionOperator(std::size_t begin,
                                                std::size_t end) {
+  if (useSoA) {
+    evaluateDiffusionOperatorSoA(begin, end);
+    return;
+  }
   for (std::size_t i = begin; i < end; ++i) {
     const std::size_t ix{i * nSpecies};
     const std::size_t ix_upx{comp->up_x(i) * nSpecies};
@@ -209,12 +474,115 @@ void SimCompartment::evaluateDiffusionOperator(std::size_t begin,
   }
 }
 
+// dc[i] += D . (c[i+offset_up] + c[i+offset_dn] - 2 c[i]) for i in [0, n)
+// all accesses are unit-stride so this loop is auto-vectorized
+static void applyStencilRun(const double *c, double *dc, std::size_t n,
+                            const std::array<std::ptrdiff_t, 6> &offsets,
+                            const std::array<double, 3> &d) {
+  const double *c_upx{c + offsets[0]};
+  const double *c_dnx{c + offsets[1]};
+  const double *c_upy{c + offsets[2]};
+  const double *c_dny{c + offsets[3]};
+  const double *c_upz{c + offsets[4]};
+  const double *c_dnz{c + offsets[5]};
+  const double dx{d[0]};
+  const double dy{d[1]};
+  const double dz{d[2]};
+  for (std::size_t i = 0; i < n; ++i) {
+    dc[i] += dx * (c_upx[i] + c_dnx[i] - 2.0 * c[i]) +
+             dy * (c_upy[i] + c_dny[i] - 2.0 * c[i]) +
+             dz * (c_upz[i] + c_dnz[i] - 2.0 * c[i]);
+  }
+}
+
+void SimCompartment::evaluateDiffusionOperatorSoA(std::size_t begin,
+                                                  std::size_t end) {
+  // vectorized stencil for runs of voxels with constant neighbour offsets
+  auto run{std::ranges::upper_bound(stencilRuns, begin, std::less<>{},
+                                    &StencilRun::begin)};
+  if (run != stencilRuns.begin()) {
+    --run;
+  }
+  for (; run != stencilRuns.end() && run->begin < end; ++run) {
+    const std::size_t b{std::max(run->begin, begin)};
+    const std::size_t e{std::min(run->end, end)};
+    if (b >= e) {
+      continue;
+    }
+    for (std::size_t is = 0; is < nSpecies; ++is) {
+      const auto &d{diffConstants[is]};
+      if (d[0] == 0.0 && d[1] == 0.0 && d[2] == 0.0) {
+        continue;
+      }
+      const std::size_t i0{index(b, is)};
+      applyStencilRun(conc.data() + i0, dcdt.data() + i0, e - b, run->offsets,
+                      d);
+    }
+  }
+  // indexed neighbour lookup for the remaining voxels
+  for (auto iter{std::ranges::lower_bound(stencilBoundaryVoxels, begin)};
+       iter != stencilBoundaryVoxels.end() && *iter < end; ++iter) {
+    const std::size_t i{*iter};
+    const std::size_t upx{comp->up_x(i)};
+    const std::size_t dnx{comp->dn_x(i)};
+    const std::size_t upy{comp->up_y(i)};
+    const std::size_t dny{comp->dn_y(i)};
+    const std::size_t upz{comp->up_z(i)};
+    const std::size_t dnz{comp->dn_z(i)};
+    for (std::size_t is = 0; is < nSpecies; ++is) {
+      const double *c{conc.data() + is * speciesStride};
+      dcdt[index(i, is)] +=
+          diffConstants[is][0] * (c[upx] + c[dnx] - 2.0 * c[i]) +
+          diffConstants[is][1] * (c[upy] + c[dny] - 2.0 * c[i]) +
+          diffConstants[is][2] * (c[upz] + c[dnz] - 2.0 * c[i]);
+    }
+  }
+}
+
 void SimCompartment::evaluateReactions(std::size_t begin, std::size_t end) {
-  for (std::size_t i = begin; i < end; ++i) {
-    sym.eval(dcdt.data() + i * nSpecies, conc.data() + i * nSpecies);
+  if (useSoA || !runtimeParameterValues.empty()) {
+    evaluateReactionsBlocked(begin, end);
+    return;
+  }
+  sym.evalBatch(dcdt.data() + begin * nSpecies, conc.data() + begin * nSpecies,
+                end - begin, nSpecies);
+}
+
+void SimCompartment::evaluateReactionsBlocked(std::size_t begin,
+                                              std::size_t end) {
+  // gather a block of voxels into contiguous rows of [species, runtime
+  // parameters] for the compiled reaction terms, then scatter the results
+  // back to dcdt
+  const std::size_t rowSize{nSpecies + runtimeParameterValues.size()};
+  auto &buffers{getReactionBuffers(nSpecies, runtimeParameterValues,
+                                   runtimeParameterValuesId)};
+  auto &vars{buffers.vars};
+  auto &result{buffers.result};
+  for (std::size_t b = begin; b < end; b += reactionBlockSize) {
+    const std::size_t n{std::min(reactionBlockSize, end - b)};
+    for (std::size_t is = 0; is < nSpecies; ++is) {
+      for (std::size_t i = 0; i < n; ++i) {
+        vars[i * rowSize + is] = conc[index(b + i, is)];
+      }
+    }
+    sym.evalBatch(result.data(), vars.data(), n, rowSize);
+    for (std::size_t is = 0; is < nSpecies; ++is) {
+      for (std::size_t i = 0; i < n; ++i) {
+        dcdt[index(b + i, is)] = result[i * rowSize + is];
+      }
+    }
   }
 }
 
+void SimCompartment::evaluateReactions() { evaluateReactions(0, nPixels); }
+
+void SimCompartment::evaluateReactions_tbb() {
+  tbbParallelFor(nPixels,
+                 [this](const oneapi::tbb::blocked_range<std::size_t> &r) {
+                   evaluateReactions(r.begin(), r.end());
+                 });
+}
+
 void SimCompartment::evaluateReactionsAndDiffusion() {
   evaluateReactions(0, nPixels);
   evaluateDiffusionOperator(0, nPixels);
@@ -338,6 +706,260 @@ void SimCompartment::doRKFinalise_tbb(double cFactor, double s2Factor,
       });
 }
 
+void SimCompartment::doIMEXSubstep1(double dt, std::size_t begin,
+                                    std::size_t end) {
+  for (std::size_t i = begin; i < end; ++i) {
+    s3[i] = conc[i];
+    conc[i] += dt * dcdt[i];
+    s2[i] = conc[i];
+  }
+}
+
+void SimCompartment::doIMEXSubstep1(double dt) {
+  s2.resize(conc.size());
+  s3.resize(conc.size());
+  doIMEXSubstep1(dt, 0, conc.size());
+}
+
+void SimCompartment::doIMEXSubstep1_tbb(double dt) {
+  s2.resize(conc.size());
+  s3.resize(conc.size());
+  tbbParallelFor(conc.size(),
+                 [this, dt](const oneapi::tbb::blocked_range<std::size_t> &r) {
+                   doIMEXSubstep1(dt, r.begin(), r.end());
+                 });
+}
+
+void SimCompartment::doIMEXSubstep2(double dt, std::size_t begin,
+                                    std::size_t end) {
+  // s2 contains the explicit part of the first stage, s3 the initial conc:
+  // new explicit part is s3 + dt/2 (dcdt_0 + dcdt_1), and the first order
+  // solution is kept in s2 for the error estimate
+  for (std::size_t i = begin; i < end; ++i) {
+    double c{0.5 * s3[i] + 0.5 * s2[i] + 0.5 * dt * dcdt[i]};
+    s2[i] = conc[i];
+    conc[i] = c;
+  }
+}
+
+void SimCompartment::doIMEXSubstep2(double dt) {
+  doIMEXSubstep2(dt, 0, conc.size());
+}
+
+void SimCompartment::doIMEXSubstep2_tbb(double dt) {
+  tbbParallelFor(conc.size(),
+                 [this, dt](const oneapi::tbb::blocked_range<std::size_t> &r) {
+                   doIMEXSubstep2(dt, r.begin(), r.end());
+                 });
+}
+
+// Lv = D . Laplacian v, for a single species stored contiguously in v
+static void applyLaplacian(const geometry::Compartment *comp,
+                           const std::array<double, 3> &d,
+                           const std::vector<double> &v,
+                           std::vector<double> &Lv) {
+  for (std::size_t i = 0; i < v.size(); ++i) {
+    Lv[i] = d[0] * (v[comp->up_x(i)] + v[comp->dn_x(i)] - 2.0 * v[i]) +
+            d[1] * (v[comp->up_y(i)] + v[comp->dn_y(i)] - 2.0 * v[i]) +
+            d[2] * (v[comp->up_z(i)] + v[comp->dn_z(i)] - 2.0 * v[i]);
+  }
+}
+
+void SimCompartment::solveImplicitDiffusion(double dt,
+                                            std::size_t speciesIndex) {
+  // solve A x = b, with A = 1 - dt D Laplacian, using the Jacobi
+  // preconditioned conjugate gradient method. A is symmetric positive
+  // definite since the neighbour of a boundary voxel is itself.
+  constexpr double relativeTolerance{1e-10};
+  auto &w{implicitDiffusionWorkspaces[speciesIndex]};
+  w.converged = true;
+  if (!isDiffusing(speciesIndex)) {
+    return;
+  }
+  const auto &d{diffConstants[speciesIndex]};
+  auto &[x, r, z, p, q, invDiag, converged]{w};
+  x.resize(nPixels);
+  r.resize(nPixels);
+  z.resize(nPixels);
+  p.resize(nPixels);
+  q.resize(nPixels);
+  invDiag.resize(nPixels);
+  for (std::size_t ix = 0; ix < nPixels; ++ix) {
+    x[ix] = conc[index(ix, speciesIndex)];
+  }
+  auto applyA = [c = comp, dt, &d](const std::vector<double> &v,
+                                    std::vector<double> &Av) {
+    applyLaplacian(c, d, v, Av);
+    for (std::size_t i = 0; i < v.size(); ++i) {
+      Av[i] = v[i] - dt * Av[i];
+    }
+  };
+  auto dot = [](const std::vector<double> &a, const std::vector<double> &b) {
+    return std::inner_product(a.cbegin(), a.cend(), b.cbegin(), 0.0);
+  };
+  // inverse of diagonal of A: a neighbour that is the voxel itself does not
+  // contribute to the diagonal
+  for (std::size_t i = 0; i < nPixels; ++i) {
+    auto n = [i](std::size_t up, std::size_t dn) {
+      return static_cast<double>(static_cast<int>(up != i) +
+                                 static_cast<int>(dn != i));
+    };
+    invDiag[i] = 1.0 / (1.0 + dt * (d[0] * n(comp->up_x(i), comp->dn_x(i)) +
+                                    d[1] * n(comp->up_y(i), comp->dn_y(i)) +
+                                    d[2] * n(comp->up_z(i), comp->dn_z(i))));
+  }
+  // initial guess x = b
+  const double bNorm{std::sqrt(dot(x, x))};
+  applyA(x, r);
+  for (std::size_t i = 0; i < nPixels; ++i) {
+    r[i] = conc[index(i, speciesIndex)] - r[i];
+  }
+  for (std::size_t i = 0; i < nPixels; ++i) {
+    z[i] = invDiag[i] * r[i];
+  }
+  p = z;
+  double rz{dot(r, z)};
+  std::size_t iter{0};
+  auto isConverged = [&]() {
+    return std::sqrt(dot(r, r)) <= relativeTolerance * bNorm;
+  };
+  while (!isConverged() && iter < nPixels) {
+    applyA(p, q);
+    const double alpha{rz / dot(p, q)};
+    for (std::size_t i = 0; i < nPixels; ++i) {
+      x[i] += alpha * p[i];
+      r[i] -= alpha * q[i];
+      z[i] = invDiag[i] * r[i];
+    }
+    const double rzNew{dot(r, z)};
+    const double beta{rzNew / rz};
+    rz = rzNew;
+    for (std::size_t i = 0; i < nPixels; ++i) {
+      p[i] = z[i] + beta * p[i];
+    }
+    ++iter;
+  }
+  converged = isConverged();
+  if (!converged) {
+    // leave conc unchanged: the caller rejects the step
+    SPDLOG_DEBUG("species {}: CG did not converge in {} iterations",
+                 speciesIndex, iter);
+    return;
+  }
+  SPDLOG_TRACE("species {}: CG converged in {} iterations", speciesIndex,
+               iter);
+  for (std::size_t ix = 0; ix < nPixels; ++ix) {
+    conc[index(ix, speciesIndex)] = x[ix];
+  }
+}
+
+bool SimCompartment::solveImplicitDiffusion(double dt) {
+  implicitDiffusionWorkspaces.resize(nSpecies);
+  for (std::size_t is = 0; is < nSpecies; ++is) {
+    solveImplicitDiffusion(dt, is);
+  }
+  return std::ranges::all_of(implicitDiffusionWorkspaces,
+                             &ImplicitDiffusionWorkspace::converged);
+}
+
+bool SimCompartment::solveImplicitDiffusion_tbb(double dt) {
+  implicitDiffusionWorkspaces.resize(nSpecies);
+  // each species is an independent linear system
+  tbbParallelFor(
+      nSpecies,
+      [this, dt](const oneapi::tbb::blocked_range<std::size_t> &r) {
+        for (std::size_t is = r.begin(); is < r.end(); ++is) {
+          solveImplicitDiffusion(dt, is);
+        }
+      },
+      1);
+  return std::ranges::all_of(implicitDiffusionWorkspaces,
+                             &ImplicitDiffusionWorkspace::converged);
+}
+
+void SimCompartment::addExplicitDiffusion(double dt,
+                                          std::size_t speciesIndex) {
+  if (!isDiffusing(speciesIndex)) {
+    return;
+  }
+  std::vector<double> c(nPixels);
+  for (std::size_t ix = 0; ix < nPixels; ++ix) {
+    c[ix] = s3[index(ix, speciesIndex)];
+  }
+  std::vector<double> dc(nPixels);
+  applyLaplacian(comp, diffConstants[speciesIndex], c, dc);
+  for (std::size_t ix = 0; ix < nPixels; ++ix) {
+    conc[index(ix, speciesIndex)] += dt * dc[ix];
+  }
+}
+
+void SimCompartment::addExplicitDiffusion(double dt) {
+  for (std::size_t is = 0; is < nSpecies; ++is) {
+    addExplicitDiffusion(dt, is);
+  }
+}
+
+void SimCompartment::addExplicitDiffusion_tbb(double dt) {
+  tbbParallelFor(
+      nSpecies,
+      [this, dt](const oneapi::tbb::blocked_range<std::size_t> &r) {
+        for (std::size_t is = r.begin(); is < r.end(); ++is) {
+          addExplicitDiffusion(dt, is);
+        }
+      },
+      1);
+}
+
+bool SimCompartment::isDiffusing(std::size_t speciesIndex) const {
+  const auto &d{diffConstants[speciesIndex]};
+  return (d[0] != 0.0 || d[1] != 0.0 || d[2] != 0.0) &&
+         std::ranges::find(nonSpatialSpeciesIndices, speciesIndex) ==
+             nonSpatialSpeciesIndices.cend();
+}
+
+void SimCompartment::doDiffusionSubsteps(double dt, std::size_t speciesIndex) {
+  // forwards Euler substeps, each no larger than this species' own stability
+  // bound, rather than the bound of the fastest diffusing species
+  if (!isDiffusing(speciesIndex)) {
+    return;
+  }
+  const auto &d{diffConstants[speciesIndex]};
+  const auto nSubsteps{
+      static_cast<std::size_t>(std::ceil(dt / calculateMaxStableTimestep(d)))};
+  const double h{dt / static_cast<double>(nSubsteps)};
+  std::vector<double> c(nPixels);
+  for (std::size_t ix = 0; ix < nPixels; ++ix) {
+    c[ix] = conc[index(ix, speciesIndex)];
+  }
+  std::vector<double> dc(nPixels);
+  for (std::size_t n = 0; n < nSubsteps; ++n) {
+    applyLaplacian(comp, d, c, dc);
+    for (std::size_t ix = 0; ix < nPixels; ++ix) {
+      c[ix] += h * dc[ix];
+    }
+  }
+  for (std::size_t ix = 0; ix < nPixels; ++ix) {
+    conc[index(ix, speciesIndex)] = c[ix];
+  }
+}
+
+void SimCompartment::doDiffusionSubsteps(double dt) {
+  for (std::size_t is = 0; is < nSpecies; ++is) {
+    doDiffusionSubsteps(dt, is);
+  }
+}
+
+void SimCompartment::doDiffusionSubsteps_tbb(double dt) {
+  tbbParallelFor(
+      nSpecies,
+      [this, dt](const oneapi::tbb::blocked_range<std::size_t> &r) {
+        for (std::size_t is = r.begin(); is < r.end(); ++is) {
+          doDiffusionSubsteps(dt, is);
+        }
+      },
+      1);
+}
+
 void SimCompartment::undoRKStep(std::size_t begin, std::size_t end) {
   for (std::size_t i = begin; i < end; ++i) {
     conc[i] = s3[i];
@@ -353,10 +975,11 @@ void SimCompartment::undoRKStep_tbb() {
                  });
 }
 
-PixelIntegratorError SimCompartment::calculateRKError(double epsilon) const {
+PixelIntegratorError SimCompartment::calculateRKError(double epsilon,
+                                                      std::size_t begin,
+                                                      std::size_t end) const {
   PixelIntegratorError err{0.0, 0.0};
-  std::size_t n{conc.size()};
-  for (std::size_t i = 0; i < n; ++i) {
+  for (std::size_t i = begin; i < end; ++i) {
     double localErr = std::abs(conc[i] - s2[i]);
     err.abs = std::max(err.abs, localErr);
     // average current and previous concentrations and add a (hopefully) small
@@ -367,30 +990,167 @@ PixelIntegratorError SimCompartment::calculateRKError(double epsilon) const {
   return err;
 }
 
+PixelIntegratorError SimCompartment::calculateRKError(double epsilon) const {
+  return calculateRKError(epsilon, 0, conc.size());
+}
+
+PixelIntegratorError
+SimCompartment::calculateRKError_tbb(double epsilon) const {
+  // max is associative & commutative, so the result does not depend on how
+  // the range is split between threads
+  return tbbParallelReduce(
+      conc.size(), PixelIntegratorError{0.0, 0.0},
+      [this, epsilon](const oneapi::tbb::blocked_range<std::size_t> &r) {
+        return calculateRKError(epsilon, r.begin(), r.end());
+      },
+      maxError);
+}
+
+bool SimCompartment::canFuseSteps() const {
+  // non-spatial species need a separate sweep to average dcdt
+  return fusedStepsAllowed && nonSpatialSpeciesIndices.empty();
+}
+
+void SimCompartment::disallowFusedSteps() { fusedStepsAllowed = false; }
+
+void SimCompartment::applyFusedRKStage(const FusedRKStage &stage,
+                                       std::size_t begin, std::size_t end,
+                                       PixelIntegratorError &err) {
+  // same floating point operations in the same order as the separate
+  // doRK*Substep, doRKInit, doRKFinalise and calculateRKError functions, but
+  // the new conc is written to concNext since neighbouring tiles still need
+  // the old conc to evaluate their diffusion terms
+  const double dt{stage.dt};
+  switch (stage.type) {
+  case FusedRKStage::Type::ForwardsEuler:
+    for (std::size_t i = begin; i < end; ++i) {
+      concNext[i] = conc[i] + dt * dcdt[i];
+    }
+    break;
+  case FusedRKStage::Type::RK212Substep1:
+    for (std::size_t i = begin; i < end; ++i) {
+      s3[i] = conc[i];
+      concNext[i] = conc[i] + dt * dcdt[i];
+    }
+    break;
+  case FusedRKStage::Type::RK212Substep2:
+    for (std::size_t i = begin; i < end; ++i) {
+      s2[i] = conc[i];
+      concNext[i] = 0.5 * s3[i] + 0.5 * conc[i] + 0.5 * dt * dcdt[i];
+    }
+    break;
+  case FusedRKStage::Type::ShuOsher: {
+    const double g1{stage.g1};
+    const double g2{stage.g2};
+    const double g3{stage.g3};
+    const double beta{stage.beta};
+    const double delta{stage.delta};
+    if (stage.init) {
+      for (std::size_t i = begin; i < end; ++i) {
+        s2[i] = 0.0;
+        s3[i] = conc[i];
+      }
+    }
+    for (std::size_t i = begin; i < end; ++i) {
+      s2[i] += delta * conc[i];
+      concNext[i] =
+          g1 * conc[i] + g2 * s2[i] + g3 * s3[i] + beta * dt * dcdt[i];
+    }
+    if (stage.finalise) {
+      const double cFactor{stage.cFactor};
+      const double s2Factor{stage.s2Factor};
+      const double s3Factor{stage.s3Factor};
+      for (std::size_t i = begin; i < end; ++i) {
+        s2[i] = cFactor * concNext[i] + s2Factor * s2[i] + s3Factor * s3[i];
+      }
+    }
+    break;
+  }
+  }
+  if (stage.calculateError) {
+    for (std::size_t i = begin; i < end; ++i) {
+      double localErr = std::abs(concNext[i] - s2[i]);
+      err.abs = std::max(err.abs, localErr);
+      double localNorm = 0.5 * (concNext[i] + s3[i] + stage.epsilon);
+      err.rel = std::max(err.rel, localErr / localNorm);
+    }
+  }
+}
+
+PixelIntegratorError
+SimCompartment::doFusedRKSubstep(const FusedRKStage &stage, std::size_t begin,
+                                 std::size_t end) {
+  PixelIntegratorError err{0.0, 0.0};
+  for (std::size_t b = begin; b < end; b += fusedTileSize) {
+    const std::size_t e{std::min(b + fusedTileSize, end)};
+    evaluateReactions(b, e);
+    evaluateDiffusionOperator(b, e);
+    if (useSoA) {
+      for (std::size_t is = 0; is < nSpecies; ++is) {
+        applyFusedRKStage(stage, index(b, is), index(e, is), err);
+      }
+    } else {
+      applyFusedRKStage(stage, index(b, 0), index(e, 0), err);
+    }
+  }
+  return err;
+}
+
+PixelIntegratorError
+SimCompartment::doFusedRKSubstep(const FusedRKStage &stage) {
+  s2.resize(conc.size());
+  s3.resize(conc.size());
+  concNext.resize(conc.size());
+  auto err{doFusedRKSubstep(stage, 0, nPixels)};
+  std::swap(conc, concNext);
+  return err;
+}
+
+PixelIntegratorError
+SimCompartment::doFusedRKSubstep_tbb(const FusedRKStage &stage) {
+  s2.resize(conc.size());
+  s3.resize(conc.size());
+  concNext.resize(conc.size());
+  auto err{tbbParallelReduce(
+      nPixels, PixelIntegratorError{0.0, 0.0},
+      [this, &stage](const oneapi::tbb::blocked_range<std::size_t> &r) {
+        return doFusedRKSubstep(stage, r.begin(), r.end());
+      },
+      maxError)};
+  std::swap(conc, concNext);
+  return err;
+}
+
 std::string SimCompartment::plotRKError(common::ImageStack &images,
                                         double epsilon, double max) const {
   auto imageSize{comp->getImageSize()};
   images = {imageSize, QImage::Format_RGB32};
   images.fill(0);
   std::size_t iSpecies{nSpecies + 1};
-  for (std::size_t i = 0; i < conc.size(); ++i) {
-    double localErr = std::abs(conc[i] - s2[i]);
-    double localNorm = 0.5 * (conc[i] + s3[i] + epsilon);
-    double pixelIntensity{localErr / localNorm / max};
-    auto red{static_cast<int>(255.0 * pixelIntensity)};
-    auto voxel{comp->getVoxel(i / nSpecies)};
-    auto oldRed{qRed(images[voxel.z].pixel(voxel.p))};
-    if (red > oldRed) {
-      images[voxel.z].setPixel(voxel.p, qRgb(red, 0, 0));
-      if (red > 254) {
-        // update index of species with largest error
-        iSpecies = i % nSpecies;
+  for (std::size_t ix = 0; ix < nPixels; ++ix) {
+    for (std::size_t is = 0; is < nSpecies; ++is) {
+      const std::size_t i{index(ix, is)};
+      double localErr = std::abs(conc[i] - s2[i]);
+      double localNorm = 0.5 * (conc[i] + s3[i] + epsilon);
+      double pixelIntensity{localErr / localNorm / max};
+      auto red{static_cast<int>(255.0 * pixelIntensity)};
+      auto voxel{comp->getVoxel(ix)};
+      auto oldRed{qRed(images[voxel.z].pixel(voxel.p))};
+      if (red > oldRed) {
+        images[voxel.z].setPixel(voxel.p, qRgb(red, 0, 0));
+        if (red > 254) {
+          // update index of species with largest error
+          iSpecies = is;
+        }
       }
     }
   }
-  if (iSpecies < nSpecies) {
+  if (iSpecies < speciesNames.size()) {
     return speciesNames[iSpecies];
   }
+  if (iSpecies < nSpecies) {
+    return speciesIds[iSpecies];
+  }
   return {};
 }
 
@@ -403,38 +1163,97 @@ const std::vector<std::string> &SimCompartment::getSpeciesIds() const {
 }
 
 const std::vector<double> &SimCompartment::getConcentrations() const {
+  if (useSoA || nSensitivityParameters > 0) {
+    return concAoS;
+  }
   return conc;
 }
 
 void SimCompartment::setConcentrations(
     const std::vector<double> &concentrations) {
+  if (useSoA || nSensitivityParameters > 0) {
+    fromAoS(concentrations, conc, nOutputSpecies());
+    toAoS(conc, concAoS, nOutputSpecies());
+    return;
+  }
   conc = concentrations;
 }
 
+std::vector<double>
+SimCompartment::getConcentrationSensitivity(std::size_t speciesIndex,
+                                            std::size_t parameterIndex) const {
+  std::vector<double> s(nPixels, 0.0);
+  const std::size_t is{sensitivityIndex(speciesIndex, parameterIndex)};
+  for (std::size_t ix = 0; ix < nPixels; ++ix) {
+    s[ix] = conc[index(ix, is)];
+  }
+  return s;
+}
+
+std::vector<double>
+SimCompartment::getDcdtSensitivity(std::size_t speciesIndex,
+                                   std::size_t parameterIndex) const {
+  std::vector<double> s(nPixels, 0.0);
+  const std::size_t is{sensitivityIndex(speciesIndex, parameterIndex)};
+  for (std::size_t ix = 0; ix < nPixels; ++ix) {
+    s[ix] = dcdt[index(ix, is)];
+  }
+  return s;
+}
+
 double
 SimCompartment::getLowerOrderConcentration(std::size_t speciesIndex,
                                            std::size_t pixelIndex) const {
   if (s2.empty()) {
     return 0;
   }
-  return s2[pixelIndex * nSpecies + speciesIndex];
+  return s2[index(pixelIndex, speciesIndex)];
 }
 
 const std::vector<common::Voxel> &SimCompartment::getVoxels() const {
   return comp->getVoxels();
 }
 
-std::vector<double> &SimCompartment::getDcdt() { return dcdt; }
+const std::vector<double> &SimCompartment::getDcdt() const {
+  if (useSoA || nSensitivityParameters > 0) {
+    return dcdtAoS;
+  }
+  return dcdt;
+}
+
+void SimCompartment::updateAoSView() {
+  if (useSoA || nSensitivityParameters > 0) {
+    toAoS(conc, concAoS, nOutputSpecies());
+    toAoS(dcdt, dcdtAoS, nOutputSpecies());
+  }
+}
+
+const double *SimCompartment::getConcentrationData() const {
+  return conc.data();
+}
+
+double *SimCompartment::getDcdtData() { return dcdt.data(); }
 
 double SimCompartment::getMaxStableTimestep() const {
   return maxStableTimestep;
 }
 
+double SimCompartment::getSlowestSpeciesStableTimestep() const {
+  return slowestSpeciesStableTimestep;
+}
+
+void SimCompartment::setRuntimeParameterValues(
+    const std::vector<double> &values) {
+  runtimeParameterValues = values;
+  runtimeParameterValuesId = newParameterValuesId();
+}
+
 SimMembrane::SimMembrane(
     const model::Model &doc, const geometry::Membrane *membrane_ptr,
     SimCompartment *simCompA, SimCompartment *simCompB, bool doCSE,
     unsigned optLevel, bool timeDependent, bool spaceDependent,
-    const std::map<std::string, double, std::less<>> &substitutions)
+    const std::map<std::string, double, std::less<>> &substitutions,
+    const std::vector<RuntimeParameter> &runtimeParameters)
     : membrane(membrane_ptr), compA(simCompA), compB(simCompB),
       voxelSize{doc.getGeometry().getVoxelSize()} {
   if (timeDependent) {
@@ -506,66 +1325,156 @@ SimMembrane::SimMembrane(
   std::vector<std::string> reactionID =
       common::toStdString(doc.getReactions().getIds(membrane->getId().c_str()));
   ReacExpr reacExpr(doc, speciesIds, reactionID, volOverL3, timeDependent,
-                    spaceDependent, substitutions);
+                    spaceDependent, substitutions, runtimeParameters);
   if (!(sym.parse(reacExpr.expressions, reacExpr.variables) &&
-        sym.compile(doCSE, optLevel))) {
+        sym.compile(doCSE, optLevel, reactionBatchSize))) {
     throw PixelSimImplError(sym.getErrorMessage());
   }
+  std::vector<double> runtimeParameterValues;
+  for (const auto &p : runtimeParameters) {
+    runtimeParameterValues.push_back(p.value);
+  }
+  setRuntimeParameterValues(runtimeParameterValues);
+  initColouredBlocks();
 }
 
-void SimMembrane::evaluateReactions() {
+void SimMembrane::initColouredBlocks() {
+  // split the index pairs into blocks, then greedily colour the blocks such
+  // that no two blocks of the same colour contain the same voxel of
+  // compartment A, or the same voxel of compartment B
+  const std::size_t nVoxelsA{membrane->getCompartmentA()->nVoxels()};
+  const std::size_t nVoxelsB{membrane->getCompartmentB()->nVoxels()};
+  // usedA[c][ix] is true if voxel ix of A is in a block with colour c
+  std::vector<std::vector<bool>> usedA;
+  std::vector<std::vector<bool>> usedB;
+  colouredBlocks.clear();
+  for (const auto &[fluxDir, fluxLength] :
+       std::array<std::pair<geometry::Membrane::FLUX_DIRECTION, double>, 3>{
+           {{geometry::Membrane::FLUX_DIRECTION::X, voxelSize.width()},
+            {geometry::Membrane::FLUX_DIRECTION::Y, voxelSize.height()},
+            {geometry::Membrane::FLUX_DIRECTION::Z, voxelSize.depth()}}}) {
+    const auto &indexPairs{membrane->getIndexPairs(fluxDir)};
+    for (std::size_t b = 0; b < indexPairs.size(); b += reactionBlockSize) {
+      PairBlock block{indexPairs.data() + b,
+                      std::min(reactionBlockSize, indexPairs.size() - b),
+                      fluxLength};
+      auto isFree = [&block, &usedA, &usedB](std::size_t c) {
+        for (std::size_t i = 0; i < block.n; ++i) {
+          const auto &[ixA, ixB] = block.indexPairs[i];
+          if (usedA[c][ixA] || usedB[c][ixB]) {
+            return false;
+          }
+        }
+        return true;
+      };
+      std::size_t colour{0};
+      while (colour < colouredBlocks.size() && !isFree(colour)) {
+        ++colour;
+      }
+      if (colour == colouredBlocks.size()) {
+        colouredBlocks.emplace_back();
+        usedA.emplace_back(nVoxelsA, false);
+        usedB.emplace_back(nVoxelsB, false);
+      }
+      for (std::size_t i = 0; i < block.n; ++i) {
+        const auto &[ixA, ixB] = block.indexPairs[i];
+        usedA[colour][ixA] = true;
+        usedB[colour][ixB] = true;
+      }
+      colouredBlocks[colour].push_back(block);
+    }
+  }
+  SPDLOG_DEBUG("  - {} colours", colouredBlocks.size());
+}
+
+void SimMembrane::evaluateReactions(const PairBlock &block) {
   std::size_t nSpeciesA{0};
-  const std::vector<double> *concA{nullptr};
-  std::vector<double> *dcdtA{nullptr};
+  const double *concA{nullptr};
+  double *dcdtA{nullptr};
   if (compA != nullptr) {
     nSpeciesA = compA->getSpeciesIds().size() - nExtraVars;
-    concA = &compA->getConcentrations();
-    dcdtA = &compA->getDcdt();
+    concA = compA->getConcentrationData();
+    dcdtA = compA->getDcdtData();
   }
   std::size_t nSpeciesB{0};
-  const std::vector<double> *concB{nullptr};
-  std::vector<double> *dcdtB{nullptr};
+  const double *concB{nullptr};
+  double *dcdtB{nullptr};
   if (compB != nullptr) {
     nSpeciesB = compB->getSpeciesIds().size() - nExtraVars;
-    concB = &compB->getConcentrations();
-    dcdtB = &compB->getDcdt();
+    concB = compB->getConcentrationData();
+    dcdtB = compB->getDcdtData();
   }
-  std::vector<double> species(nSpeciesA + nSpeciesB + nExtraVars, 0);
-  std::vector<double> result(nSpeciesA + nSpeciesB + nExtraVars, 0);
-  for (const auto &[fluxDir, fluxLength] :
-       std::array<std::pair<geometry::Membrane::FLUX_DIRECTION, double>, 3>{
-           {{geometry::Membrane::FLUX_DIRECTION::X, voxelSize.width()},
-            {geometry::Membrane::FLUX_DIRECTION::Y, voxelSize.height()},
-            {geometry::Membrane::FLUX_DIRECTION::Z, voxelSize.depth()}}}) {
-    for (const auto &[ixA, ixB] : membrane->getIndexPairs(fluxDir)) {
-      // populate species concentrations: first A, then B, then t,x,y,z
-      if (concA != nullptr) {
-        std::copy_n(&((*concA)[ixA * (nSpeciesA + nExtraVars)]), nSpeciesA,
-                    &species[0]);
+  const std::size_t nVars{nSpeciesA + nSpeciesB + nExtraVars};
+  const std::size_t rowSize{nVars + runtimeParameterValues.size()};
+  auto &buffers{getReactionBuffers(nVars, runtimeParameterValues,
+                                   runtimeParameterValuesId)};
+  auto &species{buffers.vars};
+  auto &result{buffers.result};
+  // populate species concentrations: first A, then B, then t,x,y,z. The
+  // runtime parameters are already in the rest of each row
+  for (std::size_t i = 0; i < block.n; ++i) {
+    const auto &[ixA, ixB] = block.indexPairs[i];
+    double *s{species.data() + i * rowSize};
+    if (concA != nullptr) {
+      for (std::size_t is = 0; is < nSpeciesA; ++is) {
+        s[is] = concA[compA->index(ixA, is)];
+      }
+    }
+    if (concB != nullptr) {
+      for (std::size_t is = 0; is < nSpeciesB + nExtraVars; ++is) {
+        s[nSpeciesA + is] = concB[compB->index(ixB, is)];
       }
-      if (concB != nullptr) {
-        std::copy_n(&((*concB)[ixB * (nSpeciesB + nExtraVars)]),
-                    nSpeciesB + nExtraVars, &species[nSpeciesA]);
-      } else if (concA != nullptr) {
-        std::copy_n(&((*concA)[ixA * (nSpeciesA + nExtraVars) + nSpeciesA]),
-                    nExtraVars, &species[nSpeciesA]);
+    } else if (concA != nullptr) {
+      for (std::size_t is = 0; is < nExtraVars; ++is) {
+        s[nSpeciesA + is] = concA[compA->index(ixA, nSpeciesA + is)];
       }
+    }
+  }
 
-      // evaluate reaction terms
-      sym.eval(result.data(), species.data());
+  // evaluate reaction terms
+  sym.evalBatch(result.data(), species.data(), block.n, rowSize);
 
-      // add results to dc/dt: first A, then B. divide by fluxLength to get
-      // change in concentration for this voxel
-      for (std::size_t is = 0; is < nSpeciesA; ++is) {
-        (*dcdtA)[ixA * (nSpeciesA + nExtraVars) + is] +=
-            result[is] / fluxLength;
-      }
-      for (std::size_t is = 0; is < nSpeciesB; ++is) {
-        (*dcdtB)[ixB * (nSpeciesB + nExtraVars) + is] +=
-            result[is + nSpeciesA] / fluxLength;
-      }
+  // add results to dc/dt: first A, then B. divide by fluxLength to get
+  // change in concentration for this voxel
+  for (std::size_t i = 0; i < block.n; ++i) {
+    const auto &[ixA, ixB] = block.indexPairs[i];
+    const double *r{result.data() + i * rowSize};
+    for (std::size_t is = 0; is < nSpeciesA; ++is) {
+      dcdtA[compA->index(ixA, is)] += r[is] / block.fluxLength;
+    }
+    for (std::size_t is = 0; is < nSpeciesB; ++is) {
+      dcdtB[compB->index(ixB, is)] += r[is + nSpeciesA] / block.fluxLength;
     }
   }
 }
 
+void SimMembrane::evaluateReactions() {
+  for (const auto &blocks : colouredBlocks) {
+    for (const auto &block : blocks) {
+      evaluateReactions(block);
+    }
+  }
+}
+
+void SimMembrane::evaluateReactions_tbb() {
+  // colours are evaluated in order, so the order in which contributions are
+  // added to each voxel is the same as in the single-threaded version
+  for (const auto &blocks : colouredBlocks) {
+    tbbParallelFor(
+        blocks.size(),
+        [this, &blocks](const oneapi::tbb::blocked_range<std::size_t> &r) {
+          for (std::size_t i = r.begin(); i < r.end(); ++i) {
+            evaluateReactions(blocks[i]);
+          }
+        },
+        1);
+  }
+}
+
+void SimMembrane::setRuntimeParameterValues(
+    const std::vector<double> &values) {
+  runtimeParameterValues = values;
+  runtimeParameterValuesId = newParameterValuesId();
+}
+
 } // namespace sme::simulate
@@ -10,9 +10,12 @@
 #include "sme/symbolic.hpp"
 #include <QImage>
 #include <QPoint>
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace sme {
@@ -36,44 +39,144 @@ struct ReacExpr {
       const std::vector<std::string> &reactionID,
       double reactionScaleFactor = 1.0, bool timeDependent = false,
       bool spaceDependent = false,
-      const std::map<std::string, double, std::less<>> &substitutions = {});
+      const std::map<std::string, double, std::less<>> &substitutions = {},
+      const std::vector<RuntimeParameter> &runtimeParameters = {},
+      const std::vector<std::size_t> &sensitivityParameters = {});
+};
+
+// run of consecutive voxels [begin, end) with the same relative offsets
+// {+x, -x, +y, -y, +z, -z} to their nearest neighbours
+struct StencilRun {
+  std::size_t begin;
+  std::size_t end;
+  std::array<std::ptrdiff_t, 6> offsets;
+};
+
+// a single RK stage, applied in the same sweep as the evaluation of dcdt
+struct FusedRKStage {
+  enum class Type { ForwardsEuler, RK212Substep1, RK212Substep2, ShuOsher };
+  Type type{Type::ForwardsEuler};
+  double dt{0.0};
+  // ShuOsher coefficients, as in SimCompartment::doRKSubstep
+  double g1{0.0};
+  double g2{0.0};
+  double g3{0.0};
+  double beta{0.0};
+  double delta{0.0};
+  // ShuOsher only: equivalent to calling doRKInit before this stage
+  bool init{false};
+  // ShuOsher only: equivalent to calling doRKFinalise after this stage
+  bool finalise{false};
+  double cFactor{0.0};
+  double s2Factor{0.0};
+  double s3Factor{0.0};
+  // equivalent to calling calculateRKError after this stage
+  bool calculateError{false};
+  double epsilon{0.0};
+};
+
+// work vectors for the implicit diffusion solve of a single species
+struct ImplicitDiffusionWorkspace {
+  std::vector<double> x;
+  std::vector<double> r;
+  std::vector<double> z;
+  std::vector<double> p;
+  std::vector<double> q;
+  std::vector<double> invDiag;
+  bool converged{true};
 };
 
 class SimCompartment {
 private:
   common::Symbolic sym;
   // species concentrations & corresponding dcdt values
-  // ordering: ix, species
+  // AoS ordering: ix, species
+  // SoA ordering: species, ix (each species padded to a whole cache line)
   std::vector<double> conc;
   std::vector<double> dcdt;
   std::vector<double> s2;
   std::vector<double> s3;
+  // fused RK stages write the new conc here, which is then swapped with conc
+  std::vector<double> concNext;
+  bool fusedStepsAllowed{true};
+  // element (ix, is) is stored at index ix * pixelStride + is * speciesStride
+  bool useSoA{false};
+  std::size_t pixelStride{0};
+  std::size_t speciesStride{1};
+  // AoS copies of conc & dcdt returned to the caller in SoA mode
+  std::vector<double> concAoS;
+  std::vector<double> dcdtAoS;
+  // one per species, allocated by the first implicit diffusion solve
+  std::vector<ImplicitDiffusionWorkspace> implicitDiffusionWorkspaces;
+  // SoA mode: runs of voxels with unit-stride neighbours & remaining voxels
+  std::vector<StencilRun> stencilRuns;
+  std::vector<std::size_t> stencilBoundaryVoxels;
   // dimensionless diffusion constants in x,y,z directions for each species
   // i.e. [{D/dx^2, D/dy^2, D/dz^2}, {}, .. ]
   std::vector<std::array<double, 3>> diffConstants;
   const geometry::Compartment *comp;
   std::size_t nPixels;
   std::size_t nSpecies;
+  // forward sensitivities d(species)/d(parameter) are the last
+  // nModelSpecies * nSensitivityParameters "species"
+  std::size_t nModelSpecies;
+  std::size_t nSensitivityParameters{0};
   std::string compartmentId;
   std::vector<std::string> speciesIds;
   std::vector<std::string> speciesNames;
   std::vector<std::size_t> nonSpatialSpeciesIndices;
   double maxStableTimestep = std::numeric_limits<double>::max();
+  // stability bound of the slowest diffusing species
+  double slowestSpeciesStableTimestep{0.0};
+  // values of the last variables of the reaction terms, the same for every
+  // voxel, so they are not stored in conc
+  std::vector<double> runtimeParameterValues;
+  std::uint64_t runtimeParameterValuesId{0};
+  void initStencilRuns();
+  PixelIntegratorError doFusedRKSubstep(const FusedRKStage &stage,
+                                        std::size_t begin, std::size_t end);
+  void applyFusedRKStage(const FusedRKStage &stage, std::size_t begin,
+                         std::size_t end, PixelIntegratorError &err);
+  void evaluateDiffusionOperatorSoA(std::size_t begin, std::size_t end);
+  // reaction terms evaluated on blocks of voxels gathered into contiguous
+  // rows, used for the SoA layout, or if there are runtime parameters
+  void evaluateReactionsBlocked(std::size_t begin, std::size_t end);
+  // AoS copy of the first nDst species of src
+  void toAoS(const std::vector<double> &src, std::vector<double> &dst,
+             std::size_t nDst) const;
+  // false for species with zero diffusion constant, e.g. t,x,y,z, and for
+  // non-spatial species which are instead spatially averaged
+  [[nodiscard]] bool isDiffusing(std::size_t speciesIndex) const;
+  void solveImplicitDiffusion(double dt, std::size_t speciesIndex);
+  void addExplicitDiffusion(double dt, std::size_t speciesIndex);
+  void doDiffusionSubsteps(double dt, std::size_t speciesIndex);
+  // src contains the first nSrc species in AoS order, others are set to zero
+  void fromAoS(const std::vector<double> &src, std::vector<double> &dst,
+               std::size_t nSrc) const;
+  [[nodiscard]] std::size_t nOutputSpecies() const;
+  [[nodiscard]] std::size_t sensitivityIndex(std::size_t speciesIndex,
+                                             std::size_t parameterIndex) const;
 
 public:
   explicit SimCompartment(
       const model::Model &doc, const geometry::Compartment *compartment,
       std::vector<std::string> sIds, bool doCSE = true, unsigned optLevel = 3,
       bool timeDependent = false, bool spaceDependent = false,
-      const std::map<std::string, double, std::less<>> &substitutions = {});
+      const std::map<std::string, double, std::less<>> &substitutions = {},
+      bool enableSoALayout = false,
+      const std::vector<RuntimeParameter> &runtimeParameters = {},
+      const std::vector<std::size_t> &sensitivityParameters = {});
 
-  // dcdt = result of applying diffusion operator to conc
+  // dcdt += result of applying diffusion operator to conc
   void evaluateDiffusionOperator(std::size_t begin, std::size_t end);
   // dcdt += result of applying reaction expressions to conc
   void evaluateReactions(std::size_t begin, std::size_t end);
+  void evaluateReactions();
+  void evaluateReactions_tbb();
   void evaluateReactionsAndDiffusion();
   void evaluateReactionsAndDiffusion_tbb();
   void spatiallyAverageDcdt();
+  void spatiallyAverageDcdt_tbb();
   void doForwardsEulerTimestep(double dt, std::size_t begin, std::size_t end);
   void doForwardsEulerTimestep(double dt);
   void doForwardsEulerTimestep_tbb(double dt);
@@ -94,21 +197,80 @@ public:
                     std::size_t begin, std::size_t end);
   void doRKFinalise(double cFactor, double s2Factor, double s3Factor);
   void doRKFinalise_tbb(double cFactor, double s2Factor, double s3Factor);
+  // IMEX: explicit reaction part of each stage, followed by an implicit
+  // diffusion solve
+  void doIMEXSubstep1(double dt, std::size_t begin, std::size_t end);
+  void doIMEXSubstep1(double dt);
+  void doIMEXSubstep1_tbb(double dt);
+  void doIMEXSubstep2(double dt, std::size_t begin, std::size_t end);
+  void doIMEXSubstep2(double dt);
+  void doIMEXSubstep2_tbb(double dt);
+  // conc = (1 - dt D Laplacian)^{-1} conc for each species: returns false
+  // if the iterative solve did not converge
+  bool solveImplicitDiffusion(double dt);
+  bool solveImplicitDiffusion_tbb(double dt);
+  // IMEX: conc += dt D Laplacian s3 for each species, where s3 contains the
+  // concentrations at the start of the step
+  void addExplicitDiffusion(double dt);
+  void addExplicitDiffusion_tbb(double dt);
+  // operator splitting: conc += diffusion over time dt, using forwards Euler
+  // substeps with the stable timestep of each species
+  void doDiffusionSubsteps(double dt);
+  void doDiffusionSubsteps_tbb(double dt);
   void undoRKStep(std::size_t begin, std::size_t end);
   void undoRKStep();
   void undoRKStep_tbb();
+  [[nodiscard]] PixelIntegratorError calculateRKError(double epsilon,
+                                                      std::size_t begin,
+                                                      std::size_t end) const;
   [[nodiscard]] PixelIntegratorError calculateRKError(double epsilon) const;
+  [[nodiscard]] PixelIntegratorError
+  calculateRKError_tbb(double epsilon) const;
+  // evaluate dcdt and apply the RK stage in a single sweep over tiles of
+  // voxels. Only possible if no other object modifies dcdt
+  [[nodiscard]] bool canFuseSteps() const;
+  void disallowFusedSteps();
+  PixelIntegratorError doFusedRKSubstep(const FusedRKStage &stage);
+  PixelIntegratorError doFusedRKSubstep_tbb(const FusedRKStage &stage);
   std::string plotRKError(common::ImageStack &images, double epsilon,
                           double max) const;
   [[nodiscard]] const std::string &getCompartmentId() const;
   [[nodiscard]] const std::vector<std::string> &getSpeciesIds() const;
+  // AoS view of the species concentrations, regardless of storage layout,
+  // excluding any forward sensitivities. In SoA mode this is only updated
+  // by updateAoSView
   [[nodiscard]] const std::vector<double> &getConcentrations() const;
+  // AoS concentrations, regardless of storage layout: forward sensitivities
+  // are set to zero
   void setConcentrations(const std::vector<double> &);
+  // d(species)/d(parameter) for each voxel
+  [[nodiscard]] std::vector<double>
+  getConcentrationSensitivity(std::size_t speciesIndex,
+                              std::size_t parameterIndex) const;
+  // d(dcdt)/d(parameter) for each voxel
+  [[nodiscard]] std::vector<double>
+  getDcdtSensitivity(std::size_t speciesIndex,
+                     std::size_t parameterIndex) const;
   [[nodiscard]] double getLowerOrderConcentration(std::size_t speciesIndex,
                                                   std::size_t pixelIndex) const;
   [[nodiscard]] const std::vector<common::Voxel> &getVoxels() const;
-  std::vector<double> &getDcdt();
+  // AoS view of dcdt, regardless of storage layout, excluding any forward
+  // sensitivities. In SoA mode this is only updated by updateAoSView
+  [[nodiscard]] const std::vector<double> &getDcdt() const;
+  // copy conc & dcdt to the AoS views, if they are stored in another layout
+  void updateAoSView();
+  // raw storage, element (ix, is) is at index(ix, is)
+  [[nodiscard]] const double *getConcentrationData() const;
+  double *getDcdtData();
+  [[nodiscard]] inline std::size_t index(std::size_t pixelIndex,
+                                         std::size_t speciesIndex) const {
+    return pixelIndex * pixelStride + speciesIndex * speciesStride;
+  }
   [[nodiscard]] double getMaxStableTimestep() const;
+  // forwards Euler stability bound of the slowest diffusing species, or zero
+  // if no species diffuse
+  [[nodiscard]] double getSlowestSpeciesStableTimestep() const;
+  void setRuntimeParameterValues(const std::vector<double> &values);
 };
 
 class SimMembrane {
@@ -119,6 +281,20 @@ private:
   SimCompartment *compB;
   common::VolumeF voxelSize{};
   std::size_t nExtraVars{0};
+  // values of the last variables of the reaction terms
+  std::vector<double> runtimeParameterValues;
+  std::uint64_t runtimeParameterValuesId{0};
+  // a block of consecutive index pairs with the same flux direction
+  struct PairBlock {
+    const std::pair<std::size_t, std::size_t> *indexPairs;
+    std::size_t n;
+    double fluxLength;
+  };
+  // blocks grouped by colour: blocks with the same colour write to disjoint
+  // voxels in both compartments, so can safely be evaluated concurrently
+  std::vector<std::vector<PairBlock>> colouredBlocks;
+  void initColouredBlocks();
+  void evaluateReactions(const PairBlock &block);
 
 public:
   SimMembrane(
@@ -126,8 +302,11 @@ public:
       SimCompartment *simCompA, SimCompartment *simCompB, bool doCSE = true,
       unsigned optLevel = 3, bool timeDependent = false,
       bool spaceDependent = false,
-      const std::map<std::string, double, std::less<>> &substitutions = {});
+      const std::map<std::string, double, std::less<>> &substitutions = {},
+      const std::vector<RuntimeParameter> &runtimeParameters = {});
   void evaluateReactions();
+  void evaluateReactions_tbb();
+  void setRuntimeParameterValues(const std::vector<double> &values);
 };
 
 } // namespace simulate
@@ -1,7 +1,14 @@
 #include "catch_wrapper.hpp"
 #include "model_test_utils.hpp"
 #include "pixelsim.hpp"
+#include "pixelsim_impl.hpp"
+#include "sme/geometry.hpp"
 #include "sme/model.hpp"
+#include "sme/utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <oneapi/tbb/global_control.h>
 
 using namespace sme;
 using namespace sme::test;
@@ -17,4 +24,375 @@ TEST_CASE("PixelSim", "[core/simulate/pixelsim][core/"
     pixelSim.run(1, -1, []() { return true; });
     REQUIRE(pixelSim.errorMessage() == "Simulation stopped early");
   }
+  SECTION("Runtime parameters can be changed without recompiling") {
+    std::vector<std::string> comps{"comp"};
+    std::vector<std::vector<std::string>> specs{{"A", "B", "C"}};
+    // reference simulation with k1 = 0.2 inlined as a constant
+    auto mRef{getExampleModel(Mod::ABtoC)};
+    mRef.getReactions().setParameterValue("r1", "k1", 0.2);
+    simulate::PixelSim ref(mRef, comps, specs);
+    REQUIRE(ref.getRuntimeParameters().empty());
+    ref.run(0.5, -1, {});
+    const auto &cRef{ref.getConcentrations(0)};
+    for (bool soa : {false, true}) {
+      CAPTURE(soa);
+      // simulation with k1 = 0.1 as a runtime parameter
+      auto m{getExampleModel(Mod::ABtoC)};
+      m.getSimulationSettings().options.pixel.enableRuntimeParameters = true;
+      m.getSimulationSettings().options.pixel.enableSoALayout = soa;
+      m.getOptimizeOptions().optParams.push_back(
+          {simulate::OptParamType::ReactionParameter, "name", "k1", "r1",
+           0.05, 0.21});
+      simulate::PixelSim pixelSim(m, comps, specs);
+      REQUIRE(pixelSim.errorMessage().empty());
+      const auto &params{pixelSim.getRuntimeParameters()};
+      REQUIRE(params.size() == 1);
+      REQUIRE(params[0].id == "k1");
+      REQUIRE(params[0].reactionId == "r1");
+      REQUIRE(params[0].value == dbl_approx(0.1));
+      // wrong number of values is ignored
+      pixelSim.setRuntimeParameterValues({0.2, 0.3});
+      REQUIRE(params[0].value == dbl_approx(0.1));
+      pixelSim.setRuntimeParameterValues({0.2});
+      REQUIRE(params[0].value == dbl_approx(0.2));
+      pixelSim.run(0.5, -1, {});
+      const auto &c{pixelSim.getConcentrations(0)};
+      REQUIRE(c.size() == cRef.size());
+      for (std::size_t i = 0; i < c.size(); ++i) {
+        REQUIRE(c[i] == Catch::Approx(cRef[i]).epsilon(1e-10).margin(1e-14));
+      }
+    }
+  }
+  SECTION("Forward sensitivities match finite differences") {
+    std::vector<std::string> comps{"comp"};
+    std::vector<std::vector<std::string>> specs{{"A", "B", "C"}};
+    auto makeModel = [](double k1, bool sensitivities, bool soa) {
+      auto m{getExampleModel(Mod::ABtoC)};
+      auto &options{m.getSimulationSettings().options.pixel};
+      options.integrator = simulate::PixelIntegratorType::RK435;
+      options.maxErr.rel = 1e-6;
+      options.enableSoALayout = soa;
+      options.enableRuntimeParameters = true;
+      options.enableSensitivities = sensitivities;
+      m.getOptimizeOptions().optParams.push_back(
+          {simulate::OptParamType::ReactionParameter, "name", "k1", "r1",
+           0.05, 0.21});
+      m.getReactions().setParameterValue("r1", "k1", k1);
+      return m;
+    };
+    constexpr double k1{0.1};
+    constexpr double h{1e-4};
+    constexpr double t{0.1};
+    for (bool soa : {false, true}) {
+      CAPTURE(soa);
+      auto m{makeModel(k1, true, soa)};
+      simulate::PixelSim pixelSim(m, comps, specs);
+      REQUIRE(pixelSim.errorMessage().empty());
+      REQUIRE(pixelSim.getSensitivityParameters().size() == 1);
+      pixelSim.run(t, -1, {});
+      auto m0{makeModel(k1, false, soa)};
+      simulate::PixelSim sim0(m0, comps, specs);
+      REQUIRE(sim0.getSensitivityParameters().empty());
+      sim0.run(t, -1, {});
+      auto m1{makeModel(k1 + h, false, soa)};
+      simulate::PixelSim sim1(m1, comps, specs);
+      sim1.run(t, -1, {});
+      // sensitivities are not included in the concentrations
+      const auto &c{pixelSim.getConcentrations(0)};
+      const auto &c0{sim0.getConcentrations(0)};
+      const auto &c1{sim1.getConcentrations(0)};
+      REQUIRE(c.size() == c0.size());
+      const std::size_t stride{3 + pixelSim.getConcentrationPadding()};
+      for (std::size_t is = 0; is < 3; ++is) {
+        auto sensitivity{pixelSim.getConcentrationSensitivity(0, is, 0)};
+        REQUIRE(sensitivity.size() == c.size() / stride);
+        double sum{0.0};
+        double sumFiniteDifference{0.0};
+        for (std::size_t ix = 0; ix < sensitivity.size(); ++ix) {
+          REQUIRE(c[ix * stride + is] ==
+                  Catch::Approx(c0[ix * stride + is])
+                      .epsilon(1e-4)
+                      .margin(1e-10));
+          sum += sensitivity[ix];
+          sumFiniteDifference +=
+              (c1[ix * stride + is] - c0[ix * stride + is]) / h;
+        }
+        REQUIRE(sum == Catch::Approx(sumFiniteDifference).epsilon(1e-2));
+      }
+    }
+  }
+  SECTION("IMEX controls the diffusion error") {
+    // pure diffusion model: with no reactions the error estimate must come
+    // from the diffusion solve, otherwise a single large implicit step is
+    // taken for the whole simulation time
+    auto m{getExampleModel(Mod::SingleCompartmentDiffusion)};
+    std::vector<std::string> comps{"circle"};
+    std::vector<std::vector<std::string>> specs{{"slow", "fast"}};
+    auto &options{m.getSimulationSettings().options.pixel};
+    options.maxErr = {std::numeric_limits<double>::max(), 0.001};
+    options.integrator = simulate::PixelIntegratorType::RK323;
+    simulate::PixelSim ref(m, comps, specs);
+    options.integrator = simulate::PixelIntegratorType::IMEX;
+    simulate::PixelSim imex(m, comps, specs);
+    REQUIRE(imex.errorMessage().empty());
+    constexpr double t{10.0};
+    ref.run(t, -1, {});
+    REQUIRE(imex.run(t, -1, {}) > 1);
+    const auto cRef{ref.getConcentrations(0)};
+    const auto c{imex.getConcentrations(0)};
+    REQUIRE(c.size() == cRef.size());
+    const std::size_t stride{2 + imex.getConcentrationPadding()};
+    for (std::size_t is = 0; is < 2; ++is) {
+      CAPTURE(is);
+      double cMax{0.0};
+      for (std::size_t ix = 0; ix < c.size() / stride; ++ix) {
+        cMax = std::max(cMax, cRef[ix * stride + is]);
+      }
+      for (std::size_t ix = 0; ix < c.size() / stride; ++ix) {
+        REQUIRE(std::abs(c[ix * stride + is] - cRef[ix * stride + is]) <
+                0.01 * cMax);
+      }
+    }
+  }
+}
+
+TEST_CASE("SimCompartment", "[core/simulate/pixelsim][core/"
+                            "simulate][core][simulate][pixel]") {
+  SECTION("Fused RK stages are identical to separate sweeps") {
+    auto m{getExampleModel(Mod::ABtoC)};
+    const auto *comp{m.getCompartments().getCompartment("comp")};
+    std::vector<std::string> specs{"A", "B", "C"};
+    constexpr double dt{0.01};
+    constexpr double epsilon{1e-14};
+    using Stage = simulate::FusedRKStage;
+    for (bool soa : {false, true}) {
+      for (bool tbb : {false, true}) {
+        CAPTURE(soa);
+        CAPTURE(tbb);
+        simulate::SimCompartment ref(m, comp, specs, true, 3, false, false, {},
+                                     soa);
+        simulate::SimCompartment fused(m, comp, specs, true, 3, false, false,
+                                       {}, soa);
+        REQUIRE(fused.canFuseSteps());
+        auto fusedStep = [&fused, tbb](const Stage &stage) {
+          return tbb ? fused.doFusedRKSubstep_tbb(stage)
+                     : fused.doFusedRKSubstep(stage);
+        };
+        auto refDcdt = [&ref, tbb]() {
+          if (tbb) {
+            ref.evaluateReactionsAndDiffusion_tbb();
+          } else {
+            ref.evaluateReactionsAndDiffusion();
+          }
+        };
+        // copy the SoA state to the AoS views before comparing them
+        auto updateViews = [&ref, &fused]() {
+          ref.updateAoSView();
+          fused.updateAoSView();
+        };
+        // forwards Euler
+        refDcdt();
+        ref.doForwardsEulerTimestep(dt);
+        fusedStep({.type = Stage::Type::ForwardsEuler, .dt = dt});
+        updateViews();
+        REQUIRE(fused.getConcentrations() == ref.getConcentrations());
+        REQUIRE(fused.getDcdt() == ref.getDcdt());
+        // RK212
+        refDcdt();
+        ref.doRK212Substep1(dt);
+        refDcdt();
+        ref.doRK212Substep2(dt);
+        auto refErr{ref.calculateRKError(epsilon)};
+        fusedStep({.type = Stage::Type::RK212Substep1, .dt = dt});
+        auto err{fusedStep({.type = Stage::Type::RK212Substep2,
+                            .dt = dt,
+                            .calculateError = true,
+                            .epsilon = epsilon})};
+        updateViews();
+        REQUIRE(fused.getConcentrations() == ref.getConcentrations());
+        REQUIRE(fused.getDcdt() == ref.getDcdt());
+        REQUIRE(err.abs == refErr.abs);
+        REQUIRE(err.rel == refErr.rel);
+        // RK323
+        constexpr std::array<double, 3> g1{1.0, 0.25, 0.666666666666666666666};
+        constexpr std::array<double, 3> g3{0.0, 0.75, 0.333333333333333333333};
+        constexpr std::array<double, 3> beta{1.0, 0.25, 0.6666666666666666666};
+        constexpr std::array<double, 3> delta{0.0, 0.0, 1.0};
+        ref.doRKInit();
+        for (std::size_t i = 0; i < 3; ++i) {
+          refDcdt();
+          ref.doRKSubstep(dt, g1[i], 0.0, g3[i], beta[i], delta[i]);
+          err = fusedStep({.type = Stage::Type::ShuOsher,
+                           .dt = dt,
+                           .g1 = g1[i],
+                           .g3 = g3[i],
+                           .beta = beta[i],
+                           .delta = delta[i],
+                           .init = i == 0,
+                           .finalise = i == 2,
+                           .cFactor = 0.0,
+                           .s2Factor = 2.0,
+                           .s3Factor = -1.0,
+                           .calculateError = i == 2,
+                           .epsilon = epsilon});
+        }
+        ref.doRKFinalise(0.0, 2.0, -1.0);
+        refErr = ref.calculateRKError(epsilon);
+        updateViews();
+        REQUIRE(fused.getConcentrations() == ref.getConcentrations());
+        REQUIRE(fused.getDcdt() == ref.getDcdt());
+        REQUIRE(err.abs == refErr.abs);
+        REQUIRE(err.rel == refErr.rel);
+        for (std::size_t ix : std::array<std::size_t, 3>{0, 10, 1000}) {
+          for (std::size_t is = 0; is < specs.size(); ++is) {
+            REQUIRE(fused.getLowerOrderConcentration(is, ix) ==
+                    ref.getLowerOrderConcentration(is, ix));
+          }
+        }
+        // undo step
+        ref.undoRKStep();
+        fused.undoRKStep();
+        updateViews();
+        REQUIRE(fused.getConcentrations() == ref.getConcentrations());
+      }
+    }
+  }
+  SECTION("Multithreaded error & spatial average are independent of the "
+          "number of threads") {
+    auto m{getExampleModel(Mod::ABtoC)};
+    m.getSpecies().setIsSpatial("B", false);
+    const auto *comp{m.getCompartments().getCompartment("comp")};
+    std::vector<std::string> specs{"A", "B", "C"};
+    constexpr double dt{0.01};
+    constexpr double epsilon{1e-14};
+    std::vector<std::vector<double>> dcdts;
+    std::vector<simulate::PixelIntegratorError> errors;
+    for (std::size_t nThreads : {1, 2, 3, 4}) {
+      CAPTURE(nThreads);
+      oneapi::tbb::global_control control(
+          oneapi::tbb::global_control::max_allowed_parallelism, nThreads);
+      simulate::SimCompartment sim(m, comp, specs);
+      REQUIRE(sim.canFuseSteps() == false);
+      sim.evaluateReactionsAndDiffusion_tbb();
+      sim.spatiallyAverageDcdt_tbb();
+      sim.doRK212Substep1_tbb(dt);
+      sim.evaluateReactionsAndDiffusion_tbb();
+      sim.spatiallyAverageDcdt_tbb();
+      sim.doRK212Substep2_tbb(dt);
+      dcdts.push_back(sim.getDcdt());
+      errors.push_back(sim.calculateRKError_tbb(epsilon));
+      // max error is identical to the single threaded calculation
+      auto err{sim.calculateRKError(epsilon)};
+      REQUIRE(errors.back().abs == err.abs);
+      REQUIRE(errors.back().rel == err.rel);
+      // non-spatial species has the same dcdt in every voxel
+      for (std::size_t ix = 0; ix < comp->nVoxels(); ++ix) {
+        REQUIRE(dcdts.back()[3 * ix + 1] == dcdts.back()[1]);
+      }
+    }
+    for (std::size_t i = 1; i < dcdts.size(); ++i) {
+      REQUIRE(dcdts[i] == dcdts[0]);
+      REQUIRE(errors[i].abs == errors[0].abs);
+      REQUIRE(errors[i].rel == errors[0].rel);
+    }
+  }
+  SECTION("Implicit diffusion solve conserves mass") {
+    auto m{getExampleModel(Mod::ABtoC)};
+    const auto *comp{m.getCompartments().getCompartment("comp")};
+    std::vector<std::string> specs{"A", "B", "C"};
+    simulate::SimCompartment aos(m, comp, specs);
+    simulate::SimCompartment soa(m, comp, specs, true, 3, false, false, {},
+                                 true);
+    auto totals = [&specs](const std::vector<double> &c) {
+      std::vector<double> sums(specs.size(), 0.0);
+      for (std::size_t i = 0; i < c.size(); ++i) {
+        sums[i % specs.size()] += c[i];
+      }
+      return sums;
+    };
+    auto initialTotals{totals(aos.getConcentrations())};
+    // timestep far above the forwards Euler stability limit
+    double dt{1000.0 * aos.getMaxStableTimestep()};
+    REQUIRE(aos.solveImplicitDiffusion(dt));
+    REQUIRE(soa.solveImplicitDiffusion_tbb(dt));
+    soa.updateAoSView();
+    auto finalTotals{totals(aos.getConcentrations())};
+    for (std::size_t is = 0; is < specs.size(); ++is) {
+      REQUIRE(finalTotals[is] ==
+              Catch::Approx(initialTotals[is]).epsilon(1e-8));
+    }
+    REQUIRE(soa.getConcentrations() == aos.getConcentrations());
+  }
+  SECTION("Diffusion substeps") {
+    auto m{getExampleModel(Mod::ABtoC)};
+    const auto *comp{m.getCompartments().getCompartment("comp")};
+    std::vector<std::string> specs{"A", "B", "C"};
+    m.getSpecies().setDiffusionConstant("A", 0.0);
+    m.getSpecies().setDiffusionConstant(
+        "C", 0.1 * m.getSpecies().getDiffusionConstant("B"));
+    simulate::SimCompartment ref(m, comp, specs);
+    simulate::SimCompartment sim(m, comp, specs);
+    REQUIRE(sim.isDiffusing(0) == false);
+    REQUIRE(sim.isDiffusing(1) == true);
+    REQUIRE(sim.isDiffusing(2) == true);
+    // a single forwards Euler step of diffusion with the stable timestep
+    double dt{sim.getMaxStableTimestep()};
+    ref.evaluateDiffusionOperator(0, comp->nVoxels());
+    ref.doForwardsEulerTimestep(dt);
+    sim.doDiffusionSubsteps(dt);
+    const auto &c0{ref.getConcentrations()};
+    const auto &c1{sim.getConcentrations()};
+    for (std::size_t i = 0; i < c0.size(); ++i) {
+      REQUIRE(c1[i] == dbl_approx(c0[i]));
+    }
+    // species without diffusion are not modified, others conserve mass
+    auto c{sim.getConcentrations()};
+    sim.doDiffusionSubsteps_tbb(100.0 * dt);
+    double sumB0{0};
+    double sumB1{0};
+    for (std::size_t ix = 0; ix < comp->nVoxels(); ++ix) {
+      REQUIRE(sim.getConcentrations()[3 * ix] == c[3 * ix]);
+      sumB0 += c[3 * ix + 1];
+      sumB1 += sim.getConcentrations()[3 * ix + 1];
+    }
+    REQUIRE(sumB1 == Catch::Approx(sumB0).epsilon(1e-12));
+  }
+}
+
+TEST_CASE("SimMembrane", "[core/simulate/pixelsim][core/"
+                         "simulate][core][simulate][pixel]") {
+  SECTION("Multithreaded membrane fluxes are identical to single threaded") {
+    auto m{getExampleModel(Mod::VerySimpleModel)};
+    const auto &membrane{m.getMembranes().getMembranes()[0]};
+    const auto *compA{membrane.getCompartmentA()};
+    const auto *compB{membrane.getCompartmentB()};
+    auto specsA{common::toStdString(
+        m.getSpecies().getIds(compA->getId().c_str()))};
+    auto specsB{common::toStdString(
+        m.getSpecies().getIds(compB->getId().c_str()))};
+    simulate::SimCompartment refA(m, compA, specsA);
+    simulate::SimCompartment refB(m, compB, specsB);
+    simulate::SimMembrane refMembrane(m, &membrane, &refA, &refB);
+    refA.evaluateReactionsAndDiffusion();
+    refB.evaluateReactionsAndDiffusion();
+    auto dcdtA{refA.getDcdt()};
+    auto dcdtB{refB.getDcdt()};
+    refMembrane.evaluateReactions();
+    // membrane reactions change dcdt in both compartments
+    REQUIRE(refA.getDcdt() != dcdtA);
+    REQUIRE(refB.getDcdt() != dcdtB);
+    for (std::size_t nThreads : {1, 2, 3, 4}) {
+      CAPTURE(nThreads);
+      oneapi::tbb::global_control control(
+          oneapi::tbb::global_control::max_allowed_parallelism, nThreads);
+      simulate::SimCompartment simA(m, compA, specsA);
+      simulate::SimCompartment simB(m, compB, specsB);
+      simulate::SimMembrane simMembrane(m, &membrane, &simA, &simB);
+      simA.evaluateReactionsAndDiffusion();
+      simB.evaluateReactionsAndDiffusion();
+      simMembrane.evaluateReactions_tbb();
+      REQUIRE(simA.getDcdt() == refA.getDcdt());
+      REQUIRE(simB.getDcdt() == refB.getDcdt());
+    }
+  }
 }
@@ -91,6 +91,38 @@ void Simulation::initEvents() {
       {std::numeric_limits<double>::max(), {"null_infinite_time_event"}});
 }
 
+// if the events only change runtime parameters of the pixel simulator, update
+// their values and return true, otherwise return false
+static bool updateRuntimeParameters(
+    PixelSim &pixelSim, const std::vector<std::string> &eventIds,
+    const model::ModelEvents &events,
+    const std::map<std::string, double, std::less<>> &substitutions) {
+  const auto &parameters{pixelSim.getRuntimeParameters()};
+  for (const auto &id : eventIds) {
+    if (!events.isParameter(id.c_str())) {
+      return false;
+    }
+    auto var{events.getVariable(id.c_str()).toStdString()};
+    if (std::ranges::none_of(parameters, [&var](const auto &p) {
+          return p.id == var && p.reactionId.empty();
+        })) {
+      return false;
+    }
+  }
+  std::vector<double> values;
+  values.reserve(parameters.size());
+  for (const auto &p : parameters) {
+    double value{p.value};
+    if (auto iter{substitutions.find(p.id)};
+        p.reactionId.empty() && iter != substitutions.cend()) {
+      value = iter->second;
+    }
+    values.push_back(value);
+  }
+  pixelSim.setRuntimeParameterValues(values);
+  return true;
+}
+
 void Simulation::applyNextEvent() {
   const auto &ev{simEvents.front()};
   SPDLOG_INFO("Applying SimEvent at time {}", ev.time);
@@ -128,17 +160,15 @@ void Simulation::applyNextEvent() {
       }
     }
   }
-  // re-init simulator
-  simulator.reset();
-  if (settings->simulatorType == SimulatorType::DUNE &&
-      model.getGeometry().getMesh() != nullptr &&
-      model.getGeometry().getMesh()->isValid()) {
-    simulator =
-        std::make_unique<DuneSim>(model, compartmentIds, eventSubstitutions);
-  } else {
-    simulator = std::make_unique<PixelSim>(
-        model, compartmentIds, compartmentSpeciesIds, eventSubstitutions);
+  if (auto *pixelSim = dynamic_cast<PixelSim *>(simulator.get());
+      pixelSim != nullptr && updateRuntimeParameters(*pixelSim, ev.ids, events,
+                                                     eventSubstitutions)) {
+    SPDLOG_INFO("Updated runtime parameters without re-compiling");
+    simEvents.pop();
+    return;
   }
+  // re-init simulator
+  initSimulator();
   // remove applied simEvent
   simEvents.pop();
 }
@@ -198,7 +228,42 @@ Simulation::Simulation(model::Model &smeModel)
     : model(smeModel), settings(&model.getSimulationSettings()),
       data{&model.getSimulationData()},
       imageSize(model.getGeometry().getImages().volume()) {
-  if (data->timePoints.size() <= 1) {
+  init(nullptr);
+}
+
+Simulation::Simulation(model::Model &smeModel,
+                       const SimulationCheckpoint &checkpoint)
+    : model(smeModel), settings(&model.getSimulationSettings()),
+      data{&model.getSimulationData()},
+      imageSize(model.getGeometry().getImages().volume()) {
+  init(&checkpoint);
+}
+
+void Simulation::initSimulator() {
+  simulator.reset();
+  if (settings->simulatorType == SimulatorType::DUNE) {
+    model.getGeometry().ensureMesh3d();
+  }
+  if (settings->simulatorType == SimulatorType::DUNE &&
+      model.getGeometry().getHasValidMesh()) {
+    simulator =
+        std::make_unique<DuneSim>(model, compartmentIds, eventSubstitutions);
+  } else {
+    simulator = std::make_unique<PixelSim>(
+        model, compartmentIds, compartmentSpeciesIds, eventSubstitutions);
+  }
+}
+
+void Simulation::init(const SimulationCheckpoint *checkpoint) {
+  if (checkpoint != nullptr) {
+    const auto backingFile{data->concentration.getBackingFile()};
+    *data = checkpoint->data;
+    if (!backingFile.empty()) {
+      data->concentration.setBackingFile(backingFile);
+    }
+    SPDLOG_INFO("resuming simulation from checkpoint with {} timepoints",
+                data->timePoints.size());
+  } else if (data->timePoints.size() <= 1) {
     SPDLOG_INFO("starting new simulation");
     data->clear();
   } else {
@@ -207,15 +272,31 @@ Simulation::Simulation(model::Model &smeModel)
   }
   initModel();
   initEvents();
-  // init simulator
-  if (settings->simulatorType == SimulatorType::DUNE &&
-      model.getGeometry().getMesh() != nullptr &&
-      model.getGeometry().getMesh()->isValid()) {
-    simulator =
-        std::make_unique<DuneSim>(model, compartmentIds, eventSubstitutions);
+  if (checkpoint == nullptr) {
+    initSimulator();
   } else {
-    simulator = std::make_unique<PixelSim>(
-        model, compartmentIds, compartmentSpeciesIds, eventSubstitutions);
+    const auto &state{checkpoint->state};
+    eventSubstitutions = state.eventSubstitutions;
+    simEvents = {};
+    for (const auto &ev : state.events) {
+      simEvents.push(ev);
+    }
+    partialTimestep = state.time - data->timePoints.back();
+    if (partialTimestep > 0.0) {
+      // the simulator starts from the concentrations of the last frame, so
+      // temporarily add the concentrations between the last two time points
+      data->timePoints.push_back(state.time);
+      data->concentration.push_back(state.concentration);
+      data->concPadding.push_back(state.concPadding);
+      data->avgMinMax.push_back(data->avgMinMax.back());
+      data->concentrationMax.push_back(data->concentrationMax.back());
+      initSimulator();
+      data->pop_back();
+    } else {
+      partialTimestep = 0.0;
+      initSimulator();
+    }
+    simulator->setIntegratorState(state.integratorState);
   }
   if (simulator->errorMessage().empty()) {
     nCompletedTimesteps.store(data->timePoints.size());
@@ -228,6 +309,151 @@ Simulation::Simulation(model::Model &smeModel)
 
 Simulation::~Simulation() = default;
 
+// the compiled reaction terms can only be re-used if all overridden
+// parameters, and all parameters changed by events, are runtime parameters
+static bool canResetInPlace(const PixelSim &pixelSim,
+                            const std::vector<ParameterOverride> &overrides,
+                            const model::ModelEvents &events) {
+  const auto &parameters{pixelSim.getRuntimeParameters()};
+  auto isRuntimeParameter = [&parameters](const std::string &id,
+                                          const std::string &reactionId) {
+    return std::ranges::any_of(parameters, [&](const auto &p) {
+      return p.id == id && p.reactionId == reactionId;
+    });
+  };
+  for (const auto &o : overrides) {
+    if (!isRuntimeParameter(o.id, o.reactionId)) {
+      return false;
+    }
+  }
+  for (const auto &id : events.getIds()) {
+    if (events.isParameter(id) &&
+        !isRuntimeParameter(events.getVariable(id).toStdString(), {})) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Simulation::reset(
+    const std::vector<ParameterOverride> &parameterOverrides) {
+  SPDLOG_INFO("resetting simulation with {} parameter overrides",
+              parameterOverrides.size());
+  std::shared_ptr<const ConcentrationFrames::Frame> initialConcentrations;
+  if (!data->concentration.empty()) {
+    initialConcentrations = data->concentration.getFrame(0);
+  }
+  for (const auto &p : parameterOverrides) {
+    if (p.reactionId.empty()) {
+      model.getParameters().setExpression(p.id.c_str(),
+                                          common::dblToQStr(p.value, 17));
+    } else {
+      model.getReactions().setParameterValue(p.reactionId.c_str(),
+                                             p.id.c_str(), p.value);
+    }
+  }
+  data->clear();
+  initEvents();
+  partialTimestep = 0.0;
+  if (checkpointWriter != nullptr) {
+    // start a new frame log
+    checkpointWriter =
+        std::make_unique<CheckpointWriter>(checkpointWriter->getFilename());
+  }
+  bool reused{false};
+  if (auto *pixelSim{dynamic_cast<PixelSim *>(simulator.get())};
+      pixelSim != nullptr) {
+    reused =
+        initialConcentrations != nullptr &&
+        canResetInPlace(*pixelSim, parameterOverrides, model.getEvents()) &&
+        pixelSim->reset(*initialConcentrations, eventSubstitutions);
+  } else if (auto *duneSim{dynamic_cast<DuneSim *>(simulator.get())};
+             duneSim != nullptr) {
+    // the DUNE model is re-created with the new parameters on the same grid
+    reused = duneSim->reset(model, eventSubstitutions);
+  }
+  if (reused) {
+    SPDLOG_INFO("Re-using existing simulator");
+  } else {
+    initSimulator();
+  }
+  nCompletedTimesteps.store(0);
+  if (simulator->errorMessage().empty()) {
+    updateConcentrations(0);
+    ++nCompletedTimesteps;
+  }
+  return reused;
+}
+
+SimulationState Simulation::getState(double t) const {
+  SimulationState state;
+  state.time = t;
+  for (std::size_t i = 0; i < compartments.size(); ++i) {
+    state.concentration.push_back(simulator->getConcentrations(i));
+  }
+  state.concPadding = simulator->getConcentrationPadding();
+  for (auto events{simEvents}; !events.empty(); events.pop()) {
+    state.events.push_back(events.front());
+  }
+  state.eventSubstitutions = eventSubstitutions;
+  state.integratorState = simulator->getIntegratorState();
+  return state;
+}
+
+void Simulation::writeCheckpoint(double t) {
+  SPDLOG_INFO("writing checkpoint at t={}", t);
+  if (!checkpointWriter->write(*data, getState(t))) {
+    SPDLOG_WARN("Failed to write checkpoint '{}'",
+                checkpointWriter->getFilename());
+  }
+  checkpointTimer.restart();
+}
+
+std::size_t
+Simulation::runSimulator(double startTime, double time, double timeout_ms,
+                         const std::function<bool()> &stopRunningCallback) {
+  if (checkpointWriter == nullptr) {
+    return simulator->run(time, timeout_ms, stopRunningCallback);
+  }
+  // stop the simulator when a checkpoint is due, write the checkpoint, then
+  // continue for the remaining time
+  constexpr double relativeTolerance{1e-12};
+  const double t0{simulator->getSimulatedTime()};
+  auto elapsed = [this, t0]() { return simulator->getSimulatedTime() - t0; };
+  bool checkpointDue{false};
+  auto callback = [&]() {
+    if (stopRunningCallback && stopRunningCallback()) {
+      return true;
+    }
+    // no need to stop for a checkpoint if the run is about to finish
+    checkpointDue = static_cast<double>(checkpointTimer.elapsed()) >=
+                        1000.0 * checkpointInterval &&
+                    elapsed() + time * relativeTolerance < time;
+    return checkpointDue;
+  };
+  QElapsedTimer timer;
+  timer.start();
+  std::size_t steps{0};
+  do {
+    checkpointDue = false;
+    double remaining_timeout_ms{timeout_ms};
+    if (timeout_ms >= 0.0) {
+      remaining_timeout_ms =
+          std::max(timeout_ms - static_cast<double>(timer.elapsed()), 0.0);
+    }
+    steps += simulator->run(time - elapsed(), remaining_timeout_ms, callback);
+    if (checkpointDue) {
+      writeCheckpoint(startTime + elapsed());
+      if (stopRequested.load()) {
+        // the user also requested a stop
+        break;
+      }
+      simulator->setStopRequested(false);
+    }
+  } while (checkpointDue);
+  return steps;
+}
+
 std::size_t Simulation::doTimesteps(double time, std::size_t nSteps,
                                     double timeout_ms) {
   return doMultipleTimesteps({{nSteps, time}}, timeout_ms);
@@ -235,7 +461,8 @@ std::size_t Simulation::doTimesteps(double time, std::size_t nSteps,
 
 std::size_t Simulation::doMultipleTimesteps(
     const std::vector<std::pair<std::size_t, double>> &timesteps,
-    double timeout_ms, const std::function<bool()> &stopRunningCallback) {
+    double timeout_ms, const std::function<bool()> &stopRunningCallback,
+    const std::function<void()> &timepointCompletedCallback) {
   isRunning.store(true);
   stopRequested.store(false);
   if (data->timePoints.empty()) {
@@ -278,22 +505,23 @@ std::size_t Simulation::doMultipleTimesteps(
       // if an event would occur within this fraction of a timestep then apply
       // it now, rather than doing a minuscule extra simulation step
       constexpr double fractionTimestepEpsilon{1e-12};
-      double currentTime{data->timePoints.back()};
+      double currentTime{data->timePoints.back() + partialTimestep};
       while (std::abs(currentTime - nextEventTime) / time <
              fractionTimestepEpsilon) {
         SPDLOG_INFO("t={}, applying event at {}", currentTime, nextEventTime);
         applyNextEvent();
         nextEventTime = simEvents.front().time;
       }
-      double currentTimeStep{time};
+      double currentTimeStep{time - partialTimestep};
+      partialTimestep = 0.0;
       while ((currentTime + currentTimeStep - nextEventTime) / time >
              0.1 * fractionTimestepEpsilon) {
         // event would occur during this step: do a smaller sub-step until event
         double subTimeStep{nextEventTime - currentTime};
         SPDLOG_INFO("Sub-step of {} to apply event at {}", subTimeStep,
                     nextEventTime);
-        steps += simulator->run(subTimeStep, remaining_timeout_ms,
-                                stopRunningCallback);
+        steps += runSimulator(currentTime, subTimeStep, remaining_timeout_ms,
+                              stopRunningCallback);
         // update intermediate concentrations to be able to apply them to model
         updateConcentrations(currentTime + subTimeStep);
         // apply event
@@ -305,8 +533,8 @@ std::size_t Simulation::doMultipleTimesteps(
         currentTimeStep -= subTimeStep;
         SPDLOG_INFO("Remaining time step: {}", currentTimeStep);
       }
-      steps += simulator->run(currentTimeStep, remaining_timeout_ms,
-                              stopRunningCallback);
+      steps += runSimulator(currentTime, currentTimeStep,
+                            remaining_timeout_ms, stopRunningCallback);
       if (!simulator->errorMessage().empty() || stopRequested.load()) {
         isRunning.store(false);
         stopRequested.store(false);
@@ -315,14 +543,40 @@ std::size_t Simulation::doMultipleTimesteps(
       }
       updateConcentrations(data->timePoints.back() + time);
       ++nCompletedTimesteps;
+      if (timepointCompletedCallback) {
+        timepointCompletedCallback();
+      }
     }
   }
+  if (checkpointWriter != nullptr) {
+    writeCheckpoint(data->timePoints.back());
+  }
   isRunning.store(false);
   stopRequested.store(false);
   simulator->setStopRequested(false);
   return steps;
 }
 
+SimulationCheckpoint Simulation::getCheckpoint() const {
+  return {*data, getState(data->timePoints.back())};
+}
+
+bool Simulation::setCheckpointFile(const std::string &filename,
+                                   double interval_s) {
+  checkpointWriter.reset();
+  if (filename.empty()) {
+    return true;
+  }
+  if (dynamic_cast<const PixelSim *>(simulator.get()) == nullptr) {
+    SPDLOG_WARN("Checkpoints are only supported by the pixel simulator");
+    return false;
+  }
+  checkpointWriter = std::make_unique<CheckpointWriter>(filename);
+  checkpointInterval = interval_s;
+  checkpointTimer.start();
+  return true;
+}
+
 const std::string &Simulation::errorMessage() const {
   return simulator->errorMessage();
 }
@@ -359,7 +613,8 @@ std::vector<double> Simulation::getConc(std::size_t timeIndex,
                                         std::size_t compartmentIndex,
                                         std::size_t speciesIndex) const {
   std::vector<double> c;
-  const auto &compConc = data->concentration[timeIndex][compartmentIndex];
+  const auto frame{data->concentration.getFrame(timeIndex)};
+  const auto &compConc = (*frame)[compartmentIndex];
   std::size_t nPixels = compartments[compartmentIndex]->nVoxels();
   std::size_t nSpecies = compartmentSpeciesIds[compartmentIndex].size();
   std::size_t stride{nSpecies + data->concPadding[timeIndex]};
@@ -370,24 +625,37 @@ std::vector<double> Simulation::getConc(std::size_t timeIndex,
   return c;
 }
 
+// copy the value at each voxel of a compartment into an image-sized array,
+// with the same layout as a sampled field: x + width * (inverted y + height *
+// z). The value for voxel ix is values[ix * stride + offset]
+static std::vector<double> toImageArray(const std::vector<double> &values,
+                                        std::size_t stride, std::size_t offset,
+                                        const geometry::Compartment *comp,
+                                        const common::Volume &imageSize) {
+  std::vector<double> c(imageSize.nVoxels(), 0.0);
+  if (values.empty()) {
+    return c;
+  }
+  const auto nx{static_cast<std::size_t>(imageSize.width())};
+  const auto ny{static_cast<std::size_t>(imageSize.height())};
+  for (std::size_t ix = 0; ix < comp->nVoxels(); ++ix) {
+    const auto &voxel{comp->getVoxel(ix)};
+    auto arrayIndex{static_cast<std::size_t>(voxel.p.x()) +
+                    nx * (ny - 1 - static_cast<std::size_t>(voxel.p.y()) +
+                          ny * voxel.z)};
+    c[arrayIndex] = values[ix * stride + offset];
+  }
+  return c;
+}
+
 std::vector<double> Simulation::getConcArray(std::size_t timeIndex,
                                              std::size_t compartmentIndex,
                                              std::size_t speciesIndex) const {
-  std::vector<double> c(
-      static_cast<std::size_t>(imageSize.width() * imageSize.height()), 0.0);
-  const auto &compConc = data->concentration[timeIndex][compartmentIndex];
-  const auto &comp = compartments[compartmentIndex];
-  std::size_t nPixels = comp->nVoxels();
+  const auto frame{data->concentration.getFrame(timeIndex)};
   std::size_t nSpecies = compartmentSpeciesIds[compartmentIndex].size();
   std::size_t stride{nSpecies + data->concPadding[timeIndex]};
-  for (std::size_t ix = 0; ix < nPixels; ++ix) {
-    const auto &point = comp->getVoxel(ix);
-    auto arrayIndex{static_cast<std::size_t>(
-        point.p.x() +
-        imageSize.width() * (imageSize.height() - 1 - point.p.y()))};
-    c[arrayIndex] = compConc[ix * stride + speciesIndex];
-  }
-  return c;
+  return toImageArray((*frame)[compartmentIndex], stride, speciesIndex,
+                      compartments[compartmentIndex], imageSize);
 }
 
 void Simulation::applyConcsToModel(model::Model &m,
@@ -422,24 +690,59 @@ std::vector<double> Simulation::getDcdt(std::size_t compartmentIndex,
 
 std::vector<double> Simulation::getDcdtArray(std::size_t compartmentIndex,
                                              std::size_t speciesIndex) const {
-  std::vector<double> c(
-      static_cast<std::size_t>(imageSize.width() * imageSize.height()), 0.0);
   if (const auto *s = dynamic_cast<const PixelSim *>(simulator.get());
       s != nullptr) {
-    const auto &compDcdt = s->getDcdt(compartmentIndex);
-    const auto &comp = compartments[compartmentIndex];
-    std::size_t nPixels = compartments[compartmentIndex]->nVoxels();
     std::size_t nSpecies = compartmentSpeciesIds[compartmentIndex].size();
     std::size_t stride{nSpecies + data->concPadding.back()};
-    for (std::size_t ix = 0; ix < nPixels; ++ix) {
-      const auto &point = comp->getVoxel(ix);
-      auto arrayIndex{static_cast<std::size_t>(
-          point.p.x() +
-          imageSize.width() * (imageSize.height() - 1 - point.p.y()))};
-      c[arrayIndex] = compDcdt[ix * stride + speciesIndex];
+    return toImageArray(s->getDcdt(compartmentIndex), stride, speciesIndex,
+                        compartments[compartmentIndex], imageSize);
+  }
+  return std::vector<double>(imageSize.nVoxels(), 0.0);
+}
+
+std::optional<std::size_t>
+Simulation::getSensitivityParameterIndex(const std::string &id,
+                                         const std::string &reactionId) const {
+  if (const auto *s = dynamic_cast<const PixelSim *>(simulator.get());
+      s != nullptr) {
+    const auto &parameters{s->getRuntimeParameters()};
+    const auto &indices{s->getSensitivityParameters()};
+    for (std::size_t k = 0; k < indices.size(); ++k) {
+      const auto &p{parameters[indices[k]]};
+      if (p.id == id && p.reactionId == reactionId) {
+        return k;
+      }
     }
   }
-  return c;
+  return {};
+}
+
+std::vector<double>
+Simulation::getConcSensitivityArray(std::size_t compartmentIndex,
+                                    std::size_t speciesIndex,
+                                    std::size_t parameterIndex) const {
+  std::vector<double> values;
+  if (const auto *s = dynamic_cast<const PixelSim *>(simulator.get());
+      s != nullptr) {
+    values = s->getConcentrationSensitivity(compartmentIndex, speciesIndex,
+                                            parameterIndex);
+  }
+  return toImageArray(values, 1, 0, compartments[compartmentIndex],
+                      imageSize);
+}
+
+std::vector<double>
+Simulation::getDcdtSensitivityArray(std::size_t compartmentIndex,
+                                    std::size_t speciesIndex,
+                                    std::size_t parameterIndex) const {
+  std::vector<double> values;
+  if (const auto *s = dynamic_cast<const PixelSim *>(simulator.get());
+      s != nullptr) {
+    values =
+        s->getDcdtSensitivity(compartmentIndex, speciesIndex, parameterIndex);
+  }
+  return toImageArray(values, 1, 0, compartments[compartmentIndex],
+                      imageSize);
 }
 
 double Simulation::getLowerOrderConc(std::size_t compartmentIndex,
@@ -500,10 +803,12 @@ common::ImageStack Simulation::getConcImage(
   }
   common::ImageStack imgs(imageSize, QImage::Format_ARGB32_Premultiplied);
   imgs.fill(0);
+  // only page in this frame once, even if drawing multiple compartments
+  const auto frame{data->concentration.getFrame(timeIndex)};
   // iterate over compartments
   for (std::size_t ic = 0; ic < compartments.size(); ++ic) {
     const auto &voxels{compartments[ic]->getVoxels()};
-    const auto &conc{data->concentration[timeIndex][ic]};
+    const auto &conc{(*frame)[ic]};
     std::size_t nSpecies = compartmentSpeciesIds[ic].size();
     std::size_t stride{nSpecies + data->concPadding[timeIndex]};
     for (std::size_t ix = 0; ix < voxels.size(); ++ix) {
@@ -548,7 +853,8 @@ Simulation::getPyConcs(std::size_t timeIndex,
           0.0));
   const auto w{static_cast<std::size_t>(imageSize.width())};
   const auto &pixels{compartments[compartmentIndex]->getVoxels()};
-  const auto &conc{data->concentration[timeIndex][compartmentIndex]};
+  const auto frame{data->concentration.getFrame(timeIndex)};
+  const auto &conc{(*frame)[compartmentIndex]};
   const std::size_t nSpecies{compartmentSpeciesIds[compartmentIndex].size()};
   const std::size_t stride{nSpecies + data->concPadding[timeIndex]};
   for (std::size_t ix = 0; ix < pixels.size(); ++ix) {
@@ -590,6 +896,10 @@ std::size_t Simulation::getNCompletedTimesteps() const {
   return nCompletedTimesteps;
 }
 
+double Simulation::getSimulatedTime() const {
+  return simulator->getSimulatedTime();
+}
+
 const SimulationData &Simulation::getSimulationData() const { return *data; }
 
 bool Simulation::getIsRunning() const { return isRunning.load(); }
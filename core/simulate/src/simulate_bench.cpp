@@ -1,4 +1,5 @@
 #include "bench.hpp"
+#include "pixelsim_impl.hpp"
 #include "sme/simulate.hpp"
 #include "sme/simulate_options.hpp"
 
@@ -37,6 +38,56 @@ static void simulate_Simulation_getConcImage(benchmark::State &state) {
   }
 }
 
+// SimCompartment for the first compartment with non-constant species, after
+// a single RK212 step
+static std::unique_ptr<simulate::SimCompartment>
+makeSimCompartmentAfterRK212Step(const model::Model &model) {
+  const auto &species{model.getSpecies()};
+  std::vector<std::string> sIds;
+  QString compId;
+  for (const auto &id : model.getCompartments().getIds()) {
+    for (const auto &s : species.getIds(id)) {
+      if (!species.getIsConstant(s)) {
+        sIds.push_back(s.toStdString());
+      }
+    }
+    if (!sIds.empty()) {
+      compId = id;
+      break;
+    }
+  }
+  auto comp{std::make_unique<simulate::SimCompartment>(
+      model, model.getCompartments().getCompartment(compId), sIds)};
+  comp->evaluateReactionsAndDiffusion();
+  comp->doRK212Substep1(0.01);
+  comp->evaluateReactionsAndDiffusion();
+  comp->doRK212Substep2(0.01);
+  return comp;
+}
+
+template <typename T>
+static void simulate_SimCompartment_calculateRKError(benchmark::State &state) {
+  T data;
+  auto comp{makeSimCompartmentAfterRK212Step(data.model)};
+  simulate::PixelIntegratorError err;
+  for (auto _ : state) {
+    err = comp->calculateRKError(1e-14);
+  }
+}
+
+template <typename T>
+static void
+simulate_SimCompartment_calculateRKError_tbb(benchmark::State &state) {
+  T data;
+  auto comp{makeSimCompartmentAfterRK212Step(data.model)};
+  simulate::PixelIntegratorError err;
+  for (auto _ : state) {
+    err = comp->calculateRKError_tbb(1e-14);
+  }
+}
+
 SME_BENCHMARK(simulate_SimulationDUNE);
 SME_BENCHMARK(simulate_SimulationPIXEL);
 SME_BENCHMARK(simulate_Simulation_getConcImage);
+SME_BENCHMARK(simulate_SimCompartment_calculateRKError);
+SME_BENCHMARK(simulate_SimCompartment_calculateRKError_tbb);
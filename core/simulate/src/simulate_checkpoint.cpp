@@ -0,0 +1,158 @@
+#include "sme/simulate_checkpoint.hpp"
+#include "checkpoint_file.hpp"
+#include "sme/logger.hpp"
+#include <cereal/archives/binary.hpp>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <utility>
+
+namespace sme::simulate {
+
+// a single time point of the simulation results, as stored in the frame log
+struct CheckpointFrame {
+  double time{0.0};
+  std::size_t concPadding{0};
+  ConcentrationFrames::Frame concentration;
+  std::vector<std::vector<AvgMinMax>> avgMinMax;
+  std::vector<std::vector<double>> concentrationMax;
+
+  template <class Archive>
+  void serialize(Archive &ar, std::uint32_t const version) {
+    if (version == 0) {
+      ar(time, concPadding, concentration, avgMinMax, concentrationMax);
+    }
+  }
+};
+
+} // namespace sme::simulate
+
+CEREAL_CLASS_VERSION(sme::simulate::CheckpointFrame, 0);
+
+namespace sme::simulate {
+
+static std::string getFrameLogFilename(const std::string &filename) {
+  return filename + ".frames";
+}
+
+// append frames [begin, end) of data to the stream
+static void writeFrames(std::ostream &os, const SimulationData &data,
+                        std::size_t begin, std::size_t end) {
+  cereal::BinaryOutputArchive ar{os};
+  for (std::size_t i = begin; i < end; ++i) {
+    ar(CheckpointFrame{data.timePoints[i], data.concPadding[i],
+                       *data.concentration.getFrame(i), data.avgMinMax[i],
+                       data.concentrationMax[i]});
+  }
+}
+
+static bool writeState(const std::string &filename, std::uint64_t frameLogId,
+                       std::size_t nFrames, const SimulationState &state) {
+  // write to a temporary file first, so that an interrupted write does not
+  // destroy the previous checkpoint
+  return writeFileViaTemporary(
+      filename, [frameLogId, nFrames, &state](std::ostream &os) {
+        cereal::BinaryOutputArchive ar{os};
+        ar(frameLogId, nFrames, state);
+      });
+}
+
+CheckpointWriter::CheckpointWriter(std::string checkpointFilename)
+    : filename{std::move(checkpointFilename)},
+      frameLogId{std::random_device{}()} {}
+
+const std::string &CheckpointWriter::getFilename() const { return filename; }
+
+bool CheckpointWriter::write(const SimulationData &data,
+                             const SimulationState &state) {
+  const auto frameLog{getFrameLogFilename(filename)};
+  if (nLoggedFrames == 0 || data.size() < nLoggedFrames) {
+    // start a new frame log, with a new id. An existing checkpoint file
+    // refers to the id of the previous log, so can no longer be imported
+    ++frameLogId;
+    if (!writeFileViaTemporary(frameLog, [this, &data](std::ostream &os) {
+          cereal::BinaryOutputArchive ar{os};
+          ar(frameLogId, data.xmlModel);
+          writeFrames(os, data, 0, data.size());
+        })) {
+      SPDLOG_WARN("Failed to write frame log '{}'", frameLog);
+      return false;
+    }
+  } else if (data.size() > nLoggedFrames) {
+    std::ofstream fs(frameLog, std::ios::binary | std::ios::app);
+    writeFrames(fs, data, nLoggedFrames, data.size());
+    fs.close();
+    if (!fs) {
+      SPDLOG_WARN("Failed to append to frame log '{}'", frameLog);
+      // the log may now contain a partial frame: start again next time
+      nLoggedFrames = 0;
+      return false;
+    }
+  }
+  nLoggedFrames = data.size();
+  return writeState(filename, frameLogId, nLoggedFrames, state);
+}
+
+std::unique_ptr<SimulationCheckpoint>
+importCheckpoint(const std::string &filename) {
+  auto checkpoint{std::make_unique<SimulationCheckpoint>()};
+  std::uint64_t frameLogId{0};
+  std::size_t nFrames{0};
+  std::ifstream fs(filename, std::ios::binary);
+  if (!fs) {
+    SPDLOG_WARN("Failed to read file '{}'", filename);
+    return {};
+  }
+  try {
+    cereal::BinaryInputArchive ar(fs);
+    ar(frameLogId, nFrames, checkpoint->state);
+  } catch (const std::exception &e) {
+    SPDLOG_WARN("Failed to import checkpoint '{}'. {}", filename, e.what());
+    return {};
+  }
+  if (nFrames == 0) {
+    SPDLOG_WARN("Failed to import checkpoint '{}'. No simulation data",
+                filename);
+    return {};
+  }
+  // the frame log may contain more frames than the checkpoint refers to
+  const auto frameLog{getFrameLogFilename(filename)};
+  std::ifstream fsFrames(frameLog, std::ios::binary);
+  if (!fsFrames) {
+    SPDLOG_WARN("Failed to read frame log '{}'", frameLog);
+    return {};
+  }
+  auto &data{checkpoint->data};
+  data.reserve(nFrames);
+  try {
+    cereal::BinaryInputArchive ar(fsFrames);
+    std::uint64_t id{0};
+    ar(id, data.xmlModel);
+    if (id != frameLogId) {
+      SPDLOG_WARN("Frame log '{}' does not belong to checkpoint '{}'",
+                  frameLog, filename);
+      return {};
+    }
+    for (std::size_t i = 0; i < nFrames; ++i) {
+      CheckpointFrame frame;
+      ar(frame);
+      data.timePoints.push_back(frame.time);
+      data.concPadding.push_back(frame.concPadding);
+      data.concentration.push_back(std::move(frame.concentration));
+      data.avgMinMax.push_back(std::move(frame.avgMinMax));
+      data.concentrationMax.push_back(std::move(frame.concentrationMax));
+    }
+  } catch (const std::exception &e) {
+    SPDLOG_WARN("Failed to import frame log '{}'. {}", frameLog, e.what());
+    return {};
+  }
+  return checkpoint;
+}
+
+bool exportCheckpoint(const std::string &filename,
+                      const SimulationCheckpoint &checkpoint) {
+  CheckpointWriter writer(filename);
+  return writer.write(checkpoint.data, checkpoint.state);
+}
+
+} // namespace sme::simulate
@@ -0,0 +1,109 @@
+#include "catch_wrapper.hpp"
+#include "sme/simulate_checkpoint.hpp"
+#include <QFile>
+
+using namespace sme;
+
+TEST_CASE("SimulationCheckpoint", "[core/simulate/simulate_checkpoint][core/"
+                                  "simulate][core][simulate_checkpoint]") {
+  simulate::SimulationCheckpoint checkpoint;
+  checkpoint.data.timePoints = {0.0, 1.0};
+  checkpoint.data.concentration = {{{1.2, -0.881}, {1.0, -0.1}},
+                                   {{2.2, -2.881}, {3.0, -3.1}}};
+  checkpoint.data.avgMinMax = {{{{1.0, 0.5, 1.5}}}, {{{2.0, 1.5, 2.5}}}};
+  checkpoint.data.concentrationMax = {{{1.2}}, {{2.2}}};
+  checkpoint.data.concPadding = {0, 0};
+  checkpoint.data.xmlModel = "model";
+  auto &state{checkpoint.state};
+  state.time = 1.5;
+  state.concentration = {{2.5, -3.0}, {3.5, -3.5}};
+  state.events = {{1.5, {"e1", "e2"}}, {3.0, {"e3"}}};
+  state.eventSubstitutions = {{"p1", 0.2}, {"p2", -1.0}};
+  state.integratorState = {1.234e-5};
+  SECTION("export & import") {
+    REQUIRE(simulate::exportCheckpoint("tmpcheckpoint.bin", checkpoint));
+    auto imported{simulate::importCheckpoint("tmpcheckpoint.bin")};
+    REQUIRE(imported != nullptr);
+    REQUIRE(imported->data.timePoints == checkpoint.data.timePoints);
+    REQUIRE(imported->data.concentration == checkpoint.data.concentration);
+    REQUIRE(imported->data.avgMinMax[1][0][0].avg == dbl_approx(2.0));
+    REQUIRE(imported->data.concentrationMax ==
+            checkpoint.data.concentrationMax);
+    REQUIRE(imported->data.concPadding == checkpoint.data.concPadding);
+    REQUIRE(imported->data.xmlModel == checkpoint.data.xmlModel);
+    const auto &s{imported->state};
+    REQUIRE(s.time == dbl_approx(state.time));
+    REQUIRE(s.concentration == state.concentration);
+    REQUIRE(s.events.size() == 2);
+    REQUIRE(s.events[0].time == state.events[0].time);
+    REQUIRE(s.events[0].ids == state.events[0].ids);
+    REQUIRE(s.events[1].time == state.events[1].time);
+    REQUIRE(s.events[1].ids == state.events[1].ids);
+    REQUIRE(s.eventSubstitutions == state.eventSubstitutions);
+    REQUIRE(s.integratorState == state.integratorState);
+    // temporary files are removed after writing
+    REQUIRE(QFile::exists("tmpcheckpoint.bin.tmp") == false);
+    REQUIRE(QFile::exists("tmpcheckpoint.bin.frames.tmp") == false);
+    // an existing checkpoint is replaced
+    state.integratorState = {2.5e-3};
+    REQUIRE(simulate::exportCheckpoint("tmpcheckpoint.bin", checkpoint));
+    imported = simulate::importCheckpoint("tmpcheckpoint.bin");
+    REQUIRE(imported->state.integratorState == state.integratorState);
+  }
+  SECTION("writer appends new frames to the frame log") {
+    simulate::CheckpointWriter writer("tmpcheckpoint.bin");
+    REQUIRE(writer.write(checkpoint.data, state));
+    REQUIRE(simulate::importCheckpoint("tmpcheckpoint.bin")->data.size() == 2);
+    auto size{QFile("tmpcheckpoint.bin.frames").size()};
+    // new state, no new frames: frame log is unchanged
+    state.time = 1.7;
+    REQUIRE(writer.write(checkpoint.data, state));
+    REQUIRE(QFile("tmpcheckpoint.bin.frames").size() == size);
+    REQUIRE(simulate::importCheckpoint("tmpcheckpoint.bin")->state.time ==
+            dbl_approx(1.7));
+    // new frame is appended
+    checkpoint.data.timePoints.push_back(2.0);
+    checkpoint.data.concentration.push_back({{4.0, -4.0}, {5.0, -5.0}});
+    checkpoint.data.avgMinMax.push_back({{{4.0, 3.5, 4.5}}});
+    checkpoint.data.concentrationMax.push_back({{4.0}});
+    checkpoint.data.concPadding.push_back(0);
+    REQUIRE(writer.write(checkpoint.data, state));
+    REQUIRE(QFile("tmpcheckpoint.bin.frames").size() > size);
+    auto imported{simulate::importCheckpoint("tmpcheckpoint.bin")};
+    REQUIRE(imported != nullptr);
+    REQUIRE(imported->data.timePoints == checkpoint.data.timePoints);
+    REQUIRE(imported->data.concentration == checkpoint.data.concentration);
+    // fewer frames than before: frame log is replaced
+    checkpoint.data.pop_back();
+    checkpoint.data.pop_back();
+    REQUIRE(writer.write(checkpoint.data, state));
+    REQUIRE(QFile("tmpcheckpoint.bin.frames").size() < size);
+    imported = simulate::importCheckpoint("tmpcheckpoint.bin");
+    REQUIRE(imported != nullptr);
+    REQUIRE(imported->data.timePoints.size() == 1);
+  }
+  SECTION("import invalid files") {
+    REQUIRE(simulate::importCheckpoint("non-existent-file.bin") == nullptr);
+    QFile f("invalidcheckpoint.bin");
+    REQUIRE(f.open(QIODevice::WriteOnly));
+    f.write("invalid");
+    f.close();
+    REQUIRE(simulate::importCheckpoint("invalidcheckpoint.bin") == nullptr);
+    // checkpoint file that refers to a different frame log
+    REQUIRE(simulate::exportCheckpoint("tmpcheckpoint.bin", checkpoint));
+    QFile::remove("tmpcheckpointold.bin");
+    REQUIRE(QFile::copy("tmpcheckpoint.bin", "tmpcheckpointold.bin"));
+    REQUIRE(simulate::exportCheckpoint("tmpcheckpoint.bin", checkpoint));
+    QFile::remove("tmpcheckpoint.bin");
+    REQUIRE(QFile::copy("tmpcheckpointold.bin", "tmpcheckpoint.bin"));
+    REQUIRE(simulate::importCheckpoint("tmpcheckpoint.bin") == nullptr);
+    // checkpoint file without a frame log
+    REQUIRE(simulate::exportCheckpoint("tmpcheckpoint.bin", checkpoint));
+    REQUIRE(QFile::remove("tmpcheckpoint.bin.frames"));
+    REQUIRE(simulate::importCheckpoint("tmpcheckpoint.bin") == nullptr);
+    // a checkpoint without any simulation data is invalid
+    checkpoint.data.clear();
+    REQUIRE(simulate::exportCheckpoint("tmpcheckpoint.bin", checkpoint));
+    REQUIRE(simulate::importCheckpoint("tmpcheckpoint.bin") == nullptr);
+  }
+}
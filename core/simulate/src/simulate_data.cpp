@@ -1,7 +1,342 @@
 #include "sme/simulate_data.hpp"
+#include "sme/logger.hpp"
+#include <QByteArray>
+#include <QTemporaryFile>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
 
 namespace sme::simulate {
 
+// frame is stored as [nCompartments, (nValues, values...)...], compressed
+static QByteArray encodeFrame(const ConcentrationFrames::Frame &frame) {
+  std::size_t nBytes{sizeof(std::uint64_t)};
+  for (const auto &c : frame) {
+    nBytes += sizeof(std::uint64_t) + c.size() * sizeof(double);
+  }
+  QByteArray bytes(static_cast<qsizetype>(nBytes), Qt::Uninitialized);
+  auto *dest{bytes.data()};
+  auto write = [&dest](const void *src, std::size_t n) {
+    std::memcpy(dest, src, n);
+    dest += n;
+  };
+  auto n{static_cast<std::uint64_t>(frame.size())};
+  write(&n, sizeof(n));
+  for (const auto &c : frame) {
+    n = static_cast<std::uint64_t>(c.size());
+    write(&n, sizeof(n));
+    write(c.data(), c.size() * sizeof(double));
+  }
+  // favour speed over size
+  return qCompress(bytes, 1);
+}
+
+static ConcentrationFrames::Frame decodeFrame(const QByteArray &bytes) {
+  ConcentrationFrames::Frame frame;
+  const auto *src{bytes.constData()};
+  auto remaining{static_cast<std::size_t>(bytes.size())};
+  auto read = [&src, &remaining](void *dest, std::size_t n) {
+    if (n > remaining) {
+      throw std::runtime_error("Invalid simulation frame in backing file");
+    }
+    std::memcpy(dest, src, n);
+    src += n;
+    remaining -= n;
+  };
+  std::uint64_t n{0};
+  read(&n, sizeof(n));
+  frame.resize(static_cast<std::size_t>(n));
+  for (auto &c : frame) {
+    read(&n, sizeof(n));
+    if (n > remaining / sizeof(double)) {
+      throw std::runtime_error("Invalid simulation frame in backing file");
+    }
+    c.resize(static_cast<std::size_t>(n));
+    read(c.data(), c.size() * sizeof(double));
+  }
+  return frame;
+}
+
+class ConcentrationFrames::BackingFile {
+  std::string filename;
+  // created next to filename, so an existing file is never overwritten, and
+  // removed when no longer used
+  QTemporaryFile file;
+  std::mutex fileMutex;
+
+public:
+  explicit BackingFile(std::string backingFilename)
+      : filename{std::move(backingFilename)},
+        file(QString::fromStdString(filename) + ".XXXXXX") {
+    if (!file.open()) {
+      SPDLOG_WARN("Failed to create backing file for '{}'", filename);
+    }
+  }
+  BackingFile(const BackingFile &) = delete;
+  BackingFile &operator=(const BackingFile &) = delete;
+  ~BackingFile() = default;
+  [[nodiscard]] bool isOpen() const { return file.isOpen(); }
+  [[nodiscard]] const std::string &getFilename() const { return filename; }
+  [[nodiscard]] std::string getPath() const {
+    return file.fileName().toStdString();
+  }
+  FrameLocation append(const Frame &frame) {
+    auto bytes{encodeFrame(frame)};
+    std::scoped_lock lock(fileMutex);
+    FrameLocation location{static_cast<std::int64_t>(file.size()),
+                           static_cast<std::int64_t>(bytes.size())};
+    if (!file.seek(location.offset) ||
+        file.write(bytes) != location.size || !file.flush()) {
+      throw std::runtime_error("Failed to write simulation frame to '" +
+                               getPath() + "'");
+    }
+    return location;
+  }
+  Frame read(const FrameLocation &location) {
+    QByteArray bytes;
+    {
+      std::scoped_lock lock(fileMutex);
+      auto *mapped{file.map(location.offset, location.size)};
+      if (mapped == nullptr) {
+        throw std::runtime_error("Failed to read simulation frame from '" +
+                                 getPath() + "'");
+      }
+      bytes = qUncompress(mapped, static_cast<qsizetype>(location.size));
+      file.unmap(mapped);
+    }
+    return decodeFrame(bytes);
+  }
+  void truncate() {
+    std::scoped_lock lock(fileMutex);
+    file.resize(0);
+  }
+};
+
+ConcentrationFrames::ConcentrationFrames(
+    std::initializer_list<Frame> initialFrames) {
+  reserve(initialFrames.size());
+  for (const auto &frame : initialFrames) {
+    push_back(frame);
+  }
+}
+
+ConcentrationFrames::ConcentrationFrames(const ConcentrationFrames &other) {
+  *this = other;
+}
+
+ConcentrationFrames::ConcentrationFrames(ConcentrationFrames &&other) noexcept {
+  *this = std::move(other);
+}
+
+ConcentrationFrames &
+ConcentrationFrames::operator=(const ConcentrationFrames &other) {
+  if (this == &other) {
+    return *this;
+  }
+  std::scoped_lock lock(mutex, other.mutex);
+  // in-memory frames are copied, frames in the backing file are shared
+  frames.clear();
+  frames.reserve(other.frames.size());
+  for (const auto &frame : other.frames) {
+    frames.push_back(frame == nullptr ? nullptr
+                                      : std::make_shared<Frame>(*frame));
+  }
+  locations = other.locations;
+  backingFile = other.backingFile;
+  maxFramesInMemory = other.maxFramesInMemory;
+  maxCachedFrames = other.maxCachedFrames;
+  cache.clear();
+  return *this;
+}
+
+ConcentrationFrames &
+ConcentrationFrames::operator=(ConcentrationFrames &&other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+  std::scoped_lock lock(mutex, other.mutex);
+  frames = std::move(other.frames);
+  locations = std::move(other.locations);
+  backingFile = std::move(other.backingFile);
+  maxFramesInMemory = other.maxFramesInMemory;
+  maxCachedFrames = other.maxCachedFrames;
+  cache = std::move(other.cache);
+  other.frames.clear();
+  other.locations.clear();
+  other.cache.clear();
+  return *this;
+}
+
+ConcentrationFrames::~ConcentrationFrames() = default;
+
+void ConcentrationFrames::writeOldFramesToBackingFile() {
+  if (backingFile == nullptr) {
+    return;
+  }
+  // frames are moved to the backing file in order, so we can stop at the
+  // first frame that is no longer in memory
+  const std::size_t n{frames.size()};
+  for (std::size_t i = n - std::min(n, maxFramesInMemory); i > 0; --i) {
+    auto &frame{frames[i - 1]};
+    if (frame == nullptr) {
+      break;
+    }
+    if (locations[i - 1].size == 0) {
+      locations[i - 1] = backingFile->append(*frame);
+    }
+    frame.reset();
+  }
+}
+
+void ConcentrationFrames::readFrameIntoMemory(std::size_t i) {
+  if (frames[i] != nullptr) {
+    return;
+  }
+  frames[i] = std::make_shared<Frame>(*getFrameWithLock(i));
+  // the in-memory frame may now be modified, so the stored copy is stale
+  locations[i] = {};
+  std::erase_if(cache, [i](const auto &item) { return item.first == i; });
+}
+
+std::shared_ptr<const ConcentrationFrames::Frame>
+ConcentrationFrames::getFrameWithLock(std::size_t i) const {
+  if (frames[i] != nullptr) {
+    return frames[i];
+  }
+  if (auto iter{std::ranges::find_if(
+          cache, [i](const auto &item) { return item.first == i; })};
+      iter != cache.end()) {
+    cache.splice(cache.begin(), cache, iter);
+    return cache.front().second;
+  }
+  SPDLOG_DEBUG("paging in frame {} from backing file", i);
+  cache.emplace_front(
+      i, std::make_shared<const Frame>(backingFile->read(locations[i])));
+  while (cache.size() > maxCachedFrames) {
+    cache.pop_back();
+  }
+  return cache.front().second;
+}
+
+void ConcentrationFrames::setBackingFile(const std::string &filename,
+                                         std::size_t maxInMemory,
+                                         std::size_t maxCached) {
+  std::scoped_lock lock(mutex);
+  // bring any frames in an existing backing file back into memory
+  for (std::size_t i = 0; i < frames.size(); ++i) {
+    readFrameIntoMemory(i);
+  }
+  cache.clear();
+  backingFile.reset();
+  maxFramesInMemory = std::max(maxInMemory, std::size_t{1});
+  maxCachedFrames = std::max(maxCached, std::size_t{1});
+  if (filename.empty()) {
+    return;
+  }
+  backingFile = std::make_shared<BackingFile>(filename);
+  if (!backingFile->isOpen()) {
+    backingFile.reset();
+    return;
+  }
+  writeOldFramesToBackingFile();
+}
+
+std::string ConcentrationFrames::getBackingFile() const {
+  std::scoped_lock lock(mutex);
+  if (backingFile == nullptr) {
+    return {};
+  }
+  return backingFile->getFilename();
+}
+
+std::size_t ConcentrationFrames::size() const {
+  std::scoped_lock lock(mutex);
+  return frames.size();
+}
+
+bool ConcentrationFrames::empty() const { return size() == 0; }
+
+void ConcentrationFrames::clear() {
+  std::scoped_lock lock(mutex);
+  frames.clear();
+  locations.clear();
+  cache.clear();
+  // only discard the contents of the file if no copies refer to it
+  if (backingFile != nullptr && backingFile.use_count() == 1) {
+    backingFile->truncate();
+  }
+}
+
+void ConcentrationFrames::reserve(std::size_t n) {
+  std::scoped_lock lock(mutex);
+  frames.reserve(n);
+  locations.reserve(n);
+}
+
+void ConcentrationFrames::push_back(Frame frame) {
+  std::scoped_lock lock(mutex);
+  frames.push_back(std::make_shared<Frame>(std::move(frame)));
+  locations.emplace_back();
+  writeOldFramesToBackingFile();
+}
+
+ConcentrationFrames::Frame &ConcentrationFrames::emplace_back() {
+  std::scoped_lock lock(mutex);
+  frames.push_back(std::make_shared<Frame>());
+  locations.emplace_back();
+  writeOldFramesToBackingFile();
+  return *frames.back();
+}
+
+void ConcentrationFrames::pop_back() {
+  std::scoped_lock lock(mutex);
+  frames.pop_back();
+  locations.pop_back();
+  std::erase_if(cache, [n = frames.size()](const auto &item) {
+    return item.first >= n;
+  });
+  if (!frames.empty()) {
+    readFrameIntoMemory(frames.size() - 1);
+  }
+}
+
+ConcentrationFrames::Frame &ConcentrationFrames::back() {
+  std::scoped_lock lock(mutex);
+  return *frames.back();
+}
+
+const ConcentrationFrames::Frame &ConcentrationFrames::back() const {
+  std::scoped_lock lock(mutex);
+  return *frames.back();
+}
+
+std::shared_ptr<const ConcentrationFrames::Frame>
+ConcentrationFrames::getFrame(std::size_t i) const {
+  std::scoped_lock lock(mutex);
+  return getFrameWithLock(i);
+}
+
+ConcentrationFrames::Frame
+ConcentrationFrames::operator[](std::size_t i) const {
+  return *getFrame(i);
+}
+
+bool ConcentrationFrames::operator==(const ConcentrationFrames &other) const {
+  if (this == &other) {
+    return true;
+  }
+  const std::size_t n{size()};
+  if (other.size() != n) {
+    return false;
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    if (*getFrame(i) != *other.getFrame(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void SimulationData::clear() {
   timePoints.clear();
   concentration.clear();
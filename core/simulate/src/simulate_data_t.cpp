@@ -1,5 +1,9 @@
 #include "catch_wrapper.hpp"
 #include "sme/simulate_data.hpp"
+#include <QDir>
+#include <QFile>
+#include <cereal/archives/binary.hpp>
+#include <sstream>
 
 using namespace sme;
 
@@ -49,4 +53,73 @@ TEST_CASE("SimulateData",
     REQUIRE(data.concPadding.back() == 0);
     REQUIRE(data.xmlModel == "sim model");
   }
+  SECTION("backing file") {
+    // an existing file with this name is not modified
+    QFile existingFile("tmpsimdata.bin");
+    REQUIRE(existingFile.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    existingFile.write("existing");
+    existingFile.close();
+    auto backingFiles = []() {
+      return QDir().entryList({"tmpsimdata.bin.*"}, QDir::Files);
+    };
+    for (const auto &f : backingFiles()) {
+      QFile::remove(f);
+    }
+    data.concentration.setBackingFile("tmpsimdata.bin");
+    REQUIRE(data.concentration.getBackingFile() == "tmpsimdata.bin");
+    REQUIRE(backingFiles().size() == 1);
+    // only the most recent frame is kept in memory
+    REQUIRE(QFile(backingFiles().front()).size() > 0);
+    // operator[] returns a copy of the frame
+    auto frameCopy{data.concentration[0]};
+    REQUIRE(frameCopy[0][0] == dbl_approx(1.2));
+    REQUIRE(data.concentration.size() == 2);
+    REQUIRE(data.concentration[0][0][0] == dbl_approx(1.2));
+    REQUIRE(data.concentration[0][1][1] == dbl_approx(-0.1));
+    REQUIRE(data.concentration[1][0][1] == dbl_approx(-2.881));
+    for (int i = 0; i < 10; ++i) {
+      auto &frame{data.concentration.emplace_back()};
+      frame = {{static_cast<double>(i), 0.5}, {-1.0 * i}};
+    }
+    REQUIRE(data.concentration.size() == 12);
+    for (std::size_t i = 0; i < 10; ++i) {
+      auto frame{data.concentration.getFrame(i + 2)};
+      REQUIRE(frame->size() == 2);
+      REQUIRE((*frame)[0][0] == dbl_approx(static_cast<double>(i)));
+      REQUIRE((*frame)[0][1] == dbl_approx(0.5));
+      REQUIRE((*frame)[1][0] == dbl_approx(-1.0 * static_cast<double>(i)));
+    }
+    // previous frame is paged back in and can be modified
+    data.concentration.pop_back();
+    REQUIRE(data.concentration.size() == 11);
+    data.concentration.back()[1][0] = 99.0;
+    data.concentration.emplace_back();
+    REQUIRE(data.concentration[10][1][0] == dbl_approx(99.0));
+    // copy shares the backing file
+    auto copy{data.concentration};
+    REQUIRE(copy == data.concentration);
+    // serialization is the same as for an in-memory vector of frames
+    std::stringstream ss;
+    {
+      cereal::BinaryOutputArchive oar(ss);
+      oar(data.concentration);
+    }
+    std::vector<std::vector<std::vector<double>>> frames;
+    {
+      cereal::BinaryInputArchive iar(ss);
+      iar(frames);
+    }
+    REQUIRE(frames.size() == 12);
+    REQUIRE(frames[0][0][0] == dbl_approx(1.2));
+    REQUIRE(frames[10][1][0] == dbl_approx(99.0));
+    // removing the backing file moves all frames into memory
+    data.concentration.setBackingFile({});
+    REQUIRE(data.concentration.getBackingFile().empty());
+    REQUIRE(data.concentration == copy);
+    // temporary backing file is removed once no copies refer to it
+    copy.setBackingFile({});
+    REQUIRE(backingFiles().empty());
+    REQUIRE(existingFile.open(QIODevice::ReadOnly));
+    REQUIRE(existingFile.readAll() == "existing");
+  }
 }
@@ -912,7 +912,6 @@ TEST_CASE("Simulate: single-compartment-diffusion-3d, spherical geometry",
           "[core/simulate/simulate][core/"
           "simulate][core][simulate][dune][pixel][expensive][3d]") {
   // see docs/tests/diffusion.rst for analytic expressions used here
-  // TODO: when we can do 3d meshing, add DUNE here
 
   constexpr double pi = 3.14159265358979323846;
   double sigma2 = 36.0;
@@ -974,7 +973,8 @@ TEST_CASE("Simulate: single-compartment-diffusion-3d, spherical geometry",
   options.dune.dt = 1.0;
   options.dune.maxDt = 1.0;
   options.dune.minDt = 0.5;
-  for (auto simType : {simulate::SimulatorType::Pixel}) {
+  for (auto simType :
+       {simulate::SimulatorType::Pixel, simulate::SimulatorType::DUNE}) {
     // relative error on integral of initial concentration over all pixels:
     double initialRelativeError{1e-9};
     // largest relative error of any pixel after simulation:
@@ -1165,6 +1165,308 @@ TEST_CASE("Pixel simulator: brusselator model, RK2, RK3, RK4",
   }
 }
 
+TEST_CASE("Pixel simulator: IMEX integrator",
+          "[core/simulate/simulate][core/simulate][core][simulate][pixel]") {
+  double time{0.5};
+  auto s{getExampleModel(Mod::ABtoC)};
+  // do accurate simulation
+  auto &options{s.getSimulationSettings().options};
+  options.pixel.maxErr = {std::numeric_limits<double>::max(), 1e-6};
+  options.pixel.integrator = simulate::PixelIntegratorType::RK435;
+  options.pixel.enableMultiThreading = false;
+  s.getSimulationSettings().simulatorType = simulate::SimulatorType::Pixel;
+  simulate::Simulation sim(s);
+  sim.doTimesteps(time);
+  std::size_t it{sim.getTimePoints().size() - 1};
+  // IMEX simulation: diffusion error is controlled by the max timestep
+  options.pixel.integrator = simulate::PixelIntegratorType::IMEX;
+  options.pixel.maxErr = {std::numeric_limits<double>::max(), 1e-3};
+  options.pixel.maxTimestep = 1e-3;
+  for (bool multiThreading : {false, true}) {
+    CAPTURE(multiThreading);
+    options.pixel.enableMultiThreading = multiThreading;
+    s.getSimulationData().clear();
+    simulate::Simulation simIMEX(s);
+    simIMEX.doTimesteps(time);
+    REQUIRE(simIMEX.errorMessage().empty());
+    REQUIRE(simIMEX.getTimePoints().size() == sim.getTimePoints().size());
+    for (std::size_t is = 0; is < sim.getSpeciesIds(0).size(); ++is) {
+      CAPTURE(is);
+      auto c{simIMEX.getConc(it, 0, is)};
+      auto cAccurate{sim.getConc(it, 0, is)};
+      double maxDiff{0};
+      double maxConc{0};
+      for (std::size_t i = 0; i < c.size(); ++i) {
+        maxDiff = std::max(maxDiff, std::abs(c[i] - cAccurate[i]));
+        maxConc = std::max(maxConc, std::abs(cAccurate[i]));
+      }
+      REQUIRE(maxDiff < 0.02 * maxConc);
+    }
+  }
+}
+
+TEST_CASE("Pixel simulator: operator splitting",
+          "[core/simulate/simulate][core/simulate][core][simulate][pixel]") {
+  double time{0.5};
+  auto s{getExampleModel(Mod::ABtoC)};
+  // do accurate simulation
+  auto &options{s.getSimulationSettings().options};
+  options.pixel.maxErr = {std::numeric_limits<double>::max(), 1e-6};
+  options.pixel.integrator = simulate::PixelIntegratorType::RK435;
+  options.pixel.enableMultiThreading = false;
+  s.getSimulationSettings().simulatorType = simulate::SimulatorType::Pixel;
+  simulate::Simulation sim(s);
+  sim.doTimesteps(time);
+  std::size_t it{sim.getTimePoints().size() - 1};
+  // splitting step is derived from the adaptive reaction timestep, so the
+  // splitting error is controlled without setting a max timestep
+  options.pixel.enableOperatorSplitting = true;
+  options.pixel.maxErr = {std::numeric_limits<double>::max(), 1e-4};
+  for (auto integrator : {simulate::PixelIntegratorType::RK212,
+                          simulate::PixelIntegratorType::RK323,
+                          simulate::PixelIntegratorType::RK435}) {
+    options.pixel.integrator = integrator;
+    std::vector<std::vector<double>> concs;
+    for (bool multiThreading : {false, true}) {
+      CAPTURE(integrator);
+      CAPTURE(multiThreading);
+      options.pixel.enableMultiThreading = multiThreading;
+      s.getSimulationData().clear();
+      simulate::Simulation simSplit(s);
+      simSplit.doTimesteps(time);
+      REQUIRE(simSplit.errorMessage().empty());
+      REQUIRE(simSplit.getTimePoints().size() == sim.getTimePoints().size());
+      for (std::size_t is = 0; is < sim.getSpeciesIds(0).size(); ++is) {
+        CAPTURE(is);
+        auto c{simSplit.getConc(it, 0, is)};
+        auto cAccurate{sim.getConc(it, 0, is)};
+        double maxDiff{0};
+        double maxConc{0};
+        for (std::size_t i = 0; i < c.size(); ++i) {
+          maxDiff = std::max(maxDiff, std::abs(c[i] - cAccurate[i]));
+          maxConc = std::max(maxConc, std::abs(cAccurate[i]));
+        }
+        REQUIRE(maxDiff < 0.01 * maxConc);
+        concs.push_back(std::move(c));
+      }
+    }
+    // single / multithreaded should agree to almost machine precision
+    std::size_t nSpecies{concs.size() / 2};
+    for (std::size_t is = 0; is < nSpecies; ++is) {
+      for (std::size_t i = 0; i < concs[is].size(); ++i) {
+        REQUIRE(std::abs(concs[is][i] - concs[nSpecies + is][i]) < 1e-13);
+      }
+    }
+  }
+  // RK101: fixed splitting timestep that is not limited by the fastest
+  // diffusing species
+  options.pixel.integrator = simulate::PixelIntegratorType::RK101;
+  options.pixel.enableMultiThreading = false;
+  std::vector<std::size_t> steps;
+  for (bool splitting : {false, true}) {
+    CAPTURE(splitting);
+    options.pixel.enableOperatorSplitting = splitting;
+    s.getSimulationData().clear();
+    simulate::Simulation simRK101(s);
+    steps.push_back(simRK101.doTimesteps(time));
+    REQUIRE(simRK101.errorMessage().empty());
+    for (std::size_t is = 0; is < sim.getSpeciesIds(0).size(); ++is) {
+      CAPTURE(is);
+      auto c{simRK101.getConc(it, 0, is)};
+      auto cAccurate{sim.getConc(it, 0, is)};
+      double maxDiff{0};
+      double maxConc{0};
+      for (std::size_t i = 0; i < c.size(); ++i) {
+        maxDiff = std::max(maxDiff, std::abs(c[i] - cAccurate[i]));
+        maxConc = std::max(maxConc, std::abs(cAccurate[i]));
+      }
+      REQUIRE(maxDiff < 0.05 * maxConc);
+    }
+  }
+  // C diffuses 60 times faster than A and B
+  REQUIRE(steps[1] * 10 < steps[0]);
+}
+
+TEST_CASE("Pixel simulator: resume from checkpoint",
+          "[core/simulate/simulate][core/simulate][core][simulate][pixel]") {
+  auto makeModel = []() {
+    auto m{getExampleModel(Mod::VerySimpleModel)};
+    m.getSimulationSettings().simulatorType = simulate::SimulatorType::Pixel;
+    m.getSimulationSettings().options.pixel.integrator =
+        simulate::PixelIntegratorType::RK212;
+    return m;
+  };
+  // uninterrupted simulation
+  auto s{makeModel()};
+  simulate::Simulation sim(s);
+  sim.doMultipleTimesteps({{4, 0.1}});
+  REQUIRE(sim.errorMessage().empty());
+  // simulation that writes a checkpoint at the end of the run
+  std::unique_ptr<simulate::SimulationCheckpoint> checkpoint;
+  {
+    auto sA{makeModel()};
+    simulate::Simulation simA(sA);
+    REQUIRE(simA.setCheckpointFile("tmpsimcheckpoint.bin", 1e9));
+    simA.doMultipleTimesteps({{2, 0.1}});
+    REQUIRE(simA.errorMessage().empty());
+    checkpoint = simulate::importCheckpoint("tmpsimcheckpoint.bin");
+  }
+  REQUIRE(checkpoint != nullptr);
+  REQUIRE(checkpoint->data.timePoints.size() == 3);
+  REQUIRE(checkpoint->state.time == dbl_approx(0.2));
+  // resume from checkpoint
+  auto sB{makeModel()};
+  simulate::Simulation simB(sB, *checkpoint);
+  REQUIRE(simB.errorMessage().empty());
+  REQUIRE(simB.getNCompletedTimesteps() == 3);
+  simB.doMultipleTimesteps({{2, 0.1}});
+  REQUIRE(simB.errorMessage().empty());
+  REQUIRE(simB.getTimePoints() == sim.getTimePoints());
+  std::size_t it{sim.getTimePoints().size() - 1};
+  for (std::size_t ic = 0; ic < sim.getCompartmentIds().size(); ++ic) {
+    for (std::size_t is = 0; is < sim.getSpeciesIds(ic).size(); ++is) {
+      // results should be identical
+      REQUIRE(simB.getConc(it, ic, is) == sim.getConc(it, ic, is));
+    }
+  }
+  SECTION("checkpoint between time points") {
+    // uninterrupted simulation of a single long time point
+    auto sRef{makeModel()};
+    simulate::Simulation simRef(sRef);
+    simRef.doMultipleTimesteps({{1, 0.4}});
+    REQUIRE(simRef.errorMessage().empty());
+    // simulation stopped part way through: checkpoints are written while
+    // simulating, not just when a time point is completed
+    auto sC{makeModel()};
+    simulate::Simulation simC(sC);
+    REQUIRE(simC.setCheckpointFile("tmpsimcheckpoint2.bin", 0.0));
+    std::size_t nCallbacks{0};
+    simC.doMultipleTimesteps({{1, 0.4}}, -1.0,
+                             [&nCallbacks]() { return ++nCallbacks > 5; });
+    REQUIRE(simC.errorMessage() == "Simulation stopped early");
+    REQUIRE(simC.getTimePoints().size() == 1);
+    // the simulated time includes the incomplete part of the time point
+    REQUIRE(simC.getSimulatedTime() > 0.0);
+    REQUIRE(simC.getSimulatedTime() < 0.4);
+    auto checkpointC{simulate::importCheckpoint("tmpsimcheckpoint2.bin")};
+    REQUIRE(checkpointC != nullptr);
+    REQUIRE(checkpointC->data.timePoints.size() == 1);
+    REQUIRE(checkpointC->state.time > 0.0);
+    REQUIRE(checkpointC->state.time < 0.4);
+    // resume: only the remaining part of the time point is simulated
+    auto sD{makeModel()};
+    simulate::Simulation simD(sD, *checkpointC);
+    REQUIRE(simD.errorMessage().empty());
+    REQUIRE(simD.getNCompletedTimesteps() == 1);
+    simD.doMultipleTimesteps({{1, 0.4}});
+    REQUIRE(simD.errorMessage().empty());
+    REQUIRE(simD.getTimePoints().size() == 2);
+    REQUIRE(simD.getTimePoints()[1] == dbl_approx(0.4));
+    for (std::size_t ic = 0; ic < simRef.getCompartmentIds().size(); ++ic) {
+      for (std::size_t is = 0; is < simRef.getSpeciesIds(ic).size(); ++is) {
+        // same timesteps, up to rounding errors in the simulated time
+        auto c{simD.getConc(1, ic, is)};
+        auto cRef{simRef.getConc(1, ic, is)};
+        REQUIRE(c.size() == cRef.size());
+        for (std::size_t i = 0; i < c.size(); ++i) {
+          REQUIRE(c[i] == Catch::Approx(cRef[i]).epsilon(1e-10).margin(1e-12));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("Pixel simulator: reset with parameter overrides",
+          "[core/simulate/simulate][core/simulate][core][simulate][pixel]") {
+  auto makeModel = [](bool runtimeParameters) {
+    auto m{getExampleModel(Mod::ABtoC)};
+    m.getSimulationSettings().simulatorType = simulate::SimulatorType::Pixel;
+    m.getSimulationSettings().options.pixel.integrator =
+        simulate::PixelIntegratorType::RK212;
+    m.getSimulationSettings().options.pixel.enableRuntimeParameters =
+        runtimeParameters;
+    m.getOptimizeOptions().optParams.push_back(
+        {simulate::OptParamType::ReactionParameter, "name", "k1", "r1", 0.05,
+         0.21});
+    return m;
+  };
+  auto requireSameConcs = [](const simulate::Simulation &a,
+                             const simulate::Simulation &b) {
+    REQUIRE(a.getTimePoints() == b.getTimePoints());
+    std::size_t it{a.getTimePoints().size() - 1};
+    for (std::size_t ic = 0; ic < a.getCompartmentIds().size(); ++ic) {
+      for (std::size_t is = 0; is < a.getSpeciesIds(ic).size(); ++is) {
+        REQUIRE(a.getConc(it, ic, is) == b.getConc(it, ic, is));
+      }
+    }
+  };
+  for (bool runtimeParameters : {true, false}) {
+    CAPTURE(runtimeParameters);
+    // reference simulation with k1 = 0.2
+    auto sRef{makeModel(runtimeParameters)};
+    sRef.getReactions().setParameterValue("r1", "k1", 0.2);
+    simulate::Simulation simRef(sRef);
+    simRef.doMultipleTimesteps({{2, 0.1}});
+    REQUIRE(simRef.errorMessage().empty());
+    // simulation with k1 = 0.1, then reset with k1 = 0.2
+    auto s{makeModel(runtimeParameters)};
+    simulate::Simulation sim(s);
+    sim.doMultipleTimesteps({{3, 0.1}});
+    REQUIRE(sim.errorMessage().empty());
+    REQUIRE(sim.getTimePoints().size() == 4);
+    // the compiled reaction terms can only be re-used if k1 is a runtime
+    // parameter
+    REQUIRE(sim.reset({{"k1", "r1", 0.2}}) == runtimeParameters);
+    REQUIRE(s.getReactions().getParameterValue("r1", "k1") ==
+            dbl_approx(0.2));
+    REQUIRE(sim.getNCompletedTimesteps() == 1);
+    REQUIRE(sim.getTimePoints().size() == 1);
+    REQUIRE(sim.getConc(0, 0, 0) == simRef.getConc(0, 0, 0));
+    sim.doMultipleTimesteps({{2, 0.1}});
+    REQUIRE(sim.errorMessage().empty());
+    requireSameConcs(sim, simRef);
+    // reset without changing any parameters
+    REQUIRE(sim.reset() == runtimeParameters);
+    sim.doMultipleTimesteps({{2, 0.1}});
+    REQUIRE(sim.errorMessage().empty());
+    requireSameConcs(sim, simRef);
+  }
+}
+
+TEST_CASE("Pixel simulator: SoA layout matches AoS layout",
+          "[core/simulate/simulate][core/simulate][core][simulate][pixel]") {
+  for (auto exampleModel : {Mod::VerySimpleModel, Mod::ABtoC,
+                            Mod::SingleCompartmentDiffusion3D}) {
+    auto s{getExampleModel(exampleModel)};
+    s.getSimulationSettings().simulatorType = simulate::SimulatorType::Pixel;
+    auto &options{s.getSimulationSettings().options};
+    options.pixel.integrator = simulate::PixelIntegratorType::RK212;
+    for (bool multiThreading : {false, true}) {
+      options.pixel.enableMultiThreading = multiThreading;
+      options.pixel.enableSoALayout = false;
+      s.getSimulationData().clear();
+      simulate::Simulation simAoS(s);
+      simAoS.doMultipleTimesteps({{2, 0.05}});
+      options.pixel.enableSoALayout = true;
+      s.getSimulationData().clear();
+      simulate::Simulation simSoA(s);
+      simSoA.doMultipleTimesteps({{2, 0.05}});
+      CAPTURE(exampleModel);
+      CAPTURE(multiThreading);
+      REQUIRE(simSoA.errorMessage().empty());
+      REQUIRE(simSoA.getTimePoints().size() == simAoS.getTimePoints().size());
+      std::size_t it{simAoS.getTimePoints().size() - 1};
+      for (std::size_t ic = 0; ic < simAoS.getCompartmentIds().size(); ++ic) {
+        for (std::size_t is = 0; is < simAoS.getSpeciesIds(ic).size(); ++is) {
+          // results should be identical
+          REQUIRE(simSoA.getConc(it, ic, is) == simAoS.getConc(it, ic, is));
+          REQUIRE(simSoA.getDcdt(ic, is) == simAoS.getDcdt(ic, is));
+        }
+      }
+    }
+  }
+}
+
 TEST_CASE("DUNE: simulation",
           "[core/simulate/simulate][core/simulate][core][simulate][dune]") {
   SECTION("ABtoC model") {
@@ -1207,6 +1509,45 @@ TEST_CASE("DUNE: simulation",
   }
 }
 
+TEST_CASE("DUNE: reset with parameter overrides",
+          "[core/simulate/simulate][core/simulate][core][simulate][dune]") {
+  auto makeModel = []() {
+    auto m{getExampleModel(Mod::ABtoC)};
+    auto &options{m.getSimulationSettings().options};
+    options.dune.dt = 0.01;
+    options.dune.maxDt = 0.01;
+    options.dune.minDt = 0.005;
+    m.getSimulationSettings().simulatorType = simulate::SimulatorType::DUNE;
+    return m;
+  };
+  // reference simulation with k1 = 0.2
+  auto sRef{makeModel()};
+  sRef.getReactions().setParameterValue("r1", "k1", 0.2);
+  simulate::Simulation simRef(sRef);
+  simRef.doMultipleTimesteps({{2, 0.02}});
+  REQUIRE(simRef.errorMessage().empty());
+  // simulation with k1 = 0.1, then reset with k1 = 0.2
+  auto s{makeModel()};
+  simulate::Simulation sim(s);
+  sim.doMultipleTimesteps({{3, 0.02}});
+  REQUIRE(sim.errorMessage().empty());
+  // the DUNE model is re-created on the existing grid
+  REQUIRE(sim.reset({{"k1", "r1", 0.2}}));
+  REQUIRE(sim.getNCompletedTimesteps() == 1);
+  REQUIRE(sim.getTimePoints().size() == 1);
+  for (std::size_t is = 0; is < 3; ++is) {
+    REQUIRE(sim.getAvgMinMax(0, 0, is).avg ==
+            dbl_approx(simRef.getAvgMinMax(0, 0, is).avg));
+  }
+  sim.doMultipleTimesteps({{2, 0.02}});
+  REQUIRE(sim.errorMessage().empty());
+  REQUIRE(sim.getTimePoints() == simRef.getTimePoints());
+  for (std::size_t is = 0; is < 3; ++is) {
+    REQUIRE(sim.getAvgMinMax(2, 0, is).avg ==
+            dbl_approx(simRef.getAvgMinMax(2, 0, is).avg));
+  }
+}
+
 TEST_CASE("getConcImage",
           "[core/simulate/simulate][core/simulate][core][simulate]") {
   SECTION("very-simple-model") {
@@ -1312,9 +1653,11 @@ static double rel_diff(const simulate::SimulationData &a,
                        std::size_t iTimeB) {
   double d{0.0};
   double n{0.0};
-  for (std::size_t iC = 0; iC < a.concentration[iTimeA].size(); ++iC) {
-    const auto &cA{a.concentration[iTimeA][iC]};
-    const auto &cB{b.concentration[iTimeB][iC]};
+  const auto frameA{a.concentration.getFrame(iTimeA)};
+  const auto frameB{b.concentration.getFrame(iTimeB)};
+  for (std::size_t iC = 0; iC < frameA->size(); ++iC) {
+    const auto &cA{(*frameA)[iC]};
+    const auto &cB{(*frameB)[iC]};
     // normalise to max conc over all species & points in each compartment
     double norm{*std::max_element(cA.cbegin(), cA.cend())};
     if (norm == 0.0) {
@@ -1350,6 +1693,29 @@ static double rel_diff(const std::vector<double> &a,
   return d / n / norm;
 }
 
+TEST_CASE("getConcArray 3d",
+          "[core/simulate/simulate][core/simulate][core][simulate][3d]") {
+  auto s{getExampleModel(Mod::SingleCompartmentDiffusion3D)};
+  s.getSimulationSettings().simulatorType = simulate::SimulatorType::Pixel;
+  s.getSpecies().setAnalyticConcentration("slow", "1 + x + 2*y + 3*z");
+  simulate::Simulation sim(s);
+  const auto &volume{s.getGeometry().getImages().volume()};
+  REQUIRE(volume.depth() > 1);
+  const auto nx{static_cast<std::size_t>(volume.width())};
+  const auto ny{static_cast<std::size_t>(volume.height())};
+  const auto *comp{s.getCompartments().getCompartment("cube")};
+  auto conc{sim.getConc(0, 0, 0)};
+  auto array{sim.getConcArray(0, 0, 0)};
+  // same layout as a sampled field, with one value per voxel of the image
+  REQUIRE(array.size() == volume.nVoxels());
+  for (std::size_t ix = 0; ix < comp->nVoxels(); ++ix) {
+    const auto &voxel{comp->getVoxel(ix)};
+    auto x{static_cast<std::size_t>(voxel.p.x())};
+    auto y{static_cast<std::size_t>(voxel.p.y())};
+    REQUIRE(array[x + nx * (ny - 1 - y) + nx * ny * voxel.z] == conc[ix]);
+  }
+}
+
 TEST_CASE("applyConcsToModel initial concentrations",
           "[core/simulate/simulate][core/simulate][core][simulate]") {
   auto s{getExampleModel(Mod::VerySimpleModel)};
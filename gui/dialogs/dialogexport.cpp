@@ -1,4 +1,5 @@
 #include "dialogexport.hpp"
+#include "concentrationimagecache.hpp"
 #include "plotwrapper.hpp"
 #include "sme/logger.hpp"
 #include "sme/utils.hpp"
@@ -7,7 +8,7 @@
 #include <QFileDialog>
 #include <algorithm>
 
-DialogExport::DialogExport(const QVector<sme::common::ImageStack> &images,
+DialogExport::DialogExport(ConcentrationImageCache &images,
                            const PlotWrapper *plotWrapper,
                            sme::model::Model &model,
                            const sme::simulate::Simulation &simulation,
@@ -70,7 +71,8 @@ void DialogExport::saveImage() {
     filename.append(".png");
   }
   // todo: how do we save a stack of images? for now just save first z=0 slice
-  imgs.at(ui->cmbTimepoint->currentIndex())[0].save(filename);
+  auto timepoint{static_cast<std::size_t>(ui->cmbTimepoint->currentIndex())};
+  imgs.get(timepoint)[0].save(filename);
   accept();
 }
 
@@ -80,9 +82,9 @@ void DialogExport::saveImages() {
   if (dir.isEmpty()) {
     reject();
   }
-  for (int i = 0; i < imgs.size(); ++i) {
+  for (std::size_t i = 0; i < imgs.size(); ++i) {
     // todo: how do we save a stack of images? for now just save first z=0 slice
-    imgs.at(i)[0].save(QDir(dir).filePath(QString("img%1.png").arg(i)));
+    imgs.get(i)[0].save(QDir(dir).filePath(QString("img%1.png").arg(i)));
   }
   accept();
 }
@@ -10,13 +10,14 @@ namespace Ui {
 class DialogExport;
 }
 
+class ConcentrationImageCache;
 class PlotWrapper;
 
 class DialogExport : public QDialog {
   Q_OBJECT
 
 public:
-  explicit DialogExport(const QVector<sme::common::ImageStack> &images,
+  explicit DialogExport(ConcentrationImageCache &images,
                         const PlotWrapper *plotWrapper,
                         sme::model::Model &model,
                         const sme::simulate::Simulation &simulation,
@@ -25,7 +26,7 @@ public:
 
 private:
   const std::unique_ptr<Ui::DialogExport> ui;
-  const QVector<sme::common::ImageStack> &imgs;
+  ConcentrationImageCache &imgs;
   const PlotWrapper *plot;
   sme::model::Model &m;
   const sme::simulate::Simulation &sim;
@@ -1,4 +1,5 @@
 #include "catch_wrapper.hpp"
+#include "concentrationimagecache.hpp"
 #include "dialogexport.hpp"
 #include "model_test_utils.hpp"
 #include "plotwrapper.hpp"
@@ -30,6 +31,10 @@ TEST_CASE("DialogExport", "[gui/dialogs/export][gui/dialogs][gui][export]") {
   imgs[2].fill(col2);
   imgs[3].fill(col3);
   imgs[4].fill(col4);
+  ConcentrationImageCache imageCache;
+  imageCache.setRenderer(
+      [&imgs](std::size_t i) { return imgs[static_cast<int>(i)]; });
+  imageCache.resize(static_cast<std::size_t>(imgs.size()));
   QWidget plotParent;
   PlotWrapper plot("title", &plotParent);
   plot.addAvMinMaxLine("l1", QColor(12, 12, 12));
@@ -38,7 +43,7 @@ TEST_CASE("DialogExport", "[gui/dialogs/export][gui/dialogs][gui][export]") {
   plot.addAvMinMaxPoint(0, 2.0, {1.0, 1.0, 1.0});
   plot.addAvMinMaxPoint(0, 3.0, {1.0, 1.0, 1.0});
   plot.addAvMinMaxPoint(0, 4.0, {1.0, 1.0, 1.0});
-  DialogExport dia(imgs, &plot, model, sim, 2);
+  DialogExport dia(imageCache, &plot, model, sim, 2);
   ModalWidgetTimer mwt;
   SECTION("user clicks export to model") {
     std::size_t i{18};
@@ -1,15 +1,26 @@
 #include "dialogimageslice.hpp"
+#include "concentrationimagecache.hpp"
 #include "sme/logger.hpp"
 #include "ui_dialogimageslice.h"
 #include <QFileDialog>
 #include <algorithm>
 
+static std::vector<QImage> getZSlices(ConcentrationImageCache &images,
+                                      std::size_t z) {
+  std::vector<QImage> zSlices;
+  zSlices.reserve(images.size());
+  for (std::size_t i = 0; i < images.size(); ++i) {
+    zSlices.push_back(images.get(i)[z]);
+  }
+  return zSlices;
+}
+
 DialogImageSlice::DialogImageSlice(
     const sme::common::ImageStack &geometryImage,
-    const QVector<sme::common::ImageStack> &images,
-    const QVector<double> &timepoints, bool invertYAxis, QWidget *parent)
+    ConcentrationImageCache &images, const QVector<double> &timepoints,
+    bool invertYAxis, QWidget *parent)
     : QDialog(parent), ui{std::make_unique<Ui::DialogImageSlice>()},
-      imgs{images}, time{timepoints},
+      imgs{getZSlices(images, z_index)}, time{timepoints},
       startPoint{0, geometryImage.volume().height() - 1},
       endPoint{geometryImage.volume().width() - 1, 0} {
   ui->setupUi(this);
@@ -70,7 +81,7 @@ void DialogImageSlice::updateSlicedImage() {
   for (const auto &img : imgs) {
     int y = np - 1;
     for (const auto &pixel : pixels) {
-      slice[0].setPixel(t, y, img[z_index].pixel(pixel));
+      slice[0].setPixel(t, y, img.pixel(pixel));
       --y;
     }
     ++t;
@@ -102,7 +113,7 @@ void DialogImageSlice::cmbSliceType_activated(int index) {
     sliceType = SliceType::Vertical;
   }
   lblSlice_mouseDown(
-      QPoint(imgs[0].volume().width() / 2, imgs[0].volume().height() / 2));
+      QPoint(imgs[0].width() / 2, imgs[0].height() / 2));
 }
 
 void DialogImageSlice::lblSlice_mouseDown(QPoint point) {
@@ -128,8 +139,8 @@ void DialogImageSlice::lblSlice_sliceDrawn(QPoint start, QPoint end) {
 
 void DialogImageSlice::lblSlice_mouseWheelEvent(int delta) {
   int dp = delta / std::abs(delta);
-  QPoint p(std::clamp(horizontal + dp, 0, imgs[0].volume().height() - 1),
-           std::clamp(vertical + dp, 0, imgs[0].volume().width() - 1));
+  QPoint p(std::clamp(horizontal + dp, 0, imgs[0].height() - 1),
+           std::clamp(vertical + dp, 0, imgs[0].width() - 1));
   lblSlice_mouseDown(p);
 }
 
@@ -3,10 +3,12 @@
 #include "sme/image_stack.hpp"
 #include <QDialog>
 #include <memory>
+#include <vector>
 
 namespace Ui {
 class DialogImageSlice;
 }
+class ConcentrationImageCache;
 
 enum class SliceType { Horizontal, Vertical, Custom };
 
@@ -15,7 +17,7 @@ class DialogImageSlice : public QDialog {
 
 public:
   explicit DialogImageSlice(const sme::common::ImageStack &geometryImage,
-                            const QVector<sme::common::ImageStack> &images,
+                            ConcentrationImageCache &images,
                             const QVector<double> &timepoints, bool invertYAxis,
                             QWidget *parent = nullptr);
   ~DialogImageSlice() override;
@@ -25,7 +27,8 @@ private:
   // todo: don't hard-code z to zero here
   static constexpr std::size_t z_index{0};
   const std::unique_ptr<Ui::DialogImageSlice> ui;
-  const QVector<sme::common::ImageStack> &imgs;
+  // only the z-slice of each image that is displayed is kept
+  const std::vector<QImage> imgs;
   const QVector<double> &time;
   sme::common::ImageStack slice;
   SliceType sliceType;
@@ -1,4 +1,5 @@
 #include "catch_wrapper.hpp"
+#include "concentrationimagecache.hpp"
 #include "dialogimageslice.hpp"
 #include "qlabelmousetracker.hpp"
 #include "qlabelslice.hpp"
@@ -19,7 +20,11 @@ TEST_CASE("DialogImageSlice",
   }
   imgs[3].fill(col2);
   QVector<double> time{0, 1, 2, 3, 4};
-  DialogImageSlice dia(imgGeometry, imgs, time, false);
+  ConcentrationImageCache imageCache;
+  imageCache.setRenderer(
+      [&imgs](std::size_t i) { return imgs[static_cast<int>(i)]; });
+  imageCache.resize(static_cast<std::size_t>(imgs.size()));
+  DialogImageSlice dia(imgGeometry, imageCache, time, false);
   auto *lblSlice{dia.findChild<QLabelSlice *>("lblSlice")};
   REQUIRE(lblSlice != nullptr);
   auto *lblImage{dia.findChild<QLabelMouseTracker *>("lblImage")};
@@ -48,6 +48,8 @@ static QString toQStr(sme::simulate::OptAlgorithmType optAlgorithmType) {
     return "Artificial Bee Colony";
   case sme::simulate::OptAlgorithmType::gaco:
     return "Extended Ant Colony Optimization";
+  case sme::simulate::OptAlgorithmType::LBFGS:
+    return "Gradient-based local search (L-BFGS)";
   default:
     return "";
   }
@@ -161,7 +163,8 @@ setValidMinPopulation(sme::simulate::OptAlgorithmType optAlgorithmType,
       {sme::simulate::OptAlgorithmType::jDE, 7},
       {sme::simulate::OptAlgorithmType::pDE, 7},
       {sme::simulate::OptAlgorithmType::ABC, 2},
-      {sme::simulate::OptAlgorithmType::gaco, 7}};
+      {sme::simulate::OptAlgorithmType::gaco, 7},
+      {sme::simulate::OptAlgorithmType::LBFGS, 2}};
   if (auto iter{minPopulation.find(optAlgorithmType)};
       iter != minPopulation.end()) {
     spinPopulation->setMinimum(iter->second);
@@ -19,6 +19,8 @@ static int toIndex(sme::simulate::PixelIntegratorType integrator) {
     return 2;
   case sme::simulate::PixelIntegratorType::RK435:
     return 3;
+  case sme::simulate::PixelIntegratorType::IMEX:
+    return 4;
   default:
     return 0;
   }
@@ -34,6 +36,8 @@ static sme::simulate::PixelIntegratorType toPixelIntegratorEnum(int index) {
     return sme::simulate::PixelIntegratorType::RK323;
   case 3:
     return sme::simulate::PixelIntegratorType::RK435;
+  case 4:
+    return sme::simulate::PixelIntegratorType::IMEX;
   default:
     return sme::simulate::PixelIntegratorType::RK101;
   }
@@ -462,6 +462,7 @@ void MainWindow::actionExport_Dune_ini_file_triggered() {
     iniFilename.append(".ini");
   }
   QGuiApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+  model.getGeometry().ensureMesh3d();
   sme::simulate::DuneConverter dc(model, {}, true, iniFilename);
   QGuiApplication::restoreOverrideCursor();
 }
@@ -12,9 +12,11 @@
 #include "sme/simulate.hpp"
 #include "sme/utils.hpp"
 #include "ui_tabsimulate.h"
+#include <QCoreApplication>
 #include <QMessageBox>
 #include <QProgressDialog>
 #include <algorithm>
+#include <chrono>
 #include <future>
 
 TabSimulate::TabSimulate(sme::model::Model &m, QLabelMouseTracker *mouseTracker,
@@ -85,6 +87,26 @@ static void importModelTimesAndIntervals(
   }
 }
 
+void TabSimulate::constructMesh3d() {
+  auto &geometry{model.getGeometry()};
+  if (geometry.getMesh3d() != nullptr || !geometry.getIsValid() ||
+      geometry.getImages().volume().depth() < 2) {
+    return;
+  }
+  // tetrahedral meshing can take a while, so is done in a separate thread
+  QProgressDialog dialog("Constructing tetrahedral mesh...", {}, 0, 0, this);
+  dialog.setWindowModality(Qt::WindowModal);
+  dialog.setMinimumDuration(0);
+  dialog.setValue(0);
+  auto meshing{std::async(std::launch::async,
+                          &sme::model::ModelGeometry::ensureMesh3d, &geometry)};
+  constexpr std::chrono::milliseconds pollInterval{20};
+  while (meshing.wait_for(pollInterval) != std::future_status::ready) {
+    QCoreApplication::processEvents();
+  }
+  meshing.get();
+}
+
 void TabSimulate::loadModelData() {
   if (sim != nullptr && sim->getIsRunning()) {
     return;
@@ -101,10 +123,10 @@ void TabSimulate::loadModelData() {
   }
   if (model.getSimulationSettings().simulatorType ==
       sme::simulate::SimulatorType::DUNE) {
+    constructMesh3d();
     QString duneInvalidTitle{};
     QString duneInvalidMessage{};
-    if (model.getGeometry().getMesh() == nullptr ||
-        !model.getGeometry().getMesh()->isValid()) {
+    if (!model.getGeometry().getHasValidMesh()) {
       duneInvalidTitle = "Invalid Mesh";
       duneInvalidMessage =
           "Mesh geometry is not valid, and is required for a DuneCopasi "
@@ -207,6 +229,7 @@ void TabSimulate::loadModelData() {
     displayOptions.showSpecies.resize(nSpecies, true);
   }
   updateSpeciesToDraw();
+  updateImageRenderer();
   updatePlotAndImages();
   finalizePlotAndImages();
 }
@@ -237,6 +260,7 @@ void TabSimulate::reset() {
     sim->requestStop();
     simSteps.wait();
   }
+  images.clear();
   model.getSimulationData().clear();
   importModelTimesAndIntervals(ui.get(), model.getSimulationSettings().times);
   model.getSimulationSettings().times.clear();
@@ -270,17 +294,22 @@ void TabSimulate::btnSimulate_clicked() {
 
   // display modal progress dialog box
   progressDialog->setWindowModality(Qt::WindowModal);
-  progressDialog->setValue(static_cast<int>(time.size()) - 1);
+  progressDialog->setMaximum(progressSteps);
+  progressDialog->setValue(0);
   progressDialog->show();
   ui->btnSimulate->setEnabled(false);
   ui->btnResetSimulation->setEnabled(false);
-  auto progressMax{static_cast<int>(time.size())};
-  for (const auto &simulationTime : simulationTimes.value()) {
-    progressMax += static_cast<int>(simulationTime.first);
+  // progress is measured in simulation time, which the simulator also updates
+  // within each image interval
+  progressStartTime = sim->getSimulatedTime();
+  progressEndTime = progressStartTime;
+  for (const auto &[n, dt] : simulationTimes.value()) {
+    progressEndTime += static_cast<double>(n) * dt;
   }
-  progressDialog->setMaximum(progressMax);
 
   this->setCursor(Qt::WaitCursor);
+  // wait for any background image rendering before adding new results
+  updateImageRenderer();
   // start simulation in a new thread
   simSteps = std::async(
       std::launch::async, &sme::simulate::Simulation::doMultipleTimesteps,
@@ -320,6 +349,17 @@ void TabSimulate::updateSpeciesToDraw() {
   }
 }
 
+void TabSimulate::updateImageRenderer() {
+  // images are rendered lazily (and possibly concurrently) when requested
+  images.setRenderer([s = sim.get(), speciesToDraw = compartmentSpeciesToDraw,
+                      options = displayOptions](std::size_t timeIndex) {
+    return s->getConcImage(timeIndex, speciesToDraw,
+                           options.normaliseOverAllTimepoints,
+                           options.normaliseOverAllSpecies);
+  });
+  images.resize(static_cast<std::size_t>(time.size()));
+}
+
 void TabSimulate::updatePlotAndImages() {
   if (sim == nullptr) {
     return;
@@ -327,12 +367,17 @@ void TabSimulate::updatePlotAndImages() {
   std::size_t n0{static_cast<std::size_t>(time.size())};
   std::size_t n{sim->getNCompletedTimesteps()};
   if (!sim->getIsStopping()) {
-    progressDialog->setValue(static_cast<int>(n0));
+    double progress{1.0};
+    if (progressEndTime > progressStartTime) {
+      progress = (sim->getSimulatedTime() - progressStartTime) /
+                 (progressEndTime - progressStartTime);
+    }
+    progressDialog->setValue(
+        static_cast<int>(std::clamp(progress, 0.0, 1.0) * progressSteps));
   }
   for (std::size_t i = n0; i < n; ++i) {
     SPDLOG_DEBUG("adding timepoint {}", i);
     // process new results
-    images.push_back(sim->getConcImage(i, compartmentSpeciesToDraw));
     time.push_back(sim->getTimePoints()[i]);
     int speciesIndex = 0;
     for (std::size_t ic = 0; ic < sim->getCompartmentIds().size(); ++ic) {
@@ -342,8 +387,13 @@ void TabSimulate::updatePlotAndImages() {
         ++speciesIndex;
       }
     }
-    lblGeometry->setImage(images.back());
-    voxGeometry->setImage(images.back());
+  }
+  if (n > n0) {
+    // only render the image for the latest timepoint
+    images.resize(n);
+    auto image{images.get(n - 1)};
+    lblGeometry->setImage(image);
+    voxGeometry->setImage(image);
     plt->plot->rescaleAxes(true);
     plt->plot->replot(QCustomPlot::RefreshPriority::rpQueuedReplot);
   }
@@ -379,13 +429,8 @@ void TabSimulate::finalizePlotAndImages() {
   }
   plt->update(displayOptions.showSpecies, displayOptions.showMinMax);
   updateSpeciesToDraw();
-  // update all images
-  for (int iTime = 0; iTime < time.size(); ++iTime) {
-    images[iTime] = sim->getConcImage(static_cast<std::size_t>(iTime),
-                                      compartmentSpeciesToDraw,
-                                      displayOptions.normaliseOverAllTimepoints,
-                                      displayOptions.normaliseOverAllSpecies);
-  }
+  // discard any previously rendered images
+  updateImageRenderer();
   plt->setVerticalLine(time.back());
   // enable slider to choose time to display
   ui->hslideTime->setEnabled(true);
@@ -396,8 +441,10 @@ void TabSimulate::finalizePlotAndImages() {
   if (const auto &err{sim->errorMessage()}; err == "Simulation stopped early") {
     // reset simulation after early stop as it may contain a partial timestep
     SPDLOG_INFO("resetting simulation after early stop");
+    images.clear();
     sim.reset();
     sim = std::make_unique<sme::simulate::Simulation>(model);
+    updateImageRenderer();
   }
 }
 
@@ -442,13 +489,20 @@ void TabSimulate::graphClicked(const QMouseEvent *event) {
 }
 
 void TabSimulate::hslideTime_valueChanged(int value) {
-  if (images.size() <= value) {
+  auto timeIndex{static_cast<std::size_t>(value)};
+  if (value < 0 || images.size() <= timeIndex) {
     return;
   }
-  lblGeometry->setImage(images[value]);
-  voxGeometry->setImage(images[value]);
+  auto image{images.get(timeIndex)};
+  lblGeometry->setImage(image);
+  voxGeometry->setImage(image);
   plt->setVerticalLine(time[value]);
   plt->plot->replot();
   ui->lblCurrentTime->setText(
       QString("%1%2").arg(time[value]).arg(model.getUnits().getTime().name));
+  // render neighbouring timepoints in the background
+  images.prefetch(timeIndex + 1);
+  if (timeIndex > 0) {
+    images.prefetch(timeIndex - 1);
+  }
 }
@@ -1,6 +1,7 @@
 // TabSimulate
 
 #pragma once
+#include "concentrationimagecache.hpp"
 #include "dialogdisplayoptions.hpp"
 #include "plotwrapper.hpp"
 #include "sme/image_stack.hpp"
@@ -48,7 +49,8 @@ private:
   std::unique_ptr<sme::simulate::Simulation> sim;
   sme::model::DisplayOptions displayOptions;
   QVector<double> time;
-  QVector<sme::common::ImageStack> images;
+  // declared after sim so that any background rendering finishes first
+  ConcentrationImageCache images;
   QStringList compartmentNames;
   std::vector<QStringList> speciesNames;
   std::vector<std::vector<std::size_t>> compartmentSpeciesToDraw;
@@ -56,15 +58,20 @@ private:
   std::future<std::size_t> simSteps;
   QTimer plotRefreshTimer;
   QProgressDialog *progressDialog;
+  static constexpr int progressSteps{1000};
+  double progressStartTime{0.0};
+  double progressEndTime{0.0};
   bool importTimesAndIntervals{false};
   bool flipYAxis{false};
 
   std::optional<std::vector<std::pair<std::size_t, double>>>
   parseSimulationTimes();
+  void constructMesh3d();
   void btnSimulate_clicked();
   void btnSliceImage_clicked();
   void btnExport_clicked();
   void updateSpeciesToDraw();
+  void updateImageRenderer();
   void updatePlotAndImages();
   void finalizePlotAndImages();
   void btnDisplayOptions_clicked();
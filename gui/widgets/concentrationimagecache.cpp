@@ -0,0 +1,88 @@
+#include "concentrationimagecache.hpp"
+#include "sme/logger.hpp"
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+ConcentrationImageCache::ConcentrationImageCache(std::size_t maxCachedImages)
+    : maxCached{std::max(maxCachedImages, std::size_t{1})} {}
+
+ConcentrationImageCache::~ConcentrationImageCache() { discardCachedImages(); }
+
+void ConcentrationImageCache::setRenderer(Renderer imageRenderer) {
+  discardCachedImages();
+  renderer = std::move(imageRenderer);
+}
+
+void ConcentrationImageCache::resize(std::size_t nImages) {
+  n = nImages;
+  // remove any cached images that are no longer valid
+  for (auto iter = lru.begin(); iter != lru.end();) {
+    if (*iter >= n) {
+      entries.erase(*iter);
+      iter = lru.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+std::size_t ConcentrationImageCache::size() const { return n; }
+
+bool ConcentrationImageCache::empty() const { return n == 0; }
+
+std::size_t ConcentrationImageCache::nCached() const { return entries.size(); }
+
+sme::common::ImageStack ConcentrationImageCache::get(std::size_t index) {
+  if (index >= n || !renderer) {
+    return {};
+  }
+  if (auto iter{entries.find(index)}; iter != entries.end()) {
+    // move to front of the lru list
+    lru.splice(lru.begin(), lru, iter->second.lruIter);
+    // may block if this image is still being rendered in the background
+    return iter->second.image.get();
+  }
+  SPDLOG_DEBUG("rendering image {}", index);
+  std::promise<sme::common::ImageStack> promise;
+  auto image{promise.get_future().share()};
+  promise.set_value(renderer(index));
+  insert(index, image);
+  return image.get();
+}
+
+void ConcentrationImageCache::prefetch(std::size_t index) {
+  if (index >= n || !renderer || entries.contains(index)) {
+    return;
+  }
+  SPDLOG_DEBUG("prefetching image {}", index);
+  auto task{std::make_shared<std::packaged_task<sme::common::ImageStack()>>(
+      [r = renderer, index]() { return r(index); })};
+  insert(index, task->get_future().share());
+  threadPool.start([task]() { (*task)(); });
+}
+
+void ConcentrationImageCache::clear() {
+  discardCachedImages();
+  renderer = {};
+  n = 0;
+}
+
+void ConcentrationImageCache::insert(
+    std::size_t index, std::shared_future<sme::common::ImageStack> image) {
+  lru.push_front(index);
+  entries[index] = {std::move(image), lru.begin()};
+  while (entries.size() > maxCached) {
+    entries.erase(lru.back());
+    lru.pop_back();
+  }
+}
+
+void ConcentrationImageCache::discardCachedImages() {
+  // the renderer may refer to objects that are about to be deleted, so
+  // wait for any images that are currently being rendered to finish
+  threadPool.clear();
+  threadPool.waitForDone();
+  entries.clear();
+  lru.clear();
+}
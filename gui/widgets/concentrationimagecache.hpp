@@ -0,0 +1,73 @@
+#pragma once
+#include "sme/image_stack.hpp"
+#include <QThreadPool>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <list>
+#include <unordered_map>
+
+/**
+ * @brief Lazily rendered concentration images for each simulation timepoint
+ *
+ * Images are only rendered when they are requested, and a limited number of
+ * the most recently used images are kept in memory. Images can also be
+ * prefetched, in which case they are rendered on a background thread pool.
+ *
+ * Not thread safe: all member functions should be called from the same thread.
+ */
+class ConcentrationImageCache {
+public:
+  using Renderer = std::function<sme::common::ImageStack(std::size_t)>;
+  static constexpr std::size_t defaultMaxCachedImages{32};
+  explicit ConcentrationImageCache(
+      std::size_t maxCachedImages = defaultMaxCachedImages);
+  ~ConcentrationImageCache();
+  ConcentrationImageCache(const ConcentrationImageCache &) = delete;
+  ConcentrationImageCache &operator=(const ConcentrationImageCache &) = delete;
+  /**
+   * @brief Set the function used to render the image for a timepoint
+   *
+   * Any cached images are discarded. The renderer is called from the thread
+   * pool, so must be safe to call concurrently.
+   */
+  void setRenderer(Renderer imageRenderer);
+  /**
+   * @brief Set the number of timepoints with an image
+   */
+  void resize(std::size_t nImages);
+  [[nodiscard]] std::size_t size() const;
+  [[nodiscard]] bool empty() const;
+  /**
+   * @brief The number of images currently held in the cache
+   */
+  [[nodiscard]] std::size_t nCached() const;
+  /**
+   * @brief The image for a timepoint, rendered now if it is not in the cache
+   */
+  sme::common::ImageStack get(std::size_t index);
+  /**
+   * @brief Start rendering the image for a timepoint in the background
+   */
+  void prefetch(std::size_t index);
+  /**
+   * @brief Discard all cached images, and the renderer
+   */
+  void clear();
+
+private:
+  struct Entry {
+    std::shared_future<sme::common::ImageStack> image;
+    std::list<std::size_t>::iterator lruIter;
+  };
+  std::size_t maxCached;
+  std::size_t n{0};
+  Renderer renderer;
+  std::unordered_map<std::size_t, Entry> entries;
+  // most recently used index is at the front
+  std::list<std::size_t> lru;
+  QThreadPool threadPool;
+  void insert(std::size_t index,
+              std::shared_future<sme::common::ImageStack> image);
+  void discardCachedImages();
+};
@@ -0,0 +1,91 @@
+#include "catch_wrapper.hpp"
+#include "concentrationimagecache.hpp"
+#include <atomic>
+
+static constexpr uint opaque{0xff000000};
+
+TEST_CASE("ConcentrationImageCache",
+          "[gui/widgets/concentrationimagecache][gui/widgets][gui]") {
+  std::atomic<int> nRendered{0};
+  auto renderer{[&nRendered](std::size_t i) {
+    ++nRendered;
+    sme::common::ImageStack img({4, 3, 2}, QImage::Format_ARGB32_Premultiplied);
+    img.fill(opaque | static_cast<uint>(i));
+    return img;
+  }};
+  ConcentrationImageCache cache(3);
+  REQUIRE(cache.empty());
+  REQUIRE(cache.size() == 0);
+  // no renderer or images: returns empty image
+  REQUIRE(cache.get(0).empty());
+  cache.setRenderer(renderer);
+  REQUIRE(cache.get(0).empty());
+  cache.resize(10);
+  REQUIRE(cache.size() == 10);
+  REQUIRE(nRendered == 0);
+  SECTION("images are only rendered when requested") {
+    auto img{cache.get(4)};
+    REQUIRE(nRendered == 1);
+    REQUIRE(img.volume().depth() == 2);
+    REQUIRE(img[1].pixel(0, 0) == (opaque | 4));
+    REQUIRE(cache.nCached() == 1);
+    // cached image is re-used
+    img = cache.get(4);
+    REQUIRE(nRendered == 1);
+    REQUIRE(img[0].pixel(2, 1) == (opaque | 4));
+    // out of range
+    REQUIRE(cache.get(10).empty());
+    REQUIRE(nRendered == 1);
+  }
+  SECTION("least recently used images are discarded") {
+    cache.get(0);
+    cache.get(1);
+    cache.get(2);
+    REQUIRE(cache.nCached() == 3);
+    REQUIRE(nRendered == 3);
+    // use 0 so that 1 is now the least recently used
+    cache.get(0);
+    cache.get(3);
+    REQUIRE(cache.nCached() == 3);
+    REQUIRE(nRendered == 4);
+    cache.get(0);
+    cache.get(2);
+    REQUIRE(nRendered == 4);
+    cache.get(1);
+    REQUIRE(nRendered == 5);
+  }
+  SECTION("prefetched images are rendered in the background") {
+    cache.prefetch(7);
+    cache.prefetch(8);
+    // prefetching an image that is already cached does nothing
+    cache.prefetch(7);
+    REQUIRE(cache.nCached() == 2);
+    REQUIRE(cache.get(8)[0].pixel(1, 1) == (opaque | 8));
+    REQUIRE(cache.get(7)[0].pixel(1, 1) == (opaque | 7));
+    REQUIRE(nRendered == 2);
+  }
+  SECTION("changing the renderer discards cached images") {
+    cache.get(1);
+    cache.prefetch(2);
+    cache.setRenderer([](std::size_t i) {
+      sme::common::ImageStack img({2, 2, 1},
+                                  QImage::Format_ARGB32_Premultiplied);
+      img.fill(opaque | static_cast<uint>(100 + i));
+      return img;
+    });
+    REQUIRE(cache.nCached() == 0);
+    REQUIRE(cache.size() == 10);
+    REQUIRE(cache.get(1)[0].pixel(0, 0) == (opaque | 101));
+  }
+  SECTION("resizing discards images that are out of range") {
+    cache.get(1);
+    cache.get(8);
+    cache.resize(5);
+    REQUIRE(cache.nCached() == 1);
+    REQUIRE(cache.get(8).empty());
+    cache.clear();
+    REQUIRE(cache.empty());
+    REQUIRE(cache.nCached() == 0);
+    REQUIRE(cache.get(1).empty());
+  }
+}
@@ -8,6 +8,7 @@
 #include "sme_membrane.hpp"
 #include "sme_model.hpp"
 #include "sme_module.hpp"
+#include "sme_optimizationresult.hpp"
 #include "sme_parameter.hpp"
 #include "sme_reaction.hpp"
 #include "sme_reactionparameter.hpp"
@@ -26,4 +27,5 @@ PYBIND11_MODULE(sme, m) {
   sme::pybindReaction(m);
   sme::pybindReactionParameter(m);
   sme::pybindSimulationResult(m);
+  sme::pybindOptimizationResult(m);
 }
@@ -4,6 +4,7 @@
 
 #include "sme/image_stack.hpp"
 #include "sme/logger.hpp"
+#include "sme/optimize.hpp"
 #include "sme_common.hpp"
 #include "sme_model.hpp"
 #include <QElapsedTimer>
@@ -27,11 +28,13 @@ void pybindModel(pybind11::module &m) {
                     )")
       .def("export_sbml_file", &sme::Model::exportSbmlFile,
            pybind11::arg("filename"),
+           pybind11::arg("compress_sampled_fields") = false,
            R"(
            exports the model as a spatial SBML file
 
            Args:
                filename (str): the name of the file to create
+               compress_sampled_fields (bool): if True, the geometry image and any sampled field concentrations are stored compressed, which makes the file much smaller for large geometries
            )")
       .def("export_sme_file", &sme::Model::exportSmeFile,
            pybind11::arg("filename"),
@@ -234,6 +237,34 @@ void pybindModel(pybind11::module &m) {
           Returns:
               SimulationResultList: the simulation results
           )")
+      .def("optimize", &sme::Model::optimize, pybind11::arg("iterations"),
+           pybind11::arg("checkpoint_file") = "",
+           pybind11::arg("apply_parameters") = true,
+           R"(
+           optimizes the model parameters using the optimization settings of the model.
+
+           The parameters to optimize, the costs to minimize and the algorithm
+           to use are the optimization settings stored in the model,
+           which can be set up using the Spatial Model Editor GUI.
+
+           If a checkpoint file is given, the state of the optimization is written to it
+           after each iteration. If the file already exists, the optimization is resumed
+           from it, so a script that is interrupted can simply be run again to continue.
+           Every fitness evaluation is appended to the file `checkpoint_file + ".evaluations"`,
+           which is needed to resume the optimization along with the checkpoint file.
+
+           Args:
+               iterations (int): The total number of iterations to do, including any iterations in the checkpoint file.
+               checkpoint_file (str): The checkpoint file to resume from and save to. Default value: `""`, i.e. no checkpoint file.
+               apply_parameters (bool): Whether to set the model parameters to the best values found. Default value: `True`.
+
+           Returns:
+               OptimizationResult: the results of the optimization
+
+           Raises:
+               InvalidArgument: if the checkpoint file can't be read
+               RuntimeError: if the optimization fails
+           )")
       .def("__repr__",
            [](const sme::Model &a) {
              return fmt::format("<sme.Model named '{}'>", a.getName());
@@ -338,8 +369,9 @@ void Model::importGeometryFromImage(const std::string &filename) {
   }
 }
 
-void Model::exportSbmlFile(const std::string &filename) {
-  s->exportSBMLFile(filename);
+void Model::exportSbmlFile(const std::string &filename,
+                           bool compressSampledFields) {
+  s->exportSBMLFile(filename, compressSampledFields);
 }
 
 void Model::exportSmeFile(const std::string &filename) {
@@ -413,6 +445,59 @@ std::vector<SimulationResult> Model::getSimulationResults() {
   return constructSimulationResults(sim.get(), false);
 }
 
+OptimizationResult Model::optimize(std::size_t iterations,
+                                   const std::string &checkpointFile,
+                                   bool applyParameters) {
+  std::unique_ptr<simulate::Optimization> optimization;
+  std::string evaluationLogFile;
+  if (!checkpointFile.empty()) {
+    evaluationLogFile = simulate::getOptEvaluationLogFilename(checkpointFile);
+  }
+  if (!checkpointFile.empty() && QFile::exists(checkpointFile.c_str())) {
+    auto checkpoint{simulate::importOptimizationCheckpoint(checkpointFile)};
+    if (checkpoint == nullptr) {
+      throw SmeInvalidArgument("Failed to import optimization checkpoint '" +
+                               checkpointFile + "'");
+    }
+    optimization = std::make_unique<simulate::Optimization>(*s, *checkpoint,
+                                                            evaluationLogFile);
+  } else {
+    optimization =
+        std::make_unique<simulate::Optimization>(*s, evaluationLogFile);
+  }
+  while (optimization->getErrorMessage().empty() &&
+         optimization->getIterations() < iterations) {
+    optimization->evolve();
+    if (!checkpointFile.empty() &&
+        !simulate::exportOptimizationCheckpoint(
+            checkpointFile, optimization->getCheckpoint())) {
+      throw SmeRuntimeError("Failed to write optimization checkpoint '" +
+                            checkpointFile + "'");
+    }
+    if (PyErr_CheckSignals() != 0) {
+      throw pybind11::error_already_set();
+    }
+  }
+  if (const auto &e{optimization->getErrorMessage()}; !e.empty()) {
+    throw SmeRuntimeError(fmt::format("Error during optimization: {}", e));
+  }
+  if (applyParameters) {
+    optimization->applyParametersToModel(s.get());
+  }
+  OptimizationResult result;
+  result.iterations = optimization->getIterations();
+  result.fitness = optimization->getFitness();
+  result.parameters = optimization->getParams();
+  for (const auto &name : optimization->getParamNames()) {
+    result.parameterNames.push_back(name.toStdString());
+  }
+  for (auto &evaluation : optimization->getEvaluations()) {
+    result.evaluationParameters.push_back(std::move(evaluation.params));
+    result.evaluationCosts.push_back(evaluation.cost);
+  }
+  return result;
+}
+
 std::string Model::getStr() const {
   std::string str("<sme.Model>\n");
   str.append(fmt::format("  - name: '{}'\n", getName()));
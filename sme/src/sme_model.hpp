@@ -5,6 +5,7 @@
 #include "sme_common.hpp"
 #include "sme_compartment.hpp"
 #include "sme_membrane.hpp"
+#include "sme_optimizationresult.hpp"
 #include "sme_parameter.hpp"
 #include "sme_simulationresult.hpp"
 #include <memory>
@@ -29,7 +30,8 @@ public:
   [[nodiscard]] std::string getName() const;
   void setName(const std::string &name);
   void importGeometryFromImage(const std::string &filename);
-  void exportSbmlFile(const std::string &filename);
+  void exportSbmlFile(const std::string &filename,
+                      bool compressSampledFields = false);
   void exportSmeFile(const std::string &filename);
   std::vector<Compartment> compartments;
   std::vector<Membrane> membranes;
@@ -47,6 +49,9 @@ public:
                 bool continueExistingSimulation, bool returnResults,
                 int nThreads);
   std::vector<SimulationResult> getSimulationResults();
+  OptimizationResult optimize(std::size_t iterations,
+                              const std::string &checkpointFile,
+                              bool applyParameters);
   [[nodiscard]] std::string getStr() const;
 };
 
@@ -0,0 +1,62 @@
+// Python.h (included by pybind11.h) must come first
+// https://docs.python.org/3.2/c-api/intro.html#include-files
+#include <pybind11/pybind11.h>
+
+#include "sme_optimizationresult.hpp"
+
+namespace sme {
+
+void pybindOptimizationResult(pybind11::module &m) {
+  pybind11::class_<OptimizationResult>(m, "OptimizationResult",
+                                       R"(
+                                       the results of a parameter optimization
+                                       )")
+      .def_readonly("iterations", &OptimizationResult::iterations,
+                    R"(
+                    int: the total number of completed iterations
+                    )")
+      .def_readonly("fitness", &OptimizationResult::fitness,
+                    R"(
+                    List[float]: the best fitness after each iteration
+
+                    The first value is the best fitness of the initial population.
+                    )")
+      .def_readonly("parameters", &OptimizationResult::parameters,
+                    R"(
+                    List[List[float]]: the best parameter values after each iteration
+                    )")
+      .def_readonly("parameter_names", &OptimizationResult::parameterNames,
+                    R"(
+                    List[str]: the names of the parameters being optimized
+                    )")
+      .def_readonly("evaluation_parameters",
+                    &OptimizationResult::evaluationParameters,
+                    R"(
+                    List[List[float]]: the parameter values of every fitness evaluation
+                    )")
+      .def_readonly("evaluation_costs", &OptimizationResult::evaluationCosts,
+                    R"(
+                    List[float]: the cost of every fitness evaluation
+
+                    For candidates that were stopped early, or screened out using a coarse
+                    geometry, this is an estimate of the cost.
+                    )")
+      .def("__repr__",
+           [](const OptimizationResult &a) {
+             return fmt::format(
+                 "<sme.OptimizationResult after {} iterations>",
+                 a.iterations);
+           })
+      .def("__str__", &OptimizationResult::getStr);
+}
+
+std::string OptimizationResult::getStr() const {
+  std::string str("<sme.OptimizationResult>\n");
+  str.append(fmt::format("  - iterations: {}\n", iterations));
+  if (!fitness.empty()) {
+    str.append(fmt::format("  - best fitness: {}\n", fitness.back()));
+  }
+  return str;
+}
+
+} // namespace sme
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "sme_common.hpp"
+#include <pybind11/pybind11.h>
+#include <string>
+#include <vector>
+
+namespace sme {
+
+void pybindOptimizationResult(pybind11::module &m);
+
+struct OptimizationResult {
+  std::vector<double> fitness{};
+  std::vector<std::vector<double>> parameters{};
+  std::vector<std::string> parameterNames{};
+  std::vector<std::vector<double>> evaluationParameters{};
+  std::vector<double> evaluationCosts{};
+  std::size_t iterations{0};
+  [[nodiscard]] std::string getStr() const;
+};
+
+} // namespace sme
@@ -72,6 +72,18 @@ def test_export_sbml_file():
         m2.compartments["Cell"]
 
 
+def test_export_compressed_sbml_file():
+    m = sme.open_example_model()
+    m.export_sbml_file("tmp.xml")
+    m.export_sbml_file("tmp_compressed.xml", compress_sampled_fields=True)
+    with open("tmp_compressed.xml") as f:
+        assert 'spatial:compression="deflated"' in f.read()
+    assert os.path.getsize("tmp_compressed.xml") < os.path.getsize("tmp.xml")
+    m2 = sme.open_sbml_file("tmp_compressed.xml")
+    assert len(m2.compartments) == 3
+    assert np.array_equal(m2.compartment_image, m.compartment_image)
+
+
 def test_export_sme_file():
     m = sme.open_example_model()
     m.name = "Mod"
@@ -187,6 +199,45 @@ def test_simulate():
         assert len(sim_results2) == 3
 
 
+def test_optimize():
+    m = sme.open_example_model()
+    # example model has no parameters to optimize
+    with pytest.raises(sme.RuntimeError):
+        m.optimize(1)
+    # checkpoint file that can't be read
+    with pytest.raises(sme.InvalidArgument):
+        m.optimize(
+            1, checkpoint_file=_get_abs_path("concave-cell-nucleus-100x100.png")
+        )
+
+
+def test_optimize_resume(tmp_path):
+    checkpoint_file = str(tmp_path / "optimization.checkpoint")
+    m = sme.open_sbml_file(_get_abs_path("ABtoC-optimize.xml"))
+    res1 = m.optimize(1, checkpoint_file=checkpoint_file)
+    assert res1.iterations == 1
+    assert res1.parameter_names == ["k1"]
+    assert len(res1.fitness) == 2
+    assert len(res1.evaluation_costs) > 0
+    assert len(res1.evaluation_parameters) == len(res1.evaluation_costs)
+    assert os.path.isfile(checkpoint_file)
+    assert os.path.isfile(checkpoint_file + ".evaluations")
+    # resume from the checkpoint for one more iteration
+    m2 = sme.open_sbml_file(_get_abs_path("ABtoC-optimize.xml"))
+    res2 = m2.optimize(2, checkpoint_file=checkpoint_file)
+    assert res2.iterations == 2
+    assert len(res2.fitness) == 3
+    assert res2.fitness[:2] == res1.fitness
+    assert res2.fitness[2] <= res2.fitness[1]
+    n1 = len(res1.evaluation_costs)
+    assert len(res2.evaluation_costs) > n1
+    assert res2.evaluation_costs[:n1] == res1.evaluation_costs
+    assert res2.evaluation_parameters[:n1] == res1.evaluation_parameters
+    # the optimized parameter is applied to the model
+    k1 = m2.compartments["comp"].reactions["r1"].parameters["k1"].value
+    assert k1 == pytest.approx(res2.parameters[-1][0])
+
+
 def test_import_geometry_from_image():
     imgfile_original = _get_abs_path("concave-cell-nucleus-100x100.png")
     imgfile_modified = _get_abs_path("modified-concave-cell-nucleus-100x100.png")